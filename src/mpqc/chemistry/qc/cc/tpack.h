@@ -6,9 +6,13 @@
 #define SRC_MPQC_CHEMISTRY_QC_CC_TPACK_H_
 
 #include <cmath>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <mpqc/util/misc/assert.h>
+#include "mpqc/math/external/tiledarray/array_scratch.h"
+#include "mpqc/math/external/tiledarray/local_dot_product.h"
 
 namespace mpqc {
 namespace cc {
@@ -61,6 +65,19 @@ inline auto dot_product(const TPack<T> &a, const TPack<T> &b) {
   return result;
 }
 
+/// @return the contribution of this process to dot_product(a, b), see
+///         mpqc::local_dot_product()
+template <typename T>
+inline auto local_dot_product(const TPack<T> &a, const TPack<T> &b) {
+  using ::mpqc::local_dot_product;
+  MPQC_ASSERT(a.size() == b.size());
+  typename TPack<T>::scalar_type result = 0;
+  for(auto i=0; i!=a.size(); ++i) {
+    result += local_dot_product(a[i], b[i]);
+  }
+  return result;
+}
+
 template <typename T, typename Scalar>
 inline void axpy(TPack<T> &y, Scalar a, const TPack<T> &x) {
   MPQC_ASSERT(x.size() == y.size());
@@ -81,6 +98,49 @@ inline void scale(TPack<T> &y, Scalar a) {
 }
 
 }  // namespace cc
+
+namespace detail {
+
+/// a TPack is written to scratch as its elements, see ArrayScratchTraits
+template <typename T>
+struct ArrayScratchTraits<cc::TPack<T>> {
+  using element_traits = ArrayScratchTraits<T>;
+  using handle_type = std::vector<typename element_traits::handle_type>;
+  using buffer_type = std::vector<typename element_traits::buffer_type>;
+
+  static handle_type write(const cc::TPack<T> &a, const std::string &basename) {
+    handle_type handle;
+    for (auto i = 0ul; i != a.size(); ++i) {
+      handle.push_back(
+          element_traits::write(a[i], basename + "_" + std::to_string(i)));
+    }
+    return handle;
+  }
+
+  static buffer_type read_local(const handle_type &handle) {
+    buffer_type buffer;
+    for (const auto &h : handle) buffer.push_back(element_traits::read_local(h));
+    return buffer;
+  }
+
+  static cc::TPack<T> make(const handle_type &handle, buffer_type &&buffer) {
+    cc::TPack<T> result(handle.size());
+    for (auto i = 0ul; i != handle.size(); ++i) {
+      result[i] = element_traits::make(handle[i], std::move(buffer[i]));
+    }
+    return result;
+  }
+
+  static cc::TPack<T> read(const handle_type &handle) {
+    return make(handle, read_local(handle));
+  }
+
+  static void remove(const handle_type &handle) {
+    for (const auto &h : handle) element_traits::remove(h);
+  }
+};
+
+}  // namespace detail
 }  // namespace mpqc
 
 #endif  // SRC_MPQC_CHEMISTRY_QC_CC_TPACK_H_
@@ -2,6 +2,7 @@
 #include "mpqc/chemistry/molecule/molecule.h"
 
 #include "mpqc/chemistry/qc/lcao/basis/basis.h"
+#include "mpqc/chemistry/qc/lcao/basis/basis_library.h"
 #include "mpqc/chemistry/qc/lcao/basis/shell_vec_functions.h"
 #include "mpqc/util/keyval/forcelink.h"
 #include "mpqc/util/core/exception.h"
@@ -25,17 +26,9 @@ std::vector<ShellVec> Basis::Factory::get_cluster_shells(
     const auto libint_atoms =
         ::mpqc::to_libint_atom(collapse_to_atoms(cluster));
 
-    libint2::BasisSet libint_basis(basis_set_name_, libint_atoms);
-
     // Shells that go with this cluster
-    ShellVec cluster_shells;
-    cluster_shells.reserve(libint_basis.size());
-
-    for (auto &&shell : libint_basis) {
-      cluster_shells.emplace_back(std::move(shell));
-    }
-
-    cs.emplace_back(std::move(cluster_shells));
+    cs.emplace_back(
+        BasisLibrary::instance().shells(basis_set_name_, libint_atoms));
   }
 
   return cs;
@@ -46,11 +39,10 @@ ShellVec Basis::Factory::get_flat_shells(Molecule const &mol) const {
   for (auto const &cluster : mol) {
     const auto libint_atoms = to_libint_atom(collapse_to_atoms(cluster));
 
-    libint2::BasisSet libint_basis(basis_set_name_, libint_atoms);
-
-    for (auto &&shell : libint_basis) {
-      cs.emplace_back(std::move(shell));
-    }
+    auto cluster_shells =
+        BasisLibrary::instance().shells(basis_set_name_, libint_atoms);
+    cs.insert(cs.end(), std::make_move_iterator(cluster_shells.begin()),
+              std::make_move_iterator(cluster_shells.end()));
   }
 
   return cs;
@@ -216,14 +208,11 @@ Basis merge(const Basis &basis1, const Basis &basis2) {
 
 Basis parallel_make_basis(madness::World &world, const Basis::Factory &factory,
                           const mpqc::Molecule &mol) {
-  Basis basis;
-  if (world.rank() == 0) {
-    auto shells = factory.get_cluster_shells(mol);
-    basis = std::move(shells);
-  }
-
-  world.gop.broadcast_serializable(basis, 0);
-  return basis;
+  // only rank 0 reads the basis set library, the atomic shells are broadcast
+  // and each rank places them on the atoms
+  BasisLibrary::instance().load(world, factory.name(),
+                                ::mpqc::to_libint_atom(mol.atoms()));
+  return Basis(factory.get_cluster_shells(mol));
 }
 
 AtomicBasis::AtomicBasis(const KeyVal &kv)
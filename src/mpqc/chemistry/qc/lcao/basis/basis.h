@@ -160,7 +160,8 @@ Basis reblock(Basis const &basis, Op op, Args... args) {
 Eigen::RowVectorXi sub_basis_map(const Basis& basis, const Basis& sub_basis);
 
 /**
- * construct Basis from a factory and a Molecule on process 0 and broadcast to the entire world
+ * construct Basis from a factory and a Molecule on the entire world; the basis set
+ * library is only read on process 0 (see BasisLibrary) and its atomic shells are broadcast
  * @param world the madness::World
  * @param factory the Basis::Factory object
  * @param mol the Molecule object
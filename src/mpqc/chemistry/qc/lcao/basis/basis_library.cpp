@@ -0,0 +1,122 @@
+#include "mpqc/chemistry/qc/lcao/basis/basis_library.h"
+
+#include <cassert>
+#include <cmath>
+#include <set>
+
+#include <libint2/basis.h>
+
+#include "mpqc/chemistry/qc/lcao/basis/basis.h"
+
+namespace mpqc {
+namespace lcao {
+namespace gaussian {
+
+namespace detail {
+std::vector<int> unique_atomic_numbers(
+    std::vector<libint2::Atom> const &atoms) {
+  std::set<int> Zs;
+  for (auto const &atom : atoms) Zs.insert(atom.atomic_number);
+  return std::vector<int>(Zs.begin(), Zs.end());
+}
+}  // namespace detail
+
+BasisLibrary &BasisLibrary::instance() {
+  static BasisLibrary library;
+  return library;
+}
+
+void BasisLibrary::parse(std::string const &name, std::vector<int> const &Zs) {
+  std::vector<int> missing;
+  for (auto Z : Zs) {
+    if (atomic_shells_.find(std::make_pair(name, Z)) == atomic_shells_.end())
+      missing.push_back(Z);
+  }
+  if (missing.empty()) return;
+
+  // put each missing element on a different point of the x axis so that a
+  // single read of the library file provides all of them and the shells can
+  // be attributed to the elements by their centers
+  std::vector<libint2::Atom> atoms;
+  for (auto i = 0ul; i != missing.size(); ++i) {
+    libint2::Atom atom;
+    atom.atomic_number = missing[i];
+    atom.x = i;
+    atom.y = 0.0;
+    atom.z = 0.0;
+    atoms.push_back(atom);
+  }
+
+  libint2::BasisSet libint_basis(name, atoms);
+
+  std::vector<ShellVec> shells(missing.size());
+  for (auto &&shell : libint_basis) {
+    const auto i = static_cast<std::size_t>(std::lround(shell.O[0]));
+    assert(i < missing.size());
+    shell.O = {{0.0, 0.0, 0.0}};
+    shells[i].emplace_back(std::move(shell));
+  }
+
+  for (auto i = 0ul; i != missing.size(); ++i) {
+    atomic_shells_.emplace(std::make_pair(name, missing[i]),
+                           std::move(shells[i]));
+  }
+}
+
+void BasisLibrary::load(std::string const &name,
+                        std::vector<libint2::Atom> const &atoms) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  parse(name, detail::unique_atomic_numbers(atoms));
+}
+
+void BasisLibrary::load(madness::World &world, std::string const &name,
+                        std::vector<libint2::Atom> const &atoms) {
+  const auto Zs = detail::unique_atomic_numbers(atoms);
+
+  std::vector<std::pair<int, ShellVec>> element_shells;
+  if (world.rank() == 0) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    parse(name, Zs);
+    for (auto Z : Zs)
+      element_shells.emplace_back(Z,
+                                  atomic_shells_.at(std::make_pair(name, Z)));
+  }
+
+  if (world.size() > 1) {
+    world.gop.broadcast_serializable(element_shells, 0);
+    if (world.rank() != 0) {
+      std::lock_guard<std::mutex> lock(mtx_);
+      for (auto &Z_shells : element_shells) {
+        atomic_shells_.emplace(std::make_pair(name, Z_shells.first),
+                               std::move(Z_shells.second));
+      }
+    }
+  }
+}
+
+BasisLibrary::ShellVec BasisLibrary::shells(
+    std::string const &name, std::vector<libint2::Atom> const &atoms) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  parse(name, detail::unique_atomic_numbers(atoms));
+
+  ShellVec result;
+  for (auto const &atom : atoms) {
+    auto const &element_shells =
+        atomic_shells_.at(std::make_pair(name, atom.atomic_number));
+    for (auto shell : element_shells) {
+      shell.O = {{atom.x, atom.y, atom.z}};
+      result.emplace_back(std::move(shell));
+    }
+  }
+
+  return result;
+}
+
+void BasisLibrary::clear() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  atomic_shells_.clear();
+}
+
+}  // namespace gaussian
+}  // namespace lcao
+}  // namespace mpqc
@@ -0,0 +1,84 @@
+#ifndef SRC_MPQC_CHEMISTRY_QC_LCAO_BASIS_BASIS_LIBRARY_H_
+#define SRC_MPQC_CHEMISTRY_QC_LCAO_BASIS_BASIS_LIBRARY_H_
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <libint2/atom.h>
+#include <libint2/shell.h>
+#include <madness/world/world.h>
+
+namespace mpqc {
+namespace lcao {
+namespace gaussian {
+
+/// @ingroup ChemistryESLCAOBasis
+/// @{
+
+/// BasisLibrary is a process-wide cache of the atomic shells of the basis set
+/// libraries, keyed by the basis set name and the atomic number.
+
+/// Parsing a basis set library (.g94) file is much more expensive than
+/// placing the shells of an element on an atom, hence each (name, element)
+/// combination is parsed at most once per process and reused by all
+/// subsequent constructions of Basis objects (clusters, reblocked and
+/// displaced geometries, etc.).
+class BasisLibrary {
+ public:
+  using ShellVec = std::vector<libint2::Shell>;
+
+  /// @return the process-wide instance
+  static BasisLibrary& instance();
+
+  BasisLibrary(BasisLibrary const&) = delete;
+  BasisLibrary& operator=(BasisLibrary const&) = delete;
+
+  /// makes sure the shells of all elements in \c atoms are available locally;
+  /// the missing elements are parsed with a single read of the library file
+  /// @param name the basis set name
+  /// @param atoms the atoms
+  void load(std::string const& name, std::vector<libint2::Atom> const& atoms);
+
+  /// same as load(name, atoms), but the library file is only read on rank 0
+  /// and the shells are broadcast to all ranks of \c world
+  /// @note this is a collective operation
+  /// @param world the World whose ranks will use the shells
+  /// @param name the basis set name
+  /// @param atoms the atoms
+  void load(madness::World& world, std::string const& name,
+            std::vector<libint2::Atom> const& atoms);
+
+  /// @param name the basis set name
+  /// @param atoms the atoms
+  /// @return the shells of basis set \c name on \c atoms, in the order
+  ///         libint2::BasisSet(name, atoms) would produce them
+  ShellVec shells(std::string const& name,
+                  std::vector<libint2::Atom> const& atoms);
+
+  /// removes all cached shells
+  void clear();
+
+ private:
+  BasisLibrary() = default;
+
+  using key_type = std::pair<std::string, int>;
+
+  std::mutex mtx_;
+  // shells of each (basis name, atomic number) centered at the origin
+  std::map<key_type, ShellVec> atomic_shells_;
+
+  // parses the shells of elements in \c Zs not yet in atomic_shells_
+  // @pre mtx_ is locked
+  void parse(std::string const& name, std::vector<int> const& Zs);
+};
+
+/// @}
+
+}  // namespace gaussian
+}  // namespace lcao
+}  // namespace mpqc
+
+#endif  // SRC_MPQC_CHEMISTRY_QC_LCAO_BASIS_BASIS_LIBRARY_H_
@@ -5,6 +5,11 @@
 #ifndef MPQC4_SRC_MPQC_CHEMISTRY_QC_CC_CC3_H_
 #define MPQC4_SRC_MPQC_CHEMISTRY_QC_CC_CC3_H_
 
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
 #include <tiledarray.h>
 
 #include "mpqc/chemistry/qc/cc/tpack.h"
@@ -15,7 +20,9 @@
 #include "mpqc/chemistry/qc/lcao/scf/mo_build.h"
 #include "mpqc/chemistry/qc/lcao/wfn/lcao_wfn.h"
 #include "mpqc/chemistry/qc/properties/energy.h"
+#include "mpqc/math/external/tiledarray/tile_util.h"
 #include "mpqc/mpqc_config.h"
+#include "mpqc/util/external/madworld/task_counter.h"
 
 namespace mpqc {
 namespace lcao {
@@ -45,6 +52,52 @@ inline void print_CC3_direct(int iter, double dE, double error, double E1,
       "%3i \t %10.5e \t %10.5e \t %15.12f \t %10.1f \t %10.1f \n", iter, dE,
       error, E1, time1, time2);
 }
+
+/// adds \c factor times the elements of \c block , an array of a single-rank
+/// World whose element ranges start at 0 (e.g. the result of a block
+/// expression), to \c tensor at element \c offset
+template <typename Tile, typename Policy>
+void add_block_to_tensor(const TA::DistArray<Tile, Policy> &block,
+                         const std::vector<std::size_t> &offset,
+                         typename Tile::numeric_type factor, Tile &tensor) {
+  std::vector<std::size_t> idx(offset.size());
+  for (auto it = block.begin(); it != block.end(); ++it) {
+    const Tile tile = (*it).get();
+    for (auto &&block_idx : tile.range()) {
+      for (auto m = 0ul; m != idx.size(); ++m) {
+        idx[m] = block_idx[m] + offset[m];
+      }
+      tensor[idx] += factor * tile[block_idx];
+    }
+  }
+}
+
+/// @return the array with tiled range \c trange and the elements of
+/// \c tensor , which must be replicated on all ranks of \c world
+template <typename Tile, typename Policy>
+TA::DistArray<Tile, Policy> replicated_tensor_to_array(
+    madness::World &world, const TA::TiledRange &trange, const Tile &tensor) {
+  auto make_tile = [&tensor, &trange](std::size_t ord) {
+    const auto range = trange.make_tile_range(ord);
+    Tile tile(range);
+    for (auto &&idx : range) tile[idx] = tensor[idx];
+    return tile;
+  };
+  // the tensor is replicated, hence so are the norms
+  const auto shape = mpqc::detail::make_shape(
+      trange, [&make_tile](std::size_t ord) { return make_tile(ord).norm(); },
+      Policy());
+  TA::DistArray<Tile, Policy> result(world, trange, shape);
+  const auto end = result.pmap()->end();
+  for (auto it = result.pmap()->begin(); it != end; ++it) {
+    const auto ord = *it;
+    if (result.is_zero(ord)) continue;
+    result.set(ord, make_tile(ord));
+  }
+  world.gop.fence();
+  result.truncate();
+  return result;
+}
 }
 
 /**
@@ -76,6 +129,7 @@ class CC3 : public LCAOWavefunction<Tile, Policy>,
    * | max_iter | int | 30 | maxmium iteration in CCSD |
    * | verbose | bool | default use factory.verbose() | if print more information in CCSD iteration |
    * | reduced_abcd_memory | bool | false | avoid store another abcd term in standard and df method |
+   * | t3_free | bool | false | if true, T3 is not stored: in each iteration it is formed for one batch of occupied triples at a time, whose contributions to the T1 and T2 residuals are added before it is discarded; valid only with method=standard and a canonical reference |
    */
 
   // clang-format on
@@ -106,6 +160,11 @@ class CC3 : public LCAOWavefunction<Tile, Policy>,
                        "solver");
 
     reduced_abcd_memory_ = kv.value<bool>("reduced_abcd_memory", false);
+    t3_free_ = kv.value<bool>("t3_free", false);
+    if (t3_free_ && method_ != "standard") {
+      throw InputError("t3_free is only valid with the standard method",
+                       __FILE__, __LINE__, "t3_free");
+    }
 
     max_iter_ = kv.value<int>("max_iter", 30);
     verbose_ = kv.value<bool>("verbose", this->lcao_factory().verbose());
@@ -127,6 +186,7 @@ class CC3 : public LCAOWavefunction<Tile, Policy>,
   typename AOFactory::DirectTArray direct_ao_array_;
   bool df_;
   bool reduced_abcd_memory_ = false;
+  bool t3_free_ = false;
   std::string method_;
   std::size_t max_iter_;
   double target_precision_;
@@ -170,7 +230,7 @@ class CC3 : public LCAOWavefunction<Tile, Policy>,
     }
   }
 
-  // get T3 amplitudes
+  // get T3 amplitudes, packed in ("T,i,j,k"), see pack_t3()
   TArray t3() const {
     if (T3_.is_initialized()) {
       return T3_;
@@ -245,7 +305,9 @@ class CC3 : public LCAOWavefunction<Tile, Policy>,
       TArray t2;
       TArray t3;
 
-      if (method_ == "standard") {
+      if (method_ == "standard" && t3_free_) {
+        CC3_corr_energy_ = compute_CC3_t3_free(t1, t2);
+      } else if (method_ == "standard") {
         CC3_corr_energy_ = compute_CC3_conventional(t1, t2, t3);
       } /*else if (method_ == "df") {
         CC3_corr_energy_ = compute_cc3_df(t1, t2);
@@ -272,80 +334,38 @@ class CC3 : public LCAOWavefunction<Tile, Policy>,
  protected:
   // store all the integrals in memory
   // used as reference for development
-  double compute_CC3_conventional(TArray &t1, TArray &t2, TArray &t3) {
+  double compute_CC3_conventional(TArray &t1, TArray &t2, TArray &t3_packed) {
 
   //VR ... Initialize
     auto &world = this->wfn_world()->world();
     bool accurate_time = this->lcao_factory().accurate_time();
 
-    auto n_occ = this->trange1_engine()->get_occ();
-    auto n_frozen = this->trange1_engine()->get_nfrozen();
-
     if (world.rank() == 0) {
       std::cout << "Use Conventional CC3 Compute" << std::endl;
     }
 
-    auto tmp_time0 = mpqc::now(world, accurate_time);
     // get all two electron integrals
-    TArray g_abcd = this->get_abcd();
-    TArray g_ijab = this->get_ijab();
-    TArray g_ijkl = this->get_ijkl();
-    TArray g_iajb = this->get_iajb();
-    TArray g_iabj = this->get_iabj();
-    TArray g_iabc = this->get_iabc();
-    TArray g_aibc = this->get_aibc();
-    TArray g_ijak = this->get_ijak();
-    TArray g_ijka = this->get_ijka();
-    //some more integrals  _VR
-    TArray g_abci = this->get_abci();
-    TArray g_cjkl = this->get_aijk();
-    TArray g_dabi = this->get_abci();
-    TArray g_abij = this->get_abij();
-    TArray g_jkbc = this->get_ijab();
-    TArray g_aijk = this->get_aijk();
-    TArray g_iajk = this->get_iajk() ;
-    //_eVR
-
-    this->lcao_factory().registry().purge_formula(L"(i ν| G |κ λ )");
-
-    auto tmp_time1 = mpqc::now(world, accurate_time);
-    auto tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
-    mpqc::utility::print_par(world, "Integral Prepare Time: ", tmp_time, "\n");
-
-    TArray f_ai = this->get_fock_ai();
-    TArray f_ij = this->get_fock_ij();
-    TArray f_ab = this->get_fock_ab();
-
-    // store d1 to local
-    TArray d1 = detail::create_d_ai<Tile, Policy>(f_ai.world(), f_ai.trange(),
-                                          *orbital_energy(), n_occ, n_frozen);
-
-    t1("a,i") = f_ai("a,i") * d1("a,i");
-    t1.truncate();
-
-    {
-      TArray g_abij;
-      g_abij("a,b,i,j") = g_ijab("i,j,a,b");
-      t2 = detail::d_abij(g_abij, *orbital_energy(), n_occ, n_frozen);
-    }
+    const auto ints = get_cc3_integrals();
+    const auto &g_ijab = ints.g_ijab;
+    const auto &f_ai = ints.f_ai;
+    const auto &f_ij = ints.f_ij;
+    const auto &f_ab = ints.f_ab;
 
+    TArray tau;
+    double E0 = 0.0;
+    double E1 = compute_initial_guess(ints, t1, t2, tau);
+    double dE = std::abs(E1 - E0);
 
     // T3
 
     // Initialize T3 and set all elements to be zero
     //first assign it a size indirectly
-    t3("a,b,c,i,j,k") = t2("a,b,i,j") * t1("c,k");
-
-    TArray tau;
-    tau("a,b,i,j") = t2("a,b,i,j") + t1("a,i") * t1("b,j");
-
-    double E0 = 0.0;
-    double E1 = 2.0 * TA::dot(f_ai("a,i"), t1("a,i")) +
-                TA::dot(g_ijab("i,j,a,b"), 2 * tau("a,b,i,j") - tau("b,a,i,j"));
-    double mp2 = E1;
-    double dE = std::abs(E1 - E0);
-
-    mpqc::utility::print_par(world, "MP2 Energy      ", mp2, "\n");
+    // T3 is stored packed, see pack_t3()
+    {
+      TArray t3;
+      t3("a,b,c,i,j,k") = t2("a,b,i,j") * t1("c,k");
+      t3_packed = cc::pack_t3(t3);
+    }
 
     // optimize t1 and t2
     std::size_t iter = 0ul;
@@ -354,85 +374,26 @@ class CC3 : public LCAOWavefunction<Tile, Policy>,
     TArray r2;
     TArray r3;
 
-    if (world.rank() == 0) {
-      std::cout << "Start Iteration" << std::endl;
-      std::cout << "Max Iteration: " << max_iter_ << std::endl;
-      std::cout << "Target precision: " << target_precision_ << std::endl;
-      std::cout << "AccurateTime: " << accurate_time << std::endl;
-      std::cout << "PrintDetail: " << verbose_ << std::endl;
-      std::cout << "Reduced ABCD Memory Approach: "
-                << (reduced_abcd_memory_ ? "Yes" : "No") << std::endl;
-    }
+    print_iteration_header();
 
     while (iter < max_iter_) {
       // start timer
       auto time0 = mpqc::fenced_now(world);
       TArray::wait_for_lazy_cleanup(world);
-      auto t1_time0 = mpqc::now(world, accurate_time);
-      TArray h_ki, h_ac;
-      {
-        // intermediates for t1
-        // external index i and a
-        // vir index a b c d
-        // occ index i j k l
-        TArray h_kc;
-
-        // compute residual r1(n) (at convergence r1 = 0)
-        // external index i and a
-        tmp_time0 = mpqc::now(world, accurate_time);
-        r1("a,i") = f_ai("a,i") - 2.0 * (f_ai("c,k") * t1("c,i")) * t1("a,k");
-
-        {
-          h_ac("a,c") =
-              f_ab("a,c") -
-              (2.0 * g_ijab("k,l,c,d") - g_ijab("l,k,c,d")) * tau("a,d,k,l");
-          r1("a,i") += h_ac("a,c") * t1("c,i");
-        }
-
-        {
-          h_ki("k,i") =
-              f_ij("k,i") +
-              (2.0 * g_ijab("k,l,c,d") - g_ijab("k,l,d,c")) * tau("c,d,i,l");
-          r1("a,i") -= t1("a,k") * h_ki("k,i");
-        }
-
-        {
-          h_kc("k,c") =
-              f_ai("c,k") +
-              (2.0 * g_ijab("k,l,c,d") - g_ijab("k,l,d,c")) * t1("d,l");
-          r1("a,i") += h_kc("k,c") * (2.0 * t2("c,a,k,i") - t2("c,a,i,k") +
-                                      t1("c,i") * t1("a,k"));
-        }
-
-
-        tmp_time1 = mpqc::now(world, accurate_time);
-        tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
-        if (verbose_) {
-          mpqc::utility::print_par(world, "t1 h term time: ", tmp_time, "\n");
-        }
-
-        tmp_time0 = mpqc::now(world, accurate_time);
-        r1("a,i") += (2.0 * g_ijab("k,i,c,a") - g_iajb("k,a,i,c")) * t1("c,k");
 
-        r1("a,i") +=
-            (2.0 * g_iabc("k,a,c,d") - g_iabc("k,a,d,c")) * tau("c,d,k,i");
+      // the tiles of t3 are unpacked from T3 when used
+      const auto t3 = cc::direct_unpacked_t3(t3_packed, t1.trange().dim(0));
 
-        r1("a,i") -=
-            (2.0 * g_ijak("k,l,c,i") - g_ijak("l,k,c,i")) * tau("c,a,k,l");
+      compute_ccsd_residuals(ints, t1, t2, tau, r1, r2);
 
-        tmp_time1 = mpqc::now(world, accurate_time);
-        tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
-        if (verbose_) {
-          mpqc::utility::print_par(world, "t1 other time: ", tmp_time, "\n");
-        }
-      }
+      auto t3_time0 = mpqc::now(world, accurate_time);
 
       //Add T3 contribution to T1 _VR
       {
 
         TArray g_jkbc_AS;
 
-        g_jkbc_AS("j,k,b,c") = (2.0 * g_jkbc("j,k,b,c") ) - g_jkbc("j,k,c,b");
+        g_jkbc_AS("j,k,b,c") = (2.0 * g_ijab("j,k,b,c") ) - g_ijab("j,k,c,b");
 
        // seems like a sign error in eqn 15, Scuseria & Schaefer, CPL (1988)
        // Instead of '+', it should be '-'
@@ -440,339 +401,549 @@ class CC3 : public LCAOWavefunction<Tile, Policy>,
 
       }
 
-      auto t1_time1 = mpqc::now(world, accurate_time);
-      auto t1_time = mpqc::duration_in_s(t1_time0, t1_time1);
-      if (verbose_) {
-        mpqc::utility::print_par(world, "t1 total time: ", t1_time, "\n");
-      }
 
-      // intermediates for t2
-      // external index i j a b
+      // Add contribution of T3 into T2 _VR
+      {
+         const auto &g_akcd = ints.g_aibc;
+         TArray g_akcd_AS;
+         const auto &g_klic = ints.g_ijka;
+         TArray g_klic_AS;
+         TArray n2_abij;
+         TArray o2_abij;
+         TArray g_ijab_AS;
 
-      auto t2_time0 = mpqc::now(world, accurate_time);
+         g_akcd_AS("a,k,c,d") = (2 * g_akcd("a,k,c,d")) - g_akcd("a,k,d,c");
 
-      // compute residual r2(n) (at convergence r2 = 0)
+         n2_abij("a,b,i,j") = g_akcd_AS("a,k,c,d") * t3("c,b,d,i,j,k") -
+                              g_akcd   ("a,k,c,d") * t3("c,d,b,i,j,k");
 
-      // permutation part
-      tmp_time0 = mpqc::now(world, accurate_time);
+         g_klic_AS("k,l,i,c") = (2 * g_klic("k,l,i,c")) - g_klic("l,k,i,c");
 
-      {
-        r2("a,b,i,j") =
-            (g_iabc("i,c,a,b") - g_iajb("k,b,i,c") * t1("a,k")) * t1("c,j");
+         n2_abij("a,b,i,j") -= g_klic_AS("k,l,i,c") * t3("a,b,c,k,j,l") -
+                               g_klic   ("k,l,i,c") * t3("a,c,b,k,j,l");
 
-        r2("a,b,i,j") -=
-            (g_ijak("i,j,a,k") + g_ijab("i,k,a,c") * t1("c,j")) * t1("b,k");
-      }
-      tmp_time1 = mpqc::now(world, accurate_time);
-      tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
-      if (verbose_) {
-        mpqc::utility::print_par(world, "t2 other time: ", tmp_time, "\n");
-      }
+         // f_ai ..
 
-      tmp_time0 = mpqc::now(world, accurate_time);
-      {
-        // compute g intermediate
-        TArray g_ki, g_ac;
+         n2_abij("a,b,i,j") -= f_ai("c,k") * (t3("a,b,c,i,k,j")-t3("a,c,b,i,k,j"));
 
-        g_ki("k,i") = h_ki("k,i") + f_ai("c,k") * t1("c,i") +
-                      (2.0 * g_ijka("k,l,i,c") - g_ijka("l,k,i,c")) * t1("c,l");
+         // permute
+         n2_abij("a,b,i,j") = n2_abij("a,b,i,j") + n2_abij("b,a,j,i");
 
-        g_ac("a,c") = h_ac("a,c") - f_ai("c,k") * t1("a,k") +
-                      (2.0 * g_aibc("a,k,c,d") - g_aibc("a,k,d,c")) * t1("d,k");
+         //add to the r2 residual
+         r2("a,b,i,j") += n2_abij("a,b,i,j");
 
-        r2("a,b,i,j") +=
-            g_ac("a,c") * t2("c,b,i,j") - g_ki("k,i") * t2("a,b,k,j");
-      }
-      tmp_time1 = mpqc::now(world, accurate_time);
-      tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
-      if (verbose_) {
-        mpqc::utility::print_par(world, "t2 g term time: ", tmp_time, "\n");
-      }
+         //add contribution of T1T3 to the r2 residual
+         g_ijab_AS("k,l,c,d")  = (2.0 * g_ijab("k,l,c,d")) - g_ijab("l,k,c,d") ;
 
-      tmp_time0 = mpqc::now(world, accurate_time);
-      {
-        TArray j_akic;
-        TArray k_kaic;
-        // compute j and k intermediate
-        {
-          TArray T;
+         o2_abij("a,b,i,j")  = (g_ijab_AS("k,l,c,d") * (t3("a,b,c,i,j,k") - t3("a,c,b,i,j,k")))* t1("d,l") ;
 
-          T("d,b,i,l") = 0.5 * t2("d,b,i,l") + t1("d,i") * t1("b,l");
+         o2_abij("a,b,i,j") -= (g_ijab_AS("k,l,c,d") * t3("a,c,b,i,k,l") - g_ijab("k,l,c,d") * t3("c,a,b,i,k,l"))
+                               * t1("d,j") ;
 
-          j_akic("a,k,i,c") = g_ijab("i,k,a,c");
 
-          j_akic("a,k,i,c") -= g_ijka("l,k,i,c") * t1("a,l");
+         o2_abij("a,b,i,j") -= (g_ijab_AS("k,l,c,d") * t3("a,d,c,i,j,k") - g_ijab("k,l,c,d") * t3("c,d,a,i,j,k"))
+                               * t1("b,l") ;
 
-          j_akic("a,k,i,c") += g_aibc("a,k,d,c") * t1("d,i");
+         //permute
+         o2_abij("a,b,i,j") = o2_abij("a,b,i,j") + o2_abij("b,a,j,i");
 
-          j_akic("a,k,i,c") -= g_ijab("k,l,c,d") * T("d,a,i,l");
+         //add to r2 residual
+         r2("a,b,i,j") += o2_abij("a,b,i,j");
 
-          j_akic("a,k,i,c") += 0.5 *
-                               (2.0 * g_ijab("k,l,c,d") - g_ijab("k,l,d,c")) *
-                               t2("a,d,i,l");
+      }
 
-          k_kaic("k,a,i,c") = g_iajb("k,a,i,c")
+      auto t3_time1 = mpqc::now(world, accurate_time);
+      auto t3_time = mpqc::duration_in_s(t3_time0, t3_time1);
+      if (verbose_) {
+        mpqc::utility::print_par(world, "t3 total time: ", t3_time, "\n");
+      }
 
-                              - g_ijka("k,l,i,c") * t1("a,l")
+      // compute r3 residual  _VR
+      {
+          // equations below are from spin-adapted CCSDT implementation
+          // by Noga and Bartlett, JCP, 86, 7041 (1987)
+          // by Scuseria and Schaefer, CPL 146, 23 (1988), Eq. 9 for T-1a
+          // Extension from CCSDT-1b to CC3 requires contribution of T1T2, T1T1T2, and T1T1T1T2 terms to t3/r3 residual
+          // For CC3, refer to papers below
+          // by Christiansen, Koch, and Jørgensen, JCP, 103, 7429 (1995)
+          // by Koch, Christiansen, Jørgensen, de Merás, and Helgaker, JCP, 106, 1808 (1997)
+          // Let's construct intermediates as done by Noga and Bartlett
 
-                              + g_iabc("k,a,d,c") * t1("d,i")
+           TArray Chi_dabi;
+           TArray Chi_cjkl;
+           compute_t3_intermediates(ints, t1, Chi_dabi, Chi_cjkl);
 
-                              - g_ijab("k,l,d,c") * T("d,a,i,l");
-          if (verbose_) {
-            mpqc::detail::print_size_info(T, "T");
-            mpqc::detail::print_size_info(j_akic, "J_akic");
-            mpqc::detail::print_size_info(k_kaic, "K_kaic");
-          }
-        }
+           // compute the residual r3
+           TArray r3_1;
+           TArray r3_2;
 
-        r2("a,b,i,j") += 0.5 * (2.0 * j_akic("a,k,i,c") - k_kaic("k,a,i,c")) *
-                         (2.0 * t2("c,b,k,j") - t2("b,c,k,j"));
 
-        r2("a,b,i,j") += -0.5 * k_kaic("k,a,i,c") * t2("b,c,k,j") -
-                         k_kaic("k,b,i,c") * t2("a,c,k,j");
-      }
-      tmp_time1 = mpqc::now(world, accurate_time);
-      tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
-      if (verbose_) {
-        mpqc::utility::print_par(world, "t2 j,k term time: ", tmp_time, "\n");
-      }
+           r3_1("a,b,c,i,j,k")  =   f_ab("a,e") * t3("e,b,c,i,j,k")
+                                  - f_ij("i,l") * t3("a,b,c,l,j,k");
 
-      // perform the permutation
-      r2("a,b,i,j") = r2("a,b,i,j") + r2("b,a,j,i");
 
-      r2("a,b,i,j") += g_ijab("i,j,a,b");
+           // permute [(i,a) with (j,b) and (i,a) with (k,c)]
 
-      tmp_time0 = mpqc::now(world, accurate_time);
-      {
-        TArray a_klij;
-        // compute a intermediate
-        a_klij("k,l,i,j") = g_ijkl("k,l,i,j");
+           r3_1("a,b,c,i,j,k") = r3_1("a,b,c,i,j,k") + r3_1("b,a,c,j,i,k") + r3_1("c,b,a,k,j,i") ;
 
-        a_klij("k,l,i,j") += g_ijka("k,l,i,c") * t1("c,j");
 
-        a_klij("k,l,i,j") += g_ijak("k,l,c,j") * t1("c,i");
+           //  the T1 and T2 dependent terms in the t3/r3 equation
 
-        a_klij("k,l,i,j") += g_ijab("k,l,c,d") * tau("c,d,i,j");
+           r3_2("a,b,c,i,j,k") =    Chi_dabi("b,a,e,i") * t2("c,e,k,j")
+                                  - Chi_cjkl("a,m,i,j") * t2("b,c,m,k") ;
 
-        r2("a,b,i,j") += a_klij("k,l,i,j") * tau("a,b,k,l");
+           //permute
+           r3_2("a,b,c,i,j,k") = r3_2("a,b,c,i,j,k") + r3_2("a,c,b,i,k,j") +
+                                 r3_2("c,a,b,k,i,j") + r3_2("c,b,a,k,j,i") +
+                                 r3_2("b,c,a,j,k,i") + r3_2("b,a,c,j,i,k");
 
-        if (verbose_) {
-          mpqc::detail::print_size_info(a_klij, "A_klij");
-        }
-      }
-      tmp_time1 = mpqc::now(world, accurate_time);
-      tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
-      if (verbose_) {
-        mpqc::utility::print_par(world, "t2 a term time: ", tmp_time, "\n");
-      }
 
-      tmp_time0 = mpqc::now(world, accurate_time);
-      {
-        // compute b intermediate
-        if (reduced_abcd_memory_) {
-          // avoid store b_abcd
-          TArray b_abij;
-          b_abij("a,b,i,j") = g_abcd("a,b,c,d") * tau("c,d,i,j");
-
-          b_abij("a,b,i,j") -= g_aibc("a,k,c,d") * tau("c,d,i,j") * t1("b,k");
-
-          b_abij("a,b,i,j") -= g_iabc("k,b,c,d") * tau("c,d,i,j") * t1("a,k");
-
-          if (verbose_) {
-            mpqc::detail::print_size_info(b_abij, "B_abij");
-          }
+           // Add the contribution of T3 dependent terms
 
-          r2("a,b,i,j") += b_abij("a,b,i,j");
-        } else {
-          TArray b_abcd;
+           r3("a,b,c,i,j,k")  = r3_1("a,b,c,i,j,k") ;
+           r3("a,b,c,i,j,k") += r3_2("a,b,c,i,j,k") ;
 
-          b_abcd("a,b,c,d") = g_abcd("a,b,c,d") -
-                              g_aibc("a,k,c,d") * t1("b,k") -
-                              g_iabc("k,b,c,d") * t1("a,k");
 
-          if (verbose_) {
-            mpqc::detail::print_size_info(b_abcd, "B_abcd");
-          }
-
-          r2("a,b,i,j") += b_abcd("a,b,c,d") * tau("c,d,i,j");
-        }
-      }
-      tmp_time1 = mpqc::now(world, accurate_time);
-      tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
+      //denominator
+      //t3 = d_abcijk(t3_temp, *orbital_energy(), n_occ, n_frozen);
 
-      if (verbose_) {
-        mpqc::utility::print_par(world, "t2 b term time: ", tmp_time, "\n");
       }
+       // end of triples part  _VR
 
-      // Add contribution of T3 into T2 _VR
-      {
-         TArray g_akcd=this->get_aibc();
-         TArray g_akcd_AS;
-         TArray g_klic=this->get_ijka();
-         TArray g_klic_AS;
-         TArray n2_abij;
-         TArray o2_abij;
-         TArray g_ijab_AS;
-
-         g_akcd_AS("a,k,c,d") = (2 * g_akcd("a,k,c,d")) - g_akcd("a,k,d,c");
-
-         n2_abij("a,b,i,j") = g_akcd_AS("a,k,c,d") * t3("c,b,d,i,j,k") -
-                              g_akcd   ("a,k,c,d") * t3("c,d,b,i,j,k");
-
-         g_klic_AS("k,l,i,c") = (2 * g_klic("k,l,i,c")) - g_klic("l,k,i,c");
-
-         n2_abij("a,b,i,j") -= g_klic_AS("k,l,i,c") * t3("a,b,c,k,j,l") -
-                               g_klic   ("k,l,i,c") * t3("a,c,b,k,j,l");
-
-         // f_ai ..
+      // error = residual norm per element _edited VR
+      error = std::sqrt((std::pow(norm2(r1), 2) + std::pow(norm2(r2), 2)
+               + std::pow(norm2(r3), 2)))/
+              (size(r1) + size(r2) + size(r3));
 
-         n2_abij("a,b,i,j") -= f_ai("c,k") * (t3("a,b,c,i,k,j")-t3("a,c,b,i,k,j"));
+      // recompute energy
+      E0 = E1;
+      E1 = 2.0 * TA::dot(f_ai("a,i") + r1("a,i"), t1("a,i")) +
+           TA::dot(g_ijab("i,j,a,b") + r2("a,b,i,j"),
+                   2 * tau("a,b,i,j") - tau("b,a,i,j"));
+      dE = std::abs(E0 - E1);
 
-         // permute
-         n2_abij("a,b,i,j") = n2_abij("a,b,i,j") + n2_abij("b,a,j,i");
+      // update the amplitudes, if not converged
+      if (dE >= target_precision_ || error >= target_precision_) {
+        auto tmp_time0 = mpqc::now(world, accurate_time);
 
-         //add to the r2 residual
-         r2("a,b,i,j") += n2_abij("a,b,i,j");
 
-         //add contribution of T1T3 to the r2 residual
-         g_ijab_AS("k,l,c,d")  = (2.0 * g_ijab("k,l,c,d")) - g_ijab("l,k,c,d") ;
+        assert(solver_);
+        TArray r3_packed = cc::pack_t3(r3);
+        solver_->update(t1, t2, t3_packed, r1, r2, r3_packed);
 
-         o2_abij("a,b,i,j")  = (g_ijab_AS("k,l,c,d") * (t3("a,b,c,i,j,k") - t3("a,c,b,i,j,k")))* t1("d,l") ;
+        if (verbose_) {
+          mpqc::detail::print_size_info(r2, "R2");
+          mpqc::detail::print_size_info(t2, "T2");
+        }
 
-         o2_abij("a,b,i,j") -= (g_ijab_AS("k,l,c,d") * t3("a,c,b,i,k,l") - g_ijab("k,l,c,d") * t3("c,a,b,i,k,l"))
-                               * t1("d,j") ;
+        // recompute tau as well
+        tau("a,b,i,j") = t2("a,b,i,j") + t1("a,i") * t1("b,j");
+        auto tmp_time1 = mpqc::now(world, accurate_time);
+        auto tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
+        if (verbose_) {
+          mpqc::utility::print_par(world, "solver time: ", tmp_time, "\n");
+        }
 
+        auto time1 = mpqc::fenced_now(world);
+        auto duration = mpqc::duration_in_s(time0, time1);
 
-         o2_abij("a,b,i,j") -= (g_ijab_AS("k,l,c,d") * t3("a,d,c,i,j,k") - g_ijab("k,l,c,d") * t3("c,d,a,i,j,k"))
-                               * t1("b,l") ;
+        if (world.rank() == 0) {
+          detail::print_CC3(iter, dE, error, E1, duration);
+        }
 
-         //permute
-         o2_abij("a,b,i,j") = o2_abij("a,b,i,j") + o2_abij("b,a,j,i");
+        iter += 1ul;
 
-         //add to r2 residual
-         r2("a,b,i,j") += o2_abij("a,b,i,j");
+      } else {
+        auto time1 = mpqc::fenced_now(world);
+        auto duration = mpqc::duration_in_s(time0, time1);
 
-      }
+        if (world.rank() == 0) {
+          detail::print_CC3(iter, dE, error, E1, duration);
+        }
 
-      auto t2_time1 = mpqc::now(world, accurate_time);
-      auto t2_time = mpqc::duration_in_s(t2_time0, t2_time1);
-      if (verbose_) {
-        mpqc::utility::print_par(world, "t2 total time: ", t2_time, "\n");
+        break;
       }
+    }
+    if (iter >= max_iter_) {
+      utility::print_par(this->wfn_world()->world(),
+                         "\n Warning!! Exceed Max Iteration! \n");
+    }
+    if (world.rank() == 0) {
+      std::cout << "CC3 Energy  " << E1 << std::endl;
+    }
+    return E1;
+  }
 
-      // compute r3 residual  _VR
-      {
-          // equations below are from spin-adapted CCSDT implementation
-          // by Noga and Bartlett, JCP, 86, 7041 (1987)
-          // by Scuseria and Schaefer, CPL 146, 23 (1988), Eq. 9 for T-1a
-          // Extension from CCSDT-1b to CC3 requires contribution of T1T2, T1T1T2, and T1T1T1T2 terms to t3/r3 residual
-          // For CC3, refer to papers below
-          // by Christiansen, Koch, and Jørgensen, JCP, 103, 7429 (1995)
-          // by Koch, Christiansen, Jørgensen, de Merás, and Helgaker, JCP, 106, 1808 (1997)
-          // Let's construct intermediates as done by Noga and Bartlett
-
-           TArray Chi_dabi;
-           TArray Chi_cjkl;
-           TArray Chi_im;
-           TArray Chi_ae;
-           TArray Chi_jkmn;
-           TArray Chi_bcef;
-           TArray Chi_amei;
-           TArray Chi_amie;
-           TArray f_aijk;
-           TArray f_aibc;
-           TArray f_aijb;
-           TArray f_aibj;
-           TArray f_iabj;
-           TArray f_iajb;
-           TArray g_aijb;
-           TArray g_aibj;
-           TArray g_ijab_AS;
-           TArray f_int_me;
+  // T3-free CC3: T3 is never stored, in each iteration its blocks with
+  // occupied tiles {I,J,K}, I>=J>=K (the batches), are formed from T2 and the
+  // T1-dressed integrals and discarded once their contributions to R1 and R2
+  // are added; hence the memory of T3 is O(v^3) per batch instead of
+  // O(o^3 v^3). The blocks of the other orders of I,J,K are permutations of
+  // the block of the batch, since T3 is invariant to the simultaneous
+  // permutation of the pairs (a,i), (b,j), (c,k).
+  // The batches are handed out to the ranks by a global counter, each rank
+  // computes its batches in a World of its own.
+  // The triples are given by the CC3 equation with the diagonal of the Fock
+  // matrix, i.e. a canonical reference is assumed.
+  double compute_CC3_t3_free(TArray &t1, TArray &t2) {
+    auto &world = this->wfn_world()->world();
+    bool accurate_time = this->lcao_factory().accurate_time();
 
-           // some two-electron integrals
+    auto n_occ = this->trange1_engine()->get_occ();
+    auto n_frozen = this->trange1_engine()->get_nfrozen();
 
-           g_aijb("a,i,j,b")  = g_iabj("i,a,b,j") ;
-           g_aibj("a,i,b,j")  = g_iajb("i,a,j,b") ;
-           g_ijab_AS("i,j,a,b") = (2 * g_ijab("i,j,a,b")) - g_ijab("i,j,b,a");
+    if (world.rank() == 0) {
+      std::cout << "Use T3-free CC3 Compute" << std::endl;
+    }
 
-           // first define the intermediates
+    // get all two electron integrals
+    const auto ints = get_cc3_integrals();
+    const auto &g_ijab = ints.g_ijab;
+    const auto &f_ai = ints.f_ai;
 
-           f_aijk("e,i,m,n")  = g_aijk("e,i,m,n") ;
-           f_aijk("e,i,m,n") += ( g_ijab("m,n,e,f") * t1("f,i")) ;
+    TArray tau;
+    double E0 = 0.0;
+    double E1 = compute_initial_guess(ints, t1, t2, tau);
+    double dE = std::abs(E1 - E0);
 
-           f_aibc("a,m,e,f")  = g_aibc("a,m,e,f") ;
-           f_aibc("a,m,e,f") -= ( g_ijab("n,m,e,f") * t1("a,n")) ;
+    // the batches of T3
+    const auto tr_vir = t1.trange().dim(0);
+    const auto tr_occ = t1.trange().dim(1);
+    const std::size_t n_tr_vir = tr_vir.tiles_range().second;
+    const std::size_t n_tr_occ = tr_occ.tiles_range().second;
+    const std::size_t n_uocc = tr_vir.extent();
+    const std::size_t n_act_occ = tr_occ.extent();
+    std::vector<std::array<std::size_t, 3>> batches;
+    for (std::size_t I = 0; I != n_tr_occ; ++I) {
+      for (std::size_t J = 0; J <= I; ++J) {
+        for (std::size_t K = 0; K <= J; ++K) {
+          batches.push_back({{I, J, K}});
+        }
+      }
+    }
+    const std::size_t n_batches = batches.size();
+    const TA::TiledRange trange_aijk{tr_vir, tr_occ, tr_occ, tr_occ};
+    const EigenVector<double> &ens = *orbital_energy();
+    {
+      std::size_t occ_block_size = 0;
+      for (std::size_t I = 0; I != n_tr_occ; ++I) {
+        occ_block_size = std::max(
+            occ_block_size, tr_occ.tile(I).second - tr_occ.tile(I).first);
+      }
+      const double mem = std::pow(n_uocc, 3) * std::pow(occ_block_size, 3) *
+                         8 / 1.0e9;
+      // the T3 block, one of its terms (x) or a permuted copy of the T3
+      // block, and the result of the expression that computes x
+      ExEnv::out0() << "Number of T3 batches: " << n_batches << std::endl;
+      ExEnv::out0() << "Size of T3 per batch: " << mem << " GB" << std::endl;
+      ExEnv::out0() << "Max memory of T3 per batch: " << 3 * mem << " GB"
+                    << std::endl;
+    }
 
-           f_aijb("a,m,i,e")  = g_aijb("a,m,i,e") ;
-           f_aijb("a,m,i,e") += ( g_aibc("a,m,f,e") * t1("f,i")) ;
+    // split world
+    const auto rank = world.rank();
+    const auto n_proc = world.size();
+    madness::World *this_world_ptr = &world;
+    std::shared_ptr<madness::World> world_ptr;
+    if (n_proc > 1) {
+      SafeMPI::Group group = world.mpi.comm().Get_group().Incl(1, &rank);
+      SafeMPI::Intracomm comm = world.mpi.comm().Create(group);
+      world_ptr = std::make_shared<madness::World>(comm);
+      this_world_ptr = world_ptr.get();
+    }
+    auto &this_world = *this_world_ptr;
 
-           f_aibj("a,m,e,i")  = g_aibj("a,m,e,i") ;
-           f_aibj("a,m,e,i") += ( g_aibc("a,m,e,f") * t1("f,i")) ;
+    // optimize t1 and t2
+    std::size_t iter = 0ul;
+    double error = 1.0;
+    TArray r1;
+    TArray r2;
 
-           f_iabj("i,e,a,m")  = g_iabj("i,e,a,m");
-           f_iabj("i,e,a,m") -= ( g_iajk("i,e,n,m") * t1("a,n")) ;
+    print_iteration_header();
 
-           f_iajb("i,e,m,a")  = g_iajb("i,e,m,a")  ;
-           f_iajb("i,e,m,a") -= ( g_iajk("i,e,m,n") * t1("a,n")) ;
+    while (iter < max_iter_) {
+      // start timer
+      auto time0 = mpqc::fenced_now(world);
+      TArray::wait_for_lazy_cleanup(world);
 
-           f_int_me("m,e")    = g_ijab_AS ("m,n,e,f") * t1("f,n") ;
-           //For non-HF reference with non-zero occupied-virtual block, add this part
-           //f_int_me("m,e")   += f_ia("m,e") ;
+      compute_ccsd_residuals(ints, t1, t2, tau, r1, r2);
 
-           // Now the super-intermediates,
+      // Add the contribution of T3 to R1 and R2
+      {
+        auto t3_time0 = mpqc::now(world, accurate_time);
 
+        // the T1-dressed intermediates of the T3 equation
+        TArray Chi_dabi;
+        TArray Chi_cjkl;
+        compute_t3_intermediates(ints, t1, Chi_dabi, Chi_cjkl);
 
-           Chi_dabi("b,a,e,i") =  g_dabi("b,a,e,i") + ((f_aijk("e,i,m,n") * t1("a,n")) * t1("b,m"))
-                                - f_aijb("a,m,i,e") * t1("b,m") - f_aibj("b,m,e,i") * t1("a,m")
-                                + g_abcd("a,b,f,e") * t1("f,i") ;
+        // the integrals of the contractions of T3, see
+        // compute_CC3_conventional()
+        const auto &g_akcd = ints.g_aibc;
+        const auto &g_klic = ints.g_ijka;
+        TArray g_jkbc_AS;
+        TArray g_akcd_AS;
+        TArray g_klic_AS;
+        TArray g_ijab_AS;
+        g_jkbc_AS("j,k,b,c") = 2.0 * g_ijab("j,k,b,c") - g_ijab("j,k,c,b");
+        g_akcd_AS("a,k,c,d") = 2.0 * g_akcd("a,k,c,d") - g_akcd("a,k,d,c");
+        g_klic_AS("k,l,i,c") = 2.0 * g_klic("k,l,i,c") - g_klic("l,k,i,c");
+        g_ijab_AS("k,l,c,d") = 2.0 * g_ijab("k,l,c,d") - g_ijab("l,k,c,d");
+
+        // the T1 contractions of the T1*T3 terms of R2 that do not involve
+        // the external indices are done first
+        TArray f_int_kc;
+        TArray gt_klcj_AS;
+        TArray gt_klcj;
+        f_int_kc("k,c") = g_ijab_AS("k,l,c,d") * t1("d,l");
+        gt_klcj_AS("k,l,c,j") = g_ijab_AS("k,l,c,d") * t1("d,j");
+        gt_klcj("k,l,c,j") = g_ijab("k,l,c,d") * t1("d,j");
+
+        // the contributions of the batches of this rank, x2 is symmetrized
+        // as n2_abij and o2_abij in compute_CC3_conventional(), y is
+        // contracted with T1
+        Tile r1_t3(TA::Range(std::vector<std::size_t>{n_uocc, n_act_occ}),
+                   0.0);
+        Tile x2_t3(TA::Range(std::vector<std::size_t>{n_uocc, n_uocc,
+                                                      n_act_occ, n_act_occ}),
+                   0.0);
+        Tile y_t3(TA::Range(std::vector<std::size_t>{n_uocc, n_act_occ,
+                                                     n_act_occ, n_act_occ}),
+                  0.0);
+
+        typedef std::vector<std::size_t> block;
+
+        // x("a,b,c,i,j,k") = Chi_dabi("b,a,e,i") * t2("c,e,k,j")
+        //                    - Chi_cjkl("a,m,i,j") * t2("b,c,m,k")
+        // for the occupied tiles {P,Q,R} of i,j,k
+        auto x = [&](std::size_t P, std::size_t Q, std::size_t R) {
+          TArray x_abcijk;
+          x_abcijk("a,b,c,i,j,k") =
+              Chi_dabi("b,a,e,i").block(
+                  block{0, 0, 0, P},
+                  block{n_tr_vir, n_tr_vir, n_tr_vir, P + 1}) *
+                  t2("c,e,k,j").block(
+                      block{0, 0, R, Q},
+                      block{n_tr_vir, n_tr_vir, R + 1, Q + 1}) -
+              Chi_cjkl("a,m,i,j").block(
+                  block{0, 0, P, Q},
+                  block{n_tr_vir, n_tr_occ, P + 1, Q + 1}) *
+                  t2("b,c,m,k").block(
+                      block{0, 0, 0, R},
+                      block{n_tr_vir, n_tr_vir, n_tr_occ, R + 1});
+          return x_abcijk;
+        };
+
+        // adds the contributions of the T3 block {I,J,K} to R1 and R2
+        auto contract = [&](std::size_t I, std::size_t J, std::size_t K,
+                            const TArray &t3) {
+          const std::size_t i_offset = tr_occ.tile(I).first;
+          const std::size_t j_offset = tr_occ.tile(J).first;
+          const std::size_t k_offset = tr_occ.tile(K).first;
+
+          // the contractions of the T3 block, with the indices of
+          // compute_CC3_conventional() renamed such that t3 is always
+          // t3("...,i,j,k")
+          {
+            TArray r1_k;
+            r1_k("a,k") =
+                g_jkbc_AS("i,j,b,c").block(
+                    block{I, J, 0, 0},
+                    block{I + 1, J + 1, n_tr_vir, n_tr_vir}) *
+                (t3("b,a,c,i,j,k") - t3("b,c,a,i,j,k"));
+            detail::add_block_to_tensor(r1_k, {0, k_offset}, -1.0, r1_t3);
+          }
 
-           Chi_cjkl("a,m,i,j") =  g_cjkl("a,m,i,j") + ((f_aibc("a,m,e,f") * t1("e,i")) * t1("f,j"))
-                                + f_iabj("i,e,a,m") * t1("e,j") + f_iajb("j,e,m,a") * t1("e,i")
-                                - g_ijkl("i,j,n,m") * t1("a,n") ;
+          {
+            TArray x2_ij;
+            x2_ij("a,b,i,j") =
+                g_akcd_AS("a,k,c,d").block(
+                    block{0, K, 0, 0},
+                    block{n_tr_vir, K + 1, n_tr_vir, n_tr_vir}) *
+                    t3("c,b,d,i,j,k") -
+                g_akcd("a,k,c,d").block(
+                    block{0, K, 0, 0},
+                    block{n_tr_vir, K + 1, n_tr_vir, n_tr_vir}) *
+                    t3("c,d,b,i,j,k") +
+                f_int_kc("k,c").block(block{K, 0}, block{K + 1, n_tr_vir}) *
+                    (t3("a,b,c,i,j,k") - t3("a,c,b,i,j,k"));
+            detail::add_block_to_tensor(x2_ij, {0, 0, i_offset, j_offset},
+                                        1.0, x2_t3);
+          }
 
+          {
+            TArray x2_lj;
+            x2_lj("a,b,l,j") =
+                g_klic_AS("i,k,l,c").block(
+                    block{I, K, 0, 0},
+                    block{I + 1, K + 1, n_tr_occ, n_tr_vir}) *
+                    t3("a,b,c,i,j,k") -
+                g_klic("i,k,l,c").block(
+                    block{I, K, 0, 0},
+                    block{I + 1, K + 1, n_tr_occ, n_tr_vir}) *
+                    t3("a,c,b,i,j,k");
+            detail::add_block_to_tensor(x2_lj, {0, 0, 0, j_offset}, -1.0,
+                                        x2_t3);
+          }
 
-           // compute the residual r3
-           TArray r3_1;
-           TArray r3_2;
+          {
+            TArray x2_ik;
+            x2_ik("a,b,i,k") =
+                f_ai("c,j").block(block{0, J}, block{n_tr_vir, J + 1}) *
+                (t3("a,b,c,i,j,k") - t3("a,c,b,i,j,k"));
+            detail::add_block_to_tensor(x2_ik, {0, 0, i_offset, k_offset},
+                                        -1.0, x2_t3);
+          }
 
+          {
+            TArray x2_il;
+            x2_il("a,b,i,l") =
+                gt_klcj_AS("j,k,c,l").block(
+                    block{J, K, 0, 0},
+                    block{J + 1, K + 1, n_tr_vir, n_tr_occ}) *
+                    t3("a,c,b,i,j,k") -
+                gt_klcj("j,k,c,l").block(
+                    block{J, K, 0, 0},
+                    block{J + 1, K + 1, n_tr_vir, n_tr_occ}) *
+                    t3("c,a,b,i,j,k");
+            detail::add_block_to_tensor(x2_il, {0, 0, i_offset, 0}, -1.0,
+                                        x2_t3);
+          }
 
-           r3_1("a,b,c,i,j,k")  =   f_ab("a,e") * t3("e,b,c,i,j,k")
-                                  - f_ij("i,l") * t3("a,b,c,l,j,k");
+          {
+            TArray y_ijl;
+            y_ijl("a,i,j,l") =
+                g_ijab_AS("k,l,c,d").block(
+                    block{K, 0, 0, 0},
+                    block{K + 1, n_tr_occ, n_tr_vir, n_tr_vir}) *
+                    t3("a,d,c,i,j,k") -
+                g_ijab("k,l,c,d").block(
+                    block{K, 0, 0, 0},
+                    block{K + 1, n_tr_occ, n_tr_vir, n_tr_vir}) *
+                    t3("c,d,a,i,j,k");
+            detail::add_block_to_tensor(y_ijl, {0, i_offset, j_offset, 0},
+                                        1.0, y_t3);
+          }
+        };
 
+        // the dynamic distribution hands out the batches through a counter on
+        // rank 0
+        world.gop.fence();
+        utility::TaskCounter batch_counter(world, 0);
+        std::size_t my_batch = batch_counter.next().get();
 
-           // permute [(i,a) with (j,b) and (i,a) with (k,c)]
+        TA::set_default_world(this_world);
 
-           r3_1("a,b,c,i,j,k") = r3_1("a,b,c,i,j,k") + r3_1("b,a,c,j,i,k") + r3_1("c,b,a,k,j,i") ;
+        for (std::size_t batch = 0; batch < n_batches; ++batch) {
+          if (batch != my_batch) continue;
 
+          const std::array<std::size_t, 3> ijk = batches[batch];
+          const std::size_t I = ijk[0];
+          const std::size_t J = ijk[1];
+          const std::size_t K = ijk[2];
 
-           //  the T1 and T2 dependent terms in the t3/r3 equation
+          // the T3 block {I,J,K}: permute [(i,a), (j,b), (k,c)] as r3_2 in
+          // compute_CC3_conventional() and divide by the denominator; the
+          // terms are added one at a time
+          TArray t3;
+          {
+            auto x_ijk = x(I, J, K);
+            t3("a,b,c,i,j,k") = x_ijk("a,b,c,i,j,k");
+          }
+          {
+            auto x_ikj = x(I, K, J);
+            t3("a,b,c,i,j,k") += x_ikj("a,c,b,i,k,j");
+          }
+          {
+            auto x_kij = x(K, I, J);
+            t3("a,b,c,i,j,k") += x_kij("c,a,b,k,i,j");
+          }
+          {
+            auto x_kji = x(K, J, I);
+            t3("a,b,c,i,j,k") += x_kji("c,b,a,k,j,i");
+          }
+          {
+            auto x_jki = x(J, K, I);
+            t3("a,b,c,i,j,k") += x_jki("b,c,a,j,k,i");
+          }
+          {
+            auto x_jik = x(J, I, K);
+            t3("a,b,c,i,j,k") += x_jik("b,a,c,j,i,k");
+          }
 
-           r3_2("a,b,c,i,j,k") =    Chi_dabi("b,a,e,i") * t2("c,e,k,j")
-                                  - Chi_cjkl("a,m,i,j") * t2("b,c,m,k") ;
+          // the element ranges of the block start at 0
+          const auto modes = utility::make_array(
+              detail::uocc_mode(ens, n_occ), detail::uocc_mode(ens, n_occ),
+              detail::uocc_mode(ens, n_occ),
+              detail::occ_mode(ens, n_frozen + tr_occ.tile(I).first),
+              detail::occ_mode(ens, n_frozen + tr_occ.tile(J).first),
+              detail::occ_mode(ens, n_frozen + tr_occ.tile(K).first));
+          detail::apply_denominator_inplace(t3, modes);
+
+          // the blocks of the distinct orders of I,J,K: the pair m of the
+          // block {P,Q,R} = {ijk[perm[0]],ijk[perm[1]],ijk[perm[2]]} is the
+          // pair perm[m] of the block {I,J,K}
+          const std::string vir[] = {"a", "b", "c"};
+          const std::string occ[] = {"i", "j", "k"};
+          std::array<std::size_t, 3> perm{{0, 1, 2}};
+          std::vector<std::array<std::size_t, 3>> done;
+          do {
+            const std::array<std::size_t, 3> pqr{
+                {ijk[perm[0]], ijk[perm[1]], ijk[perm[2]]}};
+            if (std::find(done.begin(), done.end(), pqr) != done.end()) {
+              continue;
+            }
+            done.push_back(pqr);
 
-           //permute
-           r3_2("a,b,c,i,j,k") = r3_2("a,b,c,i,j,k") + r3_2("a,c,b,i,k,j") +
-                                 r3_2("c,a,b,k,i,j") + r3_2("c,b,a,k,j,i") +
-                                 r3_2("b,c,a,j,k,i") + r3_2("b,a,c,j,i,k");
+            if (perm[0] == 0 && perm[1] == 1) {
+              contract(I, J, K, t3);
+            } else {
+              std::string vir_ijk[3], occ_ijk[3];
+              for (auto m = 0; m != 3; ++m) {
+                vir_ijk[perm[m]] = vir[m];
+                occ_ijk[perm[m]] = occ[m];
+              }
+              TArray t3_pqr;
+              t3_pqr("a,b,c,i,j,k") =
+                  t3(vir_ijk[0] + "," + vir_ijk[1] + "," + vir_ijk[2] + "," +
+                     occ_ijk[0] + "," + occ_ijk[1] + "," + occ_ijk[2]);
+              contract(pqr[0], pqr[1], pqr[2], t3_pqr);
+            }
+          } while (std::next_permutation(perm.begin(), perm.end()));
 
+          my_batch = batch_counter.next().get();
+        }
+        this_world.gop.fence();
+        TA::set_default_world(world);
+        world.gop.fence();
 
-           // Add the contribution of T3 dependent terms
+        // sum the contributions of all ranks
+        world.gop.sum(r1_t3.data(), r1_t3.size());
+        world.gop.sum(x2_t3.data(), x2_t3.size());
+        world.gop.sum(y_t3.data(), y_t3.size());
 
-           r3("a,b,c,i,j,k")  = r3_1("a,b,c,i,j,k") ;
-           r3("a,b,c,i,j,k") += r3_2("a,b,c,i,j,k") ;
+        TArray x2_abij = detail::replicated_tensor_to_array<Tile, Policy>(
+            world, t2.trange(), x2_t3);
+        TArray y_aijl = detail::replicated_tensor_to_array<Tile, Policy>(
+            world, trange_aijk, y_t3);
+        TArray r1_ai = detail::replicated_tensor_to_array<Tile, Policy>(
+            world, t1.trange(), r1_t3);
 
+        x2_abij("a,b,i,j") -= y_aijl("a,i,j,l") * t1("b,l");
 
-      //denominator
-      //t3 = d_abcijk(t3_temp, *orbital_energy(), n_occ, n_frozen);
+        r1("a,i") += r1_ai("a,i");
+        r2("a,b,i,j") += x2_abij("a,b,i,j") + x2_abij("b,a,j,i");
 
+        auto t3_time1 = mpqc::now(world, accurate_time);
+        auto t3_time = mpqc::duration_in_s(t3_time0, t3_time1);
+        if (verbose_) {
+          mpqc::utility::print_par(world, "t3 total time: ", t3_time, "\n");
+        }
       }
-       // end of triples part  _VR
 
-      // error = residual norm per element _edited VR
-      error = std::sqrt((std::pow(norm2(r1), 2) + std::pow(norm2(r2), 2)
-               + std::pow(norm2(r3), 2)))/
-              (size(r1) + size(r2) + size(r3));
+      // error = residual norm per element
+      error = std::sqrt(std::pow(norm2(r1), 2) + std::pow(norm2(r2), 2)) /
+              (size(r1) + size(r2));
 
       // recompute energy
       E0 = E1;
@@ -783,11 +954,10 @@ class CC3 : public LCAOWavefunction<Tile, Policy>,
 
       // update the amplitudes, if not converged
       if (dE >= target_precision_ || error >= target_precision_) {
-        tmp_time0 = mpqc::now(world, accurate_time);
-
+        auto tmp_time0 = mpqc::now(world, accurate_time);
 
         assert(solver_);
-        solver_->update(t1, t2, t3, r1, r2, r3);
+        solver_->update(t1, t2, r1, r2);
 
         if (verbose_) {
           mpqc::detail::print_size_info(r2, "R2");
@@ -796,8 +966,8 @@ class CC3 : public LCAOWavefunction<Tile, Policy>,
 
         // recompute tau as well
         tau("a,b,i,j") = t2("a,b,i,j") + t1("a,i") * t1("b,j");
-        tmp_time1 = mpqc::now(world, accurate_time);
-        tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
+        auto tmp_time1 = mpqc::now(world, accurate_time);
+        auto tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
         if (verbose_) {
           mpqc::utility::print_par(world, "solver time: ", tmp_time, "\n");
         }
@@ -829,10 +999,414 @@ class CC3 : public LCAOWavefunction<Tile, Policy>,
     if (world.rank() == 0) {
       std::cout << "CC3 Energy  " << E1 << std::endl;
     }
+
+    // warning! all arrays of this_world must be cleaned before its
+    // destruction
+    if (n_proc > 1) {
+      TArray::wait_for_lazy_cleanup(this_world);
+      world.gop.fence();
+      world_ptr.reset();
+    }
     return E1;
   }
 
  private:
+  /// the integrals and Fock matrix blocks of CC3
+  struct CC3Integrals {
+    TArray g_abcd;
+    TArray g_ijab;
+    TArray g_ijkl;
+    TArray g_iajb;
+    TArray g_iabj;
+    TArray g_iabc;
+    TArray g_aibc;
+    TArray g_ijak;
+    TArray g_ijka;
+    TArray g_dabi;
+    TArray g_aijk;
+    TArray g_iajk;
+    TArray f_ai;
+    TArray f_ij;
+    TArray f_ab;
+  };
+
+  /// @return the integrals of CC3, all stored in memory
+  CC3Integrals get_cc3_integrals() {
+    auto &world = this->wfn_world()->world();
+    bool accurate_time = this->lcao_factory().accurate_time();
+
+    auto tmp_time0 = mpqc::now(world, accurate_time);
+    CC3Integrals ints;
+    ints.g_abcd = this->get_abcd();
+    ints.g_ijab = this->get_ijab();
+    ints.g_ijkl = this->get_ijkl();
+    ints.g_iajb = this->get_iajb();
+    ints.g_iabj = this->get_iabj();
+    ints.g_iabc = this->get_iabc();
+    ints.g_aibc = this->get_aibc();
+    ints.g_ijak = this->get_ijak();
+    ints.g_ijka = this->get_ijka();
+    ints.g_dabi = this->get_abci();
+    ints.g_aijk = this->get_aijk();
+    ints.g_iajk = this->get_iajk();
+
+    this->lcao_factory().registry().purge_formula(L"(i ν| G |κ λ )");
+
+    auto tmp_time1 = mpqc::now(world, accurate_time);
+    auto tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
+    mpqc::utility::print_par(world, "Integral Prepare Time: ", tmp_time, "\n");
+
+    ints.f_ai = this->get_fock_ai();
+    ints.f_ij = this->get_fock_ij();
+    ints.f_ab = this->get_fock_ab();
+    return ints;
+  }
+
+  /// initializes \c t1 and \c t2 to the first-order amplitudes and \c tau
+  /// from them
+  /// @return the MP2 energy
+  double compute_initial_guess(const CC3Integrals &ints, TArray &t1,
+                               TArray &t2, TArray &tau) {
+    auto &world = this->wfn_world()->world();
+    auto n_occ = this->trange1_engine()->get_occ();
+    auto n_frozen = this->trange1_engine()->get_nfrozen();
+    const auto &f_ai = ints.f_ai;
+    const auto &g_ijab = ints.g_ijab;
+
+    // store d1 to local
+    TArray d1 = detail::create_d_ai<Tile, Policy>(f_ai.world(), f_ai.trange(),
+                                          *orbital_energy(), n_occ, n_frozen);
+
+    t1("a,i") = f_ai("a,i") * d1("a,i");
+    t1.truncate();
+
+    {
+      TArray g_abij;
+      g_abij("a,b,i,j") = g_ijab("i,j,a,b");
+      t2 = detail::d_abij(g_abij, *orbital_energy(), n_occ, n_frozen);
+    }
+
+    tau("a,b,i,j") = t2("a,b,i,j") + t1("a,i") * t1("b,j");
+
+    double mp2 = 2.0 * TA::dot(f_ai("a,i"), t1("a,i")) +
+                 TA::dot(g_ijab("i,j,a,b"), 2 * tau("a,b,i,j") - tau("b,a,i,j"));
+
+    mpqc::utility::print_par(world, "MP2 Energy      ", mp2, "\n");
+    return mp2;
+  }
+
+  void print_iteration_header() {
+    auto &world = this->wfn_world()->world();
+    if (world.rank() == 0) {
+      std::cout << "Start Iteration" << std::endl;
+      std::cout << "Max Iteration: " << max_iter_ << std::endl;
+      std::cout << "Target precision: " << target_precision_ << std::endl;
+      std::cout << "AccurateTime: " << this->lcao_factory().accurate_time()
+                << std::endl;
+      std::cout << "PrintDetail: " << verbose_ << std::endl;
+      std::cout << "Reduced ABCD Memory Approach: "
+                << (reduced_abcd_memory_ ? "Yes" : "No") << std::endl;
+    }
+  }
+
+  /// computes the CCSD part of the residuals \c r1 and \c r2 , i.e. without
+  /// the contributions of T3
+  void compute_ccsd_residuals(const CC3Integrals &ints, const TArray &t1,
+                              const TArray &t2, const TArray &tau, TArray &r1,
+                              TArray &r2) {
+    auto &world = this->wfn_world()->world();
+    bool accurate_time = this->lcao_factory().accurate_time();
+
+    const auto &g_abcd = ints.g_abcd;
+    const auto &g_ijab = ints.g_ijab;
+    const auto &g_ijkl = ints.g_ijkl;
+    const auto &g_iajb = ints.g_iajb;
+    const auto &g_iabc = ints.g_iabc;
+    const auto &g_aibc = ints.g_aibc;
+    const auto &g_ijak = ints.g_ijak;
+    const auto &g_ijka = ints.g_ijka;
+    const auto &f_ai = ints.f_ai;
+    const auto &f_ij = ints.f_ij;
+    const auto &f_ab = ints.f_ab;
+
+    auto tmp_time0 = mpqc::now(world, accurate_time);
+    auto tmp_time1 = tmp_time0;
+    double tmp_time = 0.0;
+
+    auto t1_time0 = mpqc::now(world, accurate_time);
+    TArray h_ki, h_ac;
+    {
+      // intermediates for t1
+      // external index i and a
+      // vir index a b c d
+      // occ index i j k l
+      TArray h_kc;
+
+      // compute residual r1(n) (at convergence r1 = 0)
+      // external index i and a
+      tmp_time0 = mpqc::now(world, accurate_time);
+      r1("a,i") = f_ai("a,i") - 2.0 * (f_ai("c,k") * t1("c,i")) * t1("a,k");
+
+      {
+        h_ac("a,c") =
+            f_ab("a,c") -
+            (2.0 * g_ijab("k,l,c,d") - g_ijab("l,k,c,d")) * tau("a,d,k,l");
+        r1("a,i") += h_ac("a,c") * t1("c,i");
+      }
+
+      {
+        h_ki("k,i") =
+            f_ij("k,i") +
+            (2.0 * g_ijab("k,l,c,d") - g_ijab("k,l,d,c")) * tau("c,d,i,l");
+        r1("a,i") -= t1("a,k") * h_ki("k,i");
+      }
+
+      {
+        h_kc("k,c") =
+            f_ai("c,k") +
+            (2.0 * g_ijab("k,l,c,d") - g_ijab("k,l,d,c")) * t1("d,l");
+        r1("a,i") += h_kc("k,c") * (2.0 * t2("c,a,k,i") - t2("c,a,i,k") +
+                                    t1("c,i") * t1("a,k"));
+      }
+
+
+      tmp_time1 = mpqc::now(world, accurate_time);
+      tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
+      if (verbose_) {
+        mpqc::utility::print_par(world, "t1 h term time: ", tmp_time, "\n");
+      }
+
+      tmp_time0 = mpqc::now(world, accurate_time);
+      r1("a,i") += (2.0 * g_ijab("k,i,c,a") - g_iajb("k,a,i,c")) * t1("c,k");
+
+      r1("a,i") +=
+          (2.0 * g_iabc("k,a,c,d") - g_iabc("k,a,d,c")) * tau("c,d,k,i");
+
+      r1("a,i") -=
+          (2.0 * g_ijak("k,l,c,i") - g_ijak("l,k,c,i")) * tau("c,a,k,l");
+
+      tmp_time1 = mpqc::now(world, accurate_time);
+      tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
+      if (verbose_) {
+        mpqc::utility::print_par(world, "t1 other time: ", tmp_time, "\n");
+      }
+    }
+
+    auto t1_time1 = mpqc::now(world, accurate_time);
+    auto t1_time = mpqc::duration_in_s(t1_time0, t1_time1);
+    if (verbose_) {
+      mpqc::utility::print_par(world, "t1 total time: ", t1_time, "\n");
+    }
+
+    // intermediates for t2
+    // external index i j a b
+
+    auto t2_time0 = mpqc::now(world, accurate_time);
+
+    // compute residual r2(n) (at convergence r2 = 0)
+
+    // permutation part
+    tmp_time0 = mpqc::now(world, accurate_time);
+
+    {
+      r2("a,b,i,j") =
+          (g_iabc("i,c,a,b") - g_iajb("k,b,i,c") * t1("a,k")) * t1("c,j");
+
+      r2("a,b,i,j") -=
+          (g_ijak("i,j,a,k") + g_ijab("i,k,a,c") * t1("c,j")) * t1("b,k");
+    }
+    tmp_time1 = mpqc::now(world, accurate_time);
+    tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
+    if (verbose_) {
+      mpqc::utility::print_par(world, "t2 other time: ", tmp_time, "\n");
+    }
+
+    tmp_time0 = mpqc::now(world, accurate_time);
+    {
+      // compute g intermediate
+      TArray g_ki, g_ac;
+
+      g_ki("k,i") = h_ki("k,i") + f_ai("c,k") * t1("c,i") +
+                    (2.0 * g_ijka("k,l,i,c") - g_ijka("l,k,i,c")) * t1("c,l");
+
+      g_ac("a,c") = h_ac("a,c") - f_ai("c,k") * t1("a,k") +
+                    (2.0 * g_aibc("a,k,c,d") - g_aibc("a,k,d,c")) * t1("d,k");
+
+      r2("a,b,i,j") +=
+          g_ac("a,c") * t2("c,b,i,j") - g_ki("k,i") * t2("a,b,k,j");
+    }
+    tmp_time1 = mpqc::now(world, accurate_time);
+    tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
+    if (verbose_) {
+      mpqc::utility::print_par(world, "t2 g term time: ", tmp_time, "\n");
+    }
+
+    tmp_time0 = mpqc::now(world, accurate_time);
+    {
+      TArray j_akic;
+      TArray k_kaic;
+      // compute j and k intermediate
+      {
+        TArray T;
+
+        T("d,b,i,l") = 0.5 * t2("d,b,i,l") + t1("d,i") * t1("b,l");
+
+        j_akic("a,k,i,c") = g_ijab("i,k,a,c");
+
+        j_akic("a,k,i,c") -= g_ijka("l,k,i,c") * t1("a,l");
+
+        j_akic("a,k,i,c") += g_aibc("a,k,d,c") * t1("d,i");
+
+        j_akic("a,k,i,c") -= g_ijab("k,l,c,d") * T("d,a,i,l");
+
+        j_akic("a,k,i,c") += 0.5 *
+                             (2.0 * g_ijab("k,l,c,d") - g_ijab("k,l,d,c")) *
+                             t2("a,d,i,l");
+
+        k_kaic("k,a,i,c") = g_iajb("k,a,i,c")
+
+                            - g_ijka("k,l,i,c") * t1("a,l")
+
+                            + g_iabc("k,a,d,c") * t1("d,i")
+
+                            - g_ijab("k,l,d,c") * T("d,a,i,l");
+        if (verbose_) {
+          mpqc::detail::print_size_info(T, "T");
+          mpqc::detail::print_size_info(j_akic, "J_akic");
+          mpqc::detail::print_size_info(k_kaic, "K_kaic");
+        }
+      }
+
+      r2("a,b,i,j") += 0.5 * (2.0 * j_akic("a,k,i,c") - k_kaic("k,a,i,c")) *
+                       (2.0 * t2("c,b,k,j") - t2("b,c,k,j"));
+
+      r2("a,b,i,j") += -0.5 * k_kaic("k,a,i,c") * t2("b,c,k,j") -
+                       k_kaic("k,b,i,c") * t2("a,c,k,j");
+    }
+    tmp_time1 = mpqc::now(world, accurate_time);
+    tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
+    if (verbose_) {
+      mpqc::utility::print_par(world, "t2 j,k term time: ", tmp_time, "\n");
+    }
+
+    // perform the permutation
+    r2("a,b,i,j") = r2("a,b,i,j") + r2("b,a,j,i");
+
+    r2("a,b,i,j") += g_ijab("i,j,a,b");
+
+    tmp_time0 = mpqc::now(world, accurate_time);
+    {
+      TArray a_klij;
+      // compute a intermediate
+      a_klij("k,l,i,j") = g_ijkl("k,l,i,j");
+
+      a_klij("k,l,i,j") += g_ijka("k,l,i,c") * t1("c,j");
+
+      a_klij("k,l,i,j") += g_ijak("k,l,c,j") * t1("c,i");
+
+      a_klij("k,l,i,j") += g_ijab("k,l,c,d") * tau("c,d,i,j");
+
+      r2("a,b,i,j") += a_klij("k,l,i,j") * tau("a,b,k,l");
+
+      if (verbose_) {
+        mpqc::detail::print_size_info(a_klij, "A_klij");
+      }
+    }
+    tmp_time1 = mpqc::now(world, accurate_time);
+    tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
+    if (verbose_) {
+      mpqc::utility::print_par(world, "t2 a term time: ", tmp_time, "\n");
+    }
+
+    tmp_time0 = mpqc::now(world, accurate_time);
+    {
+      // compute b intermediate
+      if (reduced_abcd_memory_) {
+        // avoid store b_abcd
+        TArray b_abij;
+        b_abij("a,b,i,j") = g_abcd("a,b,c,d") * tau("c,d,i,j");
+
+        b_abij("a,b,i,j") -= g_aibc("a,k,c,d") * tau("c,d,i,j") * t1("b,k");
+
+        b_abij("a,b,i,j") -= g_iabc("k,b,c,d") * tau("c,d,i,j") * t1("a,k");
+
+        if (verbose_) {
+          mpqc::detail::print_size_info(b_abij, "B_abij");
+        }
+
+        r2("a,b,i,j") += b_abij("a,b,i,j");
+      } else {
+        TArray b_abcd;
+
+        b_abcd("a,b,c,d") = g_abcd("a,b,c,d") -
+                            g_aibc("a,k,c,d") * t1("b,k") -
+                            g_iabc("k,b,c,d") * t1("a,k");
+
+        if (verbose_) {
+          mpqc::detail::print_size_info(b_abcd, "B_abcd");
+        }
+
+        r2("a,b,i,j") += b_abcd("a,b,c,d") * tau("c,d,i,j");
+      }
+    }
+    tmp_time1 = mpqc::now(world, accurate_time);
+    tmp_time = mpqc::duration_in_s(tmp_time0, tmp_time1);
+
+    if (verbose_) {
+      mpqc::utility::print_par(world, "t2 b term time: ", tmp_time, "\n");
+    }
+
+    auto t2_time1 = mpqc::now(world, accurate_time);
+    auto t2_time = mpqc::duration_in_s(t2_time0, t2_time1);
+    if (verbose_) {
+      mpqc::utility::print_par(world, "t2 total time: ", t2_time, "\n");
+    }
+  }
+
+  /// computes the T1-dressed intermediates of the T3 equation
+  void compute_t3_intermediates(const CC3Integrals &ints, const TArray &t1,
+                                TArray &Chi_dabi, TArray &Chi_cjkl) {
+    // the intermediates of Noga and Bartlett, see the references in
+    // compute_CC3_conventional()
+    const auto &g_abcd = ints.g_abcd;
+    const auto &g_ijab = ints.g_ijab;
+    const auto &g_ijkl = ints.g_ijkl;
+    const auto &g_iajb = ints.g_iajb;
+    const auto &g_iabj = ints.g_iabj;
+    const auto &g_aibc = ints.g_aibc;
+    const auto &g_dabi = ints.g_dabi;
+    const auto &g_aijk = ints.g_aijk;
+    const auto &g_iajk = ints.g_iajk;
+
+    TArray f_aijk;
+    TArray f_aibc;
+    TArray f_aijb;
+    TArray f_aibj;
+    TArray f_iabj;
+    TArray f_iajb;
+    TArray g_aijb;
+    TArray g_aibj;
+
+    g_aijb("a,i,j,b") = g_iabj("i,a,b,j");
+    g_aibj("a,i,b,j") = g_iajb("i,a,j,b");
+
+    f_aijk("e,i,m,n") = g_aijk("e,i,m,n") + g_ijab("m,n,e,f") * t1("f,i");
+    f_aibc("a,m,e,f") = g_aibc("a,m,e,f") - g_ijab("n,m,e,f") * t1("a,n");
+    f_aijb("a,m,i,e") = g_aijb("a,m,i,e") + g_aibc("a,m,f,e") * t1("f,i");
+    f_aibj("a,m,e,i") = g_aibj("a,m,e,i") + g_aibc("a,m,e,f") * t1("f,i");
+    f_iabj("i,e,a,m") = g_iabj("i,e,a,m") - g_iajk("i,e,n,m") * t1("a,n");
+    f_iajb("i,e,m,a") = g_iajb("i,e,m,a") - g_iajk("i,e,m,n") * t1("a,n");
+
+    // Now the super-intermediates,
+    Chi_dabi("b,a,e,i") =  g_dabi("b,a,e,i") + ((f_aijk("e,i,m,n") * t1("a,n")) * t1("b,m"))
+                         - f_aijb("a,m,i,e") * t1("b,m") - f_aibj("b,m,e,i") * t1("a,m")
+                         + g_abcd("a,b,f,e") * t1("f,i");
+
+    Chi_cjkl("a,m,i,j") =  g_aijk("a,m,i,j") + ((f_aibc("a,m,e,f") * t1("e,i")) * t1("f,j"))
+                         + f_iabj("i,e,a,m") * t1("e,j") + f_iajb("j,e,m,a") * t1("e,i")
+                         - g_ijkl("i,j,n,m") * t1("a,n");
+  }
+
   /*
   double compute_cc3_df(TArray &t1, TArray &t2) {
     auto &world = this->wfn_world()->world();
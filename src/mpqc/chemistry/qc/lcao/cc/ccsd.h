@@ -75,6 +75,7 @@ class CCSD : public LCAOWavefunction<Tile, Policy>,
    * | @c solver   | string | @c jacobi_diis | specifies the CCSD solver; valid choices are @c jacobi_diis (combination of Jacobi update and DIIS) and @c pno (simulated PNO solver; only valid if @c method is set to @c df or @c direct_df ); @c kv will also be used to construct the Solver object, hence it will be queried for the corresponding keywords. |
    * | @c verbose | bool | false | if print more information in CCSD iteration |
    * | @c reduced_abcd_memory | bool | @c true | if @c method=standard , avoid storing an extra abcd intermediate at the cost of increased FLOPs; if @c method=df , avoid storage of (ab|cd) integral in favor of lazy evaluation in batches |
+   * | @c packed_ladder | bool | @c false | if true, the particle-particle ladder term is computed in the symmetric/antisymmetric formulation with pairs of unoccupied indices packed, which halves its FLOPs and the memory of the stored (ab|cd) integrals (the unpacked integrals are not kept unless needed after CCSD, e.g. by EOM-CCSD); applies to @c method=standard and @c df |
    * | @c cp_ccsd | bool | @c false | if @c method == df compute Xab integrals using CP decomposition |
    * | @c cp_rank | double | @c 0.6 | CP rank set to number of auxiliary basis functions * @c cp_rank |
    * | @c cp_precision | double | @c 0.1 | ALS threshold for CP decomposition |
@@ -100,6 +101,7 @@ class CCSD : public LCAOWavefunction<Tile, Policy>,
 
     solver_str_ = kv_.value<std::string>("solver", "jacobi_diis", [](const auto& value) { return value == "jacobi_diis" || value == "pno"; });
     reduced_abcd_memory_ = kv_.value<bool>("reduced_abcd_memory", true);
+    packed_ladder_ = kv_.value<bool>("packed_ladder", false);
 
     max_iter_ = kv_.value<int>("max_iter", 30);
     verbose_ = kv_.value<bool>("verbose", false);
@@ -128,6 +130,7 @@ class CCSD : public LCAOWavefunction<Tile, Policy>,
   typename AOFactory::DirectTArray direct_ao_array_;
   bool df_;
   bool reduced_abcd_memory_ = false;
+  bool packed_ladder_ = false;
   std::string method_;
   std::size_t max_iter_;
   double target_precision_;
@@ -292,12 +295,20 @@ class CCSD : public LCAOWavefunction<Tile, Policy>,
     if (method_ == "standard" || (method_ == "df" && !reduced_abcd_memory_)) {
       if(!cp_ccsd_) {
         ints.Gabcd = this->get_abcd();
+        if (packed_ladder_) {
+          ints.Gabcd_packed = cc::pack_ladder_integrals(ints.Gabcd);
+          // keep only the packed integrals
+          ints.Gabcd = TArray();
+          this->purge_abcd();
+        }
       }
       ints.Giabc = this->get_iabc();
     } else if (method_ == "direct") {
       ints.Giabc = this->get_iabc();
     }
 
+    ints.packed_ladder = packed_ladder_;
+
     if (df_) {
       ints.Xai = this->get_Xai();
       ints.Xij = this->get_Xij();
@@ -359,6 +370,8 @@ class CCSD : public LCAOWavefunction<Tile, Policy>,
       std::cout << "Verbose: " << verbose_ << std::endl;
       std::cout << "Reduced ABCD Memory Approach: "
                 << (reduced_abcd_memory_ ? "Yes" : "No") << std::endl;
+      std::cout << "Packed Ladder: " << (packed_ladder_ ? "Yes" : "No")
+                << std::endl;
     }
 
     // CCSD solver loop
@@ -527,6 +540,14 @@ class CCSD : public LCAOWavefunction<Tile, Policy>,
     return this->lcao_factory().compute(L"<a b|G|c d>" + postfix);
   }
 
+  /// removes <ab|cd>, as computed by get_abcd(), from the registry once CCSD
+  /// uses the packed integrals; classes that use <ab|cd> after CCSD must
+  /// override this to keep them
+  virtual void purge_abcd() {
+    std::wstring postfix = df_ ? L"[df]" : L"";
+    this->lcao_factory().registry().purge_formula(L"<a b|G|c d>" + postfix);
+  }
+
   /// <ia|bc>
   virtual const TArray get_iabc() {
     std::wstring postfix = df_ ? L"[df]" : L"";
@@ -0,0 +1,470 @@
+#ifndef SRC_MPQC_CHEMISTRY_QC_LCAO_CC_CCSD_LADDER_H_
+#define SRC_MPQC_CHEMISTRY_QC_LCAO_CC_CCSD_LADDER_H_
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <tiledarray.h>
+#include "mpqc/chemistry/qc/lcao/integrals/direct_task_integrals.h"
+#include "mpqc/math/external/tiledarray/tile_util.h"
+
+namespace mpqc {
+namespace lcao {
+namespace cc {
+
+/**
+ * @brief this file contains the symmetric/antisymmetric formulation of the
+ * particle-particle ladder term of closed-shell CCSD,
+ * \f$ B^{ab}_{ij} = \sum_{cd} W_{abcd} \tau^{cd}_{ij} \f$ with
+ * \f$ W_{abcd} = W_{badc} \f$ and \f$ \tau^{cd}_{ij} = \tau^{dc}_{ji} \f$ .
+ *
+ * With \f$ \tau^\pm_{cd,ij} = \frac{1}{2}(\tau^{cd}_{ij} \pm \tau^{dc}_{ij})\f$
+ * and \f$ W^\pm_{ab,cd} = \frac{1}{2}(W_{abcd} \pm W_{abdc}) \f$ the ladder
+ * term is \f$ B_{ab,ij} = \sum_{cd} (W^+_{ab,cd} \tau^+_{cd,ij} +
+ * W^-_{ab,cd} \tau^-_{cd,ij}) \f$ ; the summand is symmetric in \f$ cd \f$
+ * and \f$ B^{ba}_{ij} = B^{ab}_{ji} \f$ , hence only the pairs
+ * \f$ a \geq b \f$ and \f$ c \geq d \f$ are needed, which halves the FLOPs
+ * and the storage of \f$ W \f$ .
+ *
+ * The pairs are packed at the tile level: a packed pair mode has one tile for
+ * each pair of tiles \f$ \{A,B\}, A \geq B \f$ of the original modes, that
+ * holds all element pairs \f$ a \in A, b \in B \f$ . The tiles of the
+ * packed \f$ cd \f$ mode hold the pairs of \f$ W^+ \f$ ( \f$ \tau^+ \f$ )
+ * followed by the pairs of \f$ W^- \f$ ( \f$ \tau^- \f$ ), hence both are
+ * contracted at once and a tile of \f$ W^+ \f$ is computed with the tile of
+ * \f$ W^- \f$ from the same tiles of \f$ W \f$ .
+ */
+
+namespace detail {
+
+using mpqc::detail::find_tile;
+using mpqc::detail::make_shape;
+using mpqc::detail::tile_norm;
+using mpqc::detail::tile_pair;
+using mpqc::detail::tile_pair_ordinal;
+
+/// @return the packed pair mode of two modes tiled by \c tr1 , each tile
+/// holds \c nblocks blocks of the element pairs of its tile pair
+inline TA::TiledRange1 packed_pair_trange1(const TA::TiledRange1 &tr1,
+                                           std::size_t nblocks = 1) {
+  const auto ntiles = tr1.tiles_range().second - tr1.tiles_range().first;
+  auto extent = [&tr1](std::size_t t) {
+    return tr1.tile(t).second - tr1.tile(t).first;
+  };
+  std::vector<std::size_t> bounds{0};
+  for (auto t0 = 0ul; t0 != ntiles; ++t0) {
+    for (auto t1 = 0ul; t1 <= t0; ++t1) {
+      bounds.push_back(bounds.back() + nblocks * extent(t0) * extent(t1));
+    }
+  }
+  return TA::TiledRange1(bounds.begin(), bounds.end());
+}
+
+/// @return the tile \c {P,Q} of the packed \f$ W^\pm \f$ in range \c range
+/// from the tiles \c {A,B,C,D} and \c {A,B,D,C} of \f$ W \f$ ; each row
+/// holds \f$ W^+ \f$ followed by \f$ W^- \f$ , empty tiles are zero
+template <typename Tile>
+Tile pack_integral_tile(const TA::Range &range, const Tile &w_cd,
+                        const Tile &w_dc) {
+  using numeric_type = typename Tile::numeric_type;
+  Tile result(range, numeric_type(0));
+  const auto nrows = range.extent_data()[0];
+  const auto ncols = range.extent_data()[1] / 2;
+  auto *result_ptr = result.data();
+  if (!w_cd.empty()) {
+    const auto *w_ptr = w_cd.data();
+    for (auto r = 0ul; r != nrows; ++r) {
+      auto *row_ptr = result_ptr + r * 2 * ncols;
+      for (auto k = 0ul; k != ncols; ++k) {
+        const auto w = 0.5 * w_ptr[r * ncols + k];
+        row_ptr[k] = w;
+        row_ptr[ncols + k] = w;
+      }
+    }
+  }
+  if (!w_dc.empty()) {
+    const auto permuted = w_dc.permute(TA::Permutation({0, 1, 3, 2}));
+    const auto *w_ptr = permuted.data();
+    for (auto r = 0ul; r != nrows; ++r) {
+      auto *row_ptr = result_ptr + r * 2 * ncols;
+      for (auto k = 0ul; k != ncols; ++k) {
+        const auto w = 0.5 * w_ptr[r * ncols + k];
+        row_ptr[k] += w;
+        row_ptr[ncols + k] -= w;
+      }
+    }
+  }
+  return result;
+}
+
+/// @return the tile \c {Q,I,J} of the packed \f$ \tau^\pm \f$ in range \c
+/// range , <tt>factor * (tau_cd +- tau_dc.permute({1,0,2,3}))</tt> with \f$
+/// \tau^+ \f$ followed by \f$ \tau^- \f$ ; empty tiles are zero
+template <typename Tile>
+Tile pack_amplitude_tile(const TA::Range &range, const Tile &tau_cd,
+                         const Tile &tau_dc, double factor) {
+  using numeric_type = typename Tile::numeric_type;
+  Tile result(range, numeric_type(0));
+  const auto volume = range.volume() / 2;
+  auto *plus_ptr = result.data();
+  auto *minus_ptr = plus_ptr + volume;
+  if (!tau_cd.empty()) {
+    const auto *tau_ptr = tau_cd.data();
+    for (auto k = 0ul; k != volume; ++k) {
+      plus_ptr[k] = minus_ptr[k] = factor * tau_ptr[k];
+    }
+  }
+  if (!tau_dc.empty()) {
+    const auto permuted = tau_dc.permute(TA::Permutation({1, 0, 2, 3}));
+    const auto *tau_ptr = permuted.data();
+    for (auto k = 0ul; k != volume; ++k) {
+      plus_ptr[k] += factor * tau_ptr[k];
+      minus_ptr[k] -= factor * tau_ptr[k];
+    }
+  }
+  return result;
+}
+
+/// @return the tile of the ladder term in range \c range (of \c {A,B,I,J})
+/// from the tile \c packed of the pair \c {A,B} if \c swapped is false, or
+/// from the tile of \c {B,A,J,I} otherwise
+template <typename Tile>
+Tile unpack_ladder_tile(const TA::Range &range, const Tile &packed,
+                        bool swapped) {
+  using numeric_type = typename Tile::numeric_type;
+  // B_ab^ij = B_ba^ji
+  const TA::Permutation perm({1, 0, 3, 2});
+  const auto packed_range = swapped ? TA::Range(perm, range) : range;
+  Tile result(packed_range, numeric_type(0));
+  if (!packed.empty()) {
+    std::copy(packed.data(), packed.data() + range.volume(), result.data());
+  }
+  return swapped ? result.permute(perm) : result;
+}
+
+}  // namespace detail
+
+/**
+ * packs the symmetric and antisymmetric combinations of the 4-index integral
+ * \c w_abcd , which must satisfy \f$ W_{abcd} = W_{badc} \f$ , in pairs
+ * \f$ a \geq b, c \geq d \f$
+ *
+ * @param w_abcd \f$ W \f$ in w_abcd("a,b,c,d")
+ * @return \f$ W^\pm \f$ in \c ("P,Q") , where \c P is the packed pair
+ * \c ab and \c Q the packed pair \c cd , of \f$ W^+ \f$ and \f$ W^- \f$
+ */
+template <typename Tile, typename Policy>
+TA::DistArray<Tile, Policy> pack_ladder_integrals(
+    const TA::DistArray<Tile, Policy> &w_abcd) {
+  using Array = TA::DistArray<Tile, Policy>;
+  auto &world = w_abcd.world();
+  const auto &trange4 = w_abcd.trange();
+  const TA::TiledRange trange{
+      detail::packed_pair_trange1(trange4.data()[0]),
+      detail::packed_pair_trange1(trange4.data()[2], 2)};
+
+  // the tiles {A,B,C,D} and {A,B,D,C} of W that make up the tile {P,Q}
+  auto tiles = [&trange](std::size_t ord) {
+    const auto idx = trange.tiles_range().idx(ord);
+    const auto ab = detail::tile_pair(idx[0]);
+    const auto cd = detail::tile_pair(idx[1]);
+    return std::make_pair(
+        std::array<std::size_t, 4>{{ab.first, ab.second, cd.first, cd.second}},
+        std::array<std::size_t, 4>{
+            {ab.first, ab.second, cd.second, cd.first}});
+  };
+  // |W+|^2 + |W-|^2 = (|W_abcd|^2 + |W_abdc|^2) / 2
+  const auto shape = detail::make_shape(
+      trange,
+      [&w_abcd, &tiles](auto ord) {
+        const auto idx = tiles(ord);
+        const auto n0 = detail::tile_norm(w_abcd, idx.first);
+        const auto n1 = detail::tile_norm(w_abcd, idx.second);
+        return std::sqrt(0.5f * (n0 * n0 + n1 * n1));
+      },
+      Policy());
+
+  Array result(world, trange, shape);
+  const auto end = result.pmap()->end();
+  for (auto it = result.pmap()->begin(); it != end; ++it) {
+    const auto ord = *it;
+    if (result.is_zero(ord)) continue;
+    const auto idx = tiles(ord);
+    result.set(ord, world.taskq.add(&detail::pack_integral_tile<Tile>,
+                                    trange.make_tile_range(ord),
+                                    detail::find_tile(w_abcd, idx.first),
+                                    detail::find_tile(w_abcd, idx.second)));
+  }
+  world.gop.fence();
+  result.truncate();
+  return result;
+}
+
+/**
+ * packs \f$ \tau^\pm \f$ in pairs \f$ c \geq d \f$ ; the pairs of different
+ * tiles, \f$ C > D \f$ , are scaled by 2 to account for the pairs \f$ c < d
+ * \f$ that are not stored
+ *
+ * @param tau \f$ \tau \f$ in tau("c,d,i,j")
+ * @return the packed \f$ \tau^\pm \f$ in \c ("Q,i,j") , see
+ * pack_ladder_integrals() for \c Q
+ */
+template <typename Tile, typename Policy>
+TA::DistArray<Tile, Policy> pack_ladder_amplitudes(
+    const TA::DistArray<Tile, Policy> &tau) {
+  using Array = TA::DistArray<Tile, Policy>;
+  auto &world = tau.world();
+  const auto &trange4 = tau.trange();
+  const TA::TiledRange trange{
+      detail::packed_pair_trange1(trange4.data()[0], 2), trange4.data()[2],
+      trange4.data()[3]};
+
+  // the tiles {C,D,I,J} and {D,C,I,J} of tau that make up the tile {Q,I,J}
+  auto tiles = [&trange](std::size_t ord) {
+    const auto idx = trange.tiles_range().idx(ord);
+    const auto cd = detail::tile_pair(idx[0]);
+    return std::make_pair(
+        std::array<std::size_t, 4>{{cd.first, cd.second, idx[1], idx[2]}},
+        std::array<std::size_t, 4>{{cd.second, cd.first, idx[1], idx[2]}});
+  };
+  // 1/2 (tau +- tau^T), times 2 if C > D
+  auto factor = [](std::array<std::size_t, 4> const &idx) {
+    return idx[0] == idx[1] ? 0.5 : 1.0;
+  };
+  // |tau+|^2 + |tau-|^2 = 2 factor^2 (|tau_cd|^2 + |tau_dc|^2)
+  const auto shape = detail::make_shape(
+      trange,
+      [&tau, &tiles, &factor](auto ord) {
+        const auto idx = tiles(ord);
+        const auto n0 = detail::tile_norm(tau, idx.first);
+        const auto n1 = detail::tile_norm(tau, idx.second);
+        return float(factor(idx.first)) *
+               std::sqrt(2.0f * (n0 * n0 + n1 * n1));
+      },
+      Policy());
+
+  Array result(world, trange, shape);
+  const auto end = result.pmap()->end();
+  for (auto it = result.pmap()->begin(); it != end; ++it) {
+    const auto ord = *it;
+    if (result.is_zero(ord)) continue;
+    const auto idx = tiles(ord);
+    result.set(ord, world.taskq.add(&detail::pack_amplitude_tile<Tile>,
+                                    trange.make_tile_range(ord),
+                                    detail::find_tile(tau, idx.first),
+                                    detail::find_tile(tau, idx.second),
+                                    factor(idx.first)));
+  }
+  world.gop.fence();
+  result.truncate();
+  return result;
+}
+
+/**
+ * unpacks the ladder term \f$ B \f$
+ *
+ * @param b_packed \f$ B \f$ in \c ("P,i,j") , with \c P the packed pair
+ * \c ab
+ * @param trange the tiled range of \f$ B \f$ in \c ("a,b,i,j")
+ * @return \f$ B \f$ in \c ("a,b,i,j")
+ */
+template <typename Tile, typename Policy>
+TA::DistArray<Tile, Policy> unpack_ladder(
+    const TA::DistArray<Tile, Policy> &b_packed, const TA::TiledRange &trange) {
+  using Array = TA::DistArray<Tile, Policy>;
+  auto &world = b_packed.world();
+
+  // the tile of B packed that holds the tile {A,B,I,J} of B
+  auto packed_tile = [&trange](std::size_t ord) {
+    const auto idx = trange.tiles_range().idx(ord);
+    const auto swapped = idx[0] < idx[1];
+    const std::array<std::size_t, 3> packed_idx =
+        swapped ? std::array<std::size_t, 3>{{detail::tile_pair_ordinal(
+                                                  idx[1], idx[0]),
+                                              std::size_t(idx[3]),
+                                              std::size_t(idx[2])}}
+                : std::array<std::size_t, 3>{{detail::tile_pair_ordinal(
+                                                  idx[0], idx[1]),
+                                              std::size_t(idx[2]),
+                                              std::size_t(idx[3])}};
+    return std::make_pair(packed_idx, swapped);
+  };
+  const auto shape = detail::make_shape(
+      trange,
+      [&b_packed, &packed_tile](auto ord) {
+        return detail::tile_norm(b_packed, packed_tile(ord).first);
+      },
+      Policy());
+
+  Array result(world, trange, shape);
+  const auto end = result.pmap()->end();
+  for (auto it = result.pmap()->begin(); it != end; ++it) {
+    const auto ord = *it;
+    if (result.is_zero(ord)) continue;
+    const auto idx = packed_tile(ord);
+    result.set(ord, world.taskq.add(&detail::unpack_ladder_tile<Tile>,
+                                    trange.make_tile_range(ord),
+                                    detail::find_tile(b_packed, idx.first),
+                                    idx.second));
+  }
+  world.gop.fence();
+  result.truncate();
+  return result;
+}
+
+/**
+ * computes the ladder term from the packed integrals
+ *
+ * @tparam W the type of the packed integrals, a TA::DistArray or a
+ * gaussian::DirectArray
+ * @param w_packed \f$ W^\pm \f$ in \c ("P,Q") , see pack_ladder_integrals()
+ * @param tau \f$ \tau \f$ in tau("c,d,i,j")
+ * @return \f$ B^{ab}_{ij} = \sum_{cd} W_{abcd} \tau^{cd}_{ij} \f$ in
+ * \c ("a,b,i,j")
+ */
+template <typename W, typename Tile, typename Policy>
+TA::DistArray<Tile, Policy> compute_packed_ladder(
+    const W &w_packed, const TA::DistArray<Tile, Policy> &tau) {
+  TA::DistArray<Tile, Policy> b_packed;
+  {
+    auto tau_packed = pack_ladder_amplitudes(tau);
+    b_packed("P,i,j") = w_packed("P,Q") * tau_packed("Q,i,j");
+  }
+  // a and b have the same tiling as c and d
+  return unpack_ladder(b_packed, tau.trange());
+}
+
+/**
+ * builds the tiles of the packed \f$ W^\pm \f$ of the lazy density-fitting
+ * ladder term, \f$ W_{abcd} = M_{abcd} + M_{badc} \f$ , where \f$ M \f$ is
+ * computed from density-fitting factors by DirectDFIntegralBuilder; each tile
+ * takes 4 tiles of \f$ M \f$ , shared by \f$ W^+ \f$ and \f$ W^- \f$
+ */
+template <typename Tile, typename Policy>
+class DirectPackedLadderBuilder
+    : public std::enable_shared_from_this<
+          DirectPackedLadderBuilder<Tile, Policy>> {
+ public:
+  using MBuilder = gaussian::DirectDFIntegralBuilder<Tile, Policy>;
+
+  /**
+   * @param m_builder builds the tiles of \f$ M \f$
+   * @param trange the tiled range of \f$ M \f$
+   */
+  DirectPackedLadderBuilder(madness::World &world,
+                            std::shared_ptr<MBuilder> m_builder,
+                            TA::TiledRange trange)
+      : m_builder_(std::move(m_builder)),
+        trange_(std::move(trange)),
+        world_(world),
+        id_(world.register_ptr(this)) {}
+
+  DirectPackedLadderBuilder(DirectPackedLadderBuilder &&) = delete;
+  DirectPackedLadderBuilder(const DirectPackedLadderBuilder &) = delete;
+  DirectPackedLadderBuilder &operator=(const DirectPackedLadderBuilder &) =
+      delete;
+
+  ~DirectPackedLadderBuilder() {
+    if (madness::initialized()) {
+      madness::World *world = madness::World::world_from_id(id_.get_world_id());
+      world->unregister_ptr(this);
+    }
+  }
+
+  madness::uniqueidT id() const { return id_; }
+
+  // compute Tile for particular block
+  madness::Future<Tile> operator()(const std::vector<std::size_t> &idx,
+                                   const TA::Range &range) const {
+    TA_ASSERT(idx.size() == 2);
+    const auto ab = detail::tile_pair(idx[0]);
+    const auto cd = detail::tile_pair(idx[1]);
+    const auto a = ab.first, b = ab.second, c = cd.first, d = cd.second;
+
+    auto m = [this](std::size_t t0, std::size_t t1, std::size_t t2,
+                    std::size_t t3) {
+      std::vector<std::size_t> m_idx{t0, t1, t2, t3};
+      const auto m_range = trange_.make_tile_range(m_idx);
+      return (*m_builder_)(m_idx, m_range);
+    };
+
+    return world_.taskq.add(&DirectPackedLadderBuilder::make_tile, range,
+                            m(a, b, c, d), m(b, a, d, c), m(a, b, d, c),
+                            m(b, a, c, d));
+  }
+
+ private:
+  static Tile make_tile(const TA::Range &range, const Tile &m_abcd,
+                        const Tile &m_badc, const Tile &m_abdc,
+                        const Tile &m_bacd) {
+    // W_abcd = M_abcd + M_badc
+    const TA::Permutation perm({1, 0, 3, 2});
+    const auto w_abcd = m_abcd.add(m_badc.permute(perm));
+    const auto w_abdc = m_abdc.add(m_bacd.permute(perm));
+    return detail::pack_integral_tile(range, w_abcd, w_abdc);
+  }
+
+  std::shared_ptr<MBuilder> m_builder_;
+  TA::TiledRange trange_;
+  madness::World &world_;
+  madness::uniqueidT id_;
+};
+
+/**
+ * constructs the packed \f$ W^\pm \f$ of the lazy density-fitting ladder
+ * term, whose tiles are computed when used
+ *
+ * @param bra \f$ X^K_{ac} \f$ in bra("K,a,c")
+ * @param ket \f$ Y^K_{bd} \f$ in ket("K,b,d")
+ * @return \f$ W^\pm \f$ in \c ("P,Q") , see pack_ladder_integrals(), with
+ * \f$ W_{abcd} = M_{abcd} + M_{badc} \f$ and \f$ M_{abcd} = \sum_K X^K_{ac}
+ * Y^K_{bd} \f$
+ */
+template <typename Tile, typename Policy>
+gaussian::DirectArray<Tile, Policy, DirectPackedLadderBuilder<Tile, Policy>>
+direct_packed_ladder_integrals(const TA::DistArray<Tile, Policy> &bra,
+                               const TA::DistArray<Tile, Policy> &ket) {
+  using Builder = DirectPackedLadderBuilder<Tile, Policy>;
+  using DirectTile = gaussian::DirectTile<Tile, Builder>;
+  auto &world = bra.world();
+
+  const auto &tr_ac = bra.trange().data();
+  const auto &tr_bd = ket.trange().data();
+  const TA::TiledRange m_trange{tr_ac[1], tr_bd[1], tr_ac[2], tr_bd[2]};
+  const TA::TiledRange trange{detail::packed_pair_trange1(tr_ac[1]),
+                              detail::packed_pair_trange1(tr_ac[2], 2)};
+
+  auto m_builder = std::make_shared<typename Builder::MBuilder>(
+      bra, ket, Formula::Notation::Physical);
+  auto builder_ptr = std::make_shared<Builder>(world, m_builder, m_trange);
+
+  // set norm to a large enough value
+  const auto shape = detail::make_shape(
+      trange,
+      [&trange](auto ord) {
+        return float(trange.make_tile_range(ord).volume());
+      },
+      Policy());
+  TA::DistArray<DirectTile, Policy> result(world, trange, shape);
+
+  const auto end = result.pmap()->end();
+  for (auto it = result.pmap()->begin(); it != end; ++it) {
+    const auto ord = *it;
+    if (result.is_zero(ord)) continue;
+    auto idx = trange.tiles_range().idx(ord);
+    result.set(ord, DirectTile(std::vector<std::size_t>(idx.begin(), idx.end()),
+                               trange.make_tile_range(ord), builder_ptr));
+  }
+  world.gop.fence();
+
+  return gaussian::DirectArray<Tile, Policy, Builder>(builder_ptr, result);
+}
+
+}  // namespace cc
+}  // namespace lcao
+}  // namespace mpqc
+
+#endif  // SRC_MPQC_CHEMISTRY_QC_LCAO_CC_CCSD_LADDER_H_
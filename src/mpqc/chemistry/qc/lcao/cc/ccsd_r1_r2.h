@@ -7,6 +7,7 @@
 
 #include <tiledarray.h>
 #include "mpqc/chemistry/qc/lcao/cc/ccsd_intermediates.h"
+#include "mpqc/chemistry/qc/lcao/cc/ccsd_ladder.h"
 #include "mpqc/chemistry/qc/lcao/integrals/direct_task_integrals.h"
 
 namespace mpqc {
@@ -42,6 +43,12 @@ struct Integrals {
   Array Giabc;  // <i a|G|b c>
   Array Gijka;  // <i j|G|k a>
 
+  // symmetric and antisymmetric <a b|G|c d> packed in pairs a>=b, c>=d, see
+  // pack_ladder_integrals(); if initialized, used instead of Gabcd
+  Array Gabcd_packed;
+  // if true, the lazy density-fitting ladder term uses packed pairs too
+  bool packed_ladder = false;
+
   // mo three center integrals
   Array Xai;  // (X|a i)(X|K)^-1/2
   Array Xij;  // (X|i j)(X|K)^-1/2
@@ -190,7 +197,8 @@ Array compute_cs_ccsd_r1_df(const Array& t1, const Array& t2, const Array& tau,
  * @param t2 CCSD T2 amplitudes in T2("a,b,i,j")
  * @param tau T2("a,b,i,j") + T1("a,i")*T1("b,j")
  * @param ints cc::Integrals, requires Fia, FIJ, FAB, Gijab, Giajb, Gijka,
- * Gijkl, Giabc and Gabcd if u is not initialized
+ * Gijkl, Giabc and Gabcd (or Gabcd_packed) if u is not
+ * initialized
  * @param u half transformed intermediates U("p,r,i,j") =
  * (Tau("a,b,i,j")*Ca("q,a")*Ca("s,b"))*(p q|r s)
  * @return R2 residual
@@ -272,7 +280,11 @@ Array compute_cs_ccsd_r2(const Array& t1, const Array& t2, const Array& tau,
   {
     Array b_abij;
     if (!u.is_initialized()) {
-      b_abij("a,b,i,j") = tau("c,d,i,j") * ints.Gabcd("a,b,c,d");
+      if (ints.Gabcd_packed.is_initialized()) {
+        b_abij = cc::compute_packed_ladder(ints.Gabcd_packed, tau);
+      } else {
+        b_abij("a,b,i,j") = tau("c,d,i,j") * ints.Gabcd("a,b,c,d");
+      }
       Array tmp;
       tmp("k,a,i,j") = ints.Giabc("k,a,c,d") * tau("c,d,i,j");
       b_abij("a,b,i,j") -= tmp("k,a,j,i") * t1("b,k");
@@ -388,9 +400,13 @@ Array compute_cs_ccsd_r2_df(const Array& t1, const Array& t2, const Array& tau,
       auto time2 = std::chrono::high_resolution_clock::now();
       std::chrono::duration<double> time_span = time2 - time1;
 
-      if (ints.Gabcd.is_initialized()) {
+      if (ints.Gabcd.is_initialized() || ints.Gabcd_packed.is_initialized()) {
         time1 = std::chrono::high_resolution_clock::now();
-        b_abij("a,b,i,j") = tau("c,d,i,j") * ints.Gabcd("a,b,c,d");
+        if (ints.Gabcd_packed.is_initialized()) {
+          b_abij = cc::compute_packed_ladder(ints.Gabcd_packed, tau);
+        } else {
+          b_abij("a,b,i,j") = tau("c,d,i,j") * ints.Gabcd("a,b,c,d");
+        }
         time2 = std::chrono::high_resolution_clock::now();
         time_span = time2 - time1;
 
@@ -498,12 +514,18 @@ Array compute_cs_ccsd_r2_df(const Array& t1, const Array& t2, const Array& tau,
         X_ab_t1("K,a,b") =
             0.5 * ints.Xab("K,a,b") - ints.Xai("K,b,i") * t1("a,i");
 
-        auto g_abcd_iabc_direct = gaussian::df_direct_integrals(
-            ints.Xab, X_ab_t1, Formula::Notation::Physical);
+        if (ints.packed_ladder) {
+          // W_abcd = M_abcd + M_badc, with M the integrals below
+          auto w_packed = cc::direct_packed_ladder_integrals(ints.Xab, X_ab_t1);
+          b_abij = cc::compute_packed_ladder(w_packed, tau);
+        } else {
+          auto g_abcd_iabc_direct = gaussian::df_direct_integrals(
+              ints.Xab, X_ab_t1, Formula::Notation::Physical);
 
-        b_abij("a,b,i,j") = tau("c,d,i,j") * g_abcd_iabc_direct("a,b,c,d");
+          b_abij("a,b,i,j") = tau("c,d,i,j") * g_abcd_iabc_direct("a,b,c,d");
 
-        b_abij("a,b,i,j") += b_abij("b,a,j,i");
+          b_abij("a,b,i,j") += b_abij("b,a,j,i");
+        }
       }
     } else {
       b_abij("a,b,i,j") =
@@ -5,6 +5,9 @@
 #ifndef MPQC4_SRC_MPQC_CHEMISTRY_QC_CC_CCSD_T_H_
 #define MPQC4_SRC_MPQC_CHEMISTRY_QC_CC_CCSD_T_H_
 
+#include <numeric>
+#include <queue>
+
 #include "mpqc/chemistry/qc/lcao/cc/ccsd.h"
 #include "mpqc/mpqc_config.h"
 #include "mpqc/util/misc/print.h"
@@ -16,6 +19,7 @@
 #include "mpqc/chemistry/qc/lcao/cc/laplace_transform.h"
 
 #include "mpqc/math/quadrature/gaussian.h"
+#include "mpqc/util/external/madworld/task_counter.h"
 
 namespace mpqc {
 namespace lcao {
@@ -47,6 +51,12 @@ class CCSD_T : virtual public CCSD<Tile, Policy> {
   /// string represent (T) approach, see keyval constructor for detail
   std::string approach_;
 
+  /// how {a,b,c} tasks are distributed, see keyval constructor for detail
+  std::string task_distribution_;
+
+  /// number of {a,b,c} tasks claimed at once by the dynamic distribution
+  std::size_t dynamic_chunk_size_;
+
   /// occ reblock size
   std::size_t occ_block_size_;
 
@@ -94,6 +104,8 @@ class CCSD_T : virtual public CCSD<Tile, Policy> {
    * | @c reblock_unocc | int | @c 8 | the block size used for the unoccupied orbitals |
    * | @c reblock_inner | int | number of orbitals | the block size for the inner (contraction) dimension; set to 0 to disable reblock inner; only used if @c approach=laplace |
    * | @c replicate_ijka | bool | @c false | whether to replicate integral <ij\|ka>, the smallest 2-body integral in (T); valid only with @c approach=coarse |
+   * | @c task_distribution | string | @c round_robin | how the {a,b,c} tasks are distributed among the ranks; valid choices are <ul> <li>@c round_robin (static, cyclic) <li/> @c cost (static, balanced by the estimated cost of each task computed from the unoccupied tile sizes) <li/> @c dynamic (each rank fetches the next task from a counter on rank 0 when done with the previous one) </ul>; valid only with @c approach=coarse |
+   * | @c dynamic_chunk_size | int | @c 1 | the number of consecutive {a,b,c} tasks claimed at once with @c task_distribution=dynamic ; the next chunk is requested as soon as the current one is claimed |
    * | @c quadrature_points | int | @c 4 | number of quadrature points for the Laplace transform; valid only if @c approach=laplace |
    */
   // clang-format on
@@ -121,6 +133,20 @@ class CCSD_T : virtual public CCSD<Tile, Policy> {
                        "approach");
     }
 
+    task_distribution_ =
+        kv.value<std::string>("task_distribution", "round_robin");
+    if (task_distribution_ != "round_robin" && task_distribution_ != "cost" &&
+        task_distribution_ != "dynamic") {
+      throw InputError("Invalid (T) task distribution! \n", __FILE__, __LINE__,
+                       "task_distribution");
+    }
+    const auto dynamic_chunk_size = kv.value<int>("dynamic_chunk_size", 1);
+    if (dynamic_chunk_size < 1) {
+      throw InputError("dynamic_chunk_size must be positive! \n", __FILE__,
+                       __LINE__, "dynamic_chunk_size");
+    }
+    dynamic_chunk_size_ = dynamic_chunk_size;
+
     // no default reblock inner if use laplace
     if (approach_ == "laplace") {
       reblock_ = false;
@@ -437,8 +463,35 @@ class CCSD_T : virtual public CCSD<Tile, Policy> {
               progress_points.push_back(i);
             }
 
+            // owner of each {a,b,c} task, used by the cost-based distribution
+            std::vector<std::size_t> abc_owner;
+            if (task_distribution_ == "cost") {
+              abc_owner = distribute_abc_by_cost(tr_vir, size);
+            }
+
+            // the dynamic distribution hands out the global iteration numbers
+            // (which start at 1) through a counter on rank 0, in chunks that
+            // are prefetched
+            std::unique_ptr<utility::TaskCounter> abc_counter;
+            std::unique_ptr<utility::TaskFetcher> abc_fetcher;
+            if (task_distribution_ == "dynamic") {
+              abc_counter =
+                  std::make_unique<utility::TaskCounter>(global_world, 1);
+              abc_fetcher = std::make_unique<utility::TaskFetcher>(
+                  *abc_counter, dynamic_chunk_size_);
+            }
+
+            auto is_my_abc = [&](std::size_t abc) -> bool {
+              if (task_distribution_ == "dynamic")
+                return abc == abc_fetcher->current();
+              if (task_distribution_ == "cost") return abc_owner[abc - 1] == std::size_t(rank);
+              return abc % size == rank;
+            };
+
             TA::set_default_world(this_world);
 
+            const auto loop_start = mpqc::now();
+
             // start loop over a, b, c
             for (auto a = 0; a < n_tr_vir; ++a) {
               std::size_t a_low = a;
@@ -476,8 +529,8 @@ class CCSD_T : virtual public CCSD<Tile, Policy> {
                 for (auto c = 0; c <= b; ++c) {
                   global_iter++;
 
-                  // round-robin distribute the loop
-                  if (global_iter % size != rank) continue;
+                  // distribute the loop
+                  if (!is_my_abc(global_iter)) continue;
 
                   // inner loop
                   iter++;
@@ -638,6 +691,8 @@ class CCSD_T : virtual public CCSD<Tile, Policy> {
           }
 
           triple_energy += tmp_energy;
+
+          if (abc_fetcher) abc_fetcher->advance();
         }  // loop of c
       }    // loop of b
 
@@ -647,7 +702,10 @@ class CCSD_T : virtual public CCSD<Tile, Policy> {
       }
     }  // loop of a
     this_world.gop.fence();
+    double loop_time = mpqc::duration_in_s(loop_start, mpqc::now());
     global_world.gop.fence();
+    abc_fetcher.reset();
+    abc_counter.reset();
 
     TA::set_default_world(global_world);
 
@@ -659,6 +717,7 @@ class CCSD_T : virtual public CCSD<Tile, Policy> {
           // print out process n
           std::cout << "Process " << rank << " Time: " << std::endl;
           std::cout << "Iter: " << iter << std::endl;
+          std::cout << "Loop Time: " << loop_time << " S" << std::endl;
           std::cout << "Permutation Time: " << permutation_time << " S"
                     << std::endl;
           std::cout << "Contraction Time: " << contraction_time << " S"
@@ -671,6 +730,26 @@ class CCSD_T : virtual public CCSD<Tile, Policy> {
       }
     }
 
+    // load balance of the abc loop
+    {
+      double max_loop_time = loop_time;
+      double min_loop_time = loop_time;
+      double avg_loop_time = loop_time;
+      global_world.gop.max(max_loop_time);
+      global_world.gop.min(min_loop_time);
+      global_world.gop.sum(avg_loop_time);
+      avg_loop_time /= size;
+      ExEnv::out0() << "Task Distribution: " << task_distribution_ << std::endl;
+      ExEnv::out0() << "Loop Time (min/avg/max): " << min_loop_time << " / "
+                    << avg_loop_time << " / " << max_loop_time << " S"
+                    << std::endl;
+      ExEnv::out0() << "Load Imbalance (max/avg - 1): "
+                    << (avg_loop_time > 0.0
+                            ? max_loop_time / avg_loop_time - 1.0
+                            : 0.0)
+                    << std::endl;
+    }
+
     // print out all process time
     global_world.gop.sum(iter);
     global_world.gop.sum(permutation_time);
@@ -710,6 +789,57 @@ class CCSD_T : virtual public CCSD<Tile, Policy> {
     return triple_energy;
   }
 
+  /**
+   * assigns the {a,b,c} (a>=b>=c) tasks of the coarse-grain (T) loop to ranks
+   * using the longest-processing-time-first heuristic; the cost of each task
+   * is estimated as the product of the unoccupied tile sizes, since all other
+   * dimensions of the T3 and V3 blocks are the same for all tasks
+   * @param tr_vir TiledRange1 of the unoccupied space
+   * @param nproc number of ranks
+   * @return vector of owners, in the order the tasks are visited by the loop
+   */
+  static std::vector<std::size_t> distribute_abc_by_cost(
+      const TA::TiledRange1 &tr_vir, std::size_t nproc) {
+    const auto n_tr_vir = tr_vir.tiles_range().second;
+
+    std::vector<double> cost;
+    for (std::size_t a = 0; a < n_tr_vir; ++a) {
+      const double a_size = tr_vir.tile(a).second - tr_vir.tile(a).first;
+      for (std::size_t b = 0; b <= a; ++b) {
+        const double b_size = tr_vir.tile(b).second - tr_vir.tile(b).first;
+        for (std::size_t c = 0; c <= b; ++c) {
+          const double c_size = tr_vir.tile(c).second - tr_vir.tile(c).first;
+          cost.push_back(a_size * b_size * c_size);
+        }
+      }
+    }
+
+    // visit the tasks in the order of decreasing cost
+    std::vector<std::size_t> order(cost.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&cost](std::size_t l, std::size_t r) {
+                       return cost[l] > cost[r];
+                     });
+
+    // give each task to the least loaded rank
+    using load_t = std::pair<double, std::size_t>;
+    std::priority_queue<load_t, std::vector<load_t>, std::greater<load_t>>
+        load;
+    for (std::size_t p = 0; p < nproc; ++p) load.emplace(0.0, p);
+
+    std::vector<std::size_t> owner(cost.size());
+    for (const auto abc : order) {
+      auto least_loaded = load.top();
+      load.pop();
+      owner[abc] = least_loaded.second;
+      least_loaded.first += cost[abc];
+      load.push(least_loaded);
+    }
+
+    return owner;
+  }
+
   double compute_ccsd_t_fine_grain(TArray &t1, TArray &t2) {
     auto &world = this->wfn_world()->world();
     bool accurate_time = this->lcao_factory().accurate_time();
@@ -170,7 +170,7 @@ class CCSDT2 : public LCAOWavefunction<Tile, Policy>,
     }
   }
 
-  // get T3 amplitudes
+  // get T3 amplitudes, packed in ("T,i,j,k"), see pack_t3()
   TArray t3() const {
     if (T3_.is_initialized()) {
       return T3_;
@@ -273,7 +273,7 @@ class CCSDT2 : public LCAOWavefunction<Tile, Policy>,
  protected:
   // store all the integrals in memory
   // used as reference for development
-  double compute_CCSDT2_conventional(TArray &t1, TArray &t2, TArray &t3) {
+  double compute_CCSDT2_conventional(TArray &t1, TArray &t2, TArray &t3_packed) {
 
   //VR ... Initialize
     auto &world = this->wfn_world()->world();
@@ -333,7 +333,12 @@ class CCSDT2 : public LCAOWavefunction<Tile, Policy>,
 
     // Initialize T3 and set all elements to be zero
     //first assign it a size indirectly
-    t3("a,b,c,i,j,k") = t2("a,b,i,j") * t1("c,k");
+    // T3 is stored packed, see pack_t3()
+    {
+      TArray t3;
+      t3("a,b,c,i,j,k") = t2("a,b,i,j") * t1("c,k");
+      t3_packed = cc::pack_t3(t3);
+    }
 
     TArray tau;
     tau("a,b,i,j") = t2("a,b,i,j") + t1("a,i") * t1("b,j");
@@ -368,6 +373,9 @@ class CCSDT2 : public LCAOWavefunction<Tile, Policy>,
       auto time0 = mpqc::fenced_now(world);
       TArray::wait_for_lazy_cleanup(world);
 
+      // the tiles of t3 are unpacked from T3 when used
+      const auto t3 = cc::direct_unpacked_t3(t3_packed, t1.trange().dim(0));
+
 
       auto t1_time0 = mpqc::now(world, accurate_time);
       TArray h_ki, h_ac;
@@ -783,7 +791,8 @@ class CCSDT2 : public LCAOWavefunction<Tile, Policy>,
 
 
         assert(solver_);
-        solver_->update(t1, t2, t3, r1, r2, r3);
+        TArray r3_packed = cc::pack_t3(r3);
+        solver_->update(t1, t2, t3_packed, r1, r2, r3_packed);
 
         if (verbose_) {
           mpqc::detail::print_size_info(r2, "R2");
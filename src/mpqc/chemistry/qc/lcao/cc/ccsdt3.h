@@ -169,7 +169,7 @@ class CCSDT3 : public LCAOWavefunction<Tile, Policy>,
     }
   }
 
-  // get T3 amplitudes
+  // get T3 amplitudes, packed in ("T,i,j,k"), see pack_t3()
   TArray t3() const {
     if (T3_.is_initialized()) {
       return T3_;
@@ -272,7 +272,7 @@ class CCSDT3 : public LCAOWavefunction<Tile, Policy>,
  protected:
   // store all the integrals in memory
   // used as reference for development
-  double compute_CCSDT3_conventional(TArray &t1, TArray &t2, TArray &t3) {
+  double compute_CCSDT3_conventional(TArray &t1, TArray &t2, TArray &t3_packed) {
 
   //VR ... Initialize
     auto &world = this->wfn_world()->world();
@@ -334,7 +334,12 @@ class CCSDT3 : public LCAOWavefunction<Tile, Policy>,
 
     // Initialize T3 and set all elements to be zero
     //first assign it a size indirectly
-    t3("a,b,c,i,j,k") = t2("a,b,i,j") * t1("c,k");
+    // T3 is stored packed, see pack_t3()
+    {
+      TArray t3;
+      t3("a,b,c,i,j,k") = t2("a,b,i,j") * t1("c,k");
+      t3_packed = cc::pack_t3(t3);
+    }
 
     TArray tau;
     tau("a,b,i,j") = t2("a,b,i,j") + t1("a,i") * t1("b,j");
@@ -369,6 +374,9 @@ class CCSDT3 : public LCAOWavefunction<Tile, Policy>,
       auto time0 = mpqc::fenced_now(world);
       TArray::wait_for_lazy_cleanup(world);
 
+      // the tiles of t3 are unpacked from T3 when used
+      const auto t3 = cc::direct_unpacked_t3(t3_packed, t1.trange().dim(0));
+
       auto t1_time0 = mpqc::now(world, accurate_time);
       TArray h_ki, h_ac;
       {
@@ -784,14 +792,15 @@ class CCSDT3 : public LCAOWavefunction<Tile, Policy>,
 
 
         assert(solver_);
-        solver_->update(t1, t2, t3, r1, r2, r3);
+        TArray r3_packed = cc::pack_t3(r3);
+        solver_->update(t1, t2, t3_packed, r1, r2, r3_packed);
 
 
         if (verbose_) {
           mpqc::detail::print_size_info(r2, "R2");
           mpqc::detail::print_size_info(t2, "T2");
-          mpqc::detail::print_size_info(r3, "R3");
-          mpqc::detail::print_size_info(t3, "T3");
+          mpqc::detail::print_size_info(r3_packed, "R3");
+          mpqc::detail::print_size_info(t3_packed, "T3");
         }
 
         // recompute tau as well
@@ -31,17 +31,20 @@ class EOM_CCSD : public CCSD<Tile, Policy>, public Provides<ExcitationEnergy> {
    * |---------|------|--------|-------------|
    * | davidson_solver | string | multi-state | choose the davidson solver to use, multi-state or single-state  |
    * | max_vector | int | 8 | max number of guess vector per root |
+   * | davidson_scratch_dir | string | none | if given, the Davidson subspace vectors are kept in files in this (node-local) directory instead of in memory |
    * | vector_threshold | real | 10 * precision of property | threshold for the norm of new guess vector |
    * | eom_pno | string | none | if to simulate pno, avaialble \c default, which uses first excited state to generate PNOs \c state-average, use average of states to generate PNOs  \c state-merged, join all the states to generate PNOs |
    * | eom_pno_canonical | bool | true | if canonicalize PNOs and OSVs |
    * | eom_tpno | real | 0 | PNO truncation threshold for eom |
    * | eom_tosv | real | 0 | OSV truncation threshold for eom |
+   * | sigma_block_size | int | 0 | max number of guess vectors whose products with H are computed together, must be nonnegative; 0 means all new vectors of an iteration; smaller values reduce memory |
    *
    */
 
   // clang-format on
   EOM_CCSD(const KeyVal &kv) : CCSD<Tile, Policy>(kv) {
     max_vector_ = kv.value<int>("max_vector", 8);
+    davidson_scratch_dir_ = kv.value<std::string>("davidson_scratch_dir", "");
     // will be overwrited by precision of property if default set
     vector_threshold_ = kv.value<double>("vector_threshold", 0);
 
@@ -77,6 +80,8 @@ class EOM_CCSD : public CCSD<Tile, Policy>, public Provides<ExcitationEnergy> {
     eom_pno_canonical_ = kv.value<bool>("eom_pno_canonical", true);
     eom_tpno_ = kv.value<double>("eom_tpno", 0.0);
     eom_tosv_ = kv.value<double>("eom_tosv", 0.0);
+    sigma_block_size_ =
+        kv.value<int>("sigma_block_size", 0, KeyVal::is_nonnegative);
   }
 
   void obsolete() override {
@@ -94,6 +99,9 @@ class EOM_CCSD : public CCSD<Tile, Policy>, public Provides<ExcitationEnergy> {
 
   void evaluate(ExcitationEnergy *ex_energy) override;
 
+  /// <ab|cd> is used by the EOM intermediates, hence kept after CCSD
+  void purge_abcd() override {}
+
  private:
   EigenVector<numeric_type> eom_ccsd_davidson_solver(
       std::size_t n_roots, const std::vector<TArray> &cis_vector,
@@ -103,7 +111,8 @@ class EOM_CCSD : public CCSD<Tile, Policy>, public Provides<ExcitationEnergy> {
   cc::Intermediates<TArray> compute_FWintermediates();
 
   // compute contractions of HSS, HSD, HDS, and HDD
-  //                         with guess vector Ci
+  //                         with guess vectors Ci, stacked along the leading
+  //                         mode, see stack_arrays()
   // reference: CPL, 248 (1996), 189
   TArray compute_HSS_HSD_C(const TArray &Cai, const TArray &Cabij,
                            const cc::Intermediates<TArray> &imds);
@@ -127,10 +136,12 @@ class EOM_CCSD : public CCSD<Tile, Policy>, public Provides<ExcitationEnergy> {
   std::size_t max_vector_;   // max number of guess vector
   double vector_threshold_;  // threshold for norm of new guess vector
   std::string davidson_solver_;
+  std::string davidson_scratch_dir_;  // empty if subspace is kept in memory
   std::string eom_pno_;
   bool eom_pno_canonical_;
   double eom_tpno_;
   double eom_tosv_;
+  std::size_t sigma_block_size_;  // 0 if all vectors are blocked together
 };
 
 #if TA_DEFAULT_POLICY == 0
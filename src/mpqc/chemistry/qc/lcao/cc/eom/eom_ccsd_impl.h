@@ -3,6 +3,7 @@
  */
 
 #include "mpqc/chemistry/qc/lcao/ci/cis_d.h"
+#include "mpqc/math/external/tiledarray/array_stack.h"
 
 namespace mpqc {
 namespace lcao {
@@ -72,7 +73,7 @@ EOM_CCSD<Tile, Policy>::compute_FWintermediates() {
   return imds;
 }
 
-// compute [HSS_HSD C]^A_I
+// compute [HSS_HSD C]^A_I for a stack of guess vectors, X is the vector index
 template <typename Tile, typename Policy>
 TA::DistArray<Tile, Policy> EOM_CCSD<Tile, Policy>::compute_HSS_HSD_C(
     const TArray& Cai, const TArray& Cabij,
@@ -81,40 +82,43 @@ TA::DistArray<Tile, Policy> EOM_CCSD<Tile, Policy>::compute_HSS_HSD_C(
 
   {
     // HSS * C part
-    HSS_HSD_C("a,i") =  //   Fac C^c_i
-        imds.FAB("a,c") * Cai("c,i")
+    HSS_HSD_C("X,a,i") =  //   Fac C^c_i
+        imds.FAB("a,c") * Cai("X,c,i")
         // - Fki C^a_k
-        - imds.FIJ("k,i") * Cai("a,k")
+        - imds.FIJ("k,i") * Cai("X,a,k")
         // + Wakic C^c_k
-        + (2.0 * imds.Wiabj("k,a,c,i") + imds.Wiajb("k,c,i,a")) * Cai("c,k");
+        + (2.0 * imds.Wiabj("k,a,c,i") + imds.Wiajb("k,c,i,a")) *
+              Cai("X,c,k");
   }
 
   // HSD * C part
   {
     TArray C;
-    C("a,c,i,k") = 2.0 * Cabij("a,c,i,k") - Cabij("c,a,i,k");
-    HSS_HSD_C("a,i") +=  //   Fkc C^ac_ik
-        imds.FIA("k,c") * C("a,c,i,k")
+    C("X,a,c,i,k") = 2.0 * Cabij("X,a,c,i,k") - Cabij("X,c,a,i,k");
+    HSS_HSD_C("X,a,i") +=  //   Fkc C^ac_ik
+        imds.FIA("k,c") * C("X,a,c,i,k")
         // - 1/2 Wklic C^ac_kl
-        - imds.Wijka("k,l,i,c") * C("a,c,k,l");
+        - imds.Wijka("k,l,i,c") * C("X,a,c,k,l");
 
     if (this->df_) {
       auto t1 = this->t1();
       // + 1/2 Wakcd C^cd_ik
 
-      HSS_HSD_C("a,i") += imds.Xia("K,k,d") * C("c,d,i,k") *
-                          (imds.Xab("K,a,c") - t1("a,l") * imds.Xia("K,l,c"));
+      HSS_HSD_C("X,a,i") +=
+          imds.Xia("K,k,d") * C("X,c,d,i,k") *
+          (imds.Xab("K,a,c") - t1("a,l") * imds.Xia("K,l,c"));
 
     } else {
       // + 1/2 Wakcd C^cd_ik
-      HSS_HSD_C("a,i") += imds.Waibc("a,k,c,d") * C("c,d,i,k");
+      HSS_HSD_C("X,a,i") += imds.Waibc("a,k,c,d") * C("X,c,d,i,k");
     }
   }
 
   return HSS_HSD_C;
 }
 
-// compute [HDS_HDD C]^Ab_Ij
+// compute [HDS_HDD C]^Ab_Ij for a stack of guess vectors, X is the vector
+// index
 template <typename Tile, typename Policy>
 TA::DistArray<Tile, Policy> EOM_CCSD<Tile, Policy>::compute_HDS_HDD_C(
     const TArray& Cai, const TArray& Cabij,
@@ -125,36 +129,36 @@ TA::DistArray<Tile, Policy> EOM_CCSD<Tile, Policy>::compute_HDS_HDD_C(
 
   // HDS * C part
   {
-    HDS_HDD_C("a,b,i,j") =
+    HDS_HDD_C("X,a,b,i,j") =
         // P(ij) Wabcj C^c_i
         // WAbCj C^C_I + WbAcI
-        imds.Wabci("a,b,c,j") * Cai("c,i")
+        imds.Wabci("a,b,c,j") * Cai("X,c,i")
         // P(ab) Wkaij C^b_k C^c_j
         // - WkAjI C^b_k - WKbIj C^A_K
-        - imds.Wiajk("k,b,i,j") * Cai("a,k")
+        - imds.Wiajk("k,b,i,j") * Cai("X,a,k")
 
         // - P(ij) Wlkjc C^c_k t^ab_il
         // - WlKjC C^C_K T^Ab_Il - Wlkjc C^c_k T^Ad_Ij
         // + WLKIC C^C_K T^Ab_jL + WLkIc C^c_k T^Ab_jL
-        - (2.0 * imds.Wijka("l,k,j,c") - imds.Wijka("k,l,j,c")) * Cai("c,k") *
-              t2("a,b,i,l");
+        - (2.0 * imds.Wijka("l,k,j,c") - imds.Wijka("k,l,j,c")) *
+              Cai("X,c,k") * t2("a,b,i,l");
 
     if (this->df_) {
       TArray tmp;
       tmp("K,b,d") = imds.Xab("K,b,d") - t1("b,l") * imds.Xia("K,l,d");
 
-      HDS_HDD_C("a,b,i,j") +=
-          (2.0 * imds.Xia("K,k,c") * Cai("c,k") * tmp("K,b,d") -
-           tmp("K,b,c") * Cai("c,k") * imds.Xia("K,k,d")) *
+      HDS_HDD_C("X,a,b,i,j") +=
+          (2.0 * imds.Xia("K,k,c") * Cai("X,c,k") * tmp("K,b,d") -
+           tmp("K,b,c") * Cai("X,c,k") * imds.Xia("K,k,d")) *
           t2("a,d,i,j");
 
     } else {
       // + P(ab) Wbkdc C^c_k T^ad_ij
       // + WbKdC C^C_K T^Ad_Ij + Wbkdc C^c_k T^Ad_Ij
       // - WAKDC C^C_K T^bD_Ij - WAkDc C^c_k T^bD_Ij
-      HDS_HDD_C("a,b,i,j") +=
-          (2.0 * imds.Waibc("b,k,d,c") - imds.Waibc("b,k,c,d")) * Cai("c,k") *
-          t2("a,d,i,j");
+      HDS_HDD_C("X,a,b,i,j") +=
+          (2.0 * imds.Waibc("b,k,d,c") - imds.Waibc("b,k,c,d")) *
+          Cai("X,c,k") * t2("a,d,i,j");
     }
     //    HDS_HDD_C("a,b,i,j") += HDS_HDD_C("b,a,j,i");
   }
@@ -162,53 +166,53 @@ TA::DistArray<Tile, Policy> EOM_CCSD<Tile, Policy>::compute_HDS_HDD_C(
   // HDD * C part
   {
     TArray C, GC_ab, GC_ij;
-    C("a,c,i,k") = 2.0 * Cabij("a,c,i,k") - Cabij("c,a,i,k");
-    GC_ab("a,b") = imds.Wijab("k,l,a,c") * C("b,c,k,l");
-    GC_ij("i,j") = imds.Wijab("i,k,c,d") * C("c,d,j,k");
+    C("X,a,c,i,k") = 2.0 * Cabij("X,a,c,i,k") - Cabij("X,c,a,i,k");
+    GC_ab("X,a,b") = imds.Wijab("k,l,a,c") * C("X,b,c,k,l");
+    GC_ij("X,i,j") = imds.Wijab("i,k,c,d") * C("X,c,d,j,k");
 
     TArray tmp;
-    HDS_HDD_C("a,b,i,j") +=
+    HDS_HDD_C("X,a,b,i,j") +=
 
         //   P(ab) Fbc C^ac_ij
         //   Fbc C^ac_ij + Fac C^cb_ij
-        imds.FAB("a,c") * Cabij("c,b,i,j")
+        imds.FAB("a,c") * Cabij("X,c,b,i,j")
 
         // - P(ij) Fkj C^ab_ik
         // - Fkj C^ab_ik - Fki C^ab_kj
-        - imds.FIJ("k,j") * Cabij("a,b,i,k")
+        - imds.FIJ("k,j") * Cabij("X,a,b,i,k")
 
         // + P(ab) P(ij) Wbkjc C^ac_ik
         // + Wbkjc C^ac_ik - Wbkic C^ac_jk
         // - Wakjc C^bc_ik + Wakic C^bc_jk
-        + imds.Wiabj("k,b,c,j") * C("a,c,i,k") +
-        imds.Wiajb("k,c,j,b") * Cabij("a,c,i,k") +
-        imds.Wiajb("k,c,i,b") * Cabij("a,c,k,j")
+        + imds.Wiabj("k,b,c,j") * C("X,a,c,i,k") +
+        imds.Wiajb("k,c,j,b") * Cabij("X,a,c,i,k") +
+        imds.Wiajb("k,c,i,b") * Cabij("X,a,c,k,j")
 
         // - 1/2 P(ab) g^lk_dc C^ca_kl t^db_ij
         // - 1/2 g^kl_dc C^ac_kl t^db_ij
         // - 1/2 g^kl_cd C^cb_kl t^ad_ij
-        - GC_ab("d,a") * t2("d,b,i,j")
+        - GC_ab("X,d,a") * t2("d,b,i,j")
 
         // + 1/2 P(ij) Wlkdc C^dc_ik t^ab_jl
         // - 1/2 Wlkcd C^cd_ik t^ab_lj
         // - 1/2 Wlkcd C^cd_jk t^ab_il
-        - GC_ij("l,j") * t2("a,b,i,l");
+        - GC_ij("X,l,j") * t2("a,b,i,l");
 
-    HDS_HDD_C("a,b,i,j") += HDS_HDD_C("b,a,j,i")
-                            // + 1/2 Wabcd C^cd_ij
-                            //        + WAbCd_("a,b,c,d") * Cabij("c,d,i,j")
-                            // + 1/2 Wklij C^ab_kl
-                            + imds.Wijkl("k,l,i,j") * Cabij("a,b,k,l");
+    HDS_HDD_C("X,a,b,i,j") += HDS_HDD_C("X,b,a,j,i")
+                              // + 1/2 Wabcd C^cd_ij
+                              //        + WAbCd_("a,b,c,d") * Cabij("c,d,i,j")
+                              // + 1/2 Wklij C^ab_kl
+                              + imds.Wijkl("k,l,i,j") * Cabij("X,a,b,k,l");
 
     if (imds.Wabcd.is_initialized()) {
       // + 1/2 Wabcd C^cd_ij
       //        + WAbCd_("a,b,c,d") * Cabij("c,d,i,j")
-      HDS_HDD_C("a,b,i,j") += imds.Wabcd("a,b,c,d") * Cabij("c,d,i,j");
+      HDS_HDD_C("X,a,b,i,j") += imds.Wabcd("a,b,c,d") * Cabij("X,c,d,i,j");
     } else {
       TArray tau;
       tau("a,b,i,j") = t2("a,b,i,j") + t1("a,i") * t1("b,j");
 
-      // integral direct term
+      // integral direct term, the integrals are computed once for all vectors
       auto direct_integral = this->get_direct_ao_integral();
 
       auto Ca =
@@ -217,14 +221,14 @@ TA::DistArray<Tile, Policy> EOM_CCSD<Tile, Policy>::compute_HDS_HDD_C(
           this->lcao_factory().orbital_registry().retrieve(OrbitalIndex(L"i"));
 
       TArray U;
-      U("p,r,i,j") =
-          Cabij("c,d,i,j") * Ca("q,c") * Ca("s,d") * direct_integral("p,q,r,s");
+      U("X,p,r,i,j") = Cabij("X,c,d,i,j") * Ca("q,c") * Ca("s,d") *
+                       direct_integral("p,q,r,s");
       //      U("p,r,i,j") = 0.5 * (U("p,r,i,j") + U("r,p,j,i"));
-      HDS_HDD_C("a,b,i,j") +=
-          U("p,r,i,j") * Ca("p,a") * Ca("r,b") -
-          U("r,p,i,j") * Ci("p,k") * Ca("r,a") * t1("b,k") -
-          U("p,r,i,j") * Ci("p,k") * Ca("r,b") * t1("a,k") +
-          U("p,r,i,j") * Ci("p,k") * Ci("r,l") * tau("a,b,k,l");
+      HDS_HDD_C("X,a,b,i,j") +=
+          U("X,p,r,i,j") * Ca("p,a") * Ca("r,b") -
+          U("X,r,p,i,j") * Ci("p,k") * Ca("r,a") * t1("b,k") -
+          U("X,p,r,i,j") * Ci("p,k") * Ca("r,b") * t1("a,k") +
+          U("X,p,r,i,j") * Ci("p,k") * Ci("r,l") * tau("a,b,k,l");
     }
   }
 
@@ -331,20 +335,39 @@ EOM_CCSD<Tile, Policy>::eom_ccsd_davidson_solver(
 
   auto op = [this, &imds](const std::vector<GuessVector>& vec) {
     std::size_t dim = vec.size();
-
-    // compute product of H with guess vector
-    std::vector<GuessVector> HC(dim, GuessVector(2));
     for (std::size_t i = 0; i < dim; ++i) {
-      if (vec[i][0].is_initialized() && vec[i][1].is_initialized()) {
-        HC[i][0] = compute_HSS_HSD_C(vec[i][0], vec[i][1], imds);
-        HC[i][1] = compute_HDS_HDD_C(vec[i][0], vec[i][1], imds);
-
-      } else {
+      if (!vec[i][0].is_initialized() || !vec[i][1].is_initialized()) {
         throw ProgrammingError("Guess Vector not initialized", __FILE__,
                                __LINE__);
       }
     }
 
+    // compute product of H with guess vectors, sigma_block_size_ vectors at
+    // a time: the vectors are stacked along an extra mode such that each
+    // Hbar intermediate is contracted with all of them at once
+    const auto block_size = sigma_block_size_ == 0 ? dim : sigma_block_size_;
+    std::vector<GuessVector> HC(dim, GuessVector(2));
+    for (std::size_t begin = 0; begin < dim; begin += block_size) {
+      const auto end = std::min(dim, begin + block_size);
+      std::vector<TArray> Cai, Cabij;
+      for (std::size_t i = begin; i < end; ++i) {
+        Cai.push_back(vec[i][0]);
+        Cabij.push_back(vec[i][1]);
+      }
+      const auto Cai_stack = stack_arrays(Cai);
+      const auto Cabij_stack = stack_arrays(Cabij);
+
+      auto HCai = unstack_array(
+          compute_HSS_HSD_C(Cai_stack, Cabij_stack, imds), Cai[0].trange());
+      auto HCabij = unstack_array(
+          compute_HDS_HDD_C(Cai_stack, Cabij_stack, imds), Cabij[0].trange());
+
+      for (std::size_t i = begin; i < end; ++i) {
+        HC[i][0] = HCai[i - begin];
+        HC[i][1] = HCabij[i - begin];
+      }
+    }
+
     return HC;
   };
 
@@ -354,6 +377,9 @@ EOM_CCSD<Tile, Policy>::eom_ccsd_davidson_solver(
     /// make davidson object
     DavidsonDiag<GuessVector> dvd(n_roots, false, 2, max_vector_,
                                   vector_threshold_);
+    if (!davidson_scratch_dir_.empty()) {
+      dvd.use_disk_subspace_store(davidson_scratch_dir_);
+    }
     eig = dvd.solve(C, op, pred.get(), convergence, max_iter);
     eig_vector = dvd.eigen_vector();
   }
@@ -368,6 +394,9 @@ EOM_CCSD<Tile, Policy>::eom_ccsd_davidson_solver(
     /// make davidson object
     SingleStateDavidsonDiag<GuessVector> dvd(n_roots, shift, false, 2,
                                              max_vector_, vector_threshold_);
+    if (!davidson_scratch_dir_.empty()) {
+      dvd.use_disk_subspace_store(davidson_scratch_dir_);
+    }
     eig = dvd.solve(C, op, pred.get(), convergence, max_iter);
     eig_vector = dvd.eigen_vector();
   }
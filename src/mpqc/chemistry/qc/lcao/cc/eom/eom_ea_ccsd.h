@@ -53,6 +53,9 @@ class EOM_EA_CCSD : public CCSD<Tile, Policy>,
 
   void evaluate(ExcitationEnergy *ex_energy) override;
 
+  /// <ab|cd> is used by the EOM intermediates, hence kept after CCSD
+  void purge_abcd() override {}
+
  private:
   /// @return guess vector of size n_roots as unit vector
   std::vector<GuessVector> init_guess_vector(std::size_t n_roots);
@@ -126,6 +126,10 @@ class GammaPointCCSD : public CCSD<Tile, Policy> {
     return lcao_factory_->compute(L"<a b|G|c d>");
   }
 
+  void purge_abcd() override {
+    lcao_factory_->registry().purge_formula(L"<a b|G|c d>");
+  }
+
   /// <ia|jb>
   const TArray get_iajb() override {
     return lcao_factory_->compute(L"<i a|G|j b>");
@@ -5,62 +5,61 @@
 #ifndef MPQC4_SRC_MPQC_CHEMISTRY_QC_LCAO_CC_LAPLACE_TRANSFORM_H_
 #define MPQC4_SRC_MPQC_CHEMISTRY_QC_LCAO_CC_LAPLACE_TRANSFORM_H_
 
+#include <cmath>
+
 #include <tiledarray.h>
 
+#include "mpqc/chemistry/qc/lcao/mbpt/denom_kernel.h"
 #include "mpqc/math/external/eigen/eigen.h"
+#include "mpqc/util/meta/make_array.h"
 
 // this set of functions is used to re-scale 2-electron integrals with the
 // Laplace transformat (exp(-orb_energy)).
 namespace mpqc {
 
+namespace detail {
+
+// the Laplace factor x^{(-e/alpha - 1/6)/2} of each signed orbital energy e,
+// the signs are those of the orbital energy denominators, i.e. + for occupied
+// and - for unoccupied orbitals
+struct LaplaceFactor {
+  double alpha;
+  double x;
+
+  Eigen::VectorXd operator()(const Eigen::VectorXd &e) const {
+    const auto alpha = this->alpha;
+    const auto x = this->x;
+    return e.unaryExpr([alpha, x](double v) {
+      return std::pow(x, -0.5 * (v / alpha + 1.0 / 6.0));
+    });
+  }
+};
+
+// re-scales each element of arg with the Laplace factors of its orbital
+// indices; the factors are computed once per tile and orbital
+template <typename Tile, typename Policy, std::size_t Rank>
+TA::DistArray<Tile, Policy> laplace_transform(
+    const TA::DistArray<Tile, Policy> &arg,
+    const std::array<lcao::detail::OrbitalEnergyMode<double>, Rank> &modes,
+    const Eigen::VectorXd &ens, std::size_t n_occ, double x) {
+  const double alpha = 3.0 * (ens(n_occ) - ens(n_occ - 1));
+  return lcao::detail::apply_orbital_energy_scaling(arg, modes,
+                                                    LaplaceFactor{alpha, x});
+}
+
+}  // namespace detail
+
 // re-scaling of g_dabi integral with the exponents of orbital energies. One
 // occupied and two unoccupied orbitals are re-scaled (i,a,b).
 template <typename Tile, typename Policy>
 TA::Array<double, 4, Tile, Policy> g_dabi_laplace_transform(
     const TA::Array<double, 4, Tile, Policy> &dabi, const Eigen::VectorXd &ens,
     std::size_t n_occ, std::size_t n_frozen, double x) {
-  const double alpha = 3.0 * (ens(n_occ) - ens(n_occ - 1));
-
-  auto convert = [&ens, n_occ, n_frozen, alpha, x](Tile &result_tile,
-                                                   const Tile &arg_tile) {
-
-    result_tile = Tile(arg_tile.range());
-
-    // compute index
-    const auto d0 = result_tile.range().lobound()[0];
-    const auto dn = result_tile.range().upbound()[0];
-    const auto a0 = result_tile.range().lobound()[1];
-    const auto an = result_tile.range().upbound()[1];
-    const auto b0 = result_tile.range().lobound()[2];
-    const auto bn = result_tile.range().upbound()[2];
-    const auto i0 = result_tile.range().lobound()[3];
-    const auto in = result_tile.range().upbound()[3];
-
-    auto tile_idx = 0;
-    typename Tile::value_type norm = 0.0;
-    for (auto d = d0; d < dn; ++d) {
-      for (auto a = a0; a < an; ++a) {
-        const double exp_a = pow(x, 0.5 * (ens[a + n_occ] / alpha - 1.0 / 6.0));
-        for (auto b = b0; b < bn; ++b) {
-          const double exp_b =
-              pow(x, 0.5 * (ens[b + n_occ] / alpha - 1.0 / 6.0));
-          for (auto i = i0; i < in; ++i, ++tile_idx) {
-            const double exp_i =
-                pow(x, 0.5 * (-ens[i + n_frozen] / alpha - 1.0 / 6.0));
-            const double exponent = exp_a * exp_b * exp_i;
-            const double result = arg_tile[tile_idx] * exponent;
-            result_tile[tile_idx] = result;
-            norm += result * result;
-          }
-        }
-      }
-    }
-    return std::sqrt(norm);
-  };
-
-  auto result = TA::foreach (dabi, convert);
-  dabi.world().gop.fence();
-  return result;
+  const auto o = lcao::detail::occ_mode(ens, n_frozen);
+  const auto u = lcao::detail::uocc_mode(ens, n_occ);
+  const auto s = lcao::detail::spectator_mode<double>();
+  return detail::laplace_transform(dabi, utility::make_array(s, u, u, o), ens,
+                                   n_occ, x);
 }
 
 // re-scaling of g_cjkl integral with the exponents of orbital energies. Two
@@ -69,48 +68,11 @@ template <typename Tile, typename Policy>
 TA::Array<double, 4, Tile, Policy> g_cjkl_laplace_transform(
     const TA::Array<double, 4, Tile, Policy> &cjkl, const Eigen::VectorXd &ens,
     std::size_t n_occ, std::size_t n_frozen, double x) {
-  auto convert = [&ens, n_occ, n_frozen, x](Tile &result_tile,
-                                            const Tile &arg_tile) {
-
-    result_tile = Tile(arg_tile.range());
-
-    // compute index
-    const auto c0 = result_tile.range().lobound()[0];
-    const auto cn = result_tile.range().upbound()[0];
-    const auto i0 = result_tile.range().lobound()[1];
-    const auto in = result_tile.range().upbound()[1];
-    const auto j0 = result_tile.range().lobound()[2];
-    const auto jn = result_tile.range().upbound()[2];
-    const auto k0 = result_tile.range().lobound()[3];
-    const auto kn = result_tile.range().upbound()[3];
-
-    double alpha = 3.0 * (ens(n_occ) - ens(n_occ - 1));
-
-    auto tile_idx = 0;
-    typename Tile::value_type norm = 0.0;
-    for (auto c = c0; c < cn; ++c) {
-      const double exp_c = pow(x, 0.5 * (ens[c + n_occ] / alpha - 1.0 / 6.0));
-      for (auto i = i0; i < in; ++i) {
-        const double exp_i =
-            pow(x, 0.5 * (-ens[i + n_frozen] / alpha - 1.0 / 6.0));
-        for (auto j = j0; j < jn; ++j) {
-          const double exp_j =
-              pow(x, 0.5 * (-ens[j + n_frozen] / alpha - 1.0 / 6.0));
-          for (auto k = k0; k < kn; ++k, ++tile_idx) {
-            const double exponent = exp_c * exp_i * exp_j;
-            const double result = arg_tile[tile_idx] * exponent;
-            result_tile[tile_idx] = result;
-            norm += result * result;
-          }
-        }
-      }
-    }
-    return std::sqrt(norm);
-  };
-
-  auto result = TA::foreach (cjkl, convert);
-  cjkl.world().gop.fence();
-  return result;
+  const auto o = lcao::detail::occ_mode(ens, n_frozen);
+  const auto u = lcao::detail::uocc_mode(ens, n_occ);
+  const auto s = lcao::detail::spectator_mode<double>();
+  return detail::laplace_transform(cjkl, utility::make_array(u, o, o, s), ens,
+                                   n_occ, x);
 }
 
 // re-scaling of g_abij integral with the exponents of orbital energies. Two
@@ -119,48 +81,10 @@ template <typename Tile, typename Policy>
 TA::Array<double, 4, Tile, Policy> g_abij_laplace_transform(
     const TA::Array<double, 4, Tile, Policy> &abij, const Eigen::VectorXd &ens,
     std::size_t n_occ, std::size_t n_frozen, double x) {
-  auto convert = [&ens, n_occ, n_frozen, x](Tile &result_tile,
-                                            const Tile &arg_tile) {
-
-    double alpha = 3.0 * (ens(n_occ) - ens(n_occ - 1));
-    result_tile = Tile(arg_tile.range());
-
-    // compute index
-    const auto a0 = result_tile.range().lobound()[0];
-    const auto an = result_tile.range().upbound()[0];
-    const auto b0 = result_tile.range().lobound()[1];
-    const auto bn = result_tile.range().upbound()[1];
-    const auto i0 = result_tile.range().lobound()[2];
-    const auto in = result_tile.range().upbound()[2];
-    const auto j0 = result_tile.range().lobound()[3];
-    const auto jn = result_tile.range().upbound()[3];
-
-    auto tile_idx = 0;
-    typename Tile::value_type norm = 0.0;
-    for (auto a = a0; a < an; ++a) {
-      const double exp_a = pow(x, 0.5 * (ens[a + n_occ] / alpha - 1.0 / 6.0));
-      for (auto b = b0; b < bn; ++b) {
-        const double exp_b = pow(x, 0.5 * (ens[b + n_occ] / alpha - 1.0 / 6.0));
-        for (auto i = i0; i < in; ++i) {
-          const double exp_i =
-              pow(x, 0.5 * (-ens[i + n_frozen] / alpha - 1.0 / 6.0));
-          for (auto j = j0; j < jn; ++j, ++tile_idx) {
-            const double exp_j =
-                pow(x, 0.5 * (-ens[j + n_frozen] / alpha - 1.0 / 6.0));
-            const double exponent = exp_i * exp_j * exp_a * exp_b;
-            const double result = arg_tile[tile_idx] * exponent;
-            result_tile[tile_idx] = result;
-            norm += result * result;
-          }
-        }
-      }
-    }
-    return std::sqrt(norm);
-  };
-
-  auto result = TA::foreach (abij, convert);
-  abij.world().gop.fence();
-  return result;
+  const auto o = lcao::detail::occ_mode(ens, n_frozen);
+  const auto u = lcao::detail::uocc_mode(ens, n_occ);
+  return detail::laplace_transform(abij, utility::make_array(u, u, o, o), ens,
+                                   n_occ, x);
 }
 
 // re-scaling of t2 amplitudes with the exponents of orbital energies. Two
@@ -169,48 +93,11 @@ template <typename Tile, typename Policy>
 TA::Array<double, 4, Tile, Policy> t2_oou_laplace_transform(
     const TA::Array<double, 4, Tile, Policy> &t2, const Eigen::VectorXd &ens,
     std::size_t n_occ, std::size_t n_frozen, double x) {
-  auto convert = [&ens, n_occ, n_frozen, x](Tile &result_tile,
-                                            const Tile &arg_tile) {
-
-    result_tile = Tile(arg_tile.range());
-
-    // compute index
-    const auto a0 = result_tile.range().lobound()[0];
-    const auto an = result_tile.range().upbound()[0];
-    const auto b0 = result_tile.range().lobound()[1];
-    const auto bn = result_tile.range().upbound()[1];
-    const auto i0 = result_tile.range().lobound()[2];
-    const auto in = result_tile.range().upbound()[2];
-    const auto j0 = result_tile.range().lobound()[3];
-    const auto jn = result_tile.range().upbound()[3];
-
-    double alpha = 3.0 * (ens(n_occ) - ens(n_occ - 1));
-
-    auto tile_idx = 0;
-    typename Tile::value_type norm = 0.0;
-    for (auto a = a0; a < an; ++a) {
-      for (auto b = b0; b < bn; ++b) {
-        const double exp_b = pow(x, 0.5 * (ens[b + n_occ] / alpha - 1.0 / 6.0));
-        for (auto i = i0; i < in; ++i) {
-          const double exp_i =
-              pow(x, 0.5 * (-ens[i + n_frozen] / alpha - 1.0 / 6.0));
-          for (auto j = j0; j < jn; ++j, ++tile_idx) {
-            const double exp_j =
-                pow(x, 0.5 * (-ens[j + n_frozen] / alpha - 1.0 / 6.0));
-            const double exponent = exp_b * exp_i * exp_j;
-            const double result = arg_tile[tile_idx] * exponent;
-            result_tile[tile_idx] = result;
-            norm += result * result;
-          }
-        }
-      }
-    }
-    return std::sqrt(norm);
-  };
-
-  auto result = TA::foreach (t2, convert);
-  t2.world().gop.fence();
-  return result;
+  const auto o = lcao::detail::occ_mode(ens, n_frozen);
+  const auto u = lcao::detail::uocc_mode(ens, n_occ);
+  const auto s = lcao::detail::spectator_mode<double>();
+  return detail::laplace_transform(t2, utility::make_array(s, u, o, o), ens,
+                                   n_occ, x);
 }
 
 // re-scaling of t2 amplitudes with the exponents of orbital energies. One
@@ -219,47 +106,11 @@ template <typename Tile, typename Policy>
 TA::Array<double, 4, Tile, Policy> t2_ouu_laplace_transform(
     const TA::Array<double, 4, Tile, Policy> &t2, const Eigen::VectorXd &ens,
     std::size_t n_occ, std::size_t n_frozen, double x) {
-  auto convert = [&ens, n_occ, n_frozen, x](Tile &result_tile,
-                                            const Tile &arg_tile) {
-
-    result_tile = Tile(arg_tile.range());
-
-    // compute index
-    const auto a0 = result_tile.range().lobound()[0];
-    const auto an = result_tile.range().upbound()[0];
-    const auto b0 = result_tile.range().lobound()[1];
-    const auto bn = result_tile.range().upbound()[1];
-    const auto i0 = result_tile.range().lobound()[2];
-    const auto in = result_tile.range().upbound()[2];
-    const auto j0 = result_tile.range().lobound()[3];
-    const auto jn = result_tile.range().upbound()[3];
-
-    double alpha = 3.0 * (ens(n_occ) - ens(n_occ - 1));
-
-    auto tile_idx = 0;
-    typename Tile::value_type norm = 0.0;
-    for (auto a = a0; a < an; ++a) {
-      const double exp_a = pow(x, 0.5 * (ens[a + n_occ] / alpha - 1.0 / 6.0));
-      for (auto b = b0; b < bn; ++b) {
-        const double exp_b = pow(x, 0.5 * (ens[b + n_occ] / alpha - 1.0 / 6.0));
-        for (auto i = i0; i < in; ++i) {
-          const double exp_i =
-              pow(x, 0.5 * (-ens[i + n_frozen] / alpha - 1.0 / 6.0));
-          for (auto j = j0; j < jn; ++j, ++tile_idx) {
-            const double exponent = exp_a * exp_b * exp_i;
-            const double result = arg_tile[tile_idx] * exponent;
-            result_tile[tile_idx] = result;
-            norm += result * result;
-          }
-        }
-      }
-    }
-    return std::sqrt(norm);
-  };
-
-  auto result = TA::foreach (t2, convert);
-  t2.world().gop.fence();
-  return result;
+  const auto o = lcao::detail::occ_mode(ens, n_frozen);
+  const auto u = lcao::detail::uocc_mode(ens, n_occ);
+  const auto s = lcao::detail::spectator_mode<double>();
+  return detail::laplace_transform(t2, utility::make_array(u, u, o, s), ens,
+                                   n_occ, x);
 }
 
 // re-scaling of t1 amplitudes with the exponents of orbital energies. One
@@ -268,38 +119,10 @@ template <typename Tile, typename Policy>
 TA::Array<double, 2, Tile, Policy> t1_laplace_transform(
     const TA::Array<double, 2, Tile, Policy> &t1, const Eigen::VectorXd &ens,
     std::size_t n_occ, std::size_t n_frozen, double x) {
-  auto convert = [&ens, n_occ, n_frozen, x](Tile &result_tile,
-                                            const Tile &arg_tile) {
-
-    result_tile = Tile(arg_tile.range());
-
-    // compute index
-    const auto a0 = result_tile.range().lobound()[0];
-    const auto an = result_tile.range().upbound()[0];
-    const auto i0 = result_tile.range().lobound()[1];
-    const auto in = result_tile.range().upbound()[1];
-
-    double alpha = 3.0 * (ens(n_occ) - ens(n_occ - 1));
-
-    auto tile_idx = 0;
-    typename Tile::value_type norm = 0.0;
-    for (auto a = a0; a < an; ++a) {
-      const double exp_a = pow(x, 0.5 * (ens[a + n_occ] / alpha - 1.0 / 6.0));
-      for (auto i = i0; i < in; ++i, ++tile_idx) {
-        const double exp_i =
-            pow(x, 0.5 * (-ens[i + n_frozen] / alpha - 1.0 / 6.0));
-        const double exponent = exp_a * exp_i;
-        const double result = arg_tile[tile_idx] * exponent;
-        result_tile[tile_idx] = result;
-        norm += result * result;
-      }
-    }
-    return std::sqrt(norm);
-  };
-
-  auto result = TA::foreach (t1, convert);
-  t1.world().gop.fence();
-  return result;
+  const auto o = lcao::detail::occ_mode(ens, n_frozen);
+  const auto u = lcao::detail::uocc_mode(ens, n_occ);
+  return detail::laplace_transform(t1, utility::make_array(u, o), ens,
+                                   n_occ, x);
 }
 
 // re-scaling of g_Xab integral with the exponents of orbital energies.
@@ -308,41 +131,10 @@ template <typename Tile, typename Policy>
 TA::Array<double, 3, Tile, Policy> Xab_laplace_transform(
     const TA::Array<double, 3, Tile, Policy> &Xab, const Eigen::VectorXd &ens,
     std::size_t n_occ, std::size_t n_frozen, double x) {
-  const double alpha = 3.0 * (ens(n_occ) - ens(n_occ - 1));
-
-  auto convert = [&ens, n_occ, alpha, x](Tile &result_tile,
-                                         const Tile &arg_tile) {
-
-    result_tile = Tile(arg_tile.range());
-
-    // compute index
-    const auto X0 = result_tile.range().lobound()[0];
-    const auto Xn = result_tile.range().upbound()[0];
-    const auto a0 = result_tile.range().lobound()[1];
-    const auto an = result_tile.range().upbound()[1];
-    const auto b0 = result_tile.range().lobound()[2];
-    const auto bn = result_tile.range().upbound()[2];
-
-    auto tile_idx = 0;
-    typename Tile::value_type norm = 0.0;
-    for (auto X = X0; X < Xn; ++X) {
-      for (auto a = a0; a < an; ++a) {
-        for (auto b = b0; b < bn; ++b, ++tile_idx) {
-          const double exp_b =
-              pow(x, 0.5 * (ens[b + n_occ] / alpha - 1.0 / 6.0));
-          const double exponent = exp_b;
-          const double result = arg_tile[tile_idx] * exponent;
-          result_tile[tile_idx] = result;
-          norm += result * result;
-        }
-      }
-    }
-    return std::sqrt(norm);
-  };
-
-  auto result = TA::foreach (Xab, convert);
-  Xab.world().gop.fence();
-  return result;
+  const auto u = lcao::detail::uocc_mode(ens, n_occ);
+  const auto s = lcao::detail::spectator_mode<double>();
+  return detail::laplace_transform(Xab, utility::make_array(s, s, u), ens,
+                                   n_occ, x);
 }
 
 // re-scaling of g_Xai integral with the exponents of orbital energies.
@@ -351,42 +143,11 @@ template <typename Tile, typename Policy>
 TA::Array<double, 3, Tile, Policy> Xai_laplace_transform(
     const TA::Array<double, 3, Tile, Policy> &Xai, const Eigen::VectorXd &ens,
     std::size_t n_occ, std::size_t n_frozen, double x) {
-  const double alpha = 3.0 * (ens(n_occ) - ens(n_occ - 1));
-
-  auto convert = [&ens, n_occ, n_frozen, alpha, x](Tile &result_tile,
-                                                   const Tile &arg_tile) {
-
-    result_tile = Tile(arg_tile.range());
-
-    // compute index
-    const auto X0 = result_tile.range().lobound()[0];
-    const auto Xn = result_tile.range().upbound()[0];
-    const auto a0 = result_tile.range().lobound()[1];
-    const auto an = result_tile.range().upbound()[1];
-    const auto i0 = result_tile.range().lobound()[2];
-    const auto in = result_tile.range().upbound()[2];
-
-    auto tile_idx = 0;
-    typename Tile::value_type norm = 0.0;
-    for (auto X = X0; X < Xn; ++X) {
-      for (auto a = a0; a < an; ++a) {
-        const double exp_a = pow(x, 0.5 * (ens[a + n_occ] / alpha - 1.0 / 6.0));
-        for (auto i = i0; i < in; ++i, ++tile_idx) {
-          const double exp_i =
-              pow(x, 0.5 * (-ens[i + n_frozen] / alpha - 1.0 / 6.0));
-          const double exponent = exp_a * exp_i;
-          const double result = arg_tile[tile_idx] * exponent;
-          result_tile[tile_idx] = result;
-          norm += result * result;
-        }
-      }
-    }
-    return std::sqrt(norm);
-  };
-
-  auto result = TA::foreach (Xai, convert);
-  Xai.world().gop.fence();
-  return result;
+  const auto o = lcao::detail::occ_mode(ens, n_frozen);
+  const auto u = lcao::detail::uocc_mode(ens, n_occ);
+  const auto s = lcao::detail::spectator_mode<double>();
+  return detail::laplace_transform(Xai, utility::make_array(s, u, o), ens,
+                                   n_occ, x);
 }
 
 }  // namespace mpqc
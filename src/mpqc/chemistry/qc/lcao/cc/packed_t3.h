@@ -0,0 +1,292 @@
+#ifndef SRC_MPQC_CHEMISTRY_QC_LCAO_CC_PACKED_T3_H_
+#define SRC_MPQC_CHEMISTRY_QC_LCAO_CC_PACKED_T3_H_
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <tiledarray.h>
+#include "mpqc/chemistry/qc/lcao/integrals/direct_tile.h"
+#include "mpqc/math/external/tiledarray/tile_util.h"
+
+namespace mpqc {
+namespace lcao {
+namespace cc {
+
+/**
+ * @brief this file contains the permutationally-unique storage of the
+ * closed-shell triples amplitudes \f$ t^{abc}_{ijk} \f$ (and residuals).
+ *
+ * The closed-shell amplitudes are invariant to the simultaneous permutation
+ * of the pairs \f$ (a,i), (b,j), (c,k) \f$ , hence \f$ t^{abc}_{ijk} \f$ with
+ * \f$ a \geq b \geq c \f$ and all \f$ ijk \f$ determine all amplitudes, which
+ * reduces the storage (and the cost of the Jacobi update and of DIIS) by
+ * about a factor of 6.
+ *
+ * The triples are packed at the tile level: the packed triple mode has one
+ * tile for each triple of tiles \f$ \{A,B,C\}, A \geq B \geq C \f$ of the
+ * unoccupied mode, that holds all element triples \f$ a \in A, b \in B,
+ * c \in C \f$ ; the packed array is \c ("T,i,j,k") . Its tile \c {T,I,J,K} has
+ * the (row-major) data of the tile \c {A,B,C,I,J,K} of the unpacked array.
+ */
+
+namespace detail {
+
+using mpqc::detail::find_tile;
+using mpqc::detail::make_shape;
+using mpqc::detail::tile_norm;
+using mpqc::detail::tile_pair;
+using mpqc::detail::tile_pair_ordinal;
+
+/// @return the ordinal of the tile triple \c {t0,t1,t2} ,
+/// \c t0>=t1>=t2 , in a packed triple mode
+inline std::size_t tile_triple_ordinal(std::size_t t0, std::size_t t1,
+                                       std::size_t t2) {
+  TA_ASSERT(t0 >= t1 && t1 >= t2);
+  return t0 * (t0 + 1) * (t0 + 2) / 6 + tile_pair_ordinal(t1, t2);
+}
+
+/// @return the tile triple \c {t0,t1,t2} , \c t0>=t1>=t2 , with ordinal \c p
+/// in a packed triple mode
+inline std::array<std::size_t, 3> tile_triple(std::size_t p) {
+  std::size_t t0 = 0;
+  while ((t0 + 1) * (t0 + 2) * (t0 + 3) / 6 <= p) ++t0;
+  const auto t12 = tile_pair(p - t0 * (t0 + 1) * (t0 + 2) / 6);
+  return {{t0, t12.first, t12.second}};
+}
+
+/// @return the packed triple mode of three modes tiled by \c tr1
+inline TA::TiledRange1 packed_triple_trange1(const TA::TiledRange1 &tr1) {
+  const auto ntiles = tr1.tiles_range().second - tr1.tiles_range().first;
+  auto extent = [&tr1](std::size_t t) {
+    return tr1.tile(t).second - tr1.tile(t).first;
+  };
+  std::vector<std::size_t> bounds{0};
+  for (auto t0 = 0ul; t0 != ntiles; ++t0) {
+    for (auto t1 = 0ul; t1 <= t0; ++t1) {
+      for (auto t2 = 0ul; t2 <= t1; ++t2) {
+        bounds.push_back(bounds.back() +
+                         extent(t0) * extent(t1) * extent(t2));
+      }
+    }
+  }
+  return TA::TiledRange1(bounds.begin(), bounds.end());
+}
+
+/// @return the range of the tile \c {A,B,C,I,J,K} of the unpacked array that
+/// is stored in the packed tile with range \c packed_range
+/// @param uocc_tr1 the unoccupied mode of the unpacked array
+inline TA::Range unpacked_tile_range(const TA::Range &packed_range,
+                                     const TA::TiledRange1 &uocc_tr1,
+                                     const std::array<std::size_t, 3> &abc) {
+  std::vector<std::size_t> lobound, upbound;
+  for (const auto t : abc) {
+    lobound.push_back(uocc_tr1.tile(t).first);
+    upbound.push_back(uocc_tr1.tile(t).second);
+  }
+  for (auto m = 1u; m != 4u; ++m) {
+    lobound.push_back(packed_range.lobound_data()[m]);
+    upbound.push_back(packed_range.upbound_data()[m]);
+  }
+  return TA::Range(lobound, upbound);
+}
+
+/// @return the data of \c tile in range \c range ; empty tiles are zero
+template <typename Tile>
+Tile copy_t3_tile(const TA::Range &range, const Tile &tile) {
+  using numeric_type = typename Tile::numeric_type;
+  if (tile.empty()) return Tile(range, numeric_type(0));
+  TA_ASSERT(tile.range().volume() == range.volume());
+  Tile result(range);
+  std::copy(tile.data(), tile.data() + range.volume(), result.data());
+  return result;
+}
+
+/// @return the tile of the unpacked array from the packed tile \c packed ,
+/// which holds the tile with range \c sorted_range , i.e. the tile of the
+/// unpacked array permuted by the inverse of \c perm (if \c permute is true)
+template <typename Tile>
+Tile unpack_t3_tile(const Tile &packed, const TA::Range &sorted_range,
+                    const TA::Permutation &perm, bool permute) {
+  const auto sorted = copy_t3_tile(sorted_range, packed);
+  return permute ? sorted.permute(perm) : sorted;
+}
+
+}  // namespace detail
+
+/**
+ * packs the triples amplitudes (or residuals) \c t3 , which must be
+ * invariant to the simultaneous permutation of the pairs \f$ (a,i), (b,j),
+ * (c,k) \f$ , in the triples \f$ a \geq b \geq c \f$ . If \c t3 is not
+ * invariant, the tiles \c {A,B,C,I,J,K} , \c A>=B>=C , are kept.
+ *
+ * @param t3 the amplitudes in t3("a,b,c,i,j,k")
+ * @return the packed amplitudes in \c ("T,i,j,k")
+ */
+template <typename Tile, typename Policy>
+TA::DistArray<Tile, Policy> pack_t3(const TA::DistArray<Tile, Policy> &t3) {
+  auto &world = t3.world();
+  const auto &tr1s = t3.trange().data();
+  TA_USER_ASSERT(tr1s.size() == 6, "pack_t3: t3 must be a 6-index array");
+  const TA::TiledRange trange{detail::packed_triple_trange1(tr1s[0]), tr1s[3],
+                              tr1s[4], tr1s[5]};
+
+  // the tile {A,B,C,I,J,K} of t3 that makes up the packed tile {T,I,J,K}
+  auto tile_idx = [&trange](std::size_t ord) {
+    const auto idx = trange.tiles_range().idx(ord);
+    const auto abc = detail::tile_triple(idx[0]);
+    return std::array<std::size_t, 6>{
+        {abc[0], abc[1], abc[2], std::size_t(idx[1]), std::size_t(idx[2]),
+         std::size_t(idx[3])}};
+  };
+  const auto shape = detail::make_shape(
+      trange,
+      [&t3, &tile_idx](auto ord) {
+        return detail::tile_norm(t3, tile_idx(ord));
+      },
+      Policy());
+
+  TA::DistArray<Tile, Policy> result(world, trange, shape);
+  const auto end = result.pmap()->end();
+  for (auto it = result.pmap()->begin(); it != end; ++it) {
+    const auto ord = *it;
+    if (result.is_zero(ord)) continue;
+    result.set(ord, world.taskq.add(&detail::copy_t3_tile<Tile>,
+                                    trange.make_tile_range(ord),
+                                    detail::find_tile(t3, tile_idx(ord))));
+  }
+  world.gop.fence();
+  return result;
+}
+
+/// DirectUnpackedT3Builder computes the tiles of the unpacked triples
+/// amplitudes from the packed amplitudes when they are used
+template <typename Tile, typename Policy>
+class DirectUnpackedT3Builder
+    : public std::enable_shared_from_this<
+          DirectUnpackedT3Builder<Tile, Policy>> {
+ public:
+  using Array = TA::DistArray<Tile, Policy>;
+
+  /**
+   * @param packed the packed amplitudes returned by pack_t3()
+   * @param uocc_tr1 the unoccupied mode of the unpacked amplitudes
+   */
+  DirectUnpackedT3Builder(madness::World &world, Array packed,
+                          TA::TiledRange1 uocc_tr1)
+      : packed_(std::move(packed)),
+        uocc_tr1_(std::move(uocc_tr1)),
+        world_(world),
+        id_(world.register_ptr(this)) {}
+
+  DirectUnpackedT3Builder(DirectUnpackedT3Builder &&) = delete;
+  DirectUnpackedT3Builder(const DirectUnpackedT3Builder &) = delete;
+  DirectUnpackedT3Builder &operator=(const DirectUnpackedT3Builder &) =
+      delete;
+
+  ~DirectUnpackedT3Builder() {
+    if (madness::initialized()) {
+      madness::World *world = madness::World::world_from_id(id_.get_world_id());
+      world->unregister_ptr(this);
+    }
+  }
+
+  madness::uniqueidT id() const { return id_; }
+
+  /// @return the index of the packed tile that holds the unpacked tile
+  /// \c idx and the permutation that maps the former to the latter, which is
+  /// not needed if the unoccupied tiles of \c idx are in descending order
+  template <typename Index>
+  static std::pair<std::array<std::size_t, 4>, TA::Permutation> packed_index(
+      const Index &idx, bool *permute = nullptr) {
+    // the unoccupied tiles in descending order, the occupied tiles follow
+    std::array<unsigned int, 3> q{{0, 1, 2}};
+    std::stable_sort(q.begin(), q.end(),
+                     [&idx](unsigned int x, unsigned int y) {
+                       return idx[x] > idx[y];
+                     });
+    const std::array<std::size_t, 4> packed_idx{
+        {detail::tile_triple_ordinal(idx[q[0]], idx[q[1]], idx[q[2]]),
+         std::size_t(idx[3 + q[0]]), std::size_t(idx[3 + q[1]]),
+         std::size_t(idx[3 + q[2]])}};
+    const TA::Permutation perm(
+        {q[0], q[1], q[2], 3 + q[0], 3 + q[1], 3 + q[2]});
+    if (permute != nullptr) *permute = !(q[0] == 0 && q[1] == 1);
+    return std::make_pair(packed_idx, perm);
+  }
+
+  // compute Tile for particular block
+  madness::Future<Tile> operator()(const std::vector<std::size_t> &idx,
+                                   const TA::Range &range) const {
+    TA_ASSERT(idx.size() == 6);
+    bool permute = false;
+    const auto packed = packed_index(idx, &permute);
+    const auto sorted_range = detail::unpacked_tile_range(
+        packed_.trange().make_tile_range(packed.first), uocc_tr1_,
+        detail::tile_triple(packed.first[0]));
+    TA_ASSERT(sorted_range.volume() == range.volume());
+    return world_.taskq.add(&detail::unpack_t3_tile<Tile>,
+                            detail::find_tile(packed_, packed.first),
+                            sorted_range, packed.second, permute);
+  }
+
+  const Array &packed() const { return packed_; }
+
+ private:
+  Array packed_;
+  TA::TiledRange1 uocc_tr1_;
+  madness::World &world_;
+  madness::uniqueidT id_;
+};
+
+/**
+ * constructs the unpacked triples amplitudes from the packed amplitudes,
+ * whose tiles are unpacked when used; the result can be used in TA
+ * expressions like t3("a,b,c,i,j,k") without storing the unpacked amplitudes
+ *
+ * @param packed the packed amplitudes in \c ("T,i,j,k") returned by pack_t3()
+ * @param uocc_tr1 the unoccupied mode of the unpacked amplitudes
+ * @return the unpacked amplitudes in \c ("a,b,c,i,j,k")
+ */
+template <typename Tile, typename Policy>
+gaussian::DirectArray<Tile, Policy, DirectUnpackedT3Builder<Tile, Policy>>
+direct_unpacked_t3(const TA::DistArray<Tile, Policy> &packed,
+                   const TA::TiledRange1 &uocc_tr1) {
+  using Builder = DirectUnpackedT3Builder<Tile, Policy>;
+  using DirectTile = gaussian::DirectTile<Tile, Builder>;
+  auto &world = packed.world();
+
+  const auto &tr1s = packed.trange().data();
+  const TA::TiledRange trange{uocc_tr1, uocc_tr1, uocc_tr1,
+                              tr1s[1],  tr1s[2],  tr1s[3]};
+  auto builder_ptr = std::make_shared<Builder>(world, packed, uocc_tr1);
+
+  // the norms are the norms of the packed tiles
+  const auto shape = detail::make_shape(
+      trange,
+      [&trange, &packed](auto ord) {
+        const auto idx = trange.tiles_range().idx(ord);
+        return detail::tile_norm(packed, Builder::packed_index(idx).first);
+      },
+      Policy());
+  TA::DistArray<DirectTile, Policy> result(world, trange, shape);
+
+  const auto end = result.pmap()->end();
+  for (auto it = result.pmap()->begin(); it != end; ++it) {
+    const auto ord = *it;
+    if (result.is_zero(ord)) continue;
+    auto idx = trange.tiles_range().idx(ord);
+    result.set(ord, DirectTile(std::vector<std::size_t>(idx.begin(), idx.end()),
+                               trange.make_tile_range(ord), builder_ptr));
+  }
+  world.gop.fence();
+
+  return gaussian::DirectArray<Tile, Policy, Builder>(builder_ptr, result);
+}
+
+}  // namespace cc
+}  // namespace lcao
+}  // namespace mpqc
+
+#endif  // SRC_MPQC_CHEMISTRY_QC_LCAO_CC_PACKED_T3_H_
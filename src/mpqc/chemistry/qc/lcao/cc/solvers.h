@@ -1,12 +1,17 @@
 #ifndef SRC_MPQC_CHEMISTRY_QC_LCAO_CC_SOLVERS_H_
 #define SRC_MPQC_CHEMISTRY_QC_LCAO_CC_SOLVERS_H_
 
+#include <unordered_map>
+#include <unordered_set>
 
 #include "mpqc/chemistry/molecule/common.h"
 #include "mpqc/chemistry/qc/cc/solvers.h"
+#include "mpqc/chemistry/qc/lcao/cc/packed_t3.h"
 #include "mpqc/chemistry/qc/lcao/factory/factory.h"
+#include "mpqc/chemistry/qc/lcao/mbpt/denom_kernel.h"
 #include "mpqc/math/linalg/diagonal_array.h"
 #include "mpqc/math/tensor/clr/array_to_eigen.h"
+#include "mpqc/util/meta/make_array.h"
 #include "../../../../util/core/exenv.h"
 #include "../../cc/solvers.h"
 
@@ -67,14 +72,17 @@ struct R1SquaredNormReductionOp {
 };  // R1SquaredNormReductionOp
 
 // squared norm of 2-body residual in PNO subspace
-template <typename T>
+// PNOs is a container of PNO matrices indexed by the pair ordinal i*nocc_act+j,
+// e.g. std::vector or PNOPairList::PNOView
+template <typename T, typename PNOs = std::vector<
+                          RowMatrix<typename TA::detail::scalar_type<T>::type>>>
 struct R2SquaredNormReductionOp {
   // typedefs
   typedef typename TA::detail::scalar_type<T>::type result_type;
   typedef typename T::value_type argument_type;
   using Matrix = RowMatrix<result_type>;
 
-  R2SquaredNormReductionOp(const std::vector<Matrix>& r2_space)
+  R2SquaredNormReductionOp(const PNOs& r2_space)
       : r2_space_(r2_space), nocc_act_(std::sqrt(r2_space.size())) {}
 
   // Reduction functions
@@ -94,13 +102,13 @@ struct R2SquaredNormReductionOp {
     const auto nuocc = arg.range().extent_data()[0];
 
     const auto r2_index = i * nocc_act_ + j;
-    const Matrix arg_pno = r2_space_[r2_index].transpose() *
-        TA::eigen_map(arg, nuocc, nuocc) *
-        r2_space_[r2_index];
+    const auto& pno_ij = r2_space_[r2_index];
+    const Matrix arg_pno = pno_ij.transpose() *
+        TA::eigen_map(arg, nuocc, nuocc) * pno_ij;
     result += arg_pno.squaredNorm();
   }
 
-  const std::vector<Matrix>& r2_space_;
+  const PNOs& r2_space_;
   std::size_t nocc_act_;
 };  // R2SquaredNormReductionOp
 
@@ -109,104 +117,70 @@ TA::DistArray<Tile, Policy> jacobi_update_t3_abcijk(
     const TA::DistArray<Tile, Policy>& r3_abcijk,
     const EigenVector<typename Tile::numeric_type>& ens_occ,
     const EigenVector<typename Tile::numeric_type>& ens_uocc) {
-    auto denom = [ens_occ, ens_uocc](Tile& result_tile, const Tile& arg_tile) {
-
-    result_tile = Tile(arg_tile.range());
+  using lcao::detail::occ_mode;
+  using lcao::detail::uocc_mode;
+  const auto modes = utility::make_array(
+      uocc_mode(ens_uocc), uocc_mode(ens_uocc), uocc_mode(ens_uocc),
+      occ_mode(ens_occ), occ_mode(ens_occ), occ_mode(ens_occ));
+  return lcao::detail::apply_denominator(r3_abcijk, modes);
+}
 
-    // compute index
-    const auto a0 = result_tile.range().lobound()[0];
-    const auto an = result_tile.range().upbound()[0];
-    const auto b0 = result_tile.range().lobound()[1];
-    const auto bn = result_tile.range().upbound()[1];
-    const auto c0 = result_tile.range().lobound()[2];
-    const auto cn = result_tile.range().upbound()[2];
-    const auto i0 = result_tile.range().lobound()[3];
-    const auto in = result_tile.range().upbound()[3];
-    const auto j0 = result_tile.range().lobound()[4];
-    const auto jn = result_tile.range().upbound()[4];
-    const auto k0 = result_tile.range().lobound()[5];
-    const auto kn = result_tile.range().upbound()[5];
-
-    auto tile_idx = 0;
-    typename Tile::scalar_type norm = 0.0;
-    for (auto a = a0; a < an; ++a) {
-      const auto e_a = ens_uocc[a];
-      for (auto b = b0; b < bn; ++b) {
-        const auto e_b = ens_uocc[b];
-        for (auto c = c0; c < cn; ++c) {
-          const auto e_c = ens_uocc[c];
-        for (auto i = i0; i < in; ++i) {
-          const auto e_i = ens_occ[i];
-          for (auto j = j0; j < jn; ++j) {
-            const auto e_j = ens_occ[j];
-            for (auto k = k0; k < kn; ++k, ++tile_idx) {
-              const auto e_k = ens_occ[k];
-            const auto e_iajbkc = e_i + e_j + e_k - e_a - e_b - e_c ;
-            const auto old = arg_tile[tile_idx];
-            const auto result_abcijk = old / (e_iajbkc);
-            const auto abs_result_abcijk = std::abs(result_abcijk);
-            norm += abs_result_abcijk * abs_result_abcijk;
-            result_tile[tile_idx] = result_abcijk;
-          }
-        }
-       }
-      }
-     }
-    }
-    return std::sqrt(norm);
+/**
+ * the Jacobi update of the packed triples, see pack_t3(); only the unique
+ * elements are updated
+ *
+ * @param r3_tijk the packed residual in \c ("T,i,j,k")
+ * @param uocc_tr1 the unoccupied mode of the unpacked residual
+ */
+template <typename Tile, typename Policy>
+TA::DistArray<Tile, Policy> jacobi_update_packed_t3(
+    const TA::DistArray<Tile, Policy>& r3_tijk,
+    const EigenVector<typename Tile::numeric_type>& ens_occ,
+    const EigenVector<typename Tile::numeric_type>& ens_uocc,
+    const TA::TiledRange1& uocc_tr1) {
+  using lcao::detail::occ_mode;
+  using lcao::detail::uocc_mode;
+  using lcao::detail::DenominatorOp;
+  const auto modes = utility::make_array(
+      uocc_mode(ens_uocc), uocc_mode(ens_uocc), uocc_mode(ens_uocc),
+      occ_mode(ens_occ), occ_mode(ens_occ), occ_mode(ens_occ));
+  const auto packed_tr1 = r3_tijk.trange().dim(0);
+  auto op = [modes, uocc_tr1, packed_tr1](Tile& result_tile,
+                                          const Tile& arg_tile) {
+    // the packed tile is the row-major tile {A,B,C,I,J,K} , the denominator
+    // kernel only needs the element ranges of the latter
+    const auto& range = arg_tile.range();
+    const auto abc = detail::tile_triple(
+        packed_tr1.element_to_tile(range.lobound_data()[0]));
+    const auto values =
+        lcao::detail::orbital_energy_values<DenominatorOp>(
+            detail::unpacked_tile_range(range, uocc_tr1, abc), modes,
+            [](auto&& e) { return e; });
+
+    result_tile = Tile(range);
+    const auto* arg_ptr = arg_tile.data();
+    auto* result_ptr = result_tile.data();
+    typename Tile::scalar_type norm2 = 0;
+    lcao::detail::OrbitalEnergyLoop<DenominatorOp, true, 6>::apply(
+        values, typename Tile::numeric_type(0), arg_ptr, result_ptr, norm2);
+    return std::sqrt(norm2);
   };
-
-  auto delta_t3_abcijk = TA::foreach (r3_abcijk, denom);
-  delta_t3_abcijk.world().gop.fence();
-  return delta_t3_abcijk;
+  auto result = TA::foreach (r3_tijk, op);
+  r3_tijk.world().gop.fence();
+  return result;
 }
 
-
 template <typename Tile, typename Policy>
 TA::DistArray<Tile, Policy> jacobi_update_t2_abij(
     const TA::DistArray<Tile, Policy>& r2_abij,
     const EigenVector<typename Tile::numeric_type>& ens_occ,
     const EigenVector<typename Tile::numeric_type>& ens_uocc) {
-  auto denom = [&ens_occ, &ens_uocc](Tile& result_tile, const Tile& arg_tile) {
-
-    result_tile = Tile(arg_tile.range());
-
-    // compute index
-    const auto a0 = result_tile.range().lobound()[0];
-    const auto an = result_tile.range().upbound()[0];
-    const auto b0 = result_tile.range().lobound()[1];
-    const auto bn = result_tile.range().upbound()[1];
-    const auto i0 = result_tile.range().lobound()[2];
-    const auto in = result_tile.range().upbound()[2];
-    const auto j0 = result_tile.range().lobound()[3];
-    const auto jn = result_tile.range().upbound()[3];
-
-    auto tile_idx = 0;
-    typename Tile::scalar_type norm = 0.0;
-    for (auto a = a0; a < an; ++a) {
-      const auto e_a = ens_uocc[a];
-      for (auto b = b0; b < bn; ++b) {
-        const auto e_b = ens_uocc[b];
-        for (auto i = i0; i < in; ++i) {
-          const auto e_i = ens_occ[i];
-          for (auto j = j0; j < jn; ++j, ++tile_idx) {
-            const auto e_j = ens_occ[j];
-            const auto e_iajb = e_i + e_j - e_a - e_b;
-            const auto old = arg_tile[tile_idx];
-            const auto result_abij = old / (e_iajb);
-            const auto abs_result_abij = std::abs(result_abij);
-            norm += abs_result_abij * abs_result_abij;
-            result_tile[tile_idx] = result_abij;
-          }
-        }
-      }
-    }
-    return std::sqrt(norm);
-  };
-
-  auto delta_t2_abij = TA::foreach (r2_abij, denom);
-  delta_t2_abij.world().gop.fence();
-  return delta_t2_abij;
+  using lcao::detail::occ_mode;
+  using lcao::detail::uocc_mode;
+  const auto modes =
+      utility::make_array(uocc_mode(ens_uocc), uocc_mode(ens_uocc),
+                          occ_mode(ens_occ), occ_mode(ens_occ));
+  return lcao::detail::apply_denominator(r2_abij, modes);
 }
 
 /**
@@ -225,36 +199,9 @@ TA::DistArray<Tile, Policy> jacobi_update_t1_ai(
     const TA::DistArray<Tile, Policy>& r1_ai,
     const EigenVector<typename Tile::numeric_type>& ens_occ,
     const EigenVector<typename Tile::numeric_type>& ens_uocc) {
-  auto denom = [&ens_occ, &ens_uocc](Tile& result_tile, const Tile& arg_tile) {
-
-    result_tile = Tile(arg_tile.range());
-
-    // compute index
-    const auto a0 = result_tile.range().lobound()[0];
-    const auto an = result_tile.range().upbound()[0];
-    const auto i0 = result_tile.range().lobound()[1];
-    const auto in = result_tile.range().upbound()[1];
-
-    auto tile_idx = 0;
-    typename Tile::scalar_type norm = 0.0;
-    for (auto a = a0; a < an; ++a) {
-      const auto e_a = ens_uocc[a];
-      for (auto i = i0; i < in; ++i, ++tile_idx) {
-        const auto e_i = ens_occ[i];
-        const auto e_ia = e_i - e_a;
-        const auto old = arg_tile[tile_idx];
-        const auto result_ai = old / (e_ia);
-        const auto abs_result_ai = std::abs(result_ai);
-        norm += abs_result_ai * abs_result_ai;
-        result_tile[tile_idx] = result_ai;
-      }
-    }
-    return std::sqrt(norm);
-  };
-
-  auto delta_t1_ai = TA::foreach (r1_ai, denom);
-  delta_t1_ai.world().gop.fence();
-  return delta_t1_ai;
+  const auto modes = utility::make_array(lcao::detail::uocc_mode(ens_uocc),
+                                         lcao::detail::occ_mode(ens_occ));
+  return lcao::detail::apply_denominator(r1_ai, modes);
 }
 
 /**
@@ -262,21 +209,24 @@ TA::DistArray<Tile, Policy> jacobi_update_t1_ai(
  * @param[in] r2_abij  T2 like Array with dimension "a,b,i,j", it should blocked by
  * V in a,b and 1 in i,j
  * @param[in] eps_occ_act  the diagonal of active occupied Fock matrix in canonical basis
- * @param[in] eps_pno vector of diagonal Fock matrix in PNO basis, only local i,j
- * will be initialized
- * @param[in] pnos vector of PNOs, only local i,j will be initialized
+ * @param[in] eps_pno diagonals of the Fock matrix in PNO basis indexed by the
+ * pair ordinal i*nocc_act+j (e.g. a std::vector of vectors or
+ * PNOPairList::FockView), only local i,j need to be initialized
+ * @param[in] pnos PNOs indexed by the pair ordinal i*nocc_act+j (e.g. a
+ * std::vector of matrices or PNOPairList::PNOView), only local i,j need to be
+ * initialized
  * @param[in] shift value of the shift in the denominator (i.e. the demonimator is @c F[i]+F[j]-F[a]-F[b]+shift
  * @return
  */
-template <typename Tile, typename Policy>
+template <typename Tile, typename Policy, typename EpsPNOs, typename PNOs>
 TA::DistArray<Tile, Policy> pno_jacobi_update_t2(
     const TA::DistArray<Tile, Policy>& r2_abij,
     const EigenVector<typename Tile::numeric_type>& eps_occ_act,
-    const std::vector<EigenVector<typename Tile::numeric_type>>& eps_pno,
-    const std::vector<RowMatrix<typename Tile::numeric_type>>& pnos,
+    const EpsPNOs& eps_pno,
+    const PNOs& pnos,
     typename Tile::numeric_type shift = 0.0) {
-  auto update2 = [eps_occ_act, eps_pno, pnos, shift](Tile& result_tile,
-                                                      const Tile& arg_tile) {
+  auto update2 = [&eps_occ_act, &eps_pno, &pnos, shift](Tile& result_tile,
+                                                         const Tile& arg_tile) {
 
     result_tile = Tile(arg_tile.range());
 
@@ -286,7 +236,7 @@ TA::DistArray<Tile, Policy> pno_jacobi_update_t2(
 
     // Select appropriate matrix of PNOs
     auto ij = i * eps_occ_act.size() + j;
-    Eigen::MatrixXd pno_ij = pnos[ij];
+    const auto& pno_ij = pnos[ij];
 
     // Extent data of tile
     const auto ext = arg_tile.range().extent_data();
@@ -431,13 +381,14 @@ TA::DistArray<Tile, Policy> pno_jacobi_update_t1(
  *
  * @param[in] abij T2 like Array with dimension "a,b,i,j", it should blocked by V in
  * a,b and 1 in i,j
- * @param[in] pnos vector of PNOs, only local i,j will be initialized
+ * @param[in] pnos PNOs indexed by the pair ordinal i*nocc_act+j, only local i,j
+ * need to be initialized
  * @return
  */
-template <typename Tile, typename Policy>
+template <typename Tile, typename Policy, typename PNOs>
 TA::DistArray<Tile, Policy> pno_transform_abij(
     const TA::DistArray<Tile, Policy>& abij,
-    const std::vector<RowMatrix<typename Tile::numeric_type>>& pnos) {
+    const PNOs& pnos) {
   std::size_t nocc_act = abij.trange().dim(2).extent();
 
   auto tform = [&pnos, nocc_act](Tile& result_tile, const Tile& arg_tile) {
@@ -448,7 +399,7 @@ TA::DistArray<Tile, Policy> pno_transform_abij(
 
     // Select appropriate matrix of PNOs
     const auto ij = i * nocc_act + j;
-    Eigen::MatrixXd pno_ij = pnos[ij];
+    const auto& pno_ij = pnos[ij];
     const auto nuocc = pno_ij.rows();
     const auto npno = pno_ij.cols();
 
@@ -529,19 +480,19 @@ TA::DistArray<Tile, Policy> osv_transform_ai(
  * @tparam Tile
  * @tparam Policy
  * @param[in] t2 T2-like array with dimensions "a,b,i,j"
- * @param[in] pnos Vector of PNO matrices
+ * @param[in] pnos PNO matrices indexed by the pair ordinal i*nocc_act+j
  * @return
  */
-template <typename Tile, typename Policy>
+template <typename Tile, typename Policy, typename PNOs>
 TA::DistArray<Tile, Policy> t2_project_pno(
     const TA::DistArray<Tile, Policy>& t2,
-    std::vector<RowMatrix<typename Tile::numeric_type>>& pnos) {
+    const PNOs& pnos) {
   using Matrix = RowMatrix<typename Tile::numeric_type>;
 
   std::size_t nocc_act = t2.trange().dim(2).extent();
   std::size_t nuocc = t2.trange().dim(0).extent();
 
-  auto project_t2 = [nuocc, nocc_act, pnos](Tile& result_tile, const Tile& arg_tile) {
+  auto project_t2 = [nuocc, nocc_act, &pnos](Tile& result_tile, const Tile& arg_tile) {
     result_tile = Tile(arg_tile.range());
 
     // Get values of i and j
@@ -549,7 +500,7 @@ TA::DistArray<Tile, Policy> t2_project_pno(
     const int j = arg_tile.range().lobound()[3];
 
     // Select appropriate PNO matrix
-    Matrix pno_ij = pnos[i*nocc_act + j];
+    const auto& pno_ij = pnos[i*nocc_act + j];
 
     // Turn tile of t2 into matrix
     Matrix t2_ij = TA::eigen_map(arg_tile, nuocc, nuocc);
@@ -680,16 +631,16 @@ double compute_mp2(
  * @param[in] K  T2-like array with dimension "a,b,i,j"
  * @param[in] F_occ_act  active occ-active occ block of the Fock matrix
  * @param[in] F_uocc   unocc-unocc block of the Fock matrix
- * @param[in] pnos  vector of PNO matrices
+ * @param[in] pnos  PNO matrices indexed by the pair ordinal i*nocc_act+j
  * @param[in] nocc_act   integer specifying the number of active occupied orbitals
  * @return
  */
-template<typename Tile, typename Policy>
+template<typename Tile, typename Policy, typename PNOs>
 TA::DistArray<Tile, Policy> form_T_from_K (
     const TA::DistArray<Tile, Policy>& K,
     const RowMatrix<typename Tile::numeric_type>& F_occ_act,
     const RowMatrix<typename Tile::numeric_type>& F_uocc,
-    std::vector<RowMatrix<typename Tile::numeric_type>>& pnos,
+    const PNOs& pnos,
     int nocc_act) {
 
   using Matrix = RowMatrix<typename Tile::numeric_type>;
@@ -703,7 +654,7 @@ TA::DistArray<Tile, Policy> form_T_from_K (
     const int i = arg_tile.range().lobound()[2];
     const int j = arg_tile.range().lobound()[3];
 
-    Matrix pno_ij = pnos[i*nocc_act + j];
+    const auto& pno_ij = pnos[i*nocc_act + j];
 
     auto npno = pno_ij.cols();
     Matrix F_pno = pno_ij.transpose() * F_uocc * pno_ij;
@@ -790,39 +741,182 @@ TA::DistArray<Tile, Policy> construct_density(
   return D;
 };
 
+/// PNOs of an occupied pair i,j
+template <typename Numeric>
+struct PairPNO {
+  RowMatrix<Numeric> pnos;          //!< the truncated PNOs, nuocc x max(npno,1)
+  EigenVector<Numeric> F_pno_diag;  //!< the diagonal of the Fock matrix in the PNO basis
+  EigenVector<Numeric> eigvals;     //!< all eigenvalues of the pair density
+  int npno = 0;                     //!< the number of PNOs
+
+  template <typename Archive>
+  void serialize(Archive& ar) {
+    ar& pnos& F_pno_diag& eigvals& npno;
+  }
+};
+
+/**
+ * PNOPairList holds the PNOs of the occupied pairs i,j whose (reblocked) T2
+ * tiles are owned by this process, hence its size grows linearly with the
+ * system. Pairs can be screened out as weak (see mark_weak()); like the pairs
+ * that are not local, they have no PNOs and are represented by a single zero
+ * "PNO", i.e. their amplitudes are projected out.
+ *
+ * Pairs can be inserted concurrently, e.g. from within TA::foreach or tasks;
+ * the lookups are only safe when no insertion is in progress.
+ */
+template <typename Numeric>
+class PNOPairList {
+  using map_type = madness::ConcurrentHashMap<std::size_t, PairPNO<Numeric>>;
+
+ public:
+  using Matrix = RowMatrix<Numeric>;
+  using Vector = EigenVector<Numeric>;
+  using Pair = PairPNO<Numeric>;
+  using const_iterator = typename map_type::const_iterator;
+
+  /// a view of one member of the pairs, indexed by the pair ordinal
+  /// i*nocc_act+j, that can be used in place of a std::vector
+  template <typename Value, Value Pair::*member>
+  class View {
+   public:
+    explicit View(const PNOPairList& list) : list_(&list) {}
+
+    /// @return the number of pairs, local or not
+    std::size_t size() const { return list_->nocc_act_ * list_->nocc_act_; }
+
+    const Value& operator[](std::size_t ij) const {
+      return list_->pair(ij).*member;
+    }
+
+   private:
+    const PNOPairList* list_;
+  };
+  using PNOView = View<Matrix, &Pair::pnos>;
+  using FockView = View<Vector, &Pair::F_pno_diag>;
+
+  PNOPairList() = default;
+
+  /// @param nocc_act the number of active occupied orbitals
+  /// @param nuocc the number of unoccupied orbitals
+  PNOPairList(std::size_t nocc_act, std::size_t nuocc) : nocc_act_(nocc_act) {
+    zero_.pnos = Matrix::Zero(nuocc, 1);
+    zero_.F_pno_diag = Vector::Zero(1);
+  }
+
+  /// @return the number of active occupied orbitals
+  std::size_t nocc_act() const { return nocc_act_; }
+
+  /// inserts (or replaces) the PNOs of pair \c ij
+  void insert(std::size_t ij, Pair pair) {
+    typename map_type::accessor acc;
+    pairs_.insert(acc, ij);
+    acc->second = std::move(pair);
+  }
+
+  /// @return true if the PNOs of pair \c ij are stored
+  bool contains(std::size_t ij) const { return pairs_.find(ij) != pairs_.end(); }
+
+  /// @return the PNOs of pair \c ij , or the zero pair if they are not stored
+  const Pair& pair(std::size_t ij) const {
+    const auto it = pairs_.find(ij);
+    return it != pairs_.end() ? it->second : zero_;
+  }
+
+  /// @return the number of PNOs of pair \c ij
+  int npno(std::size_t ij) const { return pair(ij).npno; }
+
+  /// @return the PNO matrices indexed by the pair ordinal
+  PNOView pnos() const { return PNOView(*this); }
+
+  /// @return the diagonals of the Fock matrix in the PNO bases indexed by the
+  /// pair ordinal
+  FockView F_pno_diag() const { return FockView(*this); }
+
+  /// screens out pair \c ij ; weak pairs are kept by clear()
+  void mark_weak(std::size_t ij) { weak_pairs_.insert(ij); }
+
+  /// @return true if pair \c ij was screened out by this process
+  bool is_weak(std::size_t ij) const { return weak_pairs_.count(ij) != 0; }
+
+  /// @return the number of pairs screened out by this process
+  std::size_t nweak() const { return weak_pairs_.size(); }
+
+  /// removes the PNOs of all pairs
+  void clear() { pairs_.clear(); }
+
+  const_iterator begin() const { return pairs_.begin(); }
+  const_iterator end() const { return pairs_.end(); }
+
+ private:
+  std::size_t nocc_act_ = 0;
+  Pair zero_;
+  map_type pairs_;
+  std::unordered_set<std::size_t> weak_pairs_;
+};
+
+/**
+ * computes the MP2 pair energies, e_ij + e_ji, of the pairs i <= j whose tiles
+ * are owned by this process
+ * @param[in] K   T2-like array with dimension "a,b,i,j", it should be blocked by
+ * V in a,b and 1 in i,j
+ * @param[in] t2  T2-like array with dimension "a,b,i,j", blocked as @c K
+ * @return the map from the pair ordinal i*nocc_act+j to the pair energy
+ */
+template <typename Tile, typename Policy>
+std::unordered_map<std::size_t, double> local_pair_energies(
+    const TA::DistArray<Tile, Policy>& K,
+    const TA::DistArray<Tile, Policy>& t2) {
+  const std::size_t nocc_act = K.trange().dim(2).extent();
+  const std::size_t nuocc = K.trange().dim(0).extent();
+
+  std::unordered_map<std::size_t, double> result;
+  const auto end = K.pmap()->end();
+  for (auto it = K.pmap()->begin(); it != end; ++it) {
+    const auto idx = K.trange().tiles_range().idx(*it);
+    const std::size_t i = idx[2];
+    const std::size_t j = idx[3];
+    if (i > j) continue;
+
+    double e_ij = 0.0;
+    if (!K.is_zero(*it) && !t2.is_zero(*it)) {
+      const Tile K_tile = K.find(*it).get();
+      const Tile t2_tile = t2.find(*it).get();
+      const auto K_ij = TA::eigen_map(K_tile, nuocc, nuocc);
+      const auto t2_ij = TA::eigen_map(t2_tile, nuocc, nuocc);
+      e_ij = (i == j ? 1.0 : 2.0) *
+             K_ij.cwiseProduct(2.0 * t2_ij - t2_ij.transpose()).sum();
+    }
+    result[i * nocc_act + j] = e_ij;
+  }
+  return result;
+}
+
 /**
+ * constructs the OSVs, i.e. the PNOs of the diagonal pairs i,i
  *
  * @tparam Tile
  * @tparam Policy
  * @param D             pair density
  * @param F_uocc        unocc-unocc portion of the Fock matrix
- * @param tpno          PNO truncation threshold
  * @param tosv          OSV truncation threshold
- * @param pnos          vector of PNO matrices
- * @param npnos         vector of nPNO values
- * @param F_pno_diag    vector of Vectors, where each Vector contains the diagonal elements of
- *                      the PNO-transformed Fock matrix
  * @param osvs          vector of OSV matrices
  * @param nosvs         vector of nOSV values
+ * @param old_nosvs     vector of nOSV values of the previous OSVs
  * @param F_osv_diag    vector of Vectors, where each Vector contains the diagonal elements of
  *                      the OSV-transformed Fock matrix
- * @param pno_canonical whether or not to canonicalize the PNOs
+ * @param pno_canonical whether or not to canonicalize the OSVs
+ * @param update_pno_rank the OSV rank update strategy
  */
 template <typename Tile, typename Policy>
-void construct_pno(
+void construct_osv(
     const TA::DistArray<Tile, Policy>& D,
     const RowMatrix<typename Tile::numeric_type>& F_uocc,
-    double tpno,
     double tosv,
-    std::vector<RowMatrix<typename Tile::numeric_type>>& pnos,
-    std::vector<int>& npnos,
-    std::vector<int>& old_npnos,
-    std::vector<EigenVector<typename Tile::numeric_type>>& F_pno_diag,
     std::vector<RowMatrix<typename Tile::numeric_type>>& osvs,
     std::vector<int>& nosvs,
     std::vector<int>& old_nosvs,
     std::vector<EigenVector<typename Tile::numeric_type>>& F_osv_diag,
-    std::vector<EigenVector<typename Tile::numeric_type>>& pno_eigvals,
     bool pno_canonical = false,
     PNORankUpdateMethod update_pno_rank = PNORankUpdateMethod::standard) {
   using Matrix = RowMatrix<typename Tile::numeric_type>;
@@ -831,32 +925,17 @@ void construct_pno(
   std::size_t nocc_act = D.trange().dim(2).extent();
   std::size_t nuocc = D.trange().dim(0).extent();
 
-  // If npnos already initialized, set old_npnos = npnos
-  // and old_nosvs = nosvs
-  const bool have_old_pnos = (npnos.size() != 0);
-  if(have_old_pnos) {
-    old_npnos = npnos;
+  // If nosvs already initialized, set old_nosvs = nosvs
+  const bool have_old_osvs = (nosvs.size() != 0);
+  if(have_old_osvs) {
     old_nosvs = nosvs;
   }
   else {
-    // Initialize old_npnos_ to have all zeroes
-    old_npnos.resize(nocc_act * nocc_act);
-    std::fill(old_npnos.begin(), old_npnos.end(), 0);
     // Initialize old_nosvs to have all zeroes
     old_nosvs.resize(nocc_act);
     std::fill(old_nosvs.begin(), old_nosvs.end(), 0);
   }
 
-  // For storing PNOs and and the Fock matrix in the PNO basis
-  npnos.resize(nocc_act * nocc_act);
-  pnos.resize(nocc_act * nocc_act);
-  F_pno_diag.resize(nocc_act * nocc_act);
-  std::fill(npnos.begin(), npnos.end(), 0);
-
-  // For storing the PNO eigenvalues
-  pno_eigvals.resize(nocc_act * nocc_act);
-
-
   // For storing OSVs (PNOs when i = j) and the Fock matrix in
   // the OSV basis
   nosvs.resize(nocc_act);
@@ -867,7 +946,7 @@ void construct_pno(
   // Lambda function to form osvs
   auto form_OSV = [&D, &F_osv_diag,
                    &F_uocc, &nosvs, &old_nosvs, tosv, nuocc, nocc_act,
-                   pno_canonical, update_pno_rank, have_old_pnos](TA::World& world){
+                   pno_canonical, update_pno_rank, have_old_osvs](TA::World& world){
 
     Eigen::SelfAdjointEigenSolver<Matrix> es;
 
@@ -932,7 +1011,7 @@ void construct_pno(
             nosv = nuocc - osvdrop;
 
           }  // fuzzy update
-          else if (update_pno_rank == PNORankUpdateMethod::fixed && have_old_pnos) {   // no update
+          else if (update_pno_rank == PNORankUpdateMethod::fixed && have_old_osvs) {   // no update
             const auto old_nosv = old_nosvs[i];
             nosv = old_nosv;
             osvdrop = nuocc - nosv;
@@ -977,128 +1056,204 @@ void construct_pno(
   osvs = form_OSV(world);
   // The following fence is unnecessary IF OSVs are only used locally
   // world.gop.fence();
+}  // construct_osv
 
-  // Lambda function to form PNOs; implement using a for_each
-  auto form_PNO = [&pnos, &F_pno_diag, &F_uocc, &npnos, &old_npnos,
-                   tpno, nuocc, nocc_act,
-                   pno_canonical, &pno_eigvals, update_pno_rank, have_old_pnos]
-      (Tile& result_tile, const Tile& arg_tile) {
-
-    Eigen::SelfAdjointEigenSolver<Matrix> es;
-
-    result_tile = Tile(arg_tile.range());
-
-    // Get values of i,j and compute ij
-    const int i = arg_tile.range().lobound()[2];
-    const int j = arg_tile.range().lobound()[3];
-    const int ij = i * nocc_act + j;
-
-    // Form D_ij matrix from arg_tile
-    Matrix D_ij = TA::eigen_map(arg_tile, nuocc, nuocc);
-
-    // Only form PNOs for i <= j
-    if (i <= j) {
-      // Diagonalize D_ij
-      es.compute(D_ij);
-      Matrix pno_ij = es.eigenvectors();
-      auto occ_ij = es.eigenvalues();
-
-      pno_eigvals[ij] = occ_ij;
-
-      // Determine number of PNOs to be dropped
-      std::size_t pnodrop = 0;
-
-      if (tpno != 0.0) {
-        for (std::size_t k = 0; k != occ_ij.rows(); ++k) {
-          if (!(occ_ij(k) >= tpno))
-            ++pnodrop;
-          else
-            break;
-        }
-      }
-
-      // Calculate the number of PNOs kept in this macro iteration
-      auto npno = nuocc - pnodrop;
-
-      // If update_pno_rank == fuzzy, compare the would-be dropped PNOs to the fuzzy cutoff
-      if (update_pno_rank == PNORankUpdateMethod::fuzzy) {
-        const auto old_npno = old_npnos[ij];
+/**
+ * constructs the PNOs of a pair from its pair density
+ *
+ * @param D_ij            the pair density
+ * @param F_uocc          unocc-unocc portion of the Fock matrix
+ * @param tpno            PNO truncation threshold
+ * @param old_npno        the number of PNOs of the previous PNOs of the pair
+ * @param have_old_pnos   whether the PNOs are being updated
+ * @param pno_canonical   whether or not to canonicalize the PNOs
+ * @param update_pno_rank the PNO rank update strategy
+ * @return the PNOs of the pair
+ */
+template <typename Numeric>
+PairPNO<Numeric> form_pair_pno(const RowMatrix<Numeric>& D_ij,
+                               const RowMatrix<Numeric>& F_uocc, double tpno,
+                               int old_npno, bool have_old_pnos,
+                               bool pno_canonical,
+                               PNORankUpdateMethod update_pno_rank) {
+  using Matrix = RowMatrix<Numeric>;
+  const std::size_t nuocc = D_ij.rows();
+
+  PairPNO<Numeric> result;
+
+  // Diagonalize D_ij
+  Eigen::SelfAdjointEigenSolver<Matrix> es(D_ij);
+  Matrix pno_ij = es.eigenvectors();
+  auto occ_ij = es.eigenvalues();
+
+  result.eigvals = occ_ij;
+
+  // Determine number of PNOs to be dropped
+  std::size_t pnodrop = 0;
+
+  if (tpno != 0.0) {
+    for (std::size_t k = 0; k != occ_ij.rows(); ++k) {
+      if (!(occ_ij(k) >= tpno))
+        ++pnodrop;
+      else
+        break;
+    }
+  }
 
-        int new_pnodrop = pnodrop;
+  // Calculate the number of PNOs kept in this macro iteration
+  auto npno = nuocc - pnodrop;
+
+  // If update_pno_rank == fuzzy, compare the would-be dropped PNOs to the fuzzy cutoff
+  if (update_pno_rank == PNORankUpdateMethod::fuzzy) {
+    int new_pnodrop = pnodrop;
+
+    // Compare new npno_ij to old npno_ij
+    if (npno < old_npno) {
+      auto diff = old_npno - npno;
+      for (int i = 1; i <= diff; ++i) {
+        int idx = pnodrop - i;
+        if (occ_ij(idx) >= tpno / 2.0) {
+          --new_pnodrop;
+        } //if
+      } // for
+    } // if
+
+    // Recompute the current macro iteration's npnos
+    pnodrop = new_pnodrop;
+    npno = nuocc - pnodrop;
+
+  }   // fuzzy update
+  else if (update_pno_rank == PNORankUpdateMethod::fixed && have_old_pnos) {  // no update
+    npno = old_npno;
+    pnodrop = nuocc - npno;
+  }  // nu update
+
+  // Store the new number of PNOs kept for calculating the average later
+  result.npno = npno;
+
+  // Truncate PNO matrix
+
+  // If npno = 0, substitute a single fake "PNO" with all coefficients
+  // equal to zero. All other code will behave the same way
+  if (npno == 0) {
+    result.pnos = Matrix::Zero(nuocc, 1);
+  }
 
-        // Compare new npno_ij to old npno_ij
-        if (npno < old_npno) {
-          auto diff = old_npno - npno;
-          for (int i = 1; i <= diff; ++i) {
-            int idx = pnodrop - i;
-            if (occ_ij(idx) >= tpno / 2.0) {
-              --new_pnodrop;
-            } //if
-          } // for
-        } // if
+  // If npno != zero, use actual zet of truncated PNOs
+  else {
+    result.pnos = pno_ij.block(0, pnodrop, nuocc, npno);
+  }
 
-        // Recompute the current macro iteration's npnos
-        pnodrop = new_pnodrop;
-        npno = nuocc - pnodrop;
+  // Transform F to PNO space
+  Matrix F_pno_ij = result.pnos.transpose() * F_uocc * result.pnos;
 
-      }   // fuzzy update
-      else if (update_pno_rank == PNORankUpdateMethod::fixed && have_old_pnos) {  // no update
-        const auto old_npno = old_npnos[ij];
-        npno = old_npno;
-        pnodrop = nuocc - npno;
-      }  // nu update
+  // Store just the diagonal elements of F_pno_ij
+  result.F_pno_diag = F_pno_ij.diagonal();
 
+  // Transform PNOs to canonical PNOs if pno_canonical_ == true
 
-      // Store the new number of PNOs kept for calculating the average later
-      npnos[ij] = npno;
+  if (pno_canonical && npno > 0) {
+    // Compute eigenvectors of F in PNO space
+    es.compute(F_pno_ij);
+    Matrix pno_transform_ij = es.eigenvectors();
 
-      // Truncate PNO matrix and store in pnos_
+    // Replace standard with canonical PNOs; pno_ij -> can_pno_ij
+    result.pnos = (result.pnos * pno_transform_ij).eval();
+    result.F_pno_diag = es.eigenvalues();
+  }  // pno_canonical
 
-      // Declare matrix pno_trunc to hold truncated set of PNOs
-      Matrix pno_trunc;
+  return result;
+}
 
-      // If npno = 0, substitute a single fake "PNO" with all coefficients
-      // equal to zero. All other code will behave the same way
-      if (npno == 0) {
-        // resize pno_trunc to be size nocc_act x 1
-        pno_trunc.resize(nuocc, 1);
+/**
+ *
+ * @tparam Tile
+ * @tparam Policy
+ * @param D             pair density
+ * @param F_uocc        unocc-unocc portion of the Fock matrix
+ * @param tpno          PNO truncation threshold
+ * @param tosv          OSV truncation threshold
+ * @param pnos          vector of PNO matrices
+ * @param npnos         vector of nPNO values
+ * @param F_pno_diag    vector of Vectors, where each Vector contains the diagonal elements of
+ *                      the PNO-transformed Fock matrix
+ * @param osvs          vector of OSV matrices
+ * @param nosvs         vector of nOSV values
+ * @param F_osv_diag    vector of Vectors, where each Vector contains the diagonal elements of
+ *                      the OSV-transformed Fock matrix
+ * @param pno_canonical whether or not to canonicalize the PNOs
+ */
+template <typename Tile, typename Policy>
+void construct_pno(
+    const TA::DistArray<Tile, Policy>& D,
+    const RowMatrix<typename Tile::numeric_type>& F_uocc,
+    double tpno,
+    double tosv,
+    std::vector<RowMatrix<typename Tile::numeric_type>>& pnos,
+    std::vector<int>& npnos,
+    std::vector<int>& old_npnos,
+    std::vector<EigenVector<typename Tile::numeric_type>>& F_pno_diag,
+    std::vector<RowMatrix<typename Tile::numeric_type>>& osvs,
+    std::vector<int>& nosvs,
+    std::vector<int>& old_nosvs,
+    std::vector<EigenVector<typename Tile::numeric_type>>& F_osv_diag,
+    std::vector<EigenVector<typename Tile::numeric_type>>& pno_eigvals,
+    bool pno_canonical = false,
+    PNORankUpdateMethod update_pno_rank = PNORankUpdateMethod::standard) {
+  using Matrix = RowMatrix<typename Tile::numeric_type>;
 
-        // Create a zero matrix of size nuocc x 1
-        Matrix pno_zero = Matrix::Zero(nuocc, 1);
+  auto& world = D.world();
+  std::size_t nocc_act = D.trange().dim(2).extent();
+  std::size_t nuocc = D.trange().dim(0).extent();
 
-        // Set pno_trunc eqaul to pno_zero matrix
-        pno_trunc = pno_zero;
-      }
+  // If npnos already initialized, set old_npnos = npnos
+  const bool have_old_pnos = (npnos.size() != 0);
+  if(have_old_pnos) {
+    old_npnos = npnos;
+  }
+  else {
+    // Initialize old_npnos_ to have all zeroes
+    old_npnos.resize(nocc_act * nocc_act);
+    std::fill(old_npnos.begin(), old_npnos.end(), 0);
+  }
 
-        // If npno != zero, use actual zet of truncated PNOs
-      else {
-        pno_trunc.resize(nuocc, npno);
-        pno_trunc = pno_ij.block(0, pnodrop, nuocc, npno);
-      }
+  // For storing PNOs and and the Fock matrix in the PNO basis
+  npnos.resize(nocc_act * nocc_act);
+  pnos.resize(nocc_act * nocc_act);
+  F_pno_diag.resize(nocc_act * nocc_act);
+  std::fill(npnos.begin(), npnos.end(), 0);
 
-      // Store truncated PNOs
-      pnos[ij] = pno_trunc;
+  // For storing the PNO eigenvalues
+  pno_eigvals.resize(nocc_act * nocc_act);
 
-      // Transform F to PNO space
-      Matrix F_pno_ij = pno_trunc.transpose() * F_uocc * pno_trunc;
+  construct_osv(D, F_uocc, tosv, osvs, nosvs, old_nosvs, F_osv_diag,
+                pno_canonical, update_pno_rank);
 
-      // Store just the diagonal elements of F_pno_ij
-      F_pno_diag[ij] = F_pno_ij.diagonal();
+  // Lambda function to form PNOs; implement using a for_each
+  auto form_PNO = [&pnos, &F_pno_diag, &F_uocc, &npnos, &old_npnos,
+                   tpno, nuocc, nocc_act,
+                   pno_canonical, &pno_eigvals, update_pno_rank, have_old_pnos]
+      (Tile& result_tile, const Tile& arg_tile) {
 
-      // Transform PNOs to canonical PNOs if pno_canonical_ == true
+    result_tile = Tile(arg_tile.range());
 
-      if (pno_canonical && npno > 0) {
-        // Compute eigenvectors of F in PNO space
-        es.compute(F_pno_ij);
-        Matrix pno_transform_ij = es.eigenvectors();
+    // Get values of i,j and compute ij
+    const int i = arg_tile.range().lobound()[2];
+    const int j = arg_tile.range().lobound()[3];
+    const int ij = i * nocc_act + j;
 
-        // Transform pno_ij to canonical PNO space; pno_ij -> can_pno_ij
-        Matrix can_pno_ij = pno_trunc * pno_transform_ij;
+    // Form D_ij matrix from arg_tile
+    Matrix D_ij = TA::eigen_map(arg_tile, nuocc, nuocc);
 
-        // Replace standard with canonical PNOs
-        pnos[ij] = can_pno_ij;
-        F_pno_diag[ij] = es.eigenvalues();
-      }  // pno_canonical
+    // Only form PNOs for i <= j
+    if (i <= j) {
+      auto pno_ij = form_pair_pno(D_ij, F_uocc, tpno, old_npnos[ij],
+                                  have_old_pnos, pno_canonical,
+                                  update_pno_rank);
+      npnos[ij] = pno_ij.npno;
+      pnos[ij] = std::move(pno_ij.pnos);
+      F_pno_diag[ij] = std::move(pno_ij.F_pno_diag);
+      pno_eigvals[ij] = std::move(pno_ij.eigvals);
     } // i <= j
 
 
@@ -1122,6 +1277,76 @@ void construct_pno(
 
 }  // construct_pno
 
+/**
+ * constructs the PNOs of the local pairs i <= j that are not weak, and the
+ * OSVs; the PNOs of the pairs i > j must be transferred from the owners of
+ * the pairs j,i
+ *
+ * @param pnos  the PNOs of the local pairs, the current ones (if any) are
+ *              replaced
+ * @sa the std::vector-based overload for the other parameters
+ */
+template <typename Tile, typename Policy>
+void construct_pno(
+    const TA::DistArray<Tile, Policy>& D,
+    const RowMatrix<typename Tile::numeric_type>& F_uocc,
+    double tpno,
+    double tosv,
+    PNOPairList<typename Tile::numeric_type>& pnos,
+    std::vector<RowMatrix<typename Tile::numeric_type>>& osvs,
+    std::vector<int>& nosvs,
+    std::vector<int>& old_nosvs,
+    std::vector<EigenVector<typename Tile::numeric_type>>& F_osv_diag,
+    bool pno_canonical = false,
+    PNORankUpdateMethod update_pno_rank = PNORankUpdateMethod::standard) {
+  using Matrix = RowMatrix<typename Tile::numeric_type>;
+
+  auto& world = D.world();
+  std::size_t nocc_act = D.trange().dim(2).extent();
+  std::size_t nuocc = D.trange().dim(0).extent();
+
+  // only the ranks of the current PNOs are needed to update them
+  const bool have_old_pnos = (nosvs.size() != 0);
+  std::unordered_map<std::size_t, int> old_npnos;
+  for (const auto& ij_pno : pnos) {
+    old_npnos.emplace(ij_pno.first, ij_pno.second.npno);
+  }
+  pnos.clear();
+
+  construct_osv(D, F_uocc, tosv, osvs, nosvs, old_nosvs, F_osv_diag,
+                pno_canonical, update_pno_rank);
+
+  // Lambda function to form PNOs; implement using a for_each
+  auto form_PNO = [&pnos, &F_uocc, &old_npnos, tpno, nuocc, nocc_act,
+                   pno_canonical, update_pno_rank, have_old_pnos]
+      (Tile& result_tile, const Tile& arg_tile) {
+
+    // Get values of i,j and compute ij
+    const int i = arg_tile.range().lobound()[2];
+    const int j = arg_tile.range().lobound()[3];
+    const int ij = i * nocc_act + j;
+
+    // Only form PNOs for i <= j
+    if (i <= j && !pnos.is_weak(ij)) {
+      const Matrix D_ij = TA::eigen_map(arg_tile, nuocc, nuocc);
+      const auto old_npno_it = old_npnos.find(ij);
+      const int old_npno =
+          old_npno_it != old_npnos.end() ? old_npno_it->second : 0;
+      pnos.insert(ij, form_pair_pno(D_ij, F_uocc, tpno, old_npno,
+                                    have_old_pnos, pno_canonical,
+                                    update_pno_rank));
+    }
+
+    // the result is not used
+    result_tile = arg_tile;
+    return arg_tile.norm();
+  };  // form_PNO
+
+  auto D_prime = TA::foreach (D, form_PNO);
+  world.gop.fence();
+
+}  // construct_pno
+
 }  // namespace detail
 
 
@@ -1160,7 +1385,13 @@ class JacobiDIISSolver : public ::mpqc::cc::DIISSolver<T> {
   void update_only(T& t1, T& t2, T& t3, const T& r1, const T& r2, const T& r3) override {
     t1("a,i") += detail::jacobi_update_t1_ai(r1, f_ii_, f_aa_)("a,i");
     t2("a,b,i,j") += detail::jacobi_update_t2_abij(r2, f_ii_, f_aa_)("a,b,i,j");
-    t3("a,b,c,i,j,k") += detail::jacobi_update_t3_abcijk(r3, f_ii_, f_aa_)("a,b,c,i,j,k");
+    if (r3.trange().rank() == 4) {
+      // packed triples, see pack_t3()
+      t3("t,i,j,k") += detail::jacobi_update_packed_t3(
+          r3, f_ii_, f_aa_, r1.trange().dim(0))("t,i,j,k");
+    } else {
+      t3("a,b,c,i,j,k") += detail::jacobi_update_t3_abcijk(r3, f_ii_, f_aa_)("a,b,c,i,j,k");
+    }
     t1.truncate();
     t2.truncate();
     t3.truncate();
@@ -1187,6 +1418,7 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
   using Vector = EigenVector<typename Tile::numeric_type>;
 
   using WorldObject_ = madness::WorldObject<PNOSolver<T, DT>>;
+  using PNOPairList = detail::PNOPairList<typename Tile::numeric_type>;
 
   // clang-format off
   /**
@@ -1199,6 +1431,7 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
    * |---------|------|--------|-------------|
    * | @c tpno | double | 1e-7 | The PNO construction threshold. This non-negative integer specifies the screening threshold for the eigenvalues of the pair density. Setting this to zero will cause the full (untruncated) set of PNOs to be used. |
    * | @c tosv | double | 1e-9 | The OSV construction threshold. This non-negative integer specifies the screening threshold for the eigenvalues of the pair density of the diagonal pairs. Setting this to zero will cause the full (untruncated) set of OSVs to be used. |
+   * | @c tpair | double | 0 | The pair screening threshold. The off-diagonal pairs whose MP2 pair energy, estimated from the initial (see @c pno_guess ) amplitudes, is smaller than this in magnitude are weak: they have no PNOs, hence their amplitudes are dropped. Setting this to zero disables the screening. |
    * | @c pno_canonical | bool | false | Whether or not to canonicalize the PNOs and OSVs |
    * | @c pno_guess | string | scmp1 | How to construct the (initial) PNOs; valid values are "scmp1" (semicanonical MP1 amplitudes; exact if using canonical orbitals) and "mp1" (exact MP1 amplitudes) |
    * | @c update_pno | bool | false | Whether or not to recompute the PNOs |
@@ -1217,6 +1450,7 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
         update_pno_(kv.value<bool>("update_pno", false)),
         tpno_(kv.value<double>("tpno", 1.e-7)),
         tosv_(kv.value<double>("tosv", 1.e-9)),
+        tpair_(kv.value<double>("tpair", 0.0)),
         min_micro_(kv.value<int>("min_micro", 3)),
         print_npnos_(kv.value<bool>("print_npnos", false)),
         micro_ratio_(kv.value<double>("micro_ratio", 3.0)),
@@ -1238,6 +1472,8 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
     auto nfzc = nocc - nocc_act;
     iter_count_ = 0;
 
+    pnos_ = PNOPairList(nocc_act, nuocc);
+
     // Counts how many micro iterations per macro iteration
     // In subsequent macro iterations, this will start at 1
     micro_count_ = 0;
@@ -1312,13 +1548,17 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
     K_reblock_ = detail::reblock_t2(K, reblock_i_, reblock_a_);
     T T_reblock = detail::reblock_t2(T2, reblock_i_, reblock_a_);
 
+    // Screen out the weak pairs
+    if (tpair_ > 0.0) {
+      screen_weak_pairs(T_reblock);
+    }
+
     // Construct PNOs and OSVs
     auto D = detail::construct_density(T_reblock);
     old_D_ = D; // Save this original D in old_D_ for purposes of mixing
     detail::construct_pno(D, F_uocc_,
-                          tpno_, tosv_,
-                          pnos_, npnos_, old_npnos_, F_pno_diag_,
-                          osvs_, nosvs_, old_nosvs_, F_osv_diag_, pno_eigvals_, pno_canonical_, update_pno_rank_);
+                          tpno_, tosv_, pnos_,
+                          osvs_, nosvs_, old_nosvs_, F_osv_diag_, pno_canonical_, update_pno_rank_);
 
     // ready to process tasks now
     this->process_pending();
@@ -1346,11 +1586,14 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
   double tpno() const { return tpno_; }
   /// @return OSV truncation threshold
   double tosv() const { return tosv_; }
+  /// @return pair screening threshold
+  double tpair() const { return tpair_; }
 
-  const auto& pno(int i, int j) const { return pnos_[i * nocc_act_ + j]; }
+  /// @note only the PNOs of the pairs owned by this process are available
+  const auto& pno(int i, int j) const { return pnos_.pair(i * nocc_act_ + j).pnos; }
   const auto& osv(int i) const { return osvs_[i]; }
 
-  const auto& npnos(int i, int j) const { return npnos_[i * nocc_act_ + j]; }
+  int npnos(int i, int j) const { return pnos_.npno(i * nocc_act_ + j); }
 
  private:
   /// Overrides DIISSolver::is_converged()
@@ -1417,7 +1660,7 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
       delta_t1_ai =
         detail::pno_jacobi_update_t1(r1, ens_occ_act, F_osv_diag_, osvs_);
       delta_t2_abij =
-        detail::pno_jacobi_update_t2(r2, ens_occ_act, F_pno_diag_, pnos_);
+        detail::pno_jacobi_update_t2(r2, ens_occ_act, pnos_.F_pno_diag(), pnos_.pnos());
     }
 
 
@@ -1486,9 +1729,8 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
 
       // Recompute the PNOs using mixed_D
       detail::construct_pno(mixed_D, F_uocc_,
-                            tpno_, tosv_,
-                            pnos_, npnos_, old_npnos_, F_pno_diag_,
-                            osvs_, nosvs_, old_nosvs_, F_osv_diag_, pno_eigvals_, pno_canonical_, update_pno_rank_);
+                            tpno_, tosv_, pnos_,
+                            osvs_, nosvs_, old_nosvs_, F_osv_diag_, pno_canonical_, update_pno_rank_);
 
       // Once PNOs have been recomputed at least once, pnos_relaxed_ becomes true
       pnos_relaxed_ = true;
@@ -1503,7 +1745,7 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
       }
 
       // Transform t_old_reblock
-      T T2 = detail::t2_project_pno(t2_old_reblock, pnos_);
+      T T2 = detail::t2_project_pno(t2_old_reblock, pnos_.pnos());
       t2 = detail::unblock_t2(T2, reblock_i_, reblock_a_);
 
 
@@ -1533,7 +1775,7 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
 
       // transform residuals to the PNO space for the sake of extrapolation
       T r1_osv = detail::osv_transform_ai(r1_reblock, osvs_);
-      T r2_pno = detail::pno_transform_abij(r2_reblock, pnos_);
+      T r2_pno = detail::pno_transform_abij(r2_reblock, pnos_.pnos());
       mpqc::cc::TPack<T> r(r1_osv, r2_pno);
       mpqc::cc::TPack<T> t(t1, t2);
 
@@ -1553,8 +1795,9 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
     auto r1_reblock = detail::reblock_t1(r1, reblock_i_, reblock_a_);
     auto r2_reblock = detail::reblock_t2(r2, reblock_i_, reblock_a_);
 
+    const auto pnos = pnos_.pnos();
     detail::R1SquaredNormReductionOp<T> op1(osvs_);
-    detail::R2SquaredNormReductionOp<T> op2(pnos_);
+    detail::R2SquaredNormReductionOp<T, typename PNOPairList::PNOView> op2(pnos);
 
     auto residual = sqrt(r1_reblock("a,i").reduce(op1).get() +
                          r2_reblock("a,b,i,j").reduce(op2).get()) /
@@ -1569,46 +1812,80 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
   /// Transfers the PNOs from the node that owns pair i,j to the node that owns pair j,i
   void transfer_pnos() {
     auto pmap = K_reblock_.pmap();
-    auto tile_extent = K_reblock_.trange().tiles_range().extent_data();
-
-    for(auto i = 0; i < tile_extent[2]; ++i) {
-      for (auto j = i + 1; j < tile_extent[3]; ++j) {
-        if(!K_reblock_.is_zero({0,0,i,j}) && K_reblock_.is_local({0,0,i,j})) {
-          auto ji_owner = pmap->owner(j * nocc_act_ + i);
-          const auto ij = i * nocc_act_ + j;
-          WorldObject_::task(ji_owner, &PNOSolver::copy_pnoij, i, j, pnos_[ij], npnos_[ij], F_pno_diag_[ij], pno_eigvals_[ij]);
-        }
+    auto& world = this->get_world();
+
+    // collect the local pairs i < j first: pnos_ must not be iterated while
+    // copy_pnoij() inserts into it. The fence makes sure that no process
+    // sends before all processes are done collecting; the entries of pnos_
+    // are not moved by the later insertions.
+    std::vector<std::pair<std::size_t, const typename PNOPairList::Pair*>> upper_pairs;
+    for (const auto& ij_pno : pnos_) {
+      if (ij_pno.first / nocc_act_ < ij_pno.first % nocc_act_) {
+        upper_pairs.emplace_back(ij_pno.first, &ij_pno.second);
       }
     }
+    world.gop.fence();
 
-    this->get_world().gop.fence();
+    for (const auto& ij_pno : upper_pairs) {
+      const int i = ij_pno.first / nocc_act_;
+      const int j = ij_pno.first % nocc_act_;
+      auto ji_owner = pmap->owner(j * nocc_act_ + i);
+      WorldObject_::task(ji_owner, &PNOSolver::copy_pnoij, i, j, *ij_pno.second);
+    }
+
+    world.gop.fence();
   }
 
   /**
    * Copies the PNOs for pair i,j to pair j,i
    * @param i The first occupied index
    * @param j The second occupied index
-   * @param pno_ij The Matrix of PNOs associated with pair i,j
-   * @param npno_ij The number of PNOs axxociated with pair i,j
-   * @param f_pno_diag_ij A Vector containing the diagonal elements of the Fock matrix
-   *        transformed to the i,j PNO space
+   * @param pno_ij The PNOs, the number of PNOs, the diagonal of the Fock
+   *        matrix in the PNO basis and the pair density eigenvalues of pair i,j
    */
-  void copy_pnoij(int i, int j, Matrix pno_ij, int npno_ij, Vector f_pno_diag_ij, Vector pno_eigvals_ij) {
+  void copy_pnoij(int i, int j, typename PNOPairList::Pair pno_ij) {
     int my_i = j;
     int my_j = i;
     int my_ij = my_i * nocc_act_ + my_j;
-    pnos_[my_ij] = pno_ij;
-    npnos_[my_ij] = npno_ij;
-    F_pno_diag_[my_ij] = f_pno_diag_ij;
-    pno_eigvals_[my_ij] = pno_eigvals_ij;
+    pnos_.insert(my_ij, std::move(pno_ij));
+  }
+
+  /// Marks the pairs whose MP2 pair energy is smaller than tpair_ as weak
+  /// @param T_reblock the (reblocked) amplitudes used to estimate the pair energies
+  void screen_weak_pairs(const T& T_reblock) {
+    auto& world = this->get_world();
+
+    const auto pair_energies = detail::local_pair_energies(K_reblock_, T_reblock);
+    double e_weak = 0.0;
+    for (const auto& ij_e : pair_energies) {
+      const auto i = ij_e.first / nocc_act_;
+      const auto j = ij_e.first % nocc_act_;
+      // the diagonal pairs are never weak
+      if (i != j && std::abs(ij_e.second) < tpair_) {
+        pnos_.mark_weak(ij_e.first);
+        e_weak += ij_e.second;
+      }
+    }
+
+    std::size_t nweak = pnos_.nweak();
+    world.gop.sum(nweak);
+    world.gop.sum(e_weak);
+
+    ExEnv::out0() << "nWeak pairs: " << nweak << ", estimated MP2 energy of weak pairs: " << e_weak << std::endl;
   }
 
   /// Prints the average number of PNOs and OSVs per pair
   void print_ave_npnos_per_pair() {
 
-    this->get_world().gop.sum(npnos_.data(), npnos_.size());
     this->get_world().gop.sum(nosvs_.data(), nosvs_.size());
 
+    // every pair is stored by exactly one process
+    long tot_pno = 0;
+    for (const auto& ij_pno : pnos_) {
+      tot_pno += ij_pno.second.npno;
+    }
+    this->get_world().gop.sum(tot_pno);
+
     if (this->get_world().rank() == 0) {
       auto tot_osv = 0;
       for (int i = 0; i != nosvs_.size(); ++i) {
@@ -1618,11 +1895,6 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
       auto ave_nosv = tot_osv / nocc_act_;
 
       // Compute and print average number of PNOs per pair
-      auto tot_pno = 0;
-      for (int i = 0; i != npnos_.size(); ++i) {
-        tot_pno += npnos_[i];
-      }
-
       auto ave_npno = tot_pno / (nocc_act_ * nocc_act_);
 
       ExEnv::out0() << "ave. nPNOs/pair: " << ave_npno << ", ave nOSVs/pair: " << ave_nosv << std::endl;
@@ -1631,6 +1903,15 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
 
   /// Prints the number of PNOs for each occupied pair
   void print_npnos_per_pair() {
+    // gather the number of PNOs of all pairs
+    std::vector<int> npnos(nocc_act_ * nocc_act_, 0);
+    for (const auto& ij_pno : pnos_) {
+      npnos[ij_pno.first] = ij_pno.second.npno;
+    }
+    this->get_world().gop.sum(npnos.data(), npnos.size());
+
+    if (this->get_world().rank() != 0) return;
+
     std::string filename = FormIO::fileext_to_fullpathname("-npnos_iter-" + std::to_string(iter_count_) + ".tsv");
     std::ofstream out_file(filename);
 
@@ -1638,23 +1919,23 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
 
     for (int i = 0; i != nocc_act_; ++i) {
       for (int j = 0; j != nocc_act_; ++j) {
-        int val = npnos_[i * nocc_act_ + j];
+        int val = npnos[i * nocc_act_ + j];
         out_file << i << " " << j << " " << val << std::endl;
       }
     }
   }
 
-  /// Prints all eigenvalues for each (unique) occupied pair
+  /// Prints all eigenvalues for each (unique, not weak) occupied pair;
+  /// each process prints the pairs it owns
   void print_eigvals() {
 
-    for (int i = 0; i != nocc_act_; ++i) {
-      for (int j = i; j != nocc_act_; ++j) {
-        std::string filename = FormIO::fileext_to_fullpathname("-pno_eigvals_i-" + std::to_string(i) + "-j-" + std::to_string(j) + "-iter-" + std::to_string(iter_count_) + ".tsv");
-        std::ofstream out_file(filename);
-        auto ij = i * nocc_act_ + j;
-        auto eigvals_ij = pno_eigvals_[ij];
-        out_file << eigvals_ij << std::endl;
-      }
+    for (const auto& ij_pno : pnos_) {
+      const int i = ij_pno.first / nocc_act_;
+      const int j = ij_pno.first % nocc_act_;
+      if (i > j) continue;
+      std::string filename = FormIO::fileext_to_fullpathname("-pno_eigvals_i-" + std::to_string(i) + "-j-" + std::to_string(j) + "-iter-" + std::to_string(iter_count_) + ".tsv");
+      std::ofstream out_file(filename);
+      out_file << ij_pno.second.eigvals << std::endl;
     }
   }
 
@@ -1799,8 +2080,8 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
   /// Computes the PNO-MP2 correction
   void compute_pno_mp2_correction() {
     // Form K_pno and T2_pno
-    T K_pno = detail::pno_transform_abij(K_reblock_, pnos_);
-    T T2_pno = detail::form_T_from_K(K_pno, F_occ_act_, F_uocc_, pnos_, nocc_act_);
+    T K_pno = detail::pno_transform_abij(K_reblock_, pnos_.pnos());
+    T T2_pno = detail::form_T_from_K(K_pno, F_occ_act_, F_uocc_, pnos_.pnos(), nocc_act_);
 
     // Compute the MP2 energy in the space of the truncated PNOs
     auto pno_e_mp2 = detail::compute_mp2(K_pno, T2_pno);
@@ -1822,8 +2103,11 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
 
     for (int i = 0; i != nocc_act_; ++i) {
       for (int j = i; j != nocc_act_; ++j) {
-        Matrix old_u = old_pnos_[i * nocc_act_ + j];
-        Matrix new_u = pnos_[i * nocc_act_ + j];
+        const auto ij = i * nocc_act_ + j;
+        if (pnos_.is_weak(ij)) continue;
+
+        const auto& old_u = old_pnos_.pair(ij).pnos;
+        const auto& new_u = pnos_.pair(ij).pnos;
 
         Matrix product = old_u.transpose() * new_u;
 
@@ -1857,6 +2141,7 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
   bool update_pno_;            //!< whether or not to update PNOs
   double tpno_;                //!< the PNO truncation threshold
   double tosv_;                //!< the OSV (diagonal PNO) truncation threshold
+  double tpair_;               //!< the weak pair screening threshold
   int nocc_act_;               //!< the number of active occupied orbitals
   int nuocc_;                  //!< the number of unoccupied orbitals
   T T_;                        //!< the array of MP1 T amplitudes
@@ -1873,13 +2158,9 @@ class PNOSolver : public ::mpqc::cc::DIISSolver<T>,
 
   double exact_e_mp2_;         //!< the exact MP2 correlation energy
 
-  // For storing PNOs and and the Fock matrix in the PNO basis
-  std::vector<int> npnos_;
-  std::vector<Matrix> pnos_;
-  std::vector<Vector> F_pno_diag_;
-  std::vector<int> old_npnos_;
-  std::vector<Matrix> old_pnos_;
-  std::vector<Vector> pno_eigvals_;
+  // For storing PNOs and and the Fock matrix in the PNO basis of the local pairs
+  PNOPairList pnos_;
+  PNOPairList old_pnos_;
 
   // For storing OSVs (PNOs when i = j) and the Fock matrix in
   // the OSV basis
@@ -5,6 +5,7 @@
 #ifndef SRC_MPQC_CHEMISTRY_QC_LCAO_CI_CIS_H_
 #define SRC_MPQC_CHEMISTRY_QC_LCAO_CI_CIS_H_
 
+#include "mpqc/chemistry/qc/lcao/scf/traditional_four_center_fock_builder.h"
 #include "mpqc/chemistry/qc/lcao/wfn/lcao_wfn.h"
 #include "mpqc/chemistry/qc/properties/excitation_energy.h"
 #include "mpqc/math/external/tiledarray/array_max_n.h"
@@ -36,8 +37,10 @@ struct IndexSort {
 /**
  * CIS for closed shell system
  *
- * @warning This is not a efficient integral direct implementation of CIS, only
- * used to generate guess eigen vectors for EOM-CCSD
+ * The "standard" and "df" methods store the (density-fitted) MO integrals;
+ * the "direct" method computes the products of H with the Davidson vectors
+ * from AO integrals, as Fock-like J/K builds with the AO transition densities,
+ * and stores no 2-electron integrals.
  *
  */
 template <typename Tile, typename Policy>
@@ -98,8 +101,9 @@ class CIS : public LCAOWavefunction<Tile, Policy>,
   * | Keyword | Type | Default| Description |
   * |---------|------|--------|-------------|
   * | ref | Wavefunction | none | reference Wavefunction, RHF for example |
-  * | method | df | standard or df | method to compute CIS, standard, df |
+  * | method | string | standard or df | method to compute CIS, standard, df or direct |
   * | max_iter| int | 30 | max number of iteration in davidson diagonalization|
+  * | davidson_scratch_dir | string | none | if given, the Davidson subspace vectors are kept in files in this (node-local) directory instead of in memory |
   */
   // clang-format on
   explicit CIS(const KeyVal &kv) : LCAOWavefunction<Tile, Policy>(kv) {
@@ -110,6 +114,7 @@ class CIS : public LCAOWavefunction<Tile, Policy>,
                        __LINE__, "ref");
     }
     max_iter_ = kv.value<int>("max_iter", 30);
+    davidson_scratch_dir_ = kv.value<std::string>("davidson_scratch_dir", "");
     auto default_method =
         this->lcao_factory().basis_registry()->have(L"Κ") ? "df" : "standard";
     method_ = kv.value<std::string>("method", default_method);
@@ -163,12 +168,22 @@ class CIS : public LCAOWavefunction<Tile, Policy>,
                                            double precision,
                                            bool triplets = false);
 
+  /// this approach is integral direct: in each Davidson iteration the
+  /// products of H with all new vectors are computed in a single pass over
+  /// the AO integrals, see FourCenterFockBuilder::compute_JK_multi()
+  /// @return excitation energy
+  std::vector<numeric_type> compute_cis_direct(std::size_t n_roots,
+                                               std::size_t n_guess,
+                                               double precision,
+                                               bool triplets = false);
+
   /// @return guess vector of size n_roots as unit vector
   std::vector<TArray> init_guess_vector(std::size_t n_roots);
 
  private:
   /// max number of iteration in davidson
   std::size_t max_iter_;
+  std::string davidson_scratch_dir_;
   /// if has density fitting
   bool df_;
   /// CIS method string
@@ -213,6 +228,8 @@ void CIS<Tile, Policy>::evaluate(ExcitationEnergy *ex_energy) {
         result = compute_cis(n_roots, n_guess, target_precision);
       } else if (method_ == "df") {
         result = compute_cis_df(n_roots, n_guess, target_precision);
+      } else if (method_ == "direct") {
+        result = compute_cis_direct(n_roots, n_guess, target_precision);
       }
     }
 
@@ -224,6 +241,9 @@ void CIS<Tile, Policy>::evaluate(ExcitationEnergy *ex_energy) {
       } else if (method_ == "df") {
         triplet_result =
             compute_cis_df(n_roots, n_guess, target_precision, true);
+      } else if (method_ == "direct") {
+        triplet_result =
+            compute_cis_direct(n_roots, n_guess, target_precision, true);
       }
       result.insert(result.end(), triplet_result.begin(), triplet_result.end());
     }
@@ -294,6 +314,9 @@ CIS<Tile, Policy>::compute_cis(std::size_t n_roots, std::size_t n_guess,
   // davidson object
   DavidsonDiag<TA::DistArray<Tile, Policy>> dvd(n_roots, true, 2, 10,
                                                 10 * converge);
+  if (!davidson_scratch_dir_.empty()) {
+    dvd.use_disk_subspace_store(davidson_scratch_dir_);
+  }
 
   auto pred = std::make_unique<Preconditioner>(eps_o_, eps_v_);
 
@@ -364,6 +387,9 @@ CIS<Tile, Policy>::compute_cis_df(std::size_t n_roots, std::size_t n_guess,
   // davidson object
   DavidsonDiag<TA::DistArray<Tile, Policy>> dvd(n_roots, true, 2, 10,
                                                 10 * converge);
+  if (!davidson_scratch_dir_.empty()) {
+    dvd.use_disk_subspace_store(davidson_scratch_dir_);
+  }
 
   auto pred = std::make_unique<Preconditioner>(eps_o_, eps_v_);
 
@@ -413,6 +439,109 @@ CIS<Tile, Policy>::compute_cis_df(std::size_t n_roots, std::size_t n_guess,
   return std::vector<numeric_type>(eig.data(), eig.data() + eig.size());
 }
 
+template <typename Tile, typename Policy>
+std::vector<typename CIS<Tile, Policy>::numeric_type>
+CIS<Tile, Policy>::compute_cis_direct(std::size_t n_roots, std::size_t n_guess,
+                                      double converge, bool triplets) {
+  ExEnv::out0() << "\n";
+  ExEnv::out0() << indent << "CIS Direct: "
+                << (triplets ? "Triplets" : "Singlets") << "\n";
+  ExEnv::out0() << "\n";
+
+  auto &factory = this->lcao_factory();
+  auto &world = factory.world();
+
+  // the Fock matrix of the reference is available in the AO basis
+  auto F_ab = factory.compute(L"<a|F|b>");
+  auto F_ij = factory.compute(L"<i|F|j>");
+  auto I_ab = factory.compute(L"<a|I|b>");
+  auto I_ij = factory.compute(L"<i|I|j>");
+
+  const auto &C_i = factory.orbital_registry().retrieve("i").coefs();
+  const auto &C_a = factory.orbital_registry().retrieve("a").coefs();
+
+  // initialize diagonal
+  if (eps_o_.size() == 0) {
+    eps_o_ = math::array_to_eigen(F_ij).diagonal();
+  }
+  if (eps_v_.size() == 0) {
+    eps_v_ = math::array_to_eigen(F_ab).diagonal();
+  }
+
+  // G(D) = 2 J(D) - K(D) for singlets, G(D) = - K(D) for triplets
+  auto &ao_factory = ::mpqc::lcao::gaussian::to_ao_factory(this->ao_factory());
+  auto basis =
+      this->wfn_world()->basis_registry()->retrieve(OrbitalIndex(L"λ"));
+  auto builder = std::make_unique<scf::FourCenterFockBuilder<Tile, Policy>>(
+      world, basis, basis, basis, !triplets, true, ao_factory.screen(),
+      ao_factory.screen_threshold());
+
+  // get guess vector
+  auto guess = init_guess_vector(n_guess);
+
+  // davidson object
+  DavidsonDiag<TA::DistArray<Tile, Policy>> dvd(n_roots, true, 2, 10,
+                                                10 * converge);
+  if (!davidson_scratch_dir_.empty()) {
+    dvd.use_disk_subspace_store(davidson_scratch_dir_);
+  }
+
+  auto pred = std::make_unique<Preconditioner>(eps_o_, eps_v_);
+
+  auto oper = [&F_ab, &F_ij, &I_ab, &I_ij, &C_i, &C_a, &builder,
+               converge](std::vector<TArray> &guess) {
+    const auto n_v = guess.size();
+
+    // the AO transition density of each vector is not symmetric, it is split
+    // into its symmetric and antisymmetric parts; the Coulomb contribution of
+    // the latter vanishes
+    std::vector<TArray> D(2 * n_v);
+    std::vector<bool> antisymmetric(2 * n_v);
+    for (std::size_t i = 0; i < n_v; i++) {
+      TArray D_ao;
+      D_ao("mu,nu") = C_i("mu,i") * guess[i]("i,a") * C_a("nu,a");
+      D[2 * i]("mu,nu") = 0.5 * (D_ao("mu,nu") + D_ao("nu,mu"));
+      D[2 * i + 1]("mu,nu") = 0.5 * (D_ao("mu,nu") - D_ao("nu,mu"));
+      antisymmetric[2 * i] = false;
+      antisymmetric[2 * i + 1] = true;
+    }
+
+    // one pass over the integrals for all vectors
+    auto G = builder->compute_JK_multi(D, converge, antisymmetric);
+
+    std::vector<TA::DistArray<Tile, Policy>> HB(n_v);
+    for (std::size_t i = 0; i < n_v; i++) {
+      const auto &vec = guess[i];
+      HB[i]("j,b") = vec("i,a") * I_ij("i,j") * F_ab("a,b") -
+                     F_ij("i,j") * vec("i,a") * I_ab("a,b") +
+                     C_i("mu,j") * (G[2 * i]("mu,nu") + G[2 * i + 1]("mu,nu")) *
+                         C_a("nu,b");
+    }
+    return HB;
+  };
+  // solve the lowest n_roots eigenvalues
+  auto eig = dvd.solve(guess, oper, pred.get(), converge, max_iter_);
+
+  ExEnv::out0() << "\n";
+  util::print_excitation_energy(eig, triplets);
+  // get the latest eigen vector
+  auto &eigen_vector = dvd.eigen_vector();
+
+  for (std::size_t i = 0; i < n_roots; i++) {
+    auto dominants = array_abs_max_n_index(eigen_vector[i], 5);
+
+    ExEnv::out0() << "Dominant determinants of excited wave function " << i + 1
+                  << "\n";
+    util::print_cis_dominant_elements(dominants);
+    ExEnv::out0() << "\n";
+  }
+
+  eigen_vector_.insert(eigen_vector_.end(), eigen_vector.begin(),
+                       eigen_vector.end());
+
+  return std::vector<numeric_type>(eig.data(), eig.data() + eig.size());
+}
+
 template <typename Tile, typename Policy>
 std::vector<typename CIS<Tile, Policy>::TArray>
 CIS<Tile, Policy>::init_guess_vector(std::size_t n_roots) {
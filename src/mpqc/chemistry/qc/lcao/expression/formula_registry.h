@@ -5,10 +5,15 @@
 #ifndef MPQC4_SRC_MPQC_CHEMISTRY_QC_EXPRESSION_FORMULA_REGISTRY_H_
 #define MPQC4_SRC_MPQC_CHEMISTRY_QC_EXPRESSION_FORMULA_REGISTRY_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <map>
+#include <string>
 
 #include "mpqc/chemistry/qc/lcao/expression/formula.h"
 #include "mpqc/math/external/tiledarray/array_info.h"
+#include "mpqc/math/external/tiledarray/array_scratch.h"
 #include "mpqc/util/external/madworld/parallel_print.h"
 #include "mpqc/util/core/exception.h"
 
@@ -146,13 +151,83 @@ class Registry {
   container_type registry_;
 };
 
+namespace detail {
+
+/// RegistryValueTraits describes how FormulaRegistry accounts for the memory
+/// of a Value and how a Value is moved to and from disk; by default the
+/// memory of Value objects is not managed
+template <typename Value>
+struct RegistryValueTraits {
+  static constexpr bool is_managed = false;
+
+  struct spilled_type {};
+
+  static std::size_t size(const Value&) { return 0; }
+  static spilled_type spill(const Value&, const std::string&) { return {}; }
+  static Value restore(const spilled_type&) { return Value{}; }
+  static void remove(const spilled_type&) {}
+};
+
+/// the memory of TA::DistArray objects with TA::Tensor tiles is managed: the
+/// local tiles are written to (and read from) a file, one per process, and
+/// only the metadata needed to reconstruct the array is kept in memory
+template <typename T, typename Allocator, typename Policy>
+struct RegistryValueTraits<TA::DistArray<TA::Tensor<T, Allocator>, Policy>> {
+  using Array = TA::DistArray<TA::Tensor<T, Allocator>, Policy>;
+  using scratch_traits = ArrayScratchTraits<Array>;
+
+  static constexpr bool is_managed = true;
+
+  using spilled_type = typename scratch_traits::handle_type;
+
+  /// @return the largest size (in bytes) of the local part of \c A
+  /// @note this is a collective operation
+  static std::size_t size(const Array& A) {
+    const auto sizes = array_sizes(A);
+    return *std::max_element(sizes.begin(), sizes.end());
+  }
+
+  /// writes the local nonzero tiles of \c A to file \c basename.rank
+  static spilled_type spill(const Array& A, const std::string& basename) {
+    return scratch_traits::write(A, basename);
+  }
+
+  /// reads the local tiles written by spill() and reconstructs the array
+  static Array restore(const spilled_type& spilled) {
+    auto A = scratch_traits::read(spilled);
+    remove(spilled);
+    return A;
+  }
+
+  static void remove(const spilled_type& spilled) {
+    scratch_traits::remove(spilled);
+  }
+};
+
+}  // namespace detail
+
 /**
  *
  *  \brief map Formula to Value object
  *
+ *  The memory used by the stored objects can be limited by set_memory_limit(),
+ *  then (if Value is a TA::DistArray) the least recently used objects are
+ *  spilled to scratch files and transparently restored by find() and
+ *  retrieve(), including their const overloads. Only objects of rank 3 and
+ *  higher are spilled.
+ *
+ *  FormulaRegistry has the interface of Registry but does not derive from it,
+ *  since the lookup functions of Registry cannot see the spilled objects.
+ *  Restoring an object does not change the logical state of the registry,
+ *  hence the storage and the bookkeeping are mutable.
+ *  @note since spilling and restoring are collective operations, the
+ *        registry must be used in the same order on all ranks, as is already
+ *        the case for the computations that populate it.
+ *  @note spilling an object that is still referenced elsewhere does not free
+ *        its memory.
  */
 template <typename Value>
-class FormulaRegistry : public Registry<Formula, Value> {
+class FormulaRegistry {
  public:
   using Key = Formula;
   using container_type = typename Registry<Key, Value>::container_type;
@@ -161,7 +236,7 @@ class FormulaRegistry : public Registry<Formula, Value> {
   using const_iterator = typename Registry<Key, Value>::const_iterator;
 
   FormulaRegistry() = default;
-  FormulaRegistry(const container_type& map) : Registry<Key, Value>(map) {}
+  FormulaRegistry(const container_type& map) : registry_(map) {}
 
   /// prevent from copy and assign of FormulaRegistry
   FormulaRegistry(FormulaRegistry const&) = delete;
@@ -170,29 +245,197 @@ class FormulaRegistry : public Registry<Formula, Value> {
   FormulaRegistry(FormulaRegistry&&) = default;
   FormulaRegistry& operator=(FormulaRegistry&&) = default;
 
+  /// removes the scratch files of the spilled objects
+  ~FormulaRegistry() {
+    for (const auto& item : spilled_) traits::remove(item.second);
+  }
+
+  /// @return the resident objects
+  const container_type& registry() const { return registry_; }
+
   /// print out formula that stored in registry
   void print_formula() const {
-    for (const auto& item : this->registry_) {
+    for (const auto& item : registry_) {
       mpqc::detail::print_size_info(item.second, item.first.string());
     }
+    for (const auto& item : spilled_) {
+      ExEnv::out0() << indent << "Spilled to disk: "
+                    << utility::to_string(item.first.string()) << std::endl;
+    }
     ExEnv::out0() << std::endl;
   }
 
+  /// sets the memory budget of the registry
+  /// @param limit the memory limit (in bytes) per process; 0 means no limit
+  /// @param scratch_dir the directory where the spilled objects are written
+  void set_memory_limit(std::size_t limit,
+                        const std::string& scratch_dir = "/tmp") {
+    memory_limit_ = limit;
+    scratch_dir_ = scratch_dir;
+  }
+
+  /// @return the memory limit (in bytes) per process; 0 means no limit
+  std::size_t memory_limit() const { return memory_limit_; }
+
+  /// @return the memory (in bytes) per process used by the resident objects
+  std::size_t memory_used() const { return memory_used_; }
+
+  /// insert to registry by std::pair<Key, Value>, throw error if key already
+  /// exist; may spill least recently used objects to stay within the budget
+  void insert(const value_type& val) {
+    if (spilled_.find(val.first) != spilled_.end() ||
+        !registry_.insert(val).second) {
+      throw ProgrammingError("Registry::insert: Key Already Exist!!!", __FILE__,
+                             __LINE__);
+    }
+    if (is_managed(val.first)) {
+      const auto size = traits::size(val.second);
+      sizes_[val.first] = size;
+      memory_used_ += size;
+      touch(val.first);
+      enforce_memory_limit(val.first);
+    }
+  }
+
+  /// insert {Key,Value} pair
+  /// @note \c val is copied
+  void insert(const Key& key, const Value& val) {
+    insert(std::make_pair(key, val));
+  }
+
+  /// update value which already exists in registry, resident or spilled; the
+  /// old value (or its scratch files) is dropped
+  /// @throw ProgrammingError if \c key not found
+  void update(const Key& key, const Value& val) {
+    auto iter = registry_.find(key);
+    auto spilled_iter = spilled_.find(key);
+    if (iter != registry_.end()) {
+      forget(key, true);
+      iter->second = val;
+    } else if (spilled_iter != spilled_.end()) {
+      traits::remove(spilled_iter->second);
+      forget(key, false);
+      spilled_.erase(spilled_iter);
+      registry_.insert(std::make_pair(key, val));
+    } else {
+      throw ProgrammingError("Registry::update: Key not Found!\n", __FILE__,
+                             __LINE__);
+    }
+    if (is_managed(key)) {
+      const auto size = traits::size(val);
+      sizes_[key] = size;
+      memory_used_ += size;
+      touch(key);
+      enforce_memory_limit(key);
+    }
+  }
+
+  /// update value which already exists in registry
+  void update(const value_type& val) { update(val.first, val.second); }
+
+  /// remove Value by Key, resident or spilled
+  void remove(const Key& key) {
+    auto iter = registry_.find(key);
+    if (iter != registry_.end()) {
+      forget(key, true);
+      registry_.erase(iter);
+    }
+    auto spilled_iter = spilled_.find(key);
+    if (spilled_iter != spilled_.end()) {
+      traits::remove(spilled_iter->second);
+      forget(key, false);
+      spilled_.erase(spilled_iter);
+    }
+  }
+
+  /// find item, restoring it from disk if it was spilled; return iterator
+  iterator find(const Key& key) {
+    restore(key);
+    return registry_.find(key);
+  }
+
+  /// find item, restoring it from disk if it was spilled; return const
+  /// iterator
+  const_iterator find(const Key& key) const {
+    restore(key);
+    return registry_.find(key);
+  }
+
+  /// check if have key in registry, resident or spilled
+  bool have(const Key& key) const {
+    return registry_.find(key) != registry_.end() ||
+           spilled_.find(key) != spilled_.end();
+  }
+
+  /// find item by key, return non-const reference to the value
+  /// @param key the item key
+  /// @throw ProgrammingError if \c key not found
+  Value& retrieve(const Key& key) {
+    auto iter = find(key);
+    if (iter == registry_.end()) {
+      throw ProgrammingError("Registry::retrieve: Key not Found", __FILE__,
+                             __LINE__);
+    }
+    return iter->second;
+  }
+
+  /// find item by key, return const reference to the value
+  /// @param key the item key
+  /// @throw ProgrammingError if \c key not found
+  const Value& retrieve(const Key& key) const {
+    auto iter = find(key);
+    if (iter == registry_.cend()) {
+      throw ProgrammingError("Registry::retrieve: key not found", __FILE__,
+                             __LINE__);
+    }
+    return iter->second;
+  }
+
+  /// return begin of iterator over the resident objects
+  iterator begin() { return registry_.begin(); }
+
+  /// return end of iterator over the resident objects
+  iterator end() { return registry_.end(); }
+
+  /// return begin of const_iterator over the resident objects
+  const_iterator cbegin() const { return registry_.cbegin(); }
+
+  /// return end of const_iterator over the resident objects
+  const_iterator cend() const { return registry_.cend(); }
+
+  /// clear the registry
+  void clear() { purge(); }
+
   /// purges all objects if p(key) == true
   template <typename Pred>
   void purge_if(const Pred& p) {
-    auto i = this->registry_.begin();
-    for (; i != this->registry_.end();) {
+    auto i = registry_.begin();
+    for (; i != registry_.end();) {
       if (p(i->first)) {
         if (verbose_) {
           ExEnv::out0() << indent << "Removed from FormulaRegistry: ";
           ExEnv::out0() << utility::to_string(i->first.string()) << "\n";
         }
-        this->registry_.erase(i++);
+        forget(i->first, true);
+        registry_.erase(i++);
       } else {
         ++i;
       }
     }
+    auto j = spilled_.begin();
+    for (; j != spilled_.end();) {
+      if (p(j->first)) {
+        if (verbose_) {
+          ExEnv::out0() << indent << "Removed from FormulaRegistry (disk): ";
+          ExEnv::out0() << utility::to_string(j->first.string()) << "\n";
+        }
+        traits::remove(j->second);
+        forget(j->first, false);
+        spilled_.erase(j++);
+      } else {
+        ++j;
+      }
+    }
   }
 
   /// purges formulae that contain Operator whose type matches \c optype
@@ -241,7 +484,88 @@ class FormulaRegistry : public Registry<Formula, Value> {
   void set_verbose(bool verbose) { verbose_ = verbose; }
 
  private:
+  using traits = detail::RegistryValueTraits<Value>;
+  using spilled_type = typename traits::spilled_type;
+
   bool verbose_ = false;
+
+  std::size_t memory_limit_ = 0;
+  std::string scratch_dir_ = "/tmp";
+  // mutated by the const lookup functions when they restore spilled objects
+  mutable container_type registry_;                 // resident objects
+  mutable std::size_t memory_used_ = 0;
+  mutable std::size_t nspills_ = 0;
+  mutable std::uint64_t clock_ = 0;
+  mutable std::map<Key, std::size_t> sizes_;        // sizes of managed objects
+  mutable std::map<Key, std::uint64_t> last_used_;  // last use of managed objects
+  mutable std::map<Key, spilled_type> spilled_;     // objects spilled to disk
+
+  /// @return true if memory of the object with \c key is accounted for
+  bool is_managed(const Key& key) const {
+    return traits::is_managed && memory_limit_ != 0 && key.rank() >= 3;
+  }
+
+  void touch(const Key& key) const { last_used_[key] = ++clock_; }
+
+  /// restores the object with \c key if it was spilled, else marks it used
+  void restore(const Key& key) const {
+    auto spilled_iter = spilled_.find(key);
+    if (spilled_iter != spilled_.end()) {
+      if (verbose_) {
+        ExEnv::out0() << indent << "Restored from disk to FormulaRegistry: ";
+        ExEnv::out0() << utility::to_string(key.string()) << "\n";
+      }
+      auto value = traits::restore(spilled_iter->second);
+      spilled_.erase(spilled_iter);
+      registry_.insert(std::make_pair(key, value));
+      memory_used_ += sizes_[key];
+      touch(key);
+      enforce_memory_limit(key);
+    } else if (sizes_.find(key) != sizes_.end()) {
+      touch(key);
+    }
+  }
+
+  /// drops the bookkeeping of the object with \c key
+  /// @param resident whether the object is in memory (i.e. not spilled)
+  void forget(const Key& key, bool resident) {
+    auto size_iter = sizes_.find(key);
+    if (size_iter != sizes_.end()) {
+      if (resident) memory_used_ -= size_iter->second;
+      sizes_.erase(size_iter);
+    }
+    last_used_.erase(key);
+  }
+
+  /// spills the least recently used resident objects, except \c in_use,
+  /// until the memory used is within the limit
+  void enforce_memory_limit(const Key& in_use) const {
+    while (memory_limit_ != 0 && memory_used_ > memory_limit_) {
+      auto lru = registry_.end();
+      auto lru_time = std::numeric_limits<std::uint64_t>::max();
+      for (const auto& item : last_used_) {
+        if (item.first == in_use || item.second >= lru_time) continue;
+        auto iter = registry_.find(item.first);
+        if (iter != registry_.end()) {
+          lru = iter;
+          lru_time = item.second;
+        }
+      }
+      if (lru == registry_.end()) break;  // nothing left to spill
+
+      const auto basename =
+          scratch_dir_ + "/mpqc.registry." +
+          std::to_string(reinterpret_cast<std::uintptr_t>(this)) + "." +
+          std::to_string(nspills_++);
+      if (verbose_) {
+        ExEnv::out0() << indent << "Spilled to disk from FormulaRegistry: ";
+        ExEnv::out0() << utility::to_string(lru->first.string()) << "\n";
+      }
+      spilled_.emplace(lru->first, traits::spill(lru->second, basename));
+      memory_used_ -= sizes_[lru->first];
+      registry_.erase(lru);
+    }
+  }
 };
 }  // namespace mpqc
 
@@ -14,6 +14,112 @@ namespace mpqc {
 namespace lcao {
 namespace f12 {
 
+namespace detail {
+
+/// ReducePairTask operation that accumulates the ijij and ijji elements of
+/// left("i1,j1,p,q") * right("i2,j2,p,q") from one (p,q) block of tiles
+template <typename Tile>
+struct PairDiagonalDot {
+  typedef Tile result_type;
+  typedef Tile first_argument_type;
+  typedef Tile second_argument_type;
+
+  TA::Range range;
+
+  PairDiagonalDot(const TA::Range &range) : range(range) {}
+
+  result_type operator()() const { return Tile(range, 0.0); }
+
+  const result_type &operator()(const result_type &result) const {
+    return result;
+  }
+
+  void operator()(result_type &result, const result_type &arg) const {
+    result.add_to(arg);
+  }
+
+  void operator()(result_type &result, const first_argument_type &left,
+                  const second_argument_type &right) const {
+    const auto lo = result.range().lobound_data();
+    const auto up = result.range().upbound_data();
+    const auto left_ext = left.range().extent_data();
+    const auto right_ext = right.range().extent_data();
+    const std::size_t npq = left_ext[2] * left_ext[3];
+    TA_ASSERT(npq == right_ext[2] * right_ext[3]);
+
+    for (auto i1 = lo[0]; i1 < up[0]; ++i1) {
+      for (auto j1 = lo[1]; j1 < up[1]; ++j1) {
+        const auto *left_ptr =
+            left.data() + ((i1 - lo[0]) * left_ext[1] + (j1 - lo[1])) * npq;
+        for (auto i2 = lo[2]; i2 < up[2]; ++i2) {
+          for (auto j2 = lo[3]; j2 < up[3]; ++j2) {
+            if (!((i1 == i2 && j1 == j2) || (i1 == j2 && j1 == i2))) continue;
+            const auto *right_ptr =
+                right.data() +
+                ((i2 - lo[2]) * right_ext[1] + (j2 - lo[3])) * npq;
+            typename Tile::numeric_type value = 0;
+            for (std::size_t pq = 0; pq < npq; ++pq) {
+              value += left_ptr[pq] * right_ptr[pq];
+            }
+            result(i1, j1, i2, j2) += value;
+          }
+        }
+      }
+    }
+  }
+};
+
+/**
+ * computes only the ijij and ijji elements of
+ * \f$ \sum_{pq} L_{i_1 j_1}^{pq} R_{i_2 j_2}^{pq} \f$, i.e. the O(o^2) dot
+ * products of the pair slices of \c left and \c right, rather than
+ * the full contraction
+ * @param left L("i1,j1,p,q")
+ * @param right R("i2,j2,p,q")
+ * @param ijij_ijji_shape SparseShape that has ijij ijji shape
+ * @return the ijij and ijji elements of L * R, (i1,j1,i2,j2)
+ */
+template <typename Tile>
+TA::DistArray<Tile, TA::SparsePolicy> pair_diagonal_contract(
+    const TA::DistArray<Tile, TA::SparsePolicy> &left,
+    const TA::DistArray<Tile, TA::SparsePolicy> &right,
+    const TA::SparseShape<float> &ijij_ijji_shape) {
+  auto &world = left.world();
+  const auto &left_tr = left.trange().data();
+  const auto &right_tr = right.trange().data();
+  TA_ASSERT(left_tr[2] == right_tr[2] && left_tr[3] == right_tr[3]);
+
+  TA::TiledRange trange{left_tr[0], left_tr[1], right_tr[0], right_tr[1]};
+  TA::DistArray<Tile, TA::SparsePolicy> result(world, trange, ijij_ijji_shape);
+
+  const auto np = left_tr[2].tiles_range().second;
+  const auto nq = left_tr[3].tiles_range().second;
+
+  for (const auto ord : *result.pmap()) {
+    if (result.is_zero(ord)) continue;
+    const auto idx = trange.tiles_range().idx(ord);
+
+    PairDiagonalDot<Tile> op(trange.make_tile_range(ord));
+    TA::detail::ReducePairTask<decltype(op)> reduce_pair_task(world, op);
+
+    std::array<std::size_t, 4> left_idx{{idx[0], idx[1], 0, 0}};
+    std::array<std::size_t, 4> right_idx{{idx[2], idx[3], 0, 0}};
+    for (std::size_t p = 0; p < np; ++p) {
+      left_idx[2] = right_idx[2] = p;
+      for (std::size_t q = 0; q < nq; ++q) {
+        left_idx[3] = right_idx[3] = q;
+        if (left.is_zero(left_idx) || right.is_zero(right_idx)) continue;
+        reduce_pair_task.add(left.find(left_idx), right.find(right_idx));
+      }
+    }
+    result.set(ord, reduce_pair_task.submit());
+  }
+
+  return result;
+}
+
+}  // namespace detail
+
 /**
  * MP2-F12 C approach V term with Density Fitting, only ijij ijji part is
  * computed
@@ -50,11 +156,12 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_V_ijij_ijji_df(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|G|p q>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|p q>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|G|p q>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|p q>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    V_ijij_ijji("i1,j1,i2,j2") -= (left * right).set_shape(shape);
+    V_ijij_ijji("i1,j1,i2,j2") -=
+        detail::pair_diagonal_contract(left, right, shape)("i1,j1,i2,j2");
     V_ijij_ijji.truncate();
     auto time1 = mpqc::now(world, accurate_time);
     auto time = mpqc::duration_in_s(time0, time1);
@@ -62,12 +169,11 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_V_ijij_ijji_df(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|G|m a'>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|m a'>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|G|m a'>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|m a'>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    TA::DistArray<Tile, TA::SparsePolicy> tmp;
-    tmp("i1,j1,i2,j2") = (left * right).set_shape(shape);
+    auto tmp = detail::pair_diagonal_contract(left, right, shape);
     tmp.truncate();
     V_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
     V_ijij_ijji("i1,j1,i2,j2") -= tmp("j1,i1,j2,i2");
@@ -115,11 +221,12 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_V_ijij_ijji(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|G|p q>");
-    auto right = lcao_factory(L"<i2 j2|R|p q>");
+    auto left = lcao_factory.compute(L"<i1 j1|G|p q>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|p q>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    V_ijij_ijji("i1,j1,i2,j2") -= (left * right).set_shape(shape);
+    V_ijij_ijji("i1,j1,i2,j2") -=
+        detail::pair_diagonal_contract(left, right, shape)("i1,j1,i2,j2");
     V_ijij_ijji.truncate();
     auto time1 = mpqc::now(world, accurate_time);
     auto time = mpqc::duration_in_s(time0, time1);
@@ -127,12 +234,11 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_V_ijij_ijji(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|G|m a'>");
-    auto right = lcao_factory(L"<i2 j2|R|m a'>");
+    auto left = lcao_factory.compute(L"<i1 j1|G|m a'>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|m a'>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    TA::DistArray<Tile, TA::SparsePolicy> tmp;
-    tmp("i1,j1,i2,j2") = (left * right).set_shape(shape);
+    auto tmp = detail::pair_diagonal_contract(left, right, shape);
     tmp.truncate();
     V_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
     V_ijij_ijji("i1,j1,i2,j2") -= tmp("j1,i1,j2,i2");
@@ -181,11 +287,12 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_X_ijij_ijji_df(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|p q>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|p q>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|p q>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|p q>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    X_ijij_ijji("i1,j1,i2,j2") -= (left * right).set_shape(ijij_ijji_shape);
+    X_ijij_ijji("i1,j1,i2,j2") -= detail::pair_diagonal_contract(
+        left, right, ijij_ijji_shape)("i1,j1,i2,j2");
     X_ijij_ijji.truncate();
     auto time1 = mpqc::now(world, accurate_time);
     auto time = mpqc::duration_in_s(time0, time1);
@@ -193,12 +300,11 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_X_ijij_ijji_df(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|m a'>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|m a'>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|m a'>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|m a'>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    TA::DistArray<Tile, TA::SparsePolicy> tmp;
-    tmp("i1,j1,i2,j2") = (left * right).set_shape(ijij_ijji_shape);
+    auto tmp = detail::pair_diagonal_contract(left, right, ijij_ijji_shape);
     tmp.truncate();
     X_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
     X_ijij_ijji("i1,j1,i2,j2") -= tmp("j1,i1,j2,i2");
@@ -245,11 +351,12 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_X_ijij_ijji(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|p q>");
-    auto right = lcao_factory(L"<i2 j2|R|p q>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|p q>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|p q>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    X_ijij_ijji("i1,j1,i2,j2") -= (left * right).set_shape(ijij_ijji_shape);
+    X_ijij_ijji("i1,j1,i2,j2") -= detail::pair_diagonal_contract(
+        left, right, ijij_ijji_shape)("i1,j1,i2,j2");
     X_ijij_ijji.truncate();
     auto time1 = mpqc::now(world, accurate_time);
     auto time = mpqc::duration_in_s(time0, time1);
@@ -257,12 +364,11 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_X_ijij_ijji(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|m a'>");
-    auto right = lcao_factory(L"<i2 j2|R|m a'>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|m a'>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|m a'>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    TA::DistArray<Tile, TA::SparsePolicy> tmp;
-    tmp("i1,j1,i2,j2") = (left * right).set_shape(ijij_ijji_shape);
+    auto tmp = detail::pair_diagonal_contract(left, right, ijij_ijji_shape);
     tmp.truncate();
     X_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
     X_ijij_ijji("i1,j1,i2,j2") -= tmp("j1,i1,j2,i2");
@@ -333,12 +439,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_C_df(
   lcao_factory.purge_formula(L"<i1 j1|R2|P' j2>[df]");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|Q' P'>[df]");
-    auto middle = lcao_factory(L"<P'|K|R'>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|Q' R'>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|Q' P'>[df]");
+    auto middle = lcao_factory.compute(L"<P'|K|R'>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|Q' R'>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,a,c") * middle("c,b");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -351,12 +459,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_C_df(
   lcao_factory.purge_formula(L"<i1 j1|R|P' Q'>[df]");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|P' m>[df]");
-    auto middle = lcao_factory(L"<P'|F|R'>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|R' m>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|P' m>[df]");
+    auto middle = lcao_factory.compute(L"<P'|F|R'>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|R' m>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -369,13 +479,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_C_df(
   lcao_factory.purge_formula(L"<i1 j1|R|P' m>[df]");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|m b'>[df]");
-    auto middle = lcao_factory(L"<m|F|P'>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|P' b'>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|m b'>[df]");
+    auto middle = lcao_factory.compute(L"<m|F|P'>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|P' b'>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") =
-        (2.0 * left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = 2.0 * left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("j1,i1,j2,i2");
@@ -389,12 +500,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_C_df(
   lcao_factory.registry().purge_index(L"P'");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|p a>[df]");
-    auto middle = lcao_factory(L"<p|F|r>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|r a>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|p a>[df]");
+    auto middle = lcao_factory.compute(L"<p|F|r>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|r a>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -405,12 +518,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_C_df(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|m b'>[df]");
-    auto middle = lcao_factory(L"<m|F|n>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|n b'>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|m b'>[df]");
+    auto middle = lcao_factory.compute(L"<m|F|n>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|n b'>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") += tmp("i1,j1,i2,j2");
@@ -421,13 +536,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_C_df(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|p a>[df]");
-    auto middle = lcao_factory(L"<p|F|a'>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|a' a>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|p a>[df]");
+    auto middle = lcao_factory.compute(L"<p|F|a'>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|a' a>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") =
-        (2.0 * left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = 2.0 * left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -508,12 +624,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_D_df(
   lcao_factory.purge_formula(L"<i1 j1|R2|P' j2>[df]");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|P' q>[df]");
-    auto middle = lcao_factory(L"<q|K|r>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|P' r>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|P' q>[df]");
+    auto middle = lcao_factory.compute(L"<q|K|r>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|P' r>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,a,c") * middle("c,b");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -526,12 +644,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_D_df(
   lcao_factory.purge_formula(L"<i1 j1|R|P' q>[df]");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|P' m>[df]");
-    auto middle = lcao_factory(L"<P'|hJ|R'>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|R' m>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|P' m>[df]");
+    auto middle = lcao_factory.compute(L"<P'|hJ|R'>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|R' m>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -545,12 +665,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_D_df(
   lcao_factory.registry().purge_index(L"P'");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|m p>[df]");
-    auto middle = lcao_factory(L"<p|K|q>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|m q>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|m p>[df]");
+    auto middle = lcao_factory.compute(L"<p|K|q>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|m q>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,a,c") * middle("c,b");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") += tmp("i1,j1,i2,j2");
@@ -564,12 +686,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_D_df(
   lcao_factory.purge_formula(L"<i1 j1|R|m p>[df]");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|p a>[df]");
-    auto middle = lcao_factory(L"<p|F|r>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|r a>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|p a>[df]");
+    auto middle = lcao_factory.compute(L"<p|F|r>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|r a>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -580,12 +704,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_D_df(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|m b'>[df]");
-    auto middle = lcao_factory(L"<m|F|n>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|n b'>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|m b'>[df]");
+    auto middle = lcao_factory.compute(L"<m|F|n>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|n b'>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -596,13 +722,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_D_df(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|p a>[df]");
-    auto middle = lcao_factory(L"<p|F|a'>[df]");
-    auto right = lcao_factory(L"<i2 j2|R|a' a>[df]");
+    auto left = lcao_factory.compute(L"<i1 j1|R|p a>[df]");
+    auto middle = lcao_factory.compute(L"<p|F|a'>[df]");
+    auto right = lcao_factory.compute(L"<i2 j2|R|a' a>[df]");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") =
-        (2.0 * left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = 2.0 * left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -677,12 +804,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_C(
   lcao_factory.purge_formula(L"<i1 j1|R2|P' j2>");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|P' Q'>");
-    auto middle = lcao_factory(L"<P'|K|R'>");
-    auto right = lcao_factory(L"<i2 j2|R|R' Q'>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|P' Q'>");
+    auto middle = lcao_factory.compute(L"<P'|K|R'>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|R' Q'>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -695,12 +824,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_C(
   lcao_factory.purge_formula(L"<i1 j1|R|P' Q'>");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|P' m>");
-    auto middle = lcao_factory(L"<P'|F|R'>");
-    auto right = lcao_factory(L"<i2 j2|R|R' m>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|P' m>");
+    auto middle = lcao_factory.compute(L"<P'|F|R'>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|R' m>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -713,13 +844,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_C(
   lcao_factory.purge_formula(L"<i1 j1|R|P' m>");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|m b'>");
-    auto middle = lcao_factory(L"<m|F|P'>");
-    auto right = lcao_factory(L"<i2 j2|R|P' b'>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|m b'>");
+    auto middle = lcao_factory.compute(L"<m|F|P'>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|P' b'>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") =
-        (2.0 * left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = 2.0 * left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("j1,i1,j2,i2");
@@ -733,12 +865,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_C(
   lcao_factory.registry().purge_index(L"P'");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|p a>");
-    auto middle = lcao_factory(L"<p|F|r>");
-    auto right = lcao_factory(L"<i2 j2|R|r a>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|p a>");
+    auto middle = lcao_factory.compute(L"<p|F|r>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|r a>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -749,12 +883,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_C(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|m b'>");
-    auto middle = lcao_factory(L"<m|F|n>");
-    auto right = lcao_factory(L"<i2 j2|R|n b'>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|m b'>");
+    auto middle = lcao_factory.compute(L"<m|F|n>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|n b'>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") += tmp("i1,j1,i2,j2");
@@ -765,13 +901,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_C(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|p a>");
-    auto middle = lcao_factory(L"<p|F|a'>");
-    auto right = lcao_factory(L"<i2 j2|R|a' a>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|p a>");
+    auto middle = lcao_factory.compute(L"<p|F|a'>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|a' a>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") =
-        (2.0 * left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = 2.0 * left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -844,12 +981,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_D(
   lcao_factory.purge_formula(L"<i1 j1|R2|P' j2>");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|P' q>");
-    auto middle = lcao_factory(L"<q|K|r>");
-    auto right = lcao_factory(L"<i2 j2|R|P' r>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|P' q>");
+    auto middle = lcao_factory.compute(L"<q|K|r>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|P' r>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,a,c") * middle("c,b");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -862,12 +1001,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_D(
   lcao_factory.purge_formula(L"<i1 j1|R|P' q>");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|P' m>");
-    auto middle = lcao_factory(L"<P'|hJ|R'>");
-    auto right = lcao_factory(L"<i2 j2|R|R' m>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|P' m>");
+    auto middle = lcao_factory.compute(L"<P'|hJ|R'>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|R' m>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -881,12 +1022,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_D(
   lcao_factory.registry().purge_index(L"P'");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|m p>");
-    auto middle = lcao_factory(L"<p|K|q>");
-    auto right = lcao_factory(L"<i2 j2|R|m q>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|m p>");
+    auto middle = lcao_factory.compute(L"<p|K|q>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|m q>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,a,c") * middle("c,b");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") += tmp("i1,j1,i2,j2");
@@ -900,12 +1043,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_D(
   lcao_factory.purge_formula(L"<i1 j1|R|m p>");
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|p a>");
-    auto middle = lcao_factory(L"<p|F|r>");
-    auto right = lcao_factory(L"<i2 j2|R|r a>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|p a>");
+    auto middle = lcao_factory.compute(L"<p|F|r>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|r a>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -916,12 +1061,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_D(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|m b'>");
-    auto middle = lcao_factory(L"<m|F|n>");
-    auto right = lcao_factory(L"<i2 j2|R|n b'>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|m b'>");
+    auto middle = lcao_factory.compute(L"<m|F|n>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|n b'>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") = (left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
@@ -932,13 +1079,14 @@ TA::DistArray<Tile, TA::SparsePolicy> compute_B_ijij_ijji_D(
   }
 
   {
-    auto left = lcao_factory(L"<i1 j1|R|p a>");
-    auto middle = lcao_factory(L"<p|F|a'>");
-    auto right = lcao_factory(L"<i2 j2|R|a' a>");
+    auto left = lcao_factory.compute(L"<i1 j1|R|p a>");
+    auto middle = lcao_factory.compute(L"<p|F|a'>");
+    auto right = lcao_factory.compute(L"<i2 j2|R|a' a>");
 
     auto time0 = mpqc::now(world, accurate_time);
-    tmp("i1,j1,i2,j2") =
-        (2.0 * left * middle * right).set_shape(ijij_ijji_shape);
+    TA::DistArray<Tile, TA::SparsePolicy> left_middle;
+    left_middle("i1,j1,a,b") = 2.0 * left("i1,j1,c,b") * middle("c,a");
+    tmp = detail::pair_diagonal_contract(left_middle, right, ijij_ijji_shape);
     tmp.truncate();
 
     B_ijij_ijji("i1,j1,i2,j2") -= tmp("i1,j1,i2,j2");
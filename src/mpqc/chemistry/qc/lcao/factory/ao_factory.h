@@ -133,10 +133,28 @@ class AOFactory : public AOFactoryBase<Tile, Policy> {
 
   DirectTArray compute_direct(const Formula& formula) override;
 
+  /**
+   * computes the three-center AO integral \c formula with the ket index at
+   * position \c tform_index (1 or 2) transformed by \c coefs, e.g.
+   * \c (X|Op|i q) for \c tform_index = 1, without forming the AO integrals;
+   * the result is not stored in the registry
+   * @param formula the three-center AO Formula
+   * @param tform_index the position of the transformed index
+   * @param coefs the AO-by-MO coefficients of the transformed index
+   */
+  TArray compute_transformed3(const Formula& formula, std::size_t tform_index,
+                              const TArray& coefs);
+
   const std::string& screen() const { return screen_; }
 
   double screen_threshold() const { return screen_threshold_; }
 
+  /// @return the cache of the CADF local metric factorizations, reused by the
+  /// CADF coefficient builds of this factory, e.g. at successive geometries
+  lcao::detail::CADFMetricCache& cadf_metric_cache() {
+    return *cadf_metric_cache_;
+  }
+
  private:
   /// compute integrals that has two dimension
   TArray compute2(const Formula& formula_string);
@@ -270,6 +288,10 @@ class AOFactory : public AOFactoryBase<Tile, Policy> {
 
   /// if do iterative inverse square root
   bool iterative_inv_sqrt_;
+
+  /// the factorizations of the CADF local metrics
+  std::shared_ptr<lcao::detail::CADFMetricCache> cadf_metric_cache_ =
+      std::make_shared<lcao::detail::CADFMetricCache>();
 };
 
 #if TA_DEFAULT_POLICY == 0
@@ -483,7 +483,8 @@ AOFactory<Tile, Policy>::compute_cadf_coeffs(const Formula& formula) {
   auto obs = detail::index_to_basis(basis_registry, mu_nu_index[0]);
   auto dfbs = detail::index_to_basis(basis_registry, Xindex[0]);
 
-  auto C = cadf_fitting_coefficients<Tile, Policy>(world, *obs, *dfbs);
+  auto C = cadf_fitting_coefficients<Tile, Policy>(world, *obs, *dfbs,
+                                                   cadf_metric_cache_.get());
 
   time1 = mpqc::now(world, this->accurate_time_);
   time += mpqc::duration_in_s(time0, time1);
@@ -747,6 +748,48 @@ AOFactory<Tile, Policy>::compute_direct3(const Formula& formula) {
   return result;
 }
 
+template <typename Tile, typename Policy>
+typename AOFactory<Tile, Policy>::TArray
+AOFactory<Tile, Policy>::compute_transformed3(const Formula& formula,
+                                              std::size_t tform_index,
+                                              const TArray& coefs) {
+  TA_USER_ASSERT(tform_index == 1 || tform_index == 2,
+                 "Only ket indices of three center integrals can be "
+                 "transformed");
+  double time = 0.0;
+  mpqc::time_point time0;
+  mpqc::time_point time1;
+  auto& world = this->world();
+  time0 = mpqc::now(world, this->accurate_time_);
+
+  BasisVector bs_array;
+  std::shared_ptr<utility::TSPool<libint2::Engine>> engine_pool;
+  std::shared_ptr<Screener> p_screener = std::make_shared<Screener>(Screener{});
+
+  parse_two_body_three_center(formula, engine_pool, bs_array, p_screener);
+
+  // the coefficients are small, replicate them
+  auto coefs_eig =
+      std::make_shared<const RowMatrixXd>(math::array_to_eigen(coefs));
+  TA_ASSERT(coefs_eig->rows() == bs_array[tform_index].nfunctions());
+
+  TArray result = transformed_integrals<Tile, Policy>(
+      world, engine_pool, bs_array, coefs_eig, coefs.trange().data()[1],
+      tform_index, p_screener, op_);
+
+  time1 = mpqc::now(world, this->accurate_time_);
+  time += mpqc::duration_in_s(time0, time1);
+
+  if(this->verbose_){
+    ExEnv::out0() << indent << "Computed Transformed Twobody Three Center Integral: "
+                  << utility::to_string(formula.string());
+    double size = mpqc::detail::array_size(result);
+    ExEnv::out0() << " Size: " << size << " GB Time: " << time << " s" << std::endl;
+  }
+
+  return result;
+}
+
 template <typename Tile, typename Policy>
 typename AOFactory<Tile, Policy>::DirectTArray
 AOFactory<Tile, Policy>::compute_direct4(const Formula& formula) {
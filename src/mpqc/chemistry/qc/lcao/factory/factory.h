@@ -36,6 +36,8 @@ class Factory : virtual public DescribedClass {
    *  |wfn_world| WavefunctionWorld | none | WavefunctionWorld object |
    *  | verbose | bool | false | if true, it will do verbose printing |
    *  |accurate_time|bool|false|if true, do fence at timing|
+   *  |registry_memory_limit|real|0|memory budget (in GB per process) for the integrals of rank 3 and higher kept in the registry; past the budget the least recently used integrals are spilled to disk and reloaded when needed; 0 means no limit|
+   *  |registry_scratch_dir|string|/tmp|the directory (preferably node-local) for the integrals spilled by the registry|
    */
   // clang-format on
 
@@ -55,6 +57,15 @@ class Factory : virtual public DescribedClass {
     verbose_ = kv.value<bool>(prefix + "verbose", false);
     registry_.set_verbose(verbose_);
     direct_registry_.set_verbose(verbose_);
+
+    const auto memory_limit =
+        kv.value<double>(prefix + "registry_memory_limit", 0.0);
+    if (memory_limit < 0.0)
+      throw InputError("registry_memory_limit cannot be negative", __FILE__,
+                       __LINE__, "registry_memory_limit");
+    const auto scratch_dir =
+        kv.value<std::string>(prefix + "registry_scratch_dir", "/tmp");
+    registry_.set_memory_limit(std::size_t(memory_limit * 1.0e9), scratch_dir);
   }
 
   /// @return MADNESS world
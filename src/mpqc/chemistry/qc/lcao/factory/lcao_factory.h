@@ -78,6 +78,9 @@ class LCAOFactory : public LCAOFactoryBase<Tile, Policy> {
    * KeyVal options
    * @param accurate_time if true, do fence when timing (default=false)
    * @param keep_partial_transform if true, use strength reduction (default=false)
+   * @param fuse_ao_transform if true, the first transformation of 3-center
+   * integrals is done while computing the AO integrals, so the AO tiles are
+   * never formed (default=false)
    *
    */
   LCAOFactory(const KeyVal& kv)
@@ -89,6 +92,7 @@ class LCAOFactory : public LCAOFactoryBase<Tile, Policy> {
     }
     keep_partial_transforms_ =
         kv.value<bool>(prefix + "keep_partial_transform", true);
+    fuse_ao_transform_ = kv.value<bool>(prefix + "fuse_ao_transform", false);
 
     auto orbital_space_registry =
         std::make_shared<OrbitalSpaceRegistry<TArray>>();
@@ -98,6 +102,8 @@ class LCAOFactory : public LCAOFactoryBase<Tile, Policy> {
     ExEnv::out0() << "\nConstructing LCAOFactory: \n"
                   << indent << "Keep partial transform = "
                   << (keep_partial_transforms_ ? "true" : "false") << "\n"
+                  << indent << "Fuse AO transform = "
+                  << (fuse_ao_transform_ ? "true" : "false") << "\n"
                   << indent << "Accurate time = "
                   << (this->accurate_time_ ? "true" : "false") << "\n"
                   << indent
@@ -175,6 +181,8 @@ class LCAOFactory : public LCAOFactoryBase<Tile, Policy> {
 
   bool keep_partial_transforms_;  //!< if true, keep partially-transformed ints
                                   //!(false by default)
+  bool fuse_ao_transform_;  //!< if true, transform 3-center AO ints on the fly
+                            //!(true by default)
 };
 
 template <typename Tile, typename Policy>
@@ -289,20 +297,40 @@ typename LCAOFactory<Tile, Policy>::TArray LCAOFactory<Tile, Policy>::compute3(
       // get AO
       auto ao_formula =
           detail::lcao_to_ao(formula_string, this->orbital_registry());
-      auto ao_integral = ao_factory_->compute_direct(ao_formula);
-
-      time0 = mpqc::now(world, this->accurate_time_);
 
       // transform to MO, only convert the right side
       auto right_index1 = formula_string.ket_indices()[0];
-      if (right_index1.is_lcao()) {
-        auto& right1 = this->orbital_registry().retrieve(right_index1);
-        result("K,i,q") = ao_integral("K,p,q") * right1("p,i");
-      }
       auto right_index2 = formula_string.ket_indices()[1];
-      if (right_index2.is_lcao()) {
-        auto& right2 = this->orbital_registry().retrieve(right_index2);
-        result("K,p,j") = result("K,p,q") * right2("q,j");
+      if (fuse_ao_transform_ &&
+          (right_index1.is_lcao() || right_index2.is_lcao())) {
+        // do the first transformation while computing the AO integrals
+        time0 = mpqc::now(world, this->accurate_time_);
+        if (right_index1.is_lcao()) {
+          auto& right1 = this->orbital_registry().retrieve(right_index1);
+          result = ao_factory_->compute_transformed3(ao_formula, 1,
+                                                     right1.coefs());
+          if (right_index2.is_lcao()) {
+            auto& right2 = this->orbital_registry().retrieve(right_index2);
+            result("K,p,j") = result("K,p,q") * right2("q,j");
+          }
+        } else {
+          auto& right2 = this->orbital_registry().retrieve(right_index2);
+          result = ao_factory_->compute_transformed3(ao_formula, 2,
+                                                     right2.coefs());
+        }
+      } else {
+        auto ao_integral = ao_factory_->compute_direct(ao_formula);
+
+        time0 = mpqc::now(world, this->accurate_time_);
+
+        if (right_index1.is_lcao()) {
+          auto& right1 = this->orbital_registry().retrieve(right_index1);
+          result("K,i,q") = ao_integral("K,p,q") * right1("p,i");
+        }
+        if (right_index2.is_lcao()) {
+          auto& right2 = this->orbital_registry().retrieve(right_index2);
+          result("K,p,j") = result("K,p,q") * right2("q,j");
+        }
       }
     } else {  // tform to optimally reduce strength, store partial transform
               // results
@@ -339,9 +367,17 @@ typename LCAOFactory<Tile, Policy>::TArray LCAOFactory<Tile, Policy>::compute3(
                        reduced_index.to_ta_expression() +
                        std::to_string(reduced_index_absrank);
 
-      // compute direct three center AO
-      if (reduced_formula.is_ao() &&
+      // compute three center AO and transform it on the fly
+      if (fuse_ao_transform_ && reduced_index_absrank != 0 &&
+          reduced_formula.is_ao() &&
           !ao_factory_->registry().have(reduced_formula)) {
+        time0 = mpqc::now(world, this->accurate_time_);
+        result = ao_factory_->compute_transformed3(
+            reduced_formula, reduced_index_absrank, reduced_index_coeff);
+      }
+      // compute direct three center AO
+      else if (reduced_formula.is_ao() &&
+               !ao_factory_->registry().have(reduced_formula)) {
         auto reduced_integral = ao_factory_->compute_direct(reduced_formula);
         time0 = mpqc::now(world, this->accurate_time_);
         result(result_key) =
@@ -344,6 +344,12 @@ class PeriodicAOFactory : public PeriodicAOFactoryBase<Tile, Policy> {
     return std::make_shared<const KeyVal>(kv_);
   }
 
+  /// @return the cache of the CADF local metric factorizations, reused by the
+  /// CADF coefficient builds of this factory, e.g. at successive geometries
+  lcao::detail::CADFMetricCache &cadf_metric_cache() {
+    return *cadf_metric_cache_;
+  }
+
  private:
   /// compute integrals that has two dimensions for periodic systems
   TArray compute2(const Formula &formula);
@@ -482,6 +488,10 @@ class PeriodicAOFactory : public PeriodicAOFactoryBase<Tile, Policy> {
   shellpair_list_t sig_shellpair_list_;
 
   libint2::any libint2_oper_params_;
+
+  /// the factorizations of the CADF local metrics
+  std::shared_ptr<lcao::detail::CADFMetricCache> cadf_metric_cache_ =
+      std::make_shared<lcao::detail::CADFMetricCache>();
 };
 
 template <typename Tile, typename Policy>
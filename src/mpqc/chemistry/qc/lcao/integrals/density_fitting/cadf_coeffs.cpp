@@ -4,6 +4,7 @@
 
 #include "cadf_coeffs.h"
 
+#include <cmath>
 #include <fstream>
 
 namespace mpqc {
@@ -29,6 +30,50 @@ gaussian::Basis by_center_basis(gaussian::Basis const &in) {
   return gaussian::Basis(std::move(out));
 }
 
+std::vector<int64_t> CADFMetricCache::atom_types(
+    gaussian::Basis const &dfbs) {
+  std::lock_guard<std::mutex> lock(types_mutex_);
+
+  std::vector<int64_t> types;
+  types.reserve(dfbs.nclusters());
+  for (auto const &atom : dfbs.cluster_shells()) {
+    // everything that determines the fitting functions, except the center
+    std::vector<double> signature;
+    for (auto const &shell : atom) {
+      signature.push_back(shell.alpha.size());
+      signature.insert(signature.end(), shell.alpha.begin(), shell.alpha.end());
+      signature.push_back(shell.contr.size());
+      for (auto const &contr : shell.contr) {
+        signature.push_back(contr.l);
+        signature.push_back(contr.pure);
+        signature.insert(signature.end(), contr.coeff.begin(),
+                         contr.coeff.end());
+      }
+    }
+
+    auto it = types_.emplace(std::move(signature), int64_t(types_.size()));
+    types.push_back(it.first->second);
+  }
+
+  return types;
+}
+
+CADFMetricCache::key_type CADFMetricCache::key(
+    int64_t type_i, std::array<double, 3> const &O_i, int64_t type_j,
+    std::array<double, 3> const &O_j) const {
+  key_type key{{type_i, type_j, 0, 0, 0}};
+  for (auto xyz = 0; xyz < 3; ++xyz) {
+    key[2 + xyz] = std::llround((O_j[xyz] - O_i[xyz]) / tolerance_);
+  }
+  return key;
+}
+
+void CADFMetricCache::clear() {
+  factorizations_.clear();
+  nentries_ = 0;
+  nbytes_ = 0;
+}
+
 void print_shape(TA::Tensor<float> const &t, std::string const &file_name) {
   auto rank = t.range().rank();
   auto ext = t.range().extent_data();
@@ -170,7 +215,7 @@ std::shared_ptr<gaussian::SchwarzScreen> cadf_by_atom_screener(
 
 TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_coeffs(
     madness::World &world, gaussian::Basis const &by_cluster_obs,
-    gaussian::Basis const &by_cluster_dfbs) {
+    gaussian::Basis const &by_cluster_dfbs, CADFMetricCache *metric_cache) {
   auto obs = detail::by_center_basis(by_cluster_obs);
   auto dfbs = detail::by_center_basis(by_cluster_dfbs);
 
@@ -223,7 +268,8 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_coeffs(
   auto eri3 = direct_sparse_integrals(world, eng3, three_array, norms,
                                       std::move(screener));
 
-  return cadf_by_atom_array(M, eri3, detail::cadf_trange(obs, dfbs));
+  return cadf_by_atom_array(M, eri3, detail::cadf_trange(obs, dfbs), dfbs,
+                            metric_cache);
 }
 
 TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_coeffs(
@@ -233,7 +279,8 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_coeffs(
     gaussian::Basis const &by_cluster_dfbs, size_t const &natoms_per_uc,
     Vector3i const &lattice_range0, Vector3i const &lattice_range1,
     Vector3i const &lattice_range_df, Vector3i const &lattice_center0,
-    Vector3i const &lattice_center1, Vector3i const &lattice_center_df) {
+    Vector3i const &lattice_center1, Vector3i const &lattice_center_df,
+    CADFMetricCache *metric_cache) {
   auto &world = M.world();
 
   auto bs0 = detail::by_center_basis(by_cluster_bs0);
@@ -304,9 +351,9 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_coeffs(
                                       std::move(screener));
 
   return cadf_by_atom_array(M, eri3, detail::cadf_trange(bs0, bs1, dfbs),
-                            natoms_per_uc, lattice_range0, lattice_range1,
-                            lattice_range_df, lattice_center0, lattice_center1,
-                            lattice_center_df);
+                            dfbs, natoms_per_uc, lattice_range0,
+                            lattice_range1, lattice_range_df, lattice_center0,
+                            lattice_center1, lattice_center_df, metric_cache);
 }
 
 }  // namespace detail
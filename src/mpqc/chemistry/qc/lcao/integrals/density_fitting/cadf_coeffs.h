@@ -18,7 +18,12 @@
 
 #include <tiledarray.h>
 
+#include <array>
+#include <atomic>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <utility>
 
 namespace mpqc {
@@ -45,6 +50,125 @@ TA::SparseShape<float> cadf_shape(madness::World &world,
 // Print the shape of a tensor in matrix form
 void print_shape(TA::Tensor<float> const &t, std::string const &file_name);
 
+/*!
+ * \brief CADFMetricCache holds the pivoted QR factorizations of the local
+ * (Coulomb) fitting metrics M(ii) and M(ij ∪ ij) of the CADF coefficients.
+ *
+ * The metric of an atom pair only depends on the fitting shells of the two
+ * atoms and on their relative position, hence a factorization is keyed on the
+ * atom types, i.e. the fitting shells up to their center, and on the
+ * displacement of the atoms rounded to a tolerance. In periodic systems and in
+ * clusters of identical fragments the same metric recurs many times.
+ *
+ * A cache is owned by the caller of the CADF coefficient builds (e.g. the AO
+ * factory), which passes it to cadf_fitting_coefficients(), hence it is
+ * shared by the tasks of a build on this process and reused by later builds,
+ * e.g. at the next geometry. The keys only depend on the fitting shells and
+ * the relative positions of the atoms, so a factorization is valid for any
+ * geometry in which the pair recurs. If no cache is given, each build uses its
+ * own. The memory held by the factorizations is bounded.
+ */
+class CADFMetricCache {
+ public:
+  using qr_type = Eigen::ColPivHouseholderQR<RowMatrixXd>;
+  /// {type of atom i, type of atom j, rounded displacement of j from i}; the
+  /// type of atom j is -1 for the single atom metric M(ii)
+  using key_type = std::array<int64_t, 5>;
+
+  /*!
+   * \param tolerance displacements that round to the same multiple of \c
+   * tolerance (in bohr) share a factorization
+   * \param max_bytes the factorizations that do not fit in \c max_bytes
+   * (per process) are computed but not stored
+   */
+  explicit CADFMetricCache(double tolerance = 1.0e-8,
+                           std::size_t max_bytes = std::size_t(1) << 30)
+      : tolerance_(tolerance), max_bytes_(max_bytes) {}
+
+  /// \return the type of each atom (cluster) of the by-atom fitting basis
+  /// \c dfbs ; atoms have the same type iff their shells are identical up to
+  /// the center
+  std::vector<int64_t> atom_types(gaussian::Basis const &dfbs);
+
+  /// \return the key of the metric of the atom of type \c type_i
+  key_type key(int64_t type_i) const { return {{type_i, -1, 0, 0, 0}}; }
+
+  /// \return the key of the metric of the atoms of types \c type_i and
+  /// \c type_j centered at \c O_i and \c O_j
+  key_type key(int64_t type_i, std::array<double, 3> const &O_i,
+               int64_t type_j, std::array<double, 3> const &O_j) const;
+
+  /*!
+   * \brief finds the factorization of key \c key, or computes it as the
+   * factorization of \c metric() if not found; thread-safe
+   *
+   * The factorization is computed without holding a lock, hence tasks that
+   * miss the same key concurrently may both compute it, the first one to
+   * finish stores it.
+   * \param metric callable that returns the metric (RowMatrixXd)
+   */
+  template <typename Metric>
+  std::shared_ptr<const qr_type> find_or_factorize(key_type const &key,
+                                                   Metric &&metric) {
+    {
+      typename map_type::const_accessor acc;
+      if (factorizations_.find(acc, key)) return acc->second;
+    }
+    auto qr = std::make_shared<const qr_type>(metric());
+
+    // reserve the memory of the factorization, give up if it does not fit
+    const auto qr_bytes = bytes(*qr);
+    auto used = nbytes_.load();
+    do {
+      if (used + qr_bytes > max_bytes_) return qr;
+    } while (!nbytes_.compare_exchange_weak(used, used + qr_bytes));
+
+    typename map_type::accessor acc;
+    if (factorizations_.insert(acc, key)) {
+      acc->second = std::move(qr);
+      ++nentries_;
+    } else {
+      // stored by a concurrent task
+      nbytes_ -= qr_bytes;
+    }
+    return acc->second;
+  }
+
+  /// \return the number of stored factorizations
+  std::size_t size() const { return nentries_; }
+
+  /// \return the memory (in bytes) held by the stored factorizations
+  std::size_t nbytes() const { return nbytes_; }
+
+  /// removes all factorizations; must not be called while tasks use the cache
+  void clear();
+
+ private:
+  struct KeyHash {
+    madness::hashT operator()(key_type const &key) const {
+      return madness::hash_range(key.begin(), key.end());
+    }
+  };
+  using map_type = madness::ConcurrentHashMap<key_type,
+                                              std::shared_ptr<const qr_type>,
+                                              KeyHash>;
+
+  /// \return the memory (in bytes) held by \c qr
+  static std::size_t bytes(qr_type const &qr) {
+    return (qr.matrixQR().size() + qr.hCoeffs().size()) * sizeof(double) +
+           qr.colsPermutation().size() * sizeof(int);
+  }
+
+  double tolerance_;
+  std::size_t max_bytes_;
+  std::atomic<std::size_t> nentries_{0};
+  std::atomic<std::size_t> nbytes_{0};
+  map_type factorizations_;
+
+  std::mutex types_mutex_;
+  std::map<std::vector<double>, int64_t> types_;
+};
+
 // Creates a shape for the by cluster tensor and also a list of atom tiles in
 // each cluster tile
 TA::SparseShape<float> cadf_shape_cluster(
@@ -53,10 +177,14 @@ TA::SparseShape<float> cadf_shape_cluster(
     std::unordered_map<int64_t, std::vector<int64_t>> &c2a  // cluster to atom
 );
 
-// Function to compute the CADF coefficients in a by atom fashion
+// Function to compute the CADF coefficients in a by atom fashion, the by atom
+// fitting basis identifies the local metrics in metric_cache (if null, a cache
+// local to the build is used)
 template <typename Array, typename DirectArray>
 TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_array(
-    Array const &, DirectArray const &, TA::TiledRange const &);
+    Array const &, DirectArray const &, TA::TiledRange const &,
+    gaussian::Basis const &dfbs_by_atom,
+    CADFMetricCache *metric_cache = nullptr);
 
 /*!
  * \brief This computes the CADF coefficients C(X_Rx, μ_R0, ν_R1) in periodic
@@ -64,6 +192,7 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_array(
  * \param M 2-e 2-center integrals
  * \param eri3 2-e 3-center integrals
  * \param trange tile range of the CADF coefficients
+ * \param dfbs_by_atom by-atom basis for index X, the basis of \c M
  * \param natoms_per_uc number of atoms in a unit cell
  * \param lattice_range0 lattice range of index μ
  * \param lattice_range1 lattice range of index ν
@@ -71,23 +200,28 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_array(
  * \param lattice_center0 origin of the lattice range of index μ
  * \param lattice_center1 origin of the lattice range of index ν
  * \param lattice_center_df origin of the lattice range of index X
+ * \param metric_cache the cache of the local metric factorizations, if null
+ * a cache local to the build is used
  * \return the by-atom CADF coefficients
  */
 template <typename Array, typename DirectArray>
 TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_array(
     Array const &M, DirectArray const &eri3, TA::TiledRange const &trange,
-    size_t const &natoms_per_uc,
+    gaussian::Basis const &dfbs_by_atom, size_t const &natoms_per_uc,
     Vector3i const &lattice_range0 = Vector3i({0, 0, 0}),
     Vector3i const &lattice_range1 = Vector3i({0, 0, 0}),
     Vector3i const &lattice_range_df = Vector3i({0, 0, 0}),
     Vector3i const &lattice_center0 = Vector3i({0, 0, 0}),
     Vector3i const &lattice_center1 = Vector3i({0, 0, 0}),
-    Vector3i const &lattice_center_df = Vector3i({0, 0, 0}));
+    Vector3i const &lattice_center_df = Vector3i({0, 0, 0}),
+    CADFMetricCache *metric_cache = nullptr);
 
-// Function to compute the CADF coefficients in a by atom fashion
+// Function to compute the CADF coefficients in a by atom fashion, see
+// cadf_by_atom_array() for metric_cache
 TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_coeffs(
     madness::World &world, gaussian::Basis const &by_cluster_obs,
-    gaussian::Basis const &by_cluster_dfbs);
+    gaussian::Basis const &by_cluster_dfbs,
+    CADFMetricCache *metric_cache = nullptr);
 
 /*!
  * \brief This computes the CADF coefficients C(X_Rx, μ_R0, ν_R1) in periodic
@@ -109,6 +243,8 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_coeffs(
  * \param lattice_center0 origin of the lattice range of index μ
  * \param lattice_center1 origin of the lattice range of index ν
  * \param lattice_center_df origin of the lattice range of index X
+ * \param metric_cache the cache of the local metric factorizations, if null
+ * a cache local to the build is used
  * \return the by-atom CADF coefficients
  */
 TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_coeffs(
@@ -121,7 +257,8 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_coeffs(
     Vector3i const &lattice_range_df = Vector3i({0, 0, 0}),
     Vector3i const &lattice_center0 = Vector3i({0, 0, 0}),
     Vector3i const &lattice_center1 = Vector3i({0, 0, 0}),
-    Vector3i const &lattice_center_df = Vector3i({0, 0, 0}));
+    Vector3i const &lattice_center_df = Vector3i({0, 0, 0}),
+    CADFMetricCache *metric_cache = nullptr);
 
 /*!
  * \brief Function to convert a by-atom array C(X, μ, ν) to a by-cluster array
@@ -149,18 +286,24 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> reblock_atom_to_clusters(
     Array const &C_atom, gaussian::Basis const &bs0, gaussian::Basis const &bs1,
     gaussian::Basis const &dfbs);
 
-// Function to create the iii tiles of the coefficients
+// Function to create the iii tiles of the coefficients, the factorization of
+// M_tile is looked up in (or added to) cache under metric_key
 template <typename DirectTile, typename Tile>
 void create_ii_tile(TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> *C,
-                    DirectTile const eri3_iii, Tile M_tile, unsigned long ord);
+                    DirectTile const eri3_iii, Tile M_tile, unsigned long ord,
+                    CADFMetricCache *cache,
+                    CADFMetricCache::key_type metric_key);
 
-// Function to create the iij and jij tiles of the coefficients
+// Function to create the iij and jij tiles of the coefficients, the
+// factorization of the ij metric is looked up in (or added to) cache under
+// metric_key
 template <typename DirectTile, typename Tile>
 void create_ij_tile(TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> *C,
                     DirectTile direct_eri3_iij, DirectTile direct_eri3_jij,
                     Tile M_tile_ii, Tile M_tile_ij, Tile M_tile_ji,
                     Tile M_tile_jj, unsigned long ord_iij,
-                    unsigned long ord_jij);
+                    unsigned long ord_jij, CADFMetricCache *cache,
+                    CADFMetricCache::key_type metric_key);
 
 /*!
  * \brief Function to compute the by atom (Schwarz) screener for CADF ERI3
@@ -191,13 +334,16 @@ std::shared_ptr<gaussian::SchwarzScreen> cadf_by_atom_screener(
 
 }  // namespace detail
 
-/// Function to compute CADF fitting coefficients
+/// Function to compute CADF fitting coefficients; the factorizations of the
+/// local metrics are looked up in (and added to) \c metric_cache , if given,
+/// see detail::CADFMetricCache
 template <typename Tile, typename Policy>
 TA::DistArray<Tile, Policy> cadf_fitting_coefficients(
     madness::World &world, gaussian::Basis const &by_cluster_obs,
-    gaussian::Basis const &by_cluster_dfbs) {
-  auto by_atom_cadf =
-      detail::cadf_by_atom_coeffs(world, by_cluster_obs, by_cluster_dfbs);
+    gaussian::Basis const &by_cluster_dfbs,
+    detail::CADFMetricCache *metric_cache = nullptr) {
+  auto by_atom_cadf = detail::cadf_by_atom_coeffs(
+      world, by_cluster_obs, by_cluster_dfbs, metric_cache);
 
   return detail::reblock_atom_to_clusters(by_atom_cadf, by_cluster_obs,
                                           by_cluster_dfbs);
@@ -208,10 +354,10 @@ template <>
 inline TA::DistArray<TA::Tensor<double>, TA::DensePolicy>
 cadf_fitting_coefficients<TA::Tensor<double>, TA::DensePolicy>(
     madness::World &world, gaussian::Basis const &obs,
-    gaussian::Basis const &dfbs) {
+    gaussian::Basis const &dfbs, detail::CADFMetricCache *metric_cache) {
   auto sparse_array =
       cadf_fitting_coefficients<TA::Tensor<double>, TA::SparsePolicy>(
-          world, obs, dfbs);
+          world, obs, dfbs, metric_cache);
   return TA::to_dense(sparse_array);
 }
 
@@ -229,6 +375,8 @@ cadf_fitting_coefficients<TA::Tensor<double>, TA::DensePolicy>(
  * \param lattice_center0 origin of the lattice range of index μ
  * \param lattice_center1 origin of the lattice range of index ν
  * \param lattice_center_df origin of the lattice range of index X
+ * \param metric_cache the cache of the local metric factorizations, if null
+ * a cache local to the build is used
  * \return the by-cluster CADF coefficients
  */
 template <typename Tile, typename Policy>
@@ -241,11 +389,12 @@ TA::DistArray<Tile, Policy> cadf_fitting_coefficients(
     const Vector3i &lattice_range_df = Vector3i({0, 0, 0}),
     const Vector3i &lattice_center0 = Vector3i({0, 0, 0}),
     const Vector3i &lattice_center1 = Vector3i({0, 0, 0}),
-    const Vector3i &lattice_center_df = Vector3i({0, 0, 0})) {
+    const Vector3i &lattice_center_df = Vector3i({0, 0, 0}),
+    detail::CADFMetricCache *metric_cache = nullptr) {
   auto by_atom_cadf = detail::cadf_by_atom_coeffs(
       M, by_cluster_bs0, by_cluster_bs1, by_cluster_dfbs, natoms_per_uc,
       lattice_range0, lattice_range1, lattice_range_df, lattice_center0,
-      lattice_center1, lattice_center_df);
+      lattice_center1, lattice_center_df, metric_cache);
 
   return detail::reblock_atom_to_clusters(by_atom_cadf, by_cluster_bs0,
                                           by_cluster_bs1, by_cluster_dfbs);
@@ -474,8 +623,13 @@ secadf_by_atom_correction<TA::Tensor<double>, TA::DensePolicy>(
 namespace detail {
 template <typename Array, typename DirectArray>
 TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_array(
-    Array const &M, DirectArray const &eri3, TA::TiledRange const &trange) {
+    Array const &M, DirectArray const &eri3, TA::TiledRange const &trange,
+    gaussian::Basis const &dfbs_by_atom, CADFMetricCache *metric_cache) {
   auto &world = M.world();
+  CADFMetricCache local_cache;
+  auto &cache = metric_cache ? *metric_cache : local_cache;
+  const auto types = cache.atom_types(dfbs_by_atom);
+  auto const &df_atoms = dfbs_by_atom.cluster_shells();
   auto Cshape = eri3.array().shape();  // cadf_shape(world, trange);
 
   // Use same pmap to ensure some locality
@@ -501,7 +655,7 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_array(
 
       unsigned long ord_iii = eri3_tiles.ordinal(idx_iii);
       world.taskq.add(create_ii_tile<DirectTile, Tile>, &C, eri3_iii, M_ii,
-                      ord_iii);
+                      ord_iii, &cache, cache.key(types[i]));
     }
 
     for (auto j = 0ul; j < natoms; ++j) {
@@ -530,8 +684,11 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_array(
           auto M_ji = M.find(M_idx_ji);
           auto M_jj = M.find(M_idx_jj);
 
+          auto key = cache.key(types[i], df_atoms[i].front().O, types[j],
+                               df_atoms[j].front().O);
           world.taskq.add(create_ij_tile<DirectTile, Tile>, &C, eri3_iij,
-                          eri3_jij, M_ii, M_ij, M_ji, M_jj, ord_iij, ord_jij);
+                          eri3_jij, M_ii, M_ij, M_ji, M_jj, ord_iij, ord_jij,
+                          &cache, key);
         }
       }
     }
@@ -545,11 +702,17 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_array(
 template <typename Array, typename DirectArray>
 TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_array(
     Array const &M, DirectArray const &eri3, TA::TiledRange const &trange,
-    size_t const &natoms_per_uc, Vector3i const &lattice_range0,
-    Vector3i const &lattice_range1, Vector3i const &lattice_range_df,
-    Vector3i const &lattice_center0, Vector3i const &lattice_center1,
-    Vector3i const &lattice_center_df) {
+    gaussian::Basis const &dfbs_by_atom, size_t const &natoms_per_uc,
+    Vector3i const &lattice_range0, Vector3i const &lattice_range1,
+    Vector3i const &lattice_range_df, Vector3i const &lattice_center0,
+    Vector3i const &lattice_center1, Vector3i const &lattice_center_df,
+    CADFMetricCache *metric_cache) {
   auto &world = M.world();
+  // the metrics of translated atom pairs are the same, they are factorized once
+  CADFMetricCache local_cache;
+  auto &cache = metric_cache ? *metric_cache : local_cache;
+  const auto types = cache.atom_types(dfbs_by_atom);
+  auto const &df_atoms = dfbs_by_atom.cluster_shells();
 
   auto Cshape = eri3.array().shape();  // cadf_shape(world, trange);
 
@@ -592,7 +755,7 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_array(
 
         unsigned long ord_iii = eri3_tiles.ordinal(idx_iii);
         world.taskq.add(create_ii_tile<DirectTile, Tile>, &C, eri3_iii, M_ii,
-                        ord_iii);
+                        ord_iii, &cache, cache.key(types[i_in_df]));
       }
     }
 
@@ -628,8 +791,12 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_array(
           auto M_ji = M.find(M_idx_ji);
           auto M_jj = M.find(M_idx_jj);
 
+          auto key =
+              cache.key(types[i_in_df], df_atoms[i_in_df].front().O,
+                        types[j_in_df], df_atoms[j_in_df].front().O);
           world.taskq.add(create_ij_tile<DirectTile, Tile>, &C, eri3_iij,
-                          eri3_jij, M_ii, M_ij, M_ji, M_jj, ord_iij, ord_jij);
+                          eri3_jij, M_ii, M_ij, M_ji, M_jj, ord_iij, ord_jij,
+                          &cache, key);
         }
       }
     }
@@ -645,17 +812,22 @@ TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> cadf_by_atom_array(
 
 template <typename DirectTile, typename Tile>
 void create_ii_tile(TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> *C,
-                    DirectTile eri3_iii, Tile M_tile, unsigned long ord) {
+                    DirectTile eri3_iii, Tile M_tile, unsigned long ord,
+                    CADFMetricCache *cache,
+                    CADFMetricCache::key_type metric_key) {
   TA::Tensor<double> eri3_tile = eri3_iii.operator TA::Tensor<double>();
   auto eri3_extent = eri3_tile.range().extent();
   RowMatrixXd eri3_eig =
       TA::eigen_map(eri3_tile, eri3_extent[0], eri3_extent[1] * eri3_extent[2]);
 
-  auto M_extent = M_tile.range().extent();
-  RowMatrixXd M_eig = TA::eigen_map(M_tile, M_extent[0], M_extent[1]);
+  auto make_M = [&M_tile]() -> RowMatrixXd {
+    auto M_extent = M_tile.range().extent();
+    return TA::eigen_map(M_tile, M_extent[0], M_extent[1]);
+  };
 
   // Use pivoted QR for stablility reasons.
-  RowMatrixXd out_eig = M_eig.colPivHouseholderQr().solve(eri3_eig);
+  auto qr = cache->find_or_factorize(metric_key, make_M);
+  RowMatrixXd out_eig = qr->solve(eri3_eig);
   TA::TensorD out_tile(eri3_tile.range(), 0.0);
 
   TA::eigen_map(out_tile, eri3_extent[0], eri3_extent[1] * eri3_extent[2]) =
@@ -669,7 +841,8 @@ void create_ij_tile(TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> *C,
                     DirectTile direct_eri3_iij, DirectTile direct_eri3_jij,
                     Tile M_tile_ii, Tile M_tile_ij, Tile M_tile_ji,
                     Tile M_tile_jj, unsigned long ord_iij,
-                    unsigned long ord_jij) {
+                    unsigned long ord_jij, CADFMetricCache *cache,
+                    CADFMetricCache::key_type metric_key) {
   TA::Tensor<double> eri3_iij = direct_eri3_iij.operator TA::Tensor<double>();
   TA::Tensor<double> eri3_jij = direct_eri3_jij.operator TA::Tensor<double>();
 
@@ -682,31 +855,36 @@ void create_ij_tile(TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> *C,
   RowMatrixXd eri3_eig_jij = TA::eigen_map(
       eri3_jij, eri3_extent_jij[0], eri3_extent_jij[1] * eri3_extent_jij[2]);
 
-  auto M_extentii = M_tile_ii.range().extent_data();
-  auto M_extentij = M_tile_ij.range().extent_data();
-  auto M_extentji = M_tile_ji.range().extent_data();
-  auto M_extentjj = M_tile_jj.range().extent_data();
+  auto make_M_combo = [&]() -> RowMatrixXd {
+    auto M_extentii = M_tile_ii.range().extent_data();
+    auto M_extentij = M_tile_ij.range().extent_data();
+    auto M_extentji = M_tile_ji.range().extent_data();
+    auto M_extentjj = M_tile_jj.range().extent_data();
 
-  auto rows = M_extentii[0] + M_extentji[0];
-  auto cols = M_extentii[1] + M_extentij[1];
+    auto rows = M_extentii[0] + M_extentji[0];
+    auto cols = M_extentii[1] + M_extentij[1];
 
-  RowMatrixXd M_combo(rows, cols);
+    RowMatrixXd M_combo(rows, cols);
 
-  // Write Mii
-  M_combo.block(0, 0, M_extentii[0], M_extentii[1]) =
-      TA::eigen_map(M_tile_ii, M_extentii[0], M_extentii[1]);
+    // Write Mii
+    M_combo.block(0, 0, M_extentii[0], M_extentii[1]) =
+        TA::eigen_map(M_tile_ii, M_extentii[0], M_extentii[1]);
 
-  // Write Mij
-  M_combo.block(0, M_extentii[1], M_extentij[0], M_extentij[1]) =
-      TA::eigen_map(M_tile_ij, M_extentij[0], M_extentij[1]);
+    // Write Mij
+    M_combo.block(0, M_extentii[1], M_extentij[0], M_extentij[1]) =
+        TA::eigen_map(M_tile_ij, M_extentij[0], M_extentij[1]);
 
-  // Write Mji
-  M_combo.block(M_extentii[0], 0, M_extentji[0], M_extentji[1]) =
-      TA::eigen_map(M_tile_ji, M_extentji[0], M_extentji[1]);
+    // Write Mji
+    M_combo.block(M_extentii[0], 0, M_extentji[0], M_extentji[1]) =
+        TA::eigen_map(M_tile_ji, M_extentji[0], M_extentji[1]);
 
-  // Write Mjj
-  M_combo.block(M_extentii[0], M_extentii[1], M_extentjj[0], M_extentjj[1]) =
-      TA::eigen_map(M_tile_jj, M_extentjj[0], M_extentjj[1]);
+    // Write Mjj
+    M_combo.block(M_extentii[0], M_extentii[1], M_extentjj[0],
+                  M_extentjj[1]) =
+        TA::eigen_map(M_tile_jj, M_extentjj[0], M_extentjj[1]);
+
+    return M_combo;
+  };
 
   // Write the two eri3 tiles into one larger fused tile
   const auto combo_rows = eri3_eig_iij.rows() + eri3_eig_jij.rows();
@@ -722,7 +900,8 @@ void create_ij_tile(TA::DistArray<TA::Tensor<double>, TA::SparsePolicy> *C,
   // this was done because it turned out that LLT was not sufficent for basis
   // set exploration and specifically LLT failed for d-aug-cc-pV5Z basis on s66
   // benzene
-  RowMatrixXd C_total = M_combo.colPivHouseholderQr().solve(eri_combo);
+  auto qr = cache->find_or_factorize(metric_key, make_M_combo);
+  RowMatrixXd C_total = qr->solve(eri_combo);
 
   if (C->is_local(ord_iij)) {
     RowMatrixXd C_iij = C_total.topRows(eri3_eig_iij.rows());
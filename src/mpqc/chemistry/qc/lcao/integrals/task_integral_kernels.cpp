@@ -292,6 +292,102 @@ TA::TensorD integral_kernel(Engine &eng, TA::Range &&rng,
   return tile;
 }
 
+TA::TensorD transformed_integral_kernel(
+    Engine &eng, TA::Range &&rng, std::array<ShellVec const *, 3> shell_ptrs,
+    std::size_t tform_index, const RowMatrixXd &coefs, Screener &screen) {
+  assert((tform_index == 1 || tform_index == 2) &&
+         "transformed_integral_kernel can only transform a ket index");
+  eng.set_precision(integral_engine_precision);
+
+  auto const &lobound = rng.lobound();
+  // the transformed index runs over the whole AO basis
+  std::array<std::size_t, 3> start = {
+      {lobound[0], tform_index == 1 ? 0ul : lobound[1],
+       tform_index == 2 ? 0ul : lobound[2]}};
+
+  auto tile = TA::TensorD(std::move(rng), 0.0);
+
+  const auto &ints_shell_sets = eng.results();
+
+  auto const &sh0 = *shell_ptrs[0];
+  auto const &sh1 = *shell_ptrs[1];
+  auto const &sh2 = *shell_ptrs[2];
+  const auto end0 = sh0.size();
+  const auto end1 = sh1.size();
+  const auto end2 = sh2.size();
+
+  // infinity norm of the coefficient block of each transformed shell
+  auto const &tform_shells = *shell_ptrs[tform_index];
+  std::vector<double> coef_norms;
+  coef_norms.reserve(tform_shells.size());
+  for (auto idx = 0ul, f = 0ul; idx < tform_shells.size(); ++idx) {
+    const auto n = tform_shells[idx].size();
+    coef_norms.push_back(
+        coefs.middleRows(f, n).lpNorm<Eigen::Infinity>());
+    f += n;
+  }
+
+  auto ext = tile.range().extent_data();
+  const auto ext1 = ext[1];
+  const auto ext2 = ext[2];
+  const auto ext12 = ext1 * ext2;
+  data_pointer MADNESS_RESTRICT tile_ptr_first = tile.data();
+
+  auto lb0 = start[0];
+  for (auto idx0 = 0ul; idx0 < end0; ++idx0) {
+    auto const &s0 = sh0[idx0];
+    const auto ns0 = s0.size();
+
+    if (!screen.skip(lb0)) {
+      auto lb1 = start[1];
+      for (auto idx1 = 0ul; idx1 < end1; ++idx1) {
+        auto const &s1 = sh1[idx1];
+        const auto ns1 = s1.size();
+
+        auto lb2 = start[2];
+        for (auto idx2 = 0ul; idx2 < end2; ++idx2) {
+          auto const &s2 = sh2[idx2];
+          const auto ns2 = s2.size();
+
+          const auto coef_norm = coef_norms[tform_index == 1 ? idx1 : idx2];
+          if (coef_norm != 0.0 && !screen.skip(lb0, lb1, lb2, coef_norm)) {
+            shell_set(eng, s0, s1, s2);
+            assert(ints_shell_sets.size() == 1 &&
+                   "integral_kernel can't handle multi-shell-set engines");
+            if (ints_shell_sets[0] != nullptr) {
+              const auto ints_ptr = ints_shell_sets[0];
+              for (auto el0 = 0ul; el0 < ns0; ++el0) {
+                const auto el0_pre = ext12 * (lb0 - start[0] + el0);
+                Eigen::Map<RowMatrixXd> tile_map(tile_ptr_first + el0_pre,
+                                                 ext1, ext2);
+                Eigen::Map<const RowMatrixXd> ints_map(
+                    ints_ptr + el0 * ns1 * ns2, ns1, ns2);
+                if (tform_index == 1) {
+                  // (x|i q) += C(p,i) (x|p q)
+                  tile_map.middleCols(lb2 - start[2], ns2).noalias() +=
+                      coefs.middleRows(lb1, ns1).transpose() * ints_map;
+                } else {
+                  // (x|p j) += (x|p q) C(q,j)
+                  tile_map.middleRows(lb1 - start[1], ns1).noalias() +=
+                      ints_map * coefs.middleRows(lb2, ns2);
+                }
+              }
+            }
+          }
+
+          lb2 += ns2;
+        }  // end sh2 for
+
+        lb1 += ns1;
+      }  // end sh1 for
+    }    // end 1 shell screen
+
+    lb0 += ns0;
+  }
+
+  return tile;
+}
+
 }  // namespace detail
 }  // namespace gaussian
 }  // namespace lcao
@@ -13,6 +13,7 @@
 
 #include "mpqc/chemistry/qc/lcao/integrals/screening/screen_base.h"
 #include "mpqc/chemistry/qc/lcao/integrals/task_integrals_common.h"
+#include "mpqc/math/external/eigen/eigen.h"
 #include "mpqc/math/groups/petite_list.h"
 
 namespace mpqc {
@@ -46,6 +47,29 @@ TA::TensorD integral_kernel(Engine &eng, TA::Range &&rng,
                             std::array<ShellVec const *, 4> shell_ptrs,
                             Screener &screen, const math::PetiteList &plist);
 
+/*!
+ * @brief This computes a tile of three-center integrals in which one of the
+ * two ket AO indices is transformed on the fly, e.g. \c (X|Op|i q) for
+ * \c tform_index = 1 or \c (X|Op|p j) for \c tform_index = 2. The AO
+ * integrals are contracted with the coefficients shell set by shell set, hence
+ * the AO tile is never formed.
+ * @param eng libint2 Engine type
+ * @param rng range of the target tile, the range of the transformed index is
+ * the range of the MOs of \c coefs , e.g. all MOs
+ * @param shell_ptrs array of shell clusters \c c0, \c c1 and \c c2 as in
+ * \c (c0|Op|c1 c2) where \c shell_ptrs[tform_index] must point to all shells of
+ * the AO basis of the transformed index
+ * @param tform_index the position of the transformed index, 1 or 2
+ * @param coefs the AO-by-MO coefficients of the MO range; the shell sets whose
+ * Schwarz estimate weighted by the infinity norm of the corresponding
+ * coefficient block is below the threshold of \c screen are skipped
+ * @param screen Screener
+ * @return
+ */
+TA::TensorD transformed_integral_kernel(
+    Engine &eng, TA::Range &&rng, std::array<ShellVec const *, 3> shell_ptrs,
+    std::size_t tform_index, const RowMatrixXd &coefs, Screener &screen);
+
 /*!
  * @brief This computes an \c std::array of integrals for operators that have
  * \c nopers components, e.g. multipole moments, geometrical derivatives,
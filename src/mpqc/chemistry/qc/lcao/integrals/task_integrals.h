@@ -10,6 +10,7 @@
 #ifndef MPQC4_SRC_MPQC_CHEMISTRY_QC_INTEGRALS_TASK_INTEGRALS_H_
 #define MPQC4_SRC_MPQC_CHEMISTRY_QC_INTEGRALS_TASK_INTEGRALS_H_
 
+#include <TiledArray/pmap/cyclic_pmap.h>
 #include <TiledArray/tensor/tensor_map.h>
 #include <TiledArray/tile_op/noop.h>
 
@@ -365,6 +366,271 @@ TA::DistArray<Tile, TA::DensePolicy> dense_integrals(
   return out;
 }
 
+namespace detail {
+
+/**
+ * TransformedSlabs describes how the three-center integrals with a
+ * transformed ket index, e.g. \c (X|Op|i q), are computed: a slab is the block
+ * of the integrals for one tile of \c X and one tile of the untransformed AO
+ * index, with the whole MO index. Each slab is computed once, then split into
+ * its MO tiles. The MO index is the last index of the tiled range of the
+ * slabs, hence the cyclic pmap, with a single process column, places all MO
+ * tiles of a slab on the process that computes it.
+ */
+struct TransformedSlabs {
+  /// @param bases the AO bases {X, p, q} of the untransformed integrals
+  /// @param tr_mo the TiledRange1 of the MO index
+  /// @param tform_index the position of the transformed index, 1 or 2
+  TransformedSlabs(madness::World &world, BasisVector const &bases,
+                   TA::TiledRange1 const &tr_mo, std::size_t tform_index)
+      : tform_index(tform_index), ao_index(3 - tform_index) {
+    const auto tr_x = bases[0].create_trange1();
+    const auto tr_ao = bases[ao_index].create_trange1();
+    trange = TA::TiledRange({tr_x, tr_ao, tr_mo});
+    nao_tiles = tr_ao.tile_extent();
+    nmo_tiles = tr_mo.tile_extent();
+    nslabs = tr_x.tile_extent() * nao_tiles;
+    pmap = std::make_shared<TA::detail::CyclicPmap>(
+        world, nslabs, nmo_tiles,
+        std::min<std::size_t>(world.size(), nslabs), 1);
+  }
+
+  /// @return the range of slab \c s , its indices are in the order of the
+  /// bases, the transformed index runs over all MOs
+  TA::Range slab_range(std::size_t s) const {
+    const auto x = trange.dim(0).tile(s / nao_tiles);
+    const auto a = trange.dim(1).tile(s % nao_tiles);
+    std::vector<std::size_t> lobound(3), upbound(3);
+    lobound[0] = x.first;
+    upbound[0] = x.second;
+    lobound[ao_index] = a.first;
+    upbound[ao_index] = a.second;
+    lobound[tform_index] = 0;
+    upbound[tform_index] = trange.dim(2).elements_range().second;
+    return TA::Range(lobound, upbound);
+  }
+
+  /// @return the shells of slab \c s , \c tform_shells are all shells of the
+  /// transformed index
+  VecArray<3> slab_shells(std::size_t s, BasisVector const &bases,
+                          ShellVec const &tform_shells) const {
+    VecArray<3> result;
+    result[0] = &bases[0].cluster_shells()[s / nao_tiles];
+    result[ao_index] = &bases[ao_index].cluster_shells()[s % nao_tiles];
+    result[tform_index] = &tform_shells;
+    return result;
+  }
+
+  std::size_t tform_index;
+  std::size_t ao_index;  // the position of the untransformed AO index
+  std::size_t nao_tiles;
+  std::size_t nmo_tiles;
+  std::size_t nslabs;
+  TA::TiledRange trange;  // {X, AO, MO}
+  std::shared_ptr<TA::Pmap> pmap;
+};
+
+/// @return the tile with range \c rng (in the {X, AO, MO} order of
+/// TransformedSlabs::trange) copied from \c slab
+inline TA::TensorD slab_tile(const TA::TensorD &slab, TA::Range &&rng,
+                             std::size_t tform_index) {
+  TA::TensorD tile(std::move(rng));
+  const auto *lo = tile.range().lobound_data();
+  const auto *up = tile.range().upbound_data();
+  const auto *slab_lo = slab.range().lobound_data();
+  const auto *slab_ext = slab.range().extent_data();
+  const auto ao_index = 3 - tform_index;
+  const std::size_t stride_x = slab_ext[1] * slab_ext[2];
+  const std::size_t stride_ao = (ao_index == 1) ? slab_ext[2] : 1;
+  const std::size_t stride_mo = (tform_index == 1) ? slab_ext[2] : 1;
+
+  auto *tile_ptr = tile.data();
+  for (auto x = lo[0]; x < up[0]; ++x) {
+    for (auto a = lo[1]; a < up[1]; ++a) {
+      const auto *slab_ptr = slab.data() + (x - slab_lo[0]) * stride_x +
+                             (a - slab_lo[ao_index]) * stride_ao +
+                             lo[2] * stride_mo;
+      for (auto i = lo[2]; i < up[2]; ++i, slab_ptr += stride_mo)
+        *tile_ptr++ = *slab_ptr;
+    }
+  }
+  return tile;
+}
+
+}  // namespace detail
+
+/*! \brief Construct a sparse three-center integral tensor with one of the ket
+ * AO indices transformed to the MO basis, e.g. \c (X|Op|i q), in parallel.
+ *
+ * The integrals are accumulated directly from the libint shell sets into
+ * slabs that span the whole MO index, see detail::TransformedSlabs and
+ * detail::transformed_integral_kernel, hence each AO shell set is computed
+ * once and the AO integrals are never stored.
+ *
+ * \param shr_pool should be a std::shared_ptr to an IntegralTSPool
+ * \param bases the AO bases {X, p, q} of the untransformed integrals
+ * \param coefs the replicated AO-by-MO coefficients of the transformed index
+ * \param tr_mo the TiledRange1 of the MO index
+ * \param tform_index the position of the transformed index, 1 or 2
+ * \param screen should be a std::shared_ptr to a Screener, shell sets are
+ * screened with the estimate weighted by the norm of the coefficients
+ * \param op needs to be a function or functor that takes a TA::TensorD && and
+ * returns any valid tile type.
+ */
+template <typename Tile = TA::TensorD, typename E>
+TA::DistArray<Tile, TA::SparsePolicy> sparse_transformed_integrals(
+    madness::World &world, ShrPool<E> shr_pool, BasisVector const &bases,
+    std::shared_ptr<const RowMatrixXd> coefs, TA::TiledRange1 const &tr_mo,
+    std::size_t tform_index,
+    std::shared_ptr<Screener> screen = std::make_shared<Screener>(Screener{}),
+    std::function<Tile(TA::TensorD &&)> op = TA::detail::Noop<Tile,TA::TensorD, true>()) {
+  TA_ASSERT(bases.size() == 3);
+  TA_ASSERT(tform_index == 1 || tform_index == 2);
+  TA_ASSERT(std::size_t(coefs->cols()) == tr_mo.elements_range().second);
+
+  const detail::TransformedSlabs slabs(world, bases, tr_mo, tform_index);
+  const auto &trange = slabs.trange;
+  const auto tvolume = trange.tiles_range().volume();
+  std::vector<std::pair<unsigned long, Tile>> tiles(tvolume);
+  TA::TensorF tile_norms(trange.tiles_range(), 0.0);
+
+  const auto tform_shells = bases[tform_index].flattened_shells();
+
+  // Capture by ref since we are going to fence after loops.
+  auto task_f = [&](std::size_t s) {
+    const auto slab = detail::transformed_integral_kernel(
+        shr_pool->local(), slabs.slab_range(s),
+        slabs.slab_shells(s, bases, tform_shells), tform_index, *coefs,
+        *screen);
+
+    for (auto i = 0ul; i < slabs.nmo_tiles; ++i) {
+      const auto ord = s * slabs.nmo_tiles + i;
+      auto ta_tile = detail::slab_tile(slab, trange.make_tile_range(ord),
+                                       tform_index);
+
+      const auto tile_volume = ta_tile.range().volume();
+      const auto tile_norm = ta_tile.norm();
+
+      // Keep tile if it was significant.
+      if (tile_norm >= tile_volume * TA::SparseShape<float>::threshold()) {
+        tile_norms[ord] = tile_norm;
+        tiles[ord].second = op(std::move(ta_tile));
+      }
+    }
+  };
+
+  for (auto s = 0ul; s < slabs.nslabs; ++s) {
+    const auto first = s * slabs.nmo_tiles;
+    if (!slabs.pmap->is_local(first)) continue;
+    for (auto ord = first; ord < first + slabs.nmo_tiles; ++ord)
+      tiles[ord].first = ord;
+    world.taskq.add(task_f, s);
+  }
+  world.gop.fence();
+
+  TA::SparseShape<float> shape(world, tile_norms, trange);
+  TA::DistArray<Tile, TA::SparsePolicy> result(world, trange, shape,
+                                               slabs.pmap);
+
+  detail::set_array(tiles, result);
+  world.gop.fence();
+  result.truncate();
+  world.gop.fence();
+
+  if (tform_index == 2) return result;
+
+  // {X, q, i} -> {X, i, q}
+  TA::DistArray<Tile, TA::SparsePolicy> out;
+  out("X,i,q") = result("X,q,i");
+  world.gop.fence();
+  return out;
+}
+
+/*! \brief Construct a dense three-center integral tensor with one of the ket
+ * AO indices transformed to the MO basis, see sparse_transformed_integrals.
+ */
+template <typename Tile = TA::TensorD, typename E>
+TA::DistArray<Tile, TA::DensePolicy> dense_transformed_integrals(
+    madness::World &world, ShrPool<E> shr_pool, BasisVector const &bases,
+    std::shared_ptr<const RowMatrixXd> coefs, TA::TiledRange1 const &tr_mo,
+    std::size_t tform_index,
+    std::shared_ptr<Screener> screen = std::make_shared<Screener>(Screener{}),
+    std::function<Tile(TA::TensorD &&)> op = TA::detail::Noop<Tile,TA::TensorD, true>()) {
+  TA_ASSERT(bases.size() == 3);
+  TA_ASSERT(tform_index == 1 || tform_index == 2);
+  TA_ASSERT(std::size_t(coefs->cols()) == tr_mo.elements_range().second);
+
+  const detail::TransformedSlabs slabs(world, bases, tr_mo, tform_index);
+  const auto &trange = slabs.trange;
+  TA::DistArray<Tile, TA::DensePolicy> result(world, trange, slabs.pmap);
+
+  const auto tform_shells = bases[tform_index].flattened_shells();
+
+  // Capture by ref since we are going to fence after loops.
+  auto slab_f = [&](std::size_t s) {
+    return detail::transformed_integral_kernel(
+        shr_pool->local(), slabs.slab_range(s),
+        slabs.slab_shells(s, bases, tform_shells), tform_index, *coefs,
+        *screen);
+  };
+  auto tile_f = [&](const TA::TensorD &slab, TA::Range rng) {
+    return op(detail::slab_tile(slab, std::move(rng), tform_index));
+  };
+
+  for (auto s = 0ul; s < slabs.nslabs; ++s) {
+    const auto first = s * slabs.nmo_tiles;
+    if (!slabs.pmap->is_local(first)) continue;
+    madness::Future<TA::TensorD> slab = world.taskq.add(slab_f, s);
+    for (auto ord = first; ord < first + slabs.nmo_tiles; ++ord) {
+      madness::Future<Tile> tile =
+          world.taskq.add(tile_f, slab, trange.make_tile_range(ord));
+      result.set(ord, tile);
+    }
+  }
+  world.gop.fence();
+
+  if (tform_index == 2) return result;
+
+  // {X, q, i} -> {X, i, q}
+  TA::DistArray<Tile, TA::DensePolicy> out;
+  out("X,i,q") = result("X,q,i");
+  world.gop.fence();
+  return out;
+}
+
+
+/*
+ * interface to sparse_transformed_integrals and dense_transformed_integrals
+ */
+
+template <typename Tile, typename Policy, typename E>
+TA::DistArray<Tile, typename std::enable_if<
+                        std::is_same<Policy, TA::DensePolicy>::value,
+                        TA::DensePolicy>::type>
+transformed_integrals(
+    madness::World &world, ShrPool<E> shr_pool, BasisVector const &bases,
+    std::shared_ptr<const RowMatrixXd> coefs, TA::TiledRange1 const &tr_mo,
+    std::size_t tform_index,
+    std::shared_ptr<Screener> screen = std::make_shared<Screener>(Screener{}),
+    std::function<Tile(TA::TensorD &&)> op = TA::detail::Noop<Tile,TA::TensorD, true>()) {
+  return dense_transformed_integrals(world, shr_pool, bases, coefs, tr_mo,
+                                     tform_index, screen, op);
+};
+
+template <typename Tile, typename Policy, typename E>
+TA::DistArray<Tile, typename std::enable_if<
+                        std::is_same<Policy, TA::SparsePolicy>::value,
+                        TA::SparsePolicy>::type>
+transformed_integrals(
+    madness::World &world, ShrPool<E> shr_pool, BasisVector const &bases,
+    std::shared_ptr<const RowMatrixXd> coefs, TA::TiledRange1 const &tr_mo,
+    std::size_t tform_index,
+    std::shared_ptr<Screener> screen = std::make_shared<Screener>(Screener{}),
+    std::function<Tile(TA::TensorD &&)> op = TA::detail::Noop<Tile,TA::TensorD, true>()) {
+  return sparse_transformed_integrals(world, shr_pool, bases, coefs, tr_mo,
+                                      tform_index, screen, op);
+};
+
 }  // namespace gaussian
 }  // namespace lcao
 }  // namespace mpqc
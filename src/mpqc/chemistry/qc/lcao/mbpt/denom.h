@@ -7,7 +7,9 @@
 
 #include <tiledarray.h>
 
+#include "mpqc/chemistry/qc/lcao/mbpt/denom_kernel.h"
 #include "mpqc/math/external/eigen/eigen.h"
+#include "mpqc/util/meta/make_array.h"
 
 namespace mpqc {
 namespace lcao {
@@ -20,97 +22,21 @@ void d_abij_inplace(TA::Array<double, 4, Tile, Policy> &abij,
                     const EigenVector<typename Tile::numeric_type> &ens,
                     std::size_t n_occ, std::size_t n_frozen,
                     typename Tile::numeric_type shift = 0.0) {
-  auto convert = [&ens, n_occ, n_frozen, shift](Tile &result_tile) {
-
-    // compute index
-    const auto a0 = result_tile.range().lobound()[0];
-    const auto an = result_tile.range().upbound()[0];
-    const auto b0 = result_tile.range().lobound()[1];
-    const auto bn = result_tile.range().upbound()[1];
-    const auto i0 = result_tile.range().lobound()[2];
-    const auto in = result_tile.range().upbound()[2];
-    const auto j0 = result_tile.range().lobound()[3];
-    const auto jn = result_tile.range().upbound()[3];
-
-    auto tile_idx = 0;
-    typename Tile::numeric_type norm = 0.0;
-    for (auto a = a0; a < an; ++a) {
-      const auto e_a = shift - ens[a + n_occ];
-      for (auto b = b0; b < bn; ++b) {
-        const auto e_ab = e_a - ens[b + n_occ];
-        for (auto i = i0; i < in; ++i) {
-          const auto e_abi = e_ab + ens[i + n_frozen];
-          for (auto j = j0; j < jn; ++j, ++tile_idx) {
-            const auto e_abij = e_abi + ens[j + n_frozen];
-            const auto old = result_tile[tile_idx];
-            const auto result_abij = old / (e_abij);
-            norm += result_abij * result_abij;
-            result_tile[tile_idx] = result_abij;
-          }
-        }
-      }
-    }
-    return std::sqrt(norm);
-  };
-
-  TA::foreach_inplace(abij, convert);
-  abij.world().gop.fence();
+  const auto modes =
+      utility::make_array(uocc_mode(ens, n_occ), uocc_mode(ens, n_occ),
+                          occ_mode(ens, n_frozen), occ_mode(ens, n_frozen));
+  apply_denominator_inplace(abij, modes, shift);
 }
 
 template <typename Tile, typename Policy, typename EigenVectorX = Eigen::Matrix<typename Tile::element_type, Eigen::Dynamic, 1>>
 TA::DistArray<Tile, Policy> d_abcijk(
     TA::DistArray<Tile, Policy> &abcijk, const EigenVectorX &ens,
     std::size_t n_occ, std::size_t n_frozen) {
-  auto convert = [&ens, n_occ, n_frozen](Tile &result_tile,
-                                         const Tile &arg_tile) {
-
-    result_tile = Tile(arg_tile.range());
-
-    // compute index
-    const auto a0 = result_tile.range().lobound()[0];
-    const auto an = result_tile.range().upbound()[0];
-    const auto b0 = result_tile.range().lobound()[1];
-    const auto bn = result_tile.range().upbound()[1];
-    const auto c0 = result_tile.range().lobound()[2];
-    const auto cn = result_tile.range().upbound()[2];
-    const auto i0 = result_tile.range().lobound()[3];
-    const auto in = result_tile.range().upbound()[3];
-    const auto j0 = result_tile.range().lobound()[4];
-    const auto jn = result_tile.range().upbound()[4];
-    const auto k0 = result_tile.range().lobound()[5];
-    const auto kn = result_tile.range().upbound()[5];
-
-    auto tile_idx = 0;
-    typename Tile::scalar_type norm = 0.0;
-    for (auto a = a0; a < an; ++a) {
-      const auto e_a = ens[a + n_occ];
-      for (auto b = b0; b < bn; ++b) {
-        const auto e_b = ens[b + n_occ];
-        for (auto c = c0; c < cn; ++c) {
-          const auto e_c = ens[c + n_occ];
-          for (auto i = i0; i < in; ++i) {
-            const auto e_i = ens[i + n_frozen];
-              for (auto j = j0; j < jn; ++j) {
-                const auto e_j = ens[j + n_frozen];
-                for (auto k = k0; k < kn; ++k, ++tile_idx) {
-                  const auto e_k = ens[k + n_frozen];
-                  const auto e_iajbkc = e_i + e_j +e_k - e_a - e_b- e_c;
-                  const auto old = arg_tile[tile_idx];
-                  const auto result_abcijk = old / (e_iajbkc);
-                  norm += std::abs(result_abcijk) * std::abs(result_abcijk);
-                  result_tile[tile_idx] = result_abcijk;
-          }
-         }
-         }
-        }
-      }
-    }
-    return std::sqrt(norm);
-  };
-
-  auto result = TA::foreach (abcijk, convert);
-  abcijk.world().gop.fence();
-  return result;
+  const EigenVector<typename Tile::numeric_type> e = ens;
+  const auto modes = utility::make_array(
+      uocc_mode(e, n_occ), uocc_mode(e, n_occ), uocc_mode(e, n_occ),
+      occ_mode(e, n_frozen), occ_mode(e, n_frozen), occ_mode(e, n_frozen));
+  return apply_denominator(abcijk, modes);
 }
 
 template <typename Tile, typename Policy>
@@ -118,45 +44,10 @@ TA::DistArray<Tile, Policy> d_abij(
     const TA::DistArray<Tile, Policy> &abij,
     const EigenVector<typename Tile::numeric_type> &ens, std::size_t n_occ,
     std::size_t n_frozen, typename Tile::numeric_type shift = 0.0) {
-  auto convert = [&ens, n_occ, n_frozen, shift](Tile &result_tile,
-                                                const Tile &arg_tile) {
-
-    result_tile = Tile(arg_tile.range());
-
-    // compute index
-    const auto a0 = result_tile.range().lobound()[0];
-    const auto an = result_tile.range().upbound()[0];
-    const auto b0 = result_tile.range().lobound()[1];
-    const auto bn = result_tile.range().upbound()[1];
-    const auto i0 = result_tile.range().lobound()[2];
-    const auto in = result_tile.range().upbound()[2];
-    const auto j0 = result_tile.range().lobound()[3];
-    const auto jn = result_tile.range().upbound()[3];
-
-    auto tile_idx = 0;
-    typename Tile::numeric_type norm = 0.0;
-    for (auto a = a0; a < an; ++a) {
-      const auto e_a = shift - ens[a + n_occ];
-      for (auto b = b0; b < bn; ++b) {
-        const auto e_ab = e_a - ens[b + n_occ];
-        for (auto i = i0; i < in; ++i) {
-          const auto e_abi = e_ab + ens[i + n_frozen];
-          for (auto j = j0; j < jn; ++j, ++tile_idx) {
-            const auto e_abij = e_abi + ens[j + n_frozen];
-            const auto old = arg_tile[tile_idx];
-            const auto result_abij = old / (e_abij);
-            norm += result_abij * result_abij;
-            result_tile[tile_idx] = result_abij;
-          }
-        }
-      }
-    }
-    return std::sqrt(norm);
-  };
-
-  auto result = TA::foreach (abij, convert);
-  abij.world().gop.fence();
-  return result;
+  const auto modes =
+      utility::make_array(uocc_mode(ens, n_occ), uocc_mode(ens, n_occ),
+                          occ_mode(ens, n_frozen), occ_mode(ens, n_frozen));
+  return apply_denominator(abij, modes, shift);
 }
 
 // create matrix d("a,i") = 1/(ei - ea)
@@ -0,0 +1,235 @@
+#ifndef SRC_MPQC_CHEMISTRY_QC_LCAO_MBPT_DENOM_KERNEL_H_
+#define SRC_MPQC_CHEMISTRY_QC_LCAO_MBPT_DENOM_KERNEL_H_
+
+#include <array>
+#include <cmath>
+
+#include <tiledarray.h>
+
+#include "mpqc/math/external/eigen/eigen.h"
+
+namespace mpqc {
+namespace lcao {
+namespace detail {
+
+/**
+ * OrbitalEnergyMode maps the indices of one mode of an array to orbital
+ * energies: element index \c p of the mode corresponds to
+ * <tt>sign * ens[p + offset]</tt>. A mode without energies (\c ens is null)
+ * does not contribute to the denominator (or scaling factor).
+ */
+template <typename T>
+struct OrbitalEnergyMode {
+  const EigenVector<T> *ens = nullptr;
+  std::size_t offset = 0;
+  T sign = 1;
+
+  /// @return the signed energies of the element indices [lo, hi)
+  EigenVector<T> energies(std::size_t lo, std::size_t hi) const {
+    return sign * ens->segment(lo + offset, hi - lo);
+  }
+};
+
+/// @return the mode of occupied orbitals, which enter denominators with sign +
+template <typename T>
+OrbitalEnergyMode<T> occ_mode(const EigenVector<T> &ens,
+                              std::size_t offset = 0) {
+  return OrbitalEnergyMode<T>{&ens, offset, T(1)};
+}
+
+/// @return the mode of unoccupied orbitals, which enter denominators with
+/// sign -
+template <typename T>
+OrbitalEnergyMode<T> uocc_mode(const EigenVector<T> &ens,
+                               std::size_t offset = 0) {
+  return OrbitalEnergyMode<T>{&ens, offset, T(-1)};
+}
+
+/// @return a mode that does not contribute
+template <typename T>
+OrbitalEnergyMode<T> spectator_mode() {
+  return OrbitalEnergyMode<T>{};
+}
+
+/// result = arg / (shift + e_0 + e_1 + ...)
+struct DenominatorOp {
+  template <typename T>
+  static T identity() {
+    return T(0);
+  }
+  template <typename T>
+  static T combine(T partial, T e) {
+    return partial + e;
+  }
+  // reciprocal-multiply, both are vectorized by Eigen
+  template <typename In, typename Out, typename T, typename E>
+  static void apply(const In &in, Out &out, T partial, const E &e) {
+    out = in * (partial + e).inverse();
+  }
+};
+
+/// result = arg * f_0 * f_1 * ...
+struct ScalingOp {
+  template <typename T>
+  static T identity() {
+    return T(1);
+  }
+  template <typename T>
+  static T combine(T partial, T f) {
+    return partial * f;
+  }
+  template <typename In, typename Out, typename T, typename E>
+  static void apply(const In &in, Out &out, T partial, const E &f) {
+    out = in * (partial * f);
+  }
+};
+
+/// loops over the \c Remaining trailing modes of a row-major tile; the
+/// innermost mode is processed as a contiguous line with Eigen array
+/// operations, i.e. SIMD instructions
+template <typename Op, bool ComputeNorm, std::size_t Remaining>
+struct OrbitalEnergyLoop {
+  template <typename T, std::size_t Rank, typename S>
+  static void apply(const std::array<EigenVector<T>, Rank> &values,
+                    T partial, const T *&arg, T *&result, S &norm2) {
+    const auto &v = values[Rank - Remaining];
+    for (auto p = 0l; p < v.size(); ++p) {
+      OrbitalEnergyLoop<Op, ComputeNorm, Remaining - 1>::apply(
+          values, Op::combine(partial, v[p]), arg, result, norm2);
+    }
+  }
+};
+
+template <typename Op, bool ComputeNorm>
+struct OrbitalEnergyLoop<Op, ComputeNorm, 1> {
+  template <typename T, std::size_t Rank, typename S>
+  static void apply(const std::array<EigenVector<T>, Rank> &values,
+                    T partial, const T *&arg, T *&result, S &norm2) {
+    using array_type = Eigen::Array<T, Eigen::Dynamic, 1>;
+    const auto &v = values[Rank - 1];
+    const auto n = v.size();
+    Eigen::Map<const array_type> in(arg, n);
+    Eigen::Map<array_type> out(result, n);
+    Op::apply(in, out, partial, v.array());
+    // the line is still in cache
+    if (ComputeNorm) norm2 += out.abs2().sum();
+    arg += n;
+    result += n;
+  }
+};
+
+/**
+ * @return the per-mode values of the tile with range \c range :
+ * <tt>transform(modes[m].energies(...))</tt> for each contributing mode \c m ,
+ * a vector of <tt>Op::identity()</tt> for the others
+ */
+template <typename Op, typename T, std::size_t Rank, typename Transform>
+std::array<EigenVector<T>, Rank> orbital_energy_values(
+    const TA::Range &range, const std::array<OrbitalEnergyMode<T>, Rank> &modes,
+    Transform &&transform) {
+  TA_ASSERT(range.rank() == Rank);
+  std::array<EigenVector<T>, Rank> values;
+  for (auto m = 0ul; m != Rank; ++m) {
+    const std::size_t lo = range.lobound_data()[m];
+    const std::size_t hi = range.upbound_data()[m];
+    if (modes[m].ens != nullptr) {
+      values[m] = transform(modes[m].energies(lo, hi));
+    } else {
+      values[m] = EigenVector<T>::Constant(hi - lo, Op::template identity<T>());
+    }
+  }
+  return values;
+}
+
+/**
+ * applies \c Op with the per-mode \c values to \c arg , writes the result to
+ * \c result (which may be \c arg itself)
+ *
+ * @tparam ComputeNorm if true, the 2-norm of the result is accumulated while
+ * it is computed
+ * @param init the initial value of the reduction over modes, e.g. the shift
+ * of the denominator
+ * @return the 2-norm of \c result if \c ComputeNorm is true, 0 otherwise
+ */
+template <typename Op, bool ComputeNorm = true, typename Tile,
+          std::size_t Rank>
+typename Tile::scalar_type apply_orbital_energy_kernel(
+    Tile &result, const Tile &arg,
+    const std::array<EigenVector<typename Tile::numeric_type>, Rank> &values,
+    typename Tile::numeric_type init) {
+  using numeric_type = typename Tile::numeric_type;
+  static_assert(Rank > 0, "apply_orbital_energy_kernel: rank must be > 0");
+  TA_ASSERT(arg.range().rank() == Rank);
+
+  if (result.data() != arg.data()) result = Tile(arg.range());
+
+  const numeric_type *arg_ptr = arg.data();
+  numeric_type *result_ptr = result.data();
+  typename Tile::scalar_type norm2 = 0;
+  OrbitalEnergyLoop<Op, ComputeNorm, Rank>::apply(values, init, arg_ptr,
+                                                  result_ptr, norm2);
+  return std::sqrt(norm2);
+}
+
+/// @return the element-wise quotient of \c arg and the orbital energy
+/// denominator <tt>shift + sum_m modes[m]</tt>
+template <typename Tile, typename Policy, std::size_t Rank>
+TA::DistArray<Tile, Policy> apply_denominator(
+    const TA::DistArray<Tile, Policy> &arg,
+    const std::array<OrbitalEnergyMode<typename Tile::numeric_type>, Rank>
+        &modes,
+    typename Tile::numeric_type shift = 0) {
+  auto op = [modes, shift](Tile &result_tile, const Tile &arg_tile) {
+    const auto values = orbital_energy_values<DenominatorOp>(
+        arg_tile.range(), modes, [](auto &&e) { return e; });
+    return apply_orbital_energy_kernel<DenominatorOp>(result_tile, arg_tile,
+                                                      values, shift);
+  };
+  auto result = TA::foreach (arg, op);
+  arg.world().gop.fence();
+  return result;
+}
+
+/// in-place version of apply_denominator()
+template <typename Tile, typename Policy, std::size_t Rank>
+void apply_denominator_inplace(
+    TA::DistArray<Tile, Policy> &arg,
+    const std::array<OrbitalEnergyMode<typename Tile::numeric_type>, Rank>
+        &modes,
+    typename Tile::numeric_type shift = 0) {
+  auto op = [modes, shift](Tile &tile) {
+    const auto values = orbital_energy_values<DenominatorOp>(
+        tile.range(), modes, [](auto &&e) { return e; });
+    return apply_orbital_energy_kernel<DenominatorOp>(tile, tile, values,
+                                                      shift);
+  };
+  TA::foreach_inplace(arg, op);
+  arg.world().gop.fence();
+}
+
+/// @return the element-wise product of \c arg and the factors
+/// <tt>transform(modes[m])</tt> of the contributing modes
+template <typename Tile, typename Policy, std::size_t Rank,
+          typename Transform>
+TA::DistArray<Tile, Policy> apply_orbital_energy_scaling(
+    const TA::DistArray<Tile, Policy> &arg,
+    const std::array<OrbitalEnergyMode<typename Tile::numeric_type>, Rank>
+        &modes,
+    Transform transform) {
+  using numeric_type = typename Tile::numeric_type;
+  auto op = [modes, transform](Tile &result_tile, const Tile &arg_tile) {
+    const auto values = orbital_energy_values<ScalingOp>(arg_tile.range(),
+                                                         modes, transform);
+    return apply_orbital_energy_kernel<ScalingOp>(result_tile, arg_tile,
+                                                  values, numeric_type(1));
+  };
+  auto result = TA::foreach (arg, op);
+  arg.world().gop.fence();
+  return result;
+}
+
+}  // namespace detail
+}  // namespace lcao
+}  // namespace mpqc
+
+#endif  // SRC_MPQC_CHEMISTRY_QC_LCAO_MBPT_DENOM_KERNEL_H_
@@ -8,6 +8,7 @@
 #include "mpqc/chemistry/qc/lcao/scf/mo_build.h"
 #include "mpqc/chemistry/qc/lcao/wfn/lcao_wfn.h"
 #include "mpqc/chemistry/qc/properties/energy.h"
+#include "mpqc/math/tensor/clr/array_to_eigen.h"
 #include "mpqc/mpqc_config.h"
 #include "mpqc/util/external/madworld/parallel_print.h"
 
@@ -27,10 +28,17 @@ struct Mp2Energy {
   std::shared_ptr<const Eigen::VectorXd> vec_;
   std::size_t n_occ_;
   std::size_t n_frozen_;
+  std::size_t i_offset_;  //!< the (active) index of the first i in the tiles
+  std::size_t j_offset_;  //!< the (active) index of the first j in the tiles
 
   Mp2Energy(std::shared_ptr<const Eigen::VectorXd> vec, std::size_t n_occ,
-            std::size_t n_frozen)
-      : vec_(vec), n_occ_(n_occ), n_frozen_(n_frozen) {}
+            std::size_t n_frozen, std::size_t i_offset = 0,
+            std::size_t j_offset = 0)
+      : vec_(vec),
+        n_occ_(n_occ),
+        n_frozen_(n_frozen),
+        i_offset_(i_offset),
+        j_offset_(j_offset) {}
 
   Mp2Energy(Mp2Energy const &) = default;
 
@@ -59,9 +67,9 @@ struct Mp2Energy {
     auto fnb = fn[3];
 
     for (auto i = sti; i < fni; ++i) {
-      const auto e_i = vec[i + n_frozen_];
+      const auto e_i = vec[i + i_offset_ + n_frozen_];
       for (auto j = stj; j < fnj; ++j) {
-        const auto e_ij = e_i + vec[j + n_frozen_];
+        const auto e_ij = e_i + vec[j + j_offset_ + n_frozen_];
         for (auto a = sta; a < fna; ++a) {
           const auto e_ija = e_ij - vec[a + n_occ_];
           for (auto b = stb; b < fnb; ++b, ++tile_idx) {
@@ -136,25 +144,33 @@ class RMP2 : public lcao::LCAOWavefunction<Tile, Policy>,
  *
  *  KeyVal type of this class RI-RMP2
  *
- *  @warning This is not an efficient RI-MP2 implementation, it computes and
- * stores <i j|a b> using density fitting
+ *  @warning Unless \c batch_memory is given, this is not an efficient RI-MP2
+ * implementation, it computes and stores <i j|a b> using density fitting
  */
 
 template <typename Tile, typename Policy>
 class RIRMP2 : public RMP2<Tile, Policy> {
  public:
+  // clang-format off
   /**
    * KeyVal constructor
    * @param kv
    *
    * keywords: inherit all keywords from RMP2
+   * | Keyword | Type | Default| Description |
+   * |---------|------|--------|-------------|
+   * | batch_memory | double | 0 | if positive, the memory (in GB, per process) available to a batch of occupied pairs; <i j|a b> is then never stored, but formed from the 3-index integrals in batches of occupied pairs that fit in this budget and reduced to the energy batch by batch |
    */
+  // clang-format on
   RIRMP2(const KeyVal &kv);
   ~RIRMP2() {}
 
  protected:
   /// override the compute function from RMP2
   double compute() override;
+
+ private:
+  double batch_memory_;  //!< memory per process for a batch of pairs, in bytes
 };
 
 #if TA_DEFAULT_POLICY == 0
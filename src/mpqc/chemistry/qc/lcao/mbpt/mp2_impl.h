@@ -30,6 +30,95 @@ double compute_mp2(
   return energy_mp2;
 }
 
+/**
+ * computes the RI-MP2 energy without storing <i j|a b>: the occupied pairs are
+ * processed in batches I x J of whole occupied tiles, for each batch
+ * <i j|a b> is formed from the 3-index integrals (Κ|G|a i)[inv_sqr] and
+ * reduced to the energy, hence the memory is O(N_aux o v) plus one batch
+ *
+ * @param batch_memory the memory available to a batch per process, in bytes
+ */
+template <typename Tile, typename Policy>
+double compute_batched_rimp2(
+    lcao::LCAOFactoryBase<Tile, Policy>& lcao_factory,
+    const std::shared_ptr<const Eigen::VectorXd>& orbital_energy,
+    const std::shared_ptr<const ::mpqc::utility::TRange1Engine>& tr1_engine,
+    double batch_memory) {
+  using Array = TA::DistArray<Tile, Policy>;
+  using numeric_type = typename Tile::numeric_type;
+  auto& world = lcao_factory.world();
+
+  const Array B = lcao_factory.compute(L"(Κ|G|a i)[inv_sqr]");
+  const auto tr_occ = B.trange().dim(2);
+  const auto occ0 = tr_occ.tile(0).first;
+  const auto n_vir = tr1_engine->get_vir();
+
+  // a batch of n x n pairs takes ~3 arrays of n^2 v^2 elements (the
+  // integrals and the temporaries of the energy expression)
+  const double pair_bytes =
+      3.0 * n_vir * n_vir * sizeof(numeric_type) / world.size();
+  const std::size_t batch_size =
+      std::max(1.0, std::floor(std::sqrt(batch_memory / pair_bytes)));
+
+  // batches of whole occupied tiles, [first, last)
+  std::vector<std::pair<std::size_t, std::size_t>> batches;
+  const std::size_t ntiles = tr_occ.tile_extent();
+  for (std::size_t first = 0, last = 1; last <= ntiles; ++last) {
+    if (last == ntiles ||
+        tr_occ.tile(last).second - tr_occ.tile(first).first > batch_size) {
+      batches.emplace_back(first, last);
+      first = last;
+    }
+  }
+
+  // B restricted to the occupied orbitals of a batch
+  auto batch_of_B = [&](const std::pair<std::size_t, std::size_t>& batch) {
+    const auto i0 = tr_occ.tile(batch.first).first;
+    std::vector<std::size_t> blocking;
+    for (auto t = batch.first; t != batch.second; ++t)
+      blocking.push_back(tr_occ.tile(t).first - i0);
+    blocking.push_back(tr_occ.tile(batch.second - 1).second - i0);
+    TA::TiledRange1 tr_batch(blocking.begin(), blocking.end());
+
+    RowMatrix<numeric_type> select =
+        RowMatrix<numeric_type>::Zero(tr_occ.extent(), tr_batch.extent());
+    for (std::size_t i = 0; i != tr_batch.extent(); ++i)
+      select(i0 - occ0 + i, i) = 1.0;
+    auto select_array =
+        math::eigen_to_array<Tile, Policy>(world, select, tr_occ, tr_batch);
+
+    Array result;
+    result("K,a,i") = B("K,a,m") * select_array("m,i");
+    return result;
+  };
+
+  ExEnv::out0() << indent << "RI-MP2 in " << batches.size() << " x "
+                << batches.size() << " batches of occupied orbitals\n";
+
+  double energy_mp2 = 0.0;
+  for (std::size_t I = 0; I != batches.size(); ++I) {
+    const auto B_I = batch_of_B(batches[I]);
+    const auto i_offset = tr_occ.tile(batches[I].first).first - occ0;
+    // <i j|a b> = <j i|b a> hence only J >= I are needed
+    for (std::size_t J = I; J != batches.size(); ++J) {
+      const auto B_J = (J == I) ? B_I : batch_of_B(batches[J]);
+      const auto j_offset = tr_occ.tile(batches[J].first).first - occ0;
+
+      Array g_ijab;
+      g_ijab("i,j,a,b") = B_I("K,a,i") * B_J("K,b,j");
+      const double energy_IJ =
+          (g_ijab("i,j,a,b") * (2 * g_ijab("i,j,a,b") - g_ijab("i,j,b,a")))
+              .reduce(mbpt::detail::Mp2Energy<Tile>(
+                  orbital_energy, tr1_engine->get_occ(),
+                  tr1_engine->get_nfrozen(), i_offset, j_offset));
+      energy_mp2 += (J == I) ? energy_IJ : 2 * energy_IJ;
+    }
+  }
+
+  utility::print_par(world, "RI-MP2 Energy: ", energy_mp2, "\n");
+  return energy_mp2;
+}
+
 }  // namespace detail
 
 template <typename Tile, typename Policy>
@@ -96,10 +185,17 @@ const std::shared_ptr<Wavefunction> RMP2<Tile, Policy>::refwfn() const {
 //
 
 template <typename Tile, typename Policy>
-RIRMP2<Tile, Policy>::RIRMP2(const KeyVal& kv) : RMP2<Tile, Policy>(kv) {}
+RIRMP2<Tile, Policy>::RIRMP2(const KeyVal& kv)
+    : RMP2<Tile, Policy>(kv),
+      batch_memory_(kv.value<double>("batch_memory", 0.0) * 1e9) {}
 
 template <typename Tile, typename Policy>
 double RIRMP2<Tile, Policy>::compute() {
+  if (batch_memory_ > 0.0)
+    return detail::compute_batched_rimp2(
+        this->lcao_factory(),
+        make_diagonal_fpq(this->lcao_factory(), this->ao_factory(), true),
+        this->trange1_engine(), batch_memory_);
   return detail::compute_mp2(
       this->lcao_factory(),
       make_diagonal_fpq(this->lcao_factory(), this->ao_factory(), true),
@@ -27,6 +27,10 @@ class DensityBuilder {
   virtual std::pair<array_type, array_type> operator()(array_type const &) = 0;
 
   virtual void print_iter(std::string const &) = 0;
+
+  /// sets the precision to which the next density is needed, e.g. that of
+  /// the current SCF iteration; builders may ignore it
+  virtual void set_target_precision(double) {}
 };
 
 }  // namespace scf
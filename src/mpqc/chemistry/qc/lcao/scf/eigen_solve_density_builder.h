@@ -4,6 +4,7 @@
 
 #include "mpqc/chemistry/qc/lcao/scf/density_builder.h"
 #include "mpqc/chemistry/qc/lcao/scf/orbital_localization.h"
+#include "mpqc/math/linalg/symm_eigen_solver.h"
 #include <array>
 #include <vector>
 
@@ -25,6 +26,7 @@ class ESolveDensityBuilder : public DensityBuilder<Tile, Policy> {
   Eigen::VectorXd eps_;  //!< canonical orbital energies
 
   double TcutC_;
+  std::shared_ptr<math::SymmEigenSolver<array_type>> eigen_solver_;
   std::shared_ptr<OrbitalLocalizer < Tile, Policy>> localizer_;
   bool localize_core_;
   int64_t n_coeff_clusters_;
@@ -59,7 +61,8 @@ class ESolveDensityBuilder : public DensityBuilder<Tile, Policy> {
       std::shared_ptr<OrbitalLocalizer < Tile, Policy>>
   localizer = nullptr,
   bool localize_core = false,
-  bool clustered_coeffs = false
+  bool clustered_coeffs = false,
+  std::shared_ptr<math::SymmEigenSolver<array_type>> eigen_solver = nullptr
   );
 
   std::pair<array_type, array_type> operator()(array_type const &F) override;
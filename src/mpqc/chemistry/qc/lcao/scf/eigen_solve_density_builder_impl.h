@@ -28,12 +28,14 @@ ESolveDensityBuilder<Tile, Policy>::ESolveDensityBuilder(
     std::shared_ptr<OrbitalLocalizer < Tile, Policy>>
 localizer,
 bool localize_core,
-bool clustered_coeffs
+bool clustered_coeffs,
+std::shared_ptr<math::SymmEigenSolver<array_type>> eigen_solver
 )
 :
 S_ (S),
 r_xyz_ints_(r_xyz),
 TcutC_(TcutC),
+eigen_solver_(eigen_solver),
 localizer_(localizer),
 localize_core_(localize_core),
 n_coeff_clusters_(nclusters),
@@ -55,6 +57,11 @@ ncore_(ncore) {
 
   MPQC_ASSERT(!(clustered_coeffs_ && localize_core_ == false));
 
+  if (!eigen_solver_) {
+    eigen_solver_ =
+        std::make_shared<math::ReplicatedSymmEigenSolver<array_type>>();
+  }
+
   auto inv1 = mpqc::fenced_now(S_.world());
   inverse_time_ = mpqc::duration_in_s(inv0, inv1);
 }
@@ -71,37 +78,22 @@ ESolveDensityBuilder<Tile, Policy>::operator()(
   auto e0 = mpqc::fenced_now(world);
   Fp("i,j") = M_inv_("i,k") * F("k,l") * M_inv_("j,l");
 
-  auto Fp_eig = math::array_to_eigen(Fp);
-
-  // solve on rank-0 only, propagate to the rest
-  EigenVector<scalar_type> eps_eig;
-  decltype(Fp_eig) C_eig;
-  if (world.rank() == 0) {
-    Eigen::SelfAdjointEigenSolver<decltype(Fp_eig)> es(Fp_eig);
-    eps_eig = es.eigenvalues();
-    C_eig = es.eigenvectors();
-    mpqc::detail::canonical_column_phase(C_eig, 1e-10);
-
-
-    // warn about "exact" degeneracies among valence occupied orbitals
-    bool exact_degeneracies = false;
-    for(auto i=ncore_+1; i<nocc_ && !exact_degeneracies; ++i) {
-      if (std::abs(eps_eig(i) - eps_eig(i - 1)) < std::numeric_limits<scalar_type>::epsilon() * 1e3) {
-        exact_degeneracies = true;
-        ExEnv::out0() << indent
-                      << "WARNING: nearly exactly degenerate occupied orbital energies, phases are NOT fixed, so take care in interpreting orbital coefficients"
-                      << std::endl;
-      }
+  eigen_solver_->compute(Fp);
+  const auto &eps_eig = eigen_solver_->eigenvalues();
+
+  // warn about "exact" degeneracies among valence occupied orbitals
+  for (auto i = ncore_ + 1; i < nocc_; ++i) {
+    if (std::abs(eps_eig(i) - eps_eig(i - 1)) <
+        std::numeric_limits<scalar_type>::epsilon() * 1e3) {
+      ExEnv::out0() << indent
+                    << "WARNING: nearly exactly degenerate occupied orbital energies, phases are NOT fixed, so take care in interpreting orbital coefficients"
+                    << std::endl;
+      break;
     }
   }
-  world.gop.broadcast_serializable(eps_eig, 0);
-  world.gop.broadcast_serializable(C_eig, 0);
-  decltype(Fp_eig) C_occ_eig = C_eig.leftCols(nocc_);
 
-  auto tr_ao = Fp.trange().data()[0];
   auto tr_occ = utility::compute_trange1(nocc_, n_coeff_clusters_);
-  C_occ = math::eigen_to_array<Tile, Policy>(Fp.world(), C_occ_eig, tr_ao,
-                                                  tr_occ);
+  C_occ = eigen_solver_->eigenvectors(nocc_, tr_occ);
 
   // Get back to AO land
   C_occ_ao("i,j") = M_inv_("k,i") * C_occ("k,j");
@@ -110,8 +102,7 @@ ESolveDensityBuilder<Tile, Policy>::operator()(
     eps_ = eps_eig;
     auto nobs = eps_eig.rows();
     auto tr_obs = utility::compute_trange1(nobs, n_coeff_clusters_);
-    auto C = math::eigen_to_array<Tile, Policy>(Fp.world(), C_eig, tr_ao,
-                                                     tr_obs);
+    auto C = eigen_solver_->eigenvectors(nobs, tr_obs);
     C_("i,j") = M_inv_("k,i") * C("k,j");
   }
   auto e1 = mpqc::fenced_now(world);
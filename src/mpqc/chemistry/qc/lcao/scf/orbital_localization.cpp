@@ -2,6 +2,10 @@
 
 #include <algorithm>
 #include <limits>
+#include <utility>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
 #include "mpqc/util/keyval/forcelink.h"
 
@@ -28,6 +32,23 @@ double compute_angle(double Aij, double Bij, double epsilon) {
   return gamma;
 };
 
+/// the Jacobi rotation angle of pair (i,j) that maximizes the Foster-Boys
+/// function
+double fb_angle(std::array<Mat, 3> const &mo_xyz, int i, int j,
+                double epsilon) {
+  auto const &mx = mo_xyz[0];
+  auto const &my = mo_xyz[1];
+  auto const &mz = mo_xyz[2];
+  Vector3d vij = {mx(i, j), my(i, j), mz(i, j)};
+  Vector3d vii = {mx(i, i), my(i, i), mz(i, i)};
+  Vector3d vjj = {mx(j, j), my(j, j), mz(j, j)};
+
+  const double Aij = vij.squaredNorm() - ((vii - vjj).squaredNorm() / 4);
+  const double Bij = (vii - vjj).dot(vij);
+
+  return compute_angle(Aij, Bij, epsilon);
+}
+
 bool fb_jacobi_sweeps(Mat &Cm, Mat &U, std::vector<Mat> const &ao_xyz,
                       double convergence_threshold, size_t max_iter) {
   std::array<Mat, 3> mo_xyz;
@@ -95,6 +116,103 @@ bool fb_jacobi_sweeps(Mat &Cm, Mat &U, std::vector<Mat> const &ao_xyz,
   return error <= convergence_threshold;
 }
 
+/// the pairs (i,j), i > j, of round \c r of the round-robin tournament of
+/// \c n orbitals (circle method); every pair appears once in n-1 (n even) or
+/// n (n odd) rounds and the pairs of one round are disjoint
+std::vector<std::pair<int, int>> tournament_round(int n, int r) {
+  const auto m = n + n % 2;  // odd n: orbital n is a dummy ("bye")
+  std::vector<std::pair<int, int>> pairs;
+  pairs.reserve(m / 2);
+  for (auto k = 0; k < m / 2; ++k) {
+    const auto a = k == 0 ? m - 1 : (r + k) % (m - 1);
+    const auto b = (r + m - 1 - k) % (m - 1);
+    if (a == n || b == n) continue;
+    pairs.emplace_back(std::max(a, b), std::min(a, b));
+  }
+  return pairs;
+}
+
+bool fb_jacobi_tournament_sweeps(Mat &Cm, Mat &U,
+                                 std::vector<Mat> const &ao_xyz,
+                                 double convergence_threshold,
+                                 size_t max_iter) {
+  std::array<Mat, 3> mo_xyz;
+  mo_xyz[0] = Cm.transpose() * ao_xyz[0] * Cm;
+  mo_xyz[1] = Cm.transpose() * ao_xyz[1] * Cm;
+  mo_xyz[2] = Cm.transpose() * ao_xyz[2] * Cm;
+
+  const int n = Cm.cols();
+  const auto nrounds = n + n % 2 - 1;
+  std::vector<double> cos_g, sin_g;
+
+  // rotates columns i and j of rows [rows.begin(), rows.end()) of m
+  auto rotate_cols = [&](Mat &m,
+                         std::vector<std::pair<int, int>> const &pairs,
+                         tbb::blocked_range<int> const &rows) {
+    for (auto r = rows.begin(); r != rows.end(); ++r) {
+      auto *row = m.data() + r * m.cols();
+      for (auto p = 0ul; p < pairs.size(); ++p) {
+        const auto mi = row[pairs[p].first];
+        const auto mj = row[pairs[p].second];
+        row[pairs[p].first] = cos_g[p] * mi + sin_g[p] * mj;
+        row[pairs[p].second] = -sin_g[p] * mi + cos_g[p] * mj;
+      }
+    }
+  };
+
+  decltype(max_iter) iter = 1;
+  double max_abs_angle_prev_iter = std::numeric_limits<double>::max();
+  double error = max_abs_angle_prev_iter;
+  while (error > convergence_threshold && iter <= max_iter) {
+    double max_abs_angle = 0.0;
+    for (auto round = 0; round < nrounds; ++round) {
+      const auto pairs = tournament_round(n, round);
+
+      // the pairs are disjoint, so their angles do not depend on the order in
+      // which they are rotated
+      cos_g.resize(pairs.size());
+      sin_g.resize(pairs.size());
+      for (auto p = 0ul; p < pairs.size(); ++p) {
+        const auto gamma = fb_angle(mo_xyz, pairs[p].first, pairs[p].second,
+                                    convergence_threshold);
+        max_abs_angle = std::max(max_abs_angle, std::abs(gamma));
+        cos_g[p] = std::cos(gamma);
+        sin_g[p] = std::sin(gamma);
+      }
+
+      // m <- m R and U <- U R, by blocks of (contiguous) rows
+      tbb::parallel_for(tbb::blocked_range<int>(0, n),
+                        [&](tbb::blocked_range<int> const &rows) {
+                          rotate_cols(U, pairs, rows);
+                          for (auto &m : mo_xyz) rotate_cols(m, pairs, rows);
+                        });
+
+      // m <- R^T m, rows i and j of different pairs are disjoint
+      tbb::parallel_for(
+          tbb::blocked_range<std::size_t>(0, pairs.size()),
+          [&](tbb::blocked_range<std::size_t> const &range) {
+            for (auto p = range.begin(); p != range.end(); ++p) {
+              const auto i = pairs[p].first;
+              const auto j = pairs[p].second;
+              for (auto &m : mo_xyz) {
+                Eigen::RowVectorXd z_i = m.row(i);
+                Eigen::RowVectorXd z_j = m.row(j);
+                m.row(i) = cos_g[p] * z_i + sin_g[p] * z_j;
+                m.row(j) = -sin_g[p] * z_i + cos_g[p] * z_j;
+              }
+            }
+          });
+    }
+
+    error = iter > 1 ? std::abs(max_abs_angle - max_abs_angle_prev_iter)
+                     : max_abs_angle;
+    ++iter;
+    max_abs_angle_prev_iter = max_abs_angle;
+  }
+
+  return error <= convergence_threshold;
+}
+
 }  // namespace scf
 }  // namespace lcao
 }  // namespace mpqc
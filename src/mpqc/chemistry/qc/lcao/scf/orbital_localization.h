@@ -5,6 +5,7 @@
 #include <cmath>
 #include <array>
 #include <iomanip>
+#include <string>
 
 #include <tiledarray_fwd.h>
 
@@ -74,6 +75,15 @@ using Mat =
 bool fb_jacobi_sweeps(Mat &Cm, Mat &U, std::vector<Mat> const &ao_xyz,
                       double convergence_threshold, size_t max_iter);
 
+/// same as fb_jacobi_sweeps(), but each sweep visits the pairs in round-robin
+/// tournament order: the pairs of a round are disjoint, hence are rotated
+/// concurrently (using TBB threads), with the rows of the dipole matrices and
+/// of @c U updated for all pairs of the round at once
+bool fb_jacobi_tournament_sweeps(Mat &Cm, Mat &U,
+                                 std::vector<Mat> const &ao_xyz,
+                                 double convergence_threshold,
+                                 size_t max_iter);
+
 /// Performs Foster-Boys localization
 /// (see J. Foster and S. Boys, Rev Mod Phys 32, 300 (1960)).
 template <typename Tile, typename Policy>
@@ -88,11 +98,19 @@ class FosterBoysLocalizer : public OrbitalLocalizer<Tile, Policy> {
    * |---------|------|--------|-------------|
    * | @c convergence | double | 1e-8 | the Jacobi solver is converged when the maximum rotation angle (in rad) does not exceed this value  |
    * | @c max_iter | int | 50 | the maximum number of Jacobi iterations |
+   * | @c ordering | string | cyclic | the order of the pair rotations in a Jacobi sweep, valid values are @c cyclic (one pair at a time, see fb_jacobi_sweeps()) and @c tournament (disjoint pairs are rotated concurrently, see fb_jacobi_tournament_sweeps()) |
    */
   // clang-format on
   FosterBoysLocalizer(const KeyVal &kv = KeyVal{})
       : jacobi_convergence_threshold_(kv.value<double>("convergence", 1e-8, KeyVal::is_nonnegative)),
-        jacobi_max_iter_(kv.value<std::size_t>("max_iter", 50)) {}
+        jacobi_max_iter_(kv.value<std::size_t>("max_iter", 50)) {
+    const auto ordering = kv.value<std::string>("ordering", "cyclic");
+    if (ordering != "tournament" && ordering != "cyclic") {
+      throw InputError("invalid value of keyword ordering", __FILE__,
+                       __LINE__, "ordering", ordering.c_str());
+    }
+    tournament_ = ordering == "tournament";
+  }
 
   /// @param C input LCAOs
   /// @param {x,y,z} electric dipole operator matrices, in AO basis
@@ -129,8 +147,9 @@ class FosterBoysLocalizer : public OrbitalLocalizer<Tile, Policy> {
         C.block(0, ncols_of_C_to_skip, C.rows(), C.cols() - ncols_of_C_to_skip);
 
     EigMat U_loc = EigMat::Identity(C_loc.cols(), C_loc.cols());
-    auto converged = fb_jacobi_sweeps(C_loc, U_loc, {ao_x, ao_y, ao_z},
-                                      jacobi_convergence_threshold_, jacobi_max_iter_);
+    auto sweeps = tournament_ ? fb_jacobi_tournament_sweeps : fb_jacobi_sweeps;
+    auto converged = sweeps(C_loc, U_loc, {ao_x, ao_y, ao_z},
+                            jacobi_convergence_threshold_, jacobi_max_iter_);
     if (!converged) {
       std::ostringstream oss;
       oss << "Foster-Boys Jacobi sweeps failed to converge to threshold=" << jacobi_convergence_threshold_
@@ -146,6 +165,7 @@ class FosterBoysLocalizer : public OrbitalLocalizer<Tile, Policy> {
 
   double jacobi_convergence_threshold_;
   size_t jacobi_max_iter_;
+  bool tournament_;
 };
 
 /// Performs Rank Revealing QR localization
@@ -221,9 +221,11 @@ class PeriodicCADFKBuilder
       auto M = compute_eri2(world, by_atom_dfbs, by_atom_dfbs);
       const Vector3i ref_lattice_range = {0, 0, 0};
 
+      // the metric factorizations are kept by the factory for later builds
       C_ = lcao::cadf_fitting_coefficients<Tile, Policy>(
           M, *obs_, *basisR_, *X_dfbs, natoms_per_uc_, ref_lattice_range,
-          R_max_, RX_max_);
+          R_max_, RX_max_, ref_lattice_range, ref_lattice_range,
+          ref_lattice_range, &ao_factory_.cadf_metric_cache());
     }
     t1 = mpqc::fenced_now(world);
     auto t_C = mpqc::duration_in_s(t0, t1);
@@ -0,0 +1,371 @@
+#ifndef MPQC4_SRC_MPQC_CHEMISTRY_QC_SCF_PBC_PERIODIC_LATTICE_TRANSFORM_H_
+#define MPQC4_SRC_MPQC_CHEMISTRY_QC_SCF_PBC_PERIODIC_LATTICE_TRANSFORM_H_
+
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <tiledarray.h>
+
+#include "mpqc/chemistry/molecule/lattice/util.h"
+#include "mpqc/math/external/eigen/eigen.h"
+#include "mpqc/math/external/tiledarray/util.h"
+
+namespace mpqc {
+namespace lcao {
+namespace scf {
+
+/*!
+ * \brief PeriodicLatticeTransform transforms rank-2 arrays M(μ_0, ν_R) between
+ * real and reciprocal space, i.e. M(μ, ν_k) = \sum_R exp(I k.R) M(μ, ν_R) and
+ * M(μ, ν_R) = Re \sum_k exp(I k.R) M(μ, ν_k) / N_k, for k on a Monkhorst-Pack
+ * mesh.
+ *
+ * Since exp(I k.R) is periodic (anti-periodic for even number of k points) in
+ * R with the period of the k mesh, the lattice sum is first folded onto the k
+ * mesh and then evaluated as a separable 3D
+ * discrete Fourier transform, i.e. O(N_R + N_k (n_k1 + n_k2 + n_k3)) instead of
+ * O(N_R N_k) operations per element. Each {μ, ν} tile pair is transformed by a
+ * single task that fetches the tiles it needs, hence the full matrix is never
+ * replicated; the transformed tiles are sent to their owners.
+ *
+ * With time-reversal symmetry, M(μ, ν_-k) = M(μ, ν_k)^*, only the k points
+ * with ordinal index k <= N_k - 1 - k (the irreducible half of the mesh) are
+ * stored in reciprocal space; the other half is reconstructed on the fly from
+ * the conjugate pairs.
+ */
+template <typename Policy>
+class PeriodicLatticeTransform
+    : public madness::WorldObject<PeriodicLatticeTransform<Policy>> {
+ public:
+  using array_type = TA::DistArray<TA::TensorD, Policy>;
+  using array_type_z = TA::DistArray<TA::TensorZ, Policy>;
+  using WorldObject_ = madness::WorldObject<PeriodicLatticeTransform<Policy>>;
+  using PeriodicLatticeTransform_ = PeriodicLatticeTransform<Policy>;
+
+  /*!
+   * \param world the world
+   * \param dcell the direct unit cell params
+   */
+  PeriodicLatticeTransform(madness::World &world, const Vector3d &dcell)
+      : WorldObject_(world), dcell_(dcell) {
+    // WorldObject mandates this is called from the ctor
+    WorldObject_::process_pending();
+  }
+
+  /*!
+   * \brief This transforms M(μ, ν_R) to M(μ, ν_k)
+   * \param matrix the real-space matrix M(μ, ν_R)
+   * \param real_lattice_range maximum unit cell index (n1, n2, n3) of \c R
+   * \param nk number of k points in each direction
+   * \param time_reversal if true, only the irreducible half of the k mesh is
+   * computed, the tiles of other k points are zero
+   * \return the reciprocal-space matrix M(μ, ν_k)
+   */
+  array_type_z real2recip(const array_type &matrix,
+                          const Vector3i &real_lattice_range,
+                          const Vector3i &nk, bool time_reversal = false) {
+    using ::mpqc::detail::direct_ord_idx;
+    using ::mpqc::detail::extend_trange1;
+
+    const auto R_size =
+        1 + direct_ord_idx(real_lattice_range, real_lattice_range);
+    const auto k_size = nk.prod();
+    const auto tr0 = matrix.trange().data()[0];
+    trange_ = TA::TiledRange({tr0, extend_trange1(tr0, k_size)});
+    real_lattice_range_ = real_lattice_range;
+    nk_ = nk;
+    time_reversal_ = time_reversal;
+
+    const auto ntiles = tr0.tile_extent();
+    auto &world = this->get_world();
+    pmap_ = Policy::default_pmap(world, trange_.tiles_range().volume());
+    const auto me = world.rank();
+    const auto nproc = world.nproc();
+    for (auto i = 0ul, ij = 0ul; i != ntiles; ++i) {
+      for (auto j = 0ul; j != ntiles; ++j, ++ij) {
+        if (ij % nproc != me) continue;
+
+        std::vector<int64_t> Rs;
+        std::vector<madness::Future<TA::TensorD>> tiles;
+        for (int64_t R = 0; R != R_size; ++R) {
+          const auto tile_R = std::array<size_t, 2>{{i, R * ntiles + j}};
+          if (matrix.is_zero(tile_R)) continue;
+          Rs.push_back(R);
+          tiles.push_back(matrix.find(tile_R));
+        }
+        if (Rs.empty()) continue;
+
+        WorldObject_::task(me, &PeriodicLatticeTransform_::real2recip_task, i,
+                           j, Rs, tiles);
+      }
+    }
+    world.gop.fence();
+
+    return make_array(recip_tiles_);
+  }
+
+  /*!
+   * \brief This transforms M(μ, ν_k) to M(μ, ν_R)
+   * \param matrix the reciprocal-space matrix M(μ, ν_k)
+   * \param real_lattice_range maximum unit cell index (n1, n2, n3) of \c R
+   * \param nk number of k points in each direction
+   * \param time_reversal if true, only the irreducible half of the k mesh is
+   * used, the other half is obtained by complex conjugation
+   * \return the real-space matrix M(μ, ν_R)
+   */
+  array_type recip2real(const array_type_z &matrix,
+                        const Vector3i &real_lattice_range,
+                        const Vector3i &nk, bool time_reversal = false) {
+    using ::mpqc::detail::direct_ord_idx;
+    using ::mpqc::detail::extend_trange1;
+
+    const auto R_size =
+        1 + direct_ord_idx(real_lattice_range, real_lattice_range);
+    const auto k_size = nk.prod();
+    const auto tr0 = matrix.trange().data()[0];
+    trange_ = TA::TiledRange({tr0, extend_trange1(tr0, R_size)});
+    real_lattice_range_ = real_lattice_range;
+    nk_ = nk;
+    time_reversal_ = time_reversal;
+
+    const auto ntiles = tr0.tile_extent();
+    auto &world = this->get_world();
+    pmap_ = Policy::default_pmap(world, trange_.tiles_range().volume());
+    const auto me = world.rank();
+    const auto nproc = world.nproc();
+    for (auto i = 0ul, ij = 0ul; i != ntiles; ++i) {
+      for (auto j = 0ul; j != ntiles; ++j, ++ij) {
+        if (ij % nproc != me) continue;
+
+        std::vector<int64_t> ks;
+        std::vector<madness::Future<TA::TensorZ>> tiles;
+        for (int64_t k = 0; k != k_size; ++k) {
+          if (time_reversal_ && !is_irreducible(k)) continue;
+          const auto tile_k = std::array<size_t, 2>{{i, k * ntiles + j}};
+          if (matrix.is_zero(tile_k)) continue;
+          ks.push_back(k);
+          tiles.push_back(matrix.find(tile_k));
+        }
+        if (ks.empty()) continue;
+
+        WorldObject_::task(me, &PeriodicLatticeTransform_::recip2real_task, i,
+                           j, ks, tiles);
+      }
+    }
+    world.gop.fence();
+
+    return make_array(real_tiles_);
+  }
+
+ private:
+  const Vector3d dcell_;
+
+  // set by real2recip/recip2real, used by the tasks
+  TA::TiledRange trange_;
+  std::shared_ptr<TA::Pmap> pmap_;
+  Vector3i real_lattice_range_;
+  Vector3i nk_;
+  bool time_reversal_ = false;
+
+  // result tiles owned by this process
+  madness::ConcurrentHashMap<std::size_t, TA::TensorZ> recip_tiles_;
+  madness::ConcurrentHashMap<std::size_t, TA::TensorD> real_tiles_;
+
+  /// @return phase factors exp(I k.R) for the k points (rows) and the unit
+  /// cells folded onto the k mesh (columns) in direction \c xyz
+  MatrixZ phase_factors(int xyz) const {
+    const auto n = nk_(xyz);
+    MatrixZ result(n, n);
+    for (auto k = 0; k != n; ++k) {
+      // see ::mpqc::detail::k_vector
+      const auto k_centered = k - 0.5 * (n - 1);
+      for (auto R = 0; R != n; ++R) {
+        result(k, R) = (dcell_(xyz) == 0.0)
+                           ? std::complex<double>(1.0, 0.0)
+                           : std::exp(std::complex<double>(
+                                 0.0, 2.0 * M_PI * k_centered * R / n));
+      }
+    }
+    return result;
+  }
+
+  /// @return {index, sign} of unit cell \c R folded onto the k mesh; the
+  /// sign accounts for the anti-periodicity of exp(I k.R) for even meshes
+  std::pair<int64_t, double> fold(int64_t R) const {
+    const auto R_3D = ::mpqc::detail::direct_3D_idx(R, real_lattice_range_);
+    int64_t ord = 0;
+    double sign = 1.0;
+    for (auto xyz = 0; xyz != 3; ++xyz) {
+      const auto n = nk_(xyz);
+      const auto r = ((R_3D(xyz) % n) + n) % n;
+      const auto period = (R_3D(xyz) - r) / n;
+      if (n % 2 == 0 && period % 2 != 0 && dcell_(xyz) != 0.0) sign = -sign;
+      ord = ord * n + r;
+    }
+    return std::make_pair(ord, sign);
+  }
+
+  /// @return true if \c k is in the irreducible half of the k mesh, i.e. -k
+  /// (ordinal index N_k - 1 - k) is not a different point with smaller index
+  bool is_irreducible(int64_t k) const { return k <= nk_.prod() - 1 - k; }
+
+  /// applies the 3D transform to the rows of \c grid, whose row index is the
+  /// ordinal index on the k mesh; if \c transpose is true, the transposed
+  /// phase factors are used
+  void transform_grid(MatrixZ &grid, bool transpose) const {
+    const auto ncols = grid.cols();
+    for (auto xyz = 0; xyz != 3; ++xyz) {
+      const auto n = nk_(xyz);
+      if (n == 1) continue;
+      MatrixZ phase = phase_factors(xyz);
+      if (transpose) phase.transposeInPlace();
+
+      // stride of this direction in the row index
+      int64_t stride = 1;
+      for (auto d = xyz + 1; d < 3; ++d) stride *= nk_(d);
+      const auto nouter = nk_.prod() / (stride * n);
+
+      MatrixZ line(n, ncols);
+      for (auto outer = 0; outer != nouter; ++outer) {
+        for (auto inner = 0; inner != stride; ++inner) {
+          const auto first = outer * n * stride + inner;
+          for (auto m = 0; m != n; ++m)
+            line.row(m) = grid.row(first + m * stride);
+          line = phase * line;
+          for (auto m = 0; m != n; ++m)
+            grid.row(first + m * stride) = line.row(m);
+        }
+      }
+    }
+  }
+
+  void real2recip_task(std::size_t i, std::size_t j, std::vector<int64_t> Rs,
+                       std::vector<TA::TensorD> tiles) {
+    const auto ntiles = trange_.dim(0).tile_extent();
+    const auto k_size = nk_.prod();
+    const auto nelements = tiles.front().range().volume();
+
+    // fold the lattice sum onto the k mesh
+    MatrixZ grid = MatrixZ::Zero(k_size, nelements);
+    for (auto r = 0ul; r != Rs.size(); ++r) {
+      const auto *data = tiles[r].data();
+      const auto folded = fold(Rs[r]);
+      auto row = grid.row(folded.first);
+      for (auto e = 0ul; e != nelements; ++e) row(e) += folded.second * data[e];
+    }
+
+    transform_grid(grid, false);
+
+    for (int64_t k = 0; k != k_size; ++k) {
+      if (time_reversal_ && !is_irreducible(k)) continue;
+      const auto ord = trange_.tiles_range().ordinal(
+          std::array<std::size_t, 2>{{i, k * ntiles + j}});
+      TA::TensorZ tile(trange_.make_tile_range(ord));
+      auto *data = tile.data();
+      for (auto e = 0ul; e != nelements; ++e) data[e] = grid(k, e);
+      const auto owner = pmap_owner(ord);
+      WorldObject_::task(owner, &PeriodicLatticeTransform_::store_recip_tile,
+                         tile, ord);
+    }
+  }
+
+  void recip2real_task(std::size_t i, std::size_t j, std::vector<int64_t> ks,
+                       std::vector<TA::TensorZ> tiles) {
+    using ::mpqc::detail::direct_ord_idx;
+
+    const auto ntiles = trange_.dim(0).tile_extent();
+    const auto k_size = nk_.prod();
+    const auto R_size =
+        1 + direct_ord_idx(real_lattice_range_, real_lattice_range_);
+    const auto nelements = tiles.front().range().volume();
+    const auto denom_inv = 1.0 / double(k_size);
+
+    MatrixZ grid = MatrixZ::Zero(k_size, nelements);
+    for (auto kk = 0ul; kk != ks.size(); ++kk) {
+      const auto *data = tiles[kk].data();
+      auto row = grid.row(ks[kk]);
+      for (auto e = 0ul; e != nelements; ++e) row(e) = data[e];
+    }
+    // M(μ, ν_-k) = M(μ, ν_k)^*
+    if (time_reversal_) {
+      for (int64_t k = 0; k != k_size; ++k) {
+        if (!is_irreducible(k))
+          grid.row(k) = grid.row(k_size - 1 - k).conjugate();
+      }
+    }
+
+    // rows are now the unit cells folded onto the k mesh
+    transform_grid(grid, true);
+
+    for (int64_t R = 0; R != R_size; ++R) {
+      const auto ord = trange_.tiles_range().ordinal(
+          std::array<std::size_t, 2>{{i, R * ntiles + j}});
+      TA::TensorD tile(trange_.make_tile_range(ord));
+      auto *data = tile.data();
+      const auto folded = fold(R);
+      const auto row = grid.row(folded.first);
+      const auto factor = folded.second * denom_inv;
+      for (auto e = 0ul; e != nelements; ++e) data[e] = row(e).real() * factor;
+      const auto owner = pmap_owner(ord);
+      WorldObject_::task(owner, &PeriodicLatticeTransform_::store_real_tile,
+                         tile, ord);
+    }
+  }
+
+  /// @return the owner of tile \c ord in the result array
+  ProcessID pmap_owner(std::size_t ord) const { return pmap_->owner(ord); }
+
+  void store_recip_tile(TA::TensorZ tile, std::size_t ord) {
+    recip_tiles_.insert(std::make_pair(ord, std::move(tile)));
+  }
+
+  void store_real_tile(TA::TensorD tile, std::size_t ord) {
+    real_tiles_.insert(std::make_pair(ord, std::move(tile)));
+  }
+
+  /// makes the result array from the local tiles received by this process
+  template <typename Tile>
+  TA::DistArray<Tile, Policy> make_array(
+      madness::ConcurrentHashMap<std::size_t, Tile> &local_tiles) {
+    auto &world = this->get_world();
+
+    typename Policy::shape_type shape;
+    // compute the shape, if sparse
+    if (!decltype(shape)::is_dense()) {
+      // extract local contribution to the shape, construct global shape
+      std::vector<std::pair<std::array<size_t, 2>, double>> local_tile_norms;
+      const auto ncols = trange_.tiles_range().extent(1);
+      for (const auto &local_tile : local_tiles) {
+        const auto ord = local_tile.first;
+        local_tile_norms.push_back(std::make_pair(
+            std::array<size_t, 2>{{ord / ncols, ord % ncols}},
+            local_tile.second.norm()));
+      }
+#if TA_DEFAULT_POLICY == 0
+      shape = decltype(shape)();
+#elif TA_DEFAULT_POLICY == 1
+      shape = decltype(shape)(world, local_tile_norms, trange_);
+#endif
+    }
+
+    TA::DistArray<Tile, Policy> result(world, trange_, shape, pmap_);
+    for (const auto &local_tile : local_tiles) {
+      if (!result.is_zero(local_tile.first))
+        result.set(local_tile.first, local_tile.second);
+    }
+    result.fill_local(0.0, true);
+    local_tiles.clear();
+    world.gop.fence();
+
+    return result;
+  }
+};
+
+}  // namespace scf
+}  // namespace lcao
+}  // namespace mpqc
+
+#endif  // MPQC4_SRC_MPQC_CHEMISTRY_QC_SCF_PBC_PERIODIC_LATTICE_TRANSFORM_H_
@@ -2,6 +2,7 @@
 #ifndef MPQC4_SRC_MPQC_CHEMISTRY_QC_SCF_PURIFICATION_DENSITY_BUILD_H_
 #define MPQC4_SRC_MPQC_CHEMISTRY_QC_SCF_PURIFICATION_DENSITY_BUILD_H_
 
+#include <string>
 #include <vector>
 #include "mpqc/chemistry/qc/lcao/scf/density_builder.h"
 
@@ -28,23 +29,59 @@ class PurificationDensityBuilder : public DensityBuilder<Tile, Policy> {
   int64_t occ_;
   int64_t ncore_;
 
+  std::string method_;
+  double truncation_ratio_;
+  double target_precision_ = 0.0;
+  bool print_detail_;
+
+  /// statistics of one purification step
+  struct Step {
+    double threshold;          //!< truncation threshold
+    double idempotency_error;  //!< (tr(D) - tr(D^2)) / occ before the step
+    double trace_error;        //!< |tr(D) - occ| after the step
+    double sparsity;           //!< fraction of zero elements after the step
+    double time;               //!< wall time in s
+  };
+  std::vector<Step> steps_;  //!< of the last purification
+
  public:
+  /// @param method the purification method, "trs4" (Niklasson's trace
+  ///        resetting 4th order) or "trace_correcting" (McWeeny-like
+  ///        trace correcting 2nd order)
+  /// @param truncation_ratio the truncation threshold of a TRS4 step is
+  ///        @c truncation_ratio times the current idempotency error, bounded
+  ///        below by @c truncation_ratio times the target precision (see
+  ///        set_target_precision()) and above by the target precision
+  /// @param print_detail if true, statistics of each step are collected and
+  ///        printed by print_iter()
   PurificationDensityBuilder(array_type const &S, std::vector<array_type> r_xyz,
                              int64_t occ, int64_t ncore, int64_t nclusters,
                              double TcutC = 0.0,
                              std::shared_ptr<OrbitalLocalizer < Tile, Policy>>
   localizer = nullptr,
   bool localize_core = true,
-  bool clustered_coeffs = false
+  bool clustered_coeffs = false,
+  std::string const &method = "trace_correcting",
+  double truncation_ratio = 1e-2,
+  bool print_detail = false
   );
 
   std::pair<array_type, array_type> operator()(array_type const &F) override;
 
-  inline void print_iter(std::string const &) override {}
+  void print_iter(std::string const &leader) override;
+
+  void set_target_precision(double precision) override {
+    target_precision_ = precision;
+  }
 
  private:
   array_type purify(array_type const &);
+  array_type purify_trs4(array_type const &);
   array_type orbitals(array_type const &);
+
+  /// records the statistics of a step that produced D
+  void record_step(array_type const &D, double threshold,
+                   double idempotency_error, double time);
 };
 
 }  // namespace scf
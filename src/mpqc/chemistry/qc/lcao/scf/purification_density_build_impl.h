@@ -1,10 +1,17 @@
+#include <iomanip>
+#include <limits>
+
 #include "mpqc/chemistry/qc/lcao/integrals/integrals.h"
 
 #include "mpqc/chemistry/qc/lcao/scf/purification_density_build.h"
 #include "mpqc/math/external/eigen/eigen.h"
+#include "mpqc/math/external/tiledarray/array_info.h"
 #include "mpqc/math/linalg/cholesky_inverse.h"
 #include "mpqc/math/linalg/sqrt_inv.h"
 #include "mpqc/math/tensor/clr/minimize_storage.h"
+#include "mpqc/util/core/exception.h"
+#include "mpqc/util/core/exenv.h"
+#include "mpqc/util/misc/time.h"
 #include "mpqc/chemistry/qc/lcao/expression/trange1_engine.h"
 
 #include "mpqc/chemistry/qc/lcao/scf/clusterd_coeffs.h"
@@ -22,7 +29,10 @@ PurificationDensityBuilder<Tile, Policy>::PurificationDensityBuilder(
     std::shared_ptr<OrbitalLocalizer < Tile, Policy>>
 localizer,
 bool localize_core,
-bool clustered_coeffs
+bool clustered_coeffs,
+std::string const &method,
+double truncation_ratio,
+bool print_detail
 )
 :
 S_ (S),
@@ -33,7 +43,14 @@ localize_core_(localize_core),
 n_coeff_clusters_(nclusters),
 clustered_coeffs_(clustered_coeffs),
 occ_(occ),
-ncore_(ncore) {
+ncore_(ncore),
+method_(method),
+truncation_ratio_(truncation_ratio),
+print_detail_(print_detail) {
+  if (method_ != "trs4" && method_ != "trace_correcting") {
+    throw InputError("invalid purification method", __FILE__, __LINE__,
+                     "purification_method", method_.c_str());
+  }
   M_inv_ = math::inverse_sqrt(S_);
   I_ = math::create_diagonal_matrix(S_, 1.0);
 
@@ -45,6 +62,11 @@ typename PurificationDensityBuilder<Tile, Policy>::array_type
 PurificationDensityBuilder<Tile, Policy>::purify(
     typename PurificationDensityBuilder<Tile, Policy>::array_type const &F) {
   auto &world = F.world();
+  steps_.clear();
+
+  if (method_ == "trs4") {
+    return purify_trs4(F);
+  }
 
   typename PurificationDensityBuilder<Tile, Policy>::array_type Fp, D, D2;
   Fp("i,j") = M_inv_("i,k") * F("k,l") * M_inv_("j,l");
@@ -61,8 +83,13 @@ PurificationDensityBuilder<Tile, Policy>::purify(
   auto iter = 0;
   auto error = std::abs(trace - occ_);
   while (error >= 1e-13 && iter <= 100) {
+    // the statistics cost an extra trace and fences, collect them only if
+    // they will be printed
+    auto t0 = print_detail_ ? mpqc::fenced_now(world) : mpqc::now();
     // Compute D2
     D2("i,j") = D("i,k") * D("k,j");
+    const auto idempotency_error =
+        print_detail_ ? (trace - D2("i,j").trace().get()) / occ_ : 0.0;
     if (trace > occ_) {
       D = D2;
     } else {
@@ -72,6 +99,11 @@ PurificationDensityBuilder<Tile, Policy>::purify(
     trace = D("i,j").trace().get();
     error = std::abs(trace - occ_);
     ++iter;
+    if (print_detail_) {
+      auto t1 = mpqc::fenced_now(world);
+      record_step(D, TA::SparseShape<float>::threshold(), idempotency_error,
+                  mpqc::duration_in_s(t0, t1));
+    }
   }
 
   D("i,j") = M_inv_("i,k") * D("k,l") * M_inv_("l,j");
@@ -81,6 +113,126 @@ PurificationDensityBuilder<Tile, Policy>::purify(
   return D;
 }
 
+/// TRS4 purification, see A. M. N. Niklasson, C. J. Tymczak, and M.
+/// Challacombe, J. Chem. Phys. 118, 8611 (2003). Each step takes 2
+/// multiplications; the truncation threshold follows the idempotency error,
+/// between @c truncation_ratio_ times the target precision and the target
+/// precision, hence the early steps, whose result is far from idempotent
+/// anyway, work with sparser matrices than the last ones.
+template<typename Tile, typename Policy>
+typename PurificationDensityBuilder<Tile, Policy>::array_type
+PurificationDensityBuilder<Tile, Policy>::purify_trs4(
+    typename PurificationDensityBuilder<Tile, Policy>::array_type const &F) {
+  auto &world = F.world();
+
+  typename PurificationDensityBuilder<Tile, Policy>::array_type Fp, D, D2;
+  Fp("i,j") = M_inv_("i,k") * F("k,l") * M_inv_("j,l");
+
+  auto eig_pair = math::eval_guess(Fp);
+  auto emax = eig_pair[1];
+  auto emin = eig_pair[0];
+  auto scale = 1.0 / (emax - emin);
+
+  // eigenvalues of D are in [0,1]
+  D("i,j") = scale * (emax * I_("i,j") - Fp("i,j"));
+
+  // stop at the truncation noise, or at machine precision if no target
+  // precision is given
+  const auto final_threshold = truncation_ratio_ * target_precision_;
+  const auto tolerance = std::max(final_threshold, 1e-13);
+
+  auto iter = 0;
+  auto prev_idempotency_error = std::numeric_limits<double>::max();
+  while (iter <= 100) {
+    auto t0 = print_detail_ ? mpqc::fenced_now(world) : mpqc::now();
+
+    D2("i,j") = D("i,k") * D("k,j");
+    const auto tr_d = D("i,j").trace().get();
+    const auto tr_d2 = D2("i,j").trace().get();
+    // D is symmetric, hence tr(D^3) and tr(D^4) are dot products
+    const auto tr_d3 = D2("i,j").dot(D("i,j")).get();
+    const auto tr_d4 = D2("i,j").dot(D2("i,j")).get();
+
+    const auto idempotency_error = (tr_d - tr_d2) / occ_;
+    if (idempotency_error < tolerance ||
+        (iter > 2 && idempotency_error >= prev_idempotency_error)) {
+      break;
+    }
+    prev_idempotency_error = idempotency_error;
+
+    // F(D) = D^2 (4D - 3D^2) and G(D) = D^2 (1 - D)^2; D <- F(D) + gamma G(D)
+    // preserves the trace if gamma = (occ - tr(F(D))) / tr(G(D)) is in [0,6]
+    const auto tr_f = 4 * tr_d3 - 3 * tr_d4;
+    const auto tr_g = tr_d2 - 2 * tr_d3 + tr_d4;
+    const auto gamma = tr_g > 0 ? (occ_ - tr_f) / tr_g
+                                : std::numeric_limits<double>::max();
+    if (gamma > 6) {
+      D("i,j") = 2 * D("i,j") - D2("i,j");
+    } else if (gamma < 0) {
+      D = D2;
+    } else {
+      D("i,j") = D2("i,k") * ((4 - 2 * gamma) * D("k,j") +
+                              (gamma - 3) * D2("k,j")) +
+                 gamma * D2("i,j");
+    }
+
+    // never truncate by more than the target precision
+    const auto threshold =
+        std::min(std::max(truncation_ratio_ * idempotency_error,
+                          final_threshold),
+                 target_precision_);
+    minimize_storage(D, threshold);
+    ++iter;
+
+    if (print_detail_) {
+      auto t1 = mpqc::fenced_now(world);
+      record_step(D, std::max<double>(threshold,
+                                      TA::SparseShape<float>::threshold()),
+                  idempotency_error, mpqc::duration_in_s(t0, t1));
+    }
+  }
+
+  D("i,j") = M_inv_("i,k") * D("k,l") * M_inv_("l,j");
+  D.truncate();
+  world.gop.fence();
+
+  return D;
+}
+
+template<typename Tile, typename Policy>
+void PurificationDensityBuilder<Tile, Policy>::record_step(
+    typename PurificationDensityBuilder<Tile, Policy>::array_type const &D,
+    double threshold, double idempotency_error, double time) {
+  const auto storage = mpqc::detail::array_storage(D);
+  Step step;
+  step.threshold = threshold;
+  step.idempotency_error = idempotency_error;
+  step.trace_error = std::abs(D("i,j").trace().get() - occ_);
+  step.sparsity = storage[0] > 0 ? 1.0 - storage[1] / storage[0] : 0.0;
+  step.time = time;
+  steps_.push_back(step);
+}
+
+template<typename Tile, typename Policy>
+void PurificationDensityBuilder<Tile, Policy>::print_iter(
+    std::string const &leader) {
+  if (!print_detail_) return;
+  auto &os = ExEnv::out0();
+  os << leader << "Purification (" << method_ << "): " << steps_.size()
+     << " steps\n";
+  os << leader << "\tstep  threshold  idempotency  trace error  sparsity"
+                  "  time\n";
+  for (auto i = 0ul; i < steps_.size(); ++i) {
+    auto const &step = steps_[i];
+    os << leader << "\t" << std::setw(4) << i << std::scientific
+       << std::setprecision(2) << std::setw(11) << step.threshold
+       << std::setw(13) << step.idempotency_error << std::setw(13)
+       << step.trace_error << std::fixed << std::setw(10) << step.sparsity
+       << std::setw(6) << step.time << "\n";
+  }
+  os << std::defaultfloat;
+}
+
 template<typename Tile, typename Policy>
 typename PurificationDensityBuilder<Tile, Policy>::array_type
 PurificationDensityBuilder<Tile, Policy>::orbitals(
@@ -45,6 +45,11 @@ class RHF
    * | @c t_cut_c | real | 0.0 | threshold in DensityBuilder, SparsePolicy only |
    * | @c decompo_type | string | "conditioned" | (cholesky_inverse, inverse_sqrt, conditioned) only valid if use ESolveDensityBuilder |
    * | @c s_tolerance | real | 1e8 | S condition number threshold in DensityBuilder, valid when @c decompo_type is set to conditioned |
+   * | @c eigen_solver | string | "replicated" | (replicated, scalapack, auto) the eigensolver of ESolveDensityBuilder: "replicated" diagonalizes a full copy of the Fock matrix, "scalapack" distributes it block-cyclically over all processes (requires ScaLAPACK), "auto" picks "scalapack" if available |
+   * | @c eigen_solver_block_size | int | 64 | the block size of the block-cyclic layout, valid when @c eigen_solver is "scalapack" |
+   * | @c purification_method | string | "trace_correcting" | (trace_correcting, trs4) the purification scheme of PurificationDensityBuilder: "trace_correcting" is the 2nd-order trace-correcting scheme, "trs4" the trace-resetting 4th-order scheme |
+   * | @c purification_truncation_ratio | real | 1e-2 | the ratio of the truncation threshold of the density to the idempotency error, the threshold is at least this ratio times and at most the target precision of the SCF iteration; valid when @c purification_method is "trs4" |
+   * | @c purification_print_detail | bool | false | if true, print the threshold, idempotency error, trace error, sparsity and time of each purification step; collecting them costs extra traces and fences |
    */
   // clang-format on
   RHF(const KeyVal& kv);
@@ -208,10 +213,26 @@ class DirectRIRHF : public RHF<Tile, Policy> {
 template <typename Tile, typename Policy>
 class DirectRHF : public RHF<Tile, Policy> {
  public:
+  // clang-format off
+  /**
+   * KeyVal constructor for DirectRHF
+   *
+   * @param kv the KeyVal object; it will be queried for all keywords of RHF as well as the following additional keywords:
+   * | Keyword | Type | Default| Description |
+   * |---------|------|--------|-------------|
+   * | @c incremental_fock | bool | false | if true, build G from the change of the density, G(D_n) = G(D_{n-1}) + G(D_n - D_{n-1}) |
+   * | @c fock_rebuild_period | int | 8 | with @c incremental_fock=true, G is rebuilt from the full density every this many iterations |
+   * | @c fock_reduction | string | "locked" | (locked, thread_local) how the Fock tile contributions of the integral tasks are summed: "locked" accumulates them in a hash map shared by all threads, "thread_local" in per-thread buffers merged at the end, which avoids lock contention but needs up to one copy of the local Fock tiles per thread |
+   */
+  // clang-format on
   DirectRHF(const KeyVal& kv);
 
  private:
   void init_fock_builder() override;
+
+  bool incremental_fock_ = false;
+  std::size_t fock_rebuild_period_ = 8;
+  std::string fock_reduction_ = "locked";
 };
 
 /**
@@ -20,6 +20,7 @@
 #include "mpqc/chemistry/qc/lcao/scf/traditional_df_fock_builder.h"
 #include "mpqc/chemistry/qc/lcao/scf/traditional_four_center_fock_builder.h"
 #include "mpqc/chemistry/qc/lcao/scf/orbital_localization.h"
+#include "mpqc/util/core/exenv.h"
 #include "mpqc/util/misc/time.h"
 
 namespace mpqc {
@@ -115,16 +116,25 @@ void RHF<Tile, Policy>::init(const KeyVal& kv) {
   if (density_builder_str_ == "purification") {
     auto density_builder = scf::PurificationDensityBuilder<Tile, Policy>(
         S_, r_xyz, nocc, ncore, n_cluster, t_cut_c_, localizer_,
-        localize_core_,clustered_coeffs_);
+        localize_core_, clustered_coeffs_,
+        kv.value<std::string>("purification_method", "trace_correcting"),
+        kv.value<double>("purification_truncation_ratio", 1e-2,
+                         KeyVal::is_nonnegative),
+        kv.value<bool>("purification_print_detail", false));
     d_builder_ =
         std::make_unique<decltype(density_builder)>(std::move(density_builder));
   } else if (density_builder_str_ == "eigen_solve") {
     std::string decompo_type =
         kv.value<std::string>("decompo_type", "conditioned");
     double s_tolerance = kv.value<double>("s_tolerance", 1e8);
+    auto eigen_solver = math::make_symm_eigen_solver<array_type>(
+        kv.value<std::string>("eigen_solver", "replicated"),
+        kv.value<int>("eigen_solver_block_size", 64, KeyVal::is_positive));
+    ExEnv::out0() << indent << "Eigensolver: " << eigen_solver->name()
+                  << "\n";
     auto density_builder = scf::ESolveDensityBuilder<Tile, Policy>(
         S_, r_xyz, nocc, ncore, n_cluster, t_cut_c_, decompo_type, s_tolerance,
-        localizer_, localize_core_, clustered_coeffs_);
+        localizer_, localize_core_, clustered_coeffs_, eigen_solver);
     d_builder_ =
         std::make_unique<decltype(density_builder)>(std::move(density_builder));
   } else {
@@ -223,6 +233,10 @@ void RHF<Tile, Policy>::solve(int64_t max_iters, double thresh) {
     diis.extrapolate(F_diis_, Grad);
     madness::print_meminfo(world.rank(), "RHF:diis");
 
+    // the density need not be more precise than the current SCF error
+    d_builder_->set_target_precision(
+        std::max(thresh, std::min(error, rms_error / volume)));
+
     auto d0 = mpqc::fenced_now(world);
     compute_density();
     auto s1 = mpqc::fenced_now(world);
@@ -418,7 +432,18 @@ void CADFRHF<Tile, Policy>::init_fock_builder() {
 
 ///////////////  DirectRHF member functions
 template <typename Tile, typename Policy>
-DirectRHF<Tile, Policy>::DirectRHF(const KeyVal& kv) : RHF<Tile, Policy>(kv) {}
+DirectRHF<Tile, Policy>::DirectRHF(const KeyVal& kv) : RHF<Tile, Policy>(kv) {
+  incremental_fock_ = kv.value<bool>("incremental_fock", false);
+  const auto rebuild_period = kv.value<int>("fock_rebuild_period", 8);
+  if (rebuild_period < 1)
+    throw InputError("DirectRHF: fock_rebuild_period must be positive",
+                     __FILE__, __LINE__, "fock_rebuild_period");
+  fock_rebuild_period_ = rebuild_period;
+  fock_reduction_ = kv.value<std::string>("fock_reduction", "locked");
+  if (fock_reduction_ != "thread_local" && fock_reduction_ != "locked")
+    throw InputError("DirectRHF: invalid fock_reduction", __FILE__, __LINE__,
+                     "fock_reduction", fock_reduction_.c_str());
+}
 
 template <typename Tile, typename Policy>
 void DirectRHF<Tile, Policy>::init_fock_builder() {
@@ -430,7 +455,8 @@ void DirectRHF<Tile, Policy>::init_fock_builder() {
   auto basis =
       this->wfn_world()->basis_registry()->retrieve(OrbitalIndex(L"λ"));
   this->f_builder_ = std::make_unique<scf::FourCenterFockBuilder<Tile, Policy>>(
-      world, basis, basis, basis, true, true, screen, screen_threshold);
+      world, basis, basis, basis, true, true, screen, screen_threshold,
+      incremental_fock_, fock_rebuild_period_, fock_reduction_);
 }
 
 ///////////////  DirectRIRHF member functions
@@ -3,7 +3,15 @@
 #define MPQC4_SRC_MPQC_CHEMISTRY_QC_SCF_TRADITIONAL_FOUR_CENTER_FOCK_BUILDER_H_
 
 #include <cassert>
-
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
 #include <tiledarray.h>
 
 #include "mpqc/chemistry/qc/lcao/basis/basis.h"
@@ -79,6 +87,24 @@ class ReferenceFourCenterFockBuilder : public FockBuilder<Tile, Policy> {
 /// FourCenterFockBuilder is an integral-direct implementation of FockBuilder
 /// in a Gaussian AO basis that uses 4-center integrals and optimally takes
 /// advantage of the permutational symmetry and shell-level screening.
+///
+/// In the incremental mode the 2-e Fock matrix is updated as
+/// \f$ G(D_n) = G(D_{n-1}) + G(D_n - D_{n-1}) \f$, hence the shell-block norms
+/// of the density change drive the screening; the accumulated error is
+/// removed by rebuilding G from the full density every \c rebuild_period
+/// iterations.
+///
+/// The Fock tile contributions of the compute tasks are reduced either in a
+/// hash map shared by all threads, with a lock per tile ("locked" reduction),
+/// or in private per-thread maps that are merged, tile by tile in parallel,
+/// once all tasks are done ("thread_local" reduction). The latter avoids
+/// contention on the popular (e.g. diagonal) tiles at the cost of up to one
+/// copy of the local Fock tiles per thread.
+///
+/// The data that depends only on the basis, i.e. the Schwarz screener, the
+/// significant shell pairs of each pair of clusters, with their libint2
+/// primitive pair data, and the function offsets of each cluster, is computed
+/// once and reused by all tile quartets and all SCF iterations.
 template <typename Tile, typename Policy>
 class FourCenterFockBuilder
     : public FockBuilder<Tile, Policy>,
@@ -104,7 +130,10 @@ class FourCenterFockBuilder
                         std::shared_ptr<const Basis> density_basis,
                         bool compute_J, bool compute_K,
                         std::string screen = "schwarz",
-                        double screen_threshold = 1.0e-10)
+                        double screen_threshold = 1.0e-10,
+                        bool incremental = false,
+                        std::size_t rebuild_period = 8,
+                        std::string reduction = "locked")
       : WorldObject_(world),
         compute_J_(compute_J),
         compute_K_(compute_K),
@@ -112,10 +141,15 @@ class FourCenterFockBuilder
         ket_basis_(std::move(ket_basis)),
         density_basis_(std::move(density_basis)),
         screen_(screen),
-        screen_threshold_(screen_threshold) {
+        screen_threshold_(screen_threshold),
+        incremental_(incremental),
+        rebuild_period_(rebuild_period),
+        thread_local_reduction_(reduction == "thread_local") {
     // same basis on each center only
     assert(bra_basis_ == ket_basis_ && bra_basis_ == density_basis_ &&
            "not yet implemented");
+    assert((reduction == "thread_local" || reduction == "locked") &&
+           "invalid reduction");
     // WorldObject mandates this is called from the ctor
     WorldObject_::process_pending();
   }
@@ -137,19 +171,81 @@ class FourCenterFockBuilder
              tiles_range_D.extent(1) == ntiles_D);
     }
 
-    if (bra_basis_ == density_basis_ && ket_basis_ == density_basis_)
+    if (bra_basis_ == density_basis_ && ket_basis_ == density_basis_) {
+      if (incremental_) return compute_JK_incremental(D, target_precision);
       return compute_JK_aaaa(D, target_precision);
+    }
     assert(false && "feature not implemented");
     return array_type{};
   }
 
+  /// computes G(D) as G(D_prev) + G(D - D_prev), where D_prev is the density
+  /// used in the previous call; falls back to the full build in the first
+  /// call and every \c rebuild_period_ calls afterwards, i.e. each full build
+  /// is followed by \c rebuild_period_-1 incremental builds
+  array_type compute_JK_incremental(array_type const& D,
+                                    double target_precision) {
+    const auto full_rebuild = !D_prev_.is_initialized() ||
+                              !G_prev_.is_initialized() ||
+                              num_incremental_builds_ + 1 >= rebuild_period_;
+
+    array_type G;
+    if (full_rebuild) {
+      G = compute_JK_aaaa(D, target_precision);
+      num_incremental_builds_ = 0;
+      norm_delta_D_ = -1.0;
+    } else {
+      array_type delta_D;
+      delta_D("i,j") = D("i,j") - D_prev_("i,j");
+      norm_delta_D_ = delta_D("i,j").norm().get();
+      auto delta_G = compute_JK_aaaa(delta_D, target_precision);
+      G("i,j") = G_prev_("i,j") + delta_G("i,j");
+      ++num_incremental_builds_;
+    }
+
+    // keep private copies, the caller is free to reuse its arrays
+    D_prev_("i,j") = D("i,j");
+    G_prev_ = G;
+
+    return G;
+  }
+
+  /// @return true if the last call in the incremental mode updated G from the
+  /// change of the density, false if it rebuilt G from the full density
+  bool last_build_incremental() const { return norm_delta_D_ >= 0.0; }
+
   array_type compute_JK_aaaa(array_type const& D, double target_precision) {
-    dist_pmap_D_ = D.pmap();
+    return compute_JK_multi(std::vector<array_type>{D}, target_precision)[0];
+  }
+
+  /// computes G(D_k) for a batch of densities in one pass over the integrals:
+  /// each shell quartet is computed once and contracted with all densities.
+
+  /// @param D the densities
+  /// @param target_precision the target precision of the integrals
+  /// @param antisymmetric if nonempty, \c antisymmetric[k] is true if
+  /// \c D[k] is antisymmetric; then G(D[k]) is the (antisymmetric) exchange
+  /// contribution only, since the Coulomb contribution vanishes. By default
+  /// all densities are symmetric.
+  /// @return G(D[k]) for each density
+  std::vector<array_type> compute_JK_multi(
+      std::vector<array_type> const& D, double target_precision,
+      std::vector<bool> const& antisymmetric = {}) {
+    const auto ndensities = D.size();
+    TA_USER_ASSERT(ndensities > 0, "FourCenterFockBuilder: no densities");
+    TA_USER_ASSERT(antisymmetric.empty() || antisymmetric.size() == ndensities,
+                   "FourCenterFockBuilder: wrong number of symmetry flags");
+    antisymmetric_ = antisymmetric.empty()
+                         ? std::vector<bool>(ndensities, false)
+                         : antisymmetric;
+    dist_pmap_D_ = D[0].pmap();
 
     // Copy D and make it replicated.
-    array_type D_repl;
-    D_repl("i,j") = D("i,j");
-    D_repl.make_replicated();
+    D_repl_.resize(ndensities);
+    for (auto k = 0ul; k != ndensities; ++k) {
+      D_repl_[k]("i,j") = D[k]("i,j");
+      D_repl_[k].make_replicated();
+    }
 
     // prepare input data
     auto& compute_world = this->get_world();
@@ -158,8 +254,8 @@ class FourCenterFockBuilder
     target_precision_ = target_precision;
 
     const uint64_t ntiles = bra_basis_->nclusters();
-    trange_D_ = D_repl.trange();
-    pmap_D_ = D_repl.pmap();
+    trange_D_ = D_repl_[0].trange();
+    pmap_D_ = D_repl_[0].pmap();
 
     // make the engine pool
     auto oper_type = libint2::Operator::coulomb;
@@ -168,20 +264,38 @@ class FourCenterFockBuilder
         oper_type, utility::make_array_of_refs(basis, basis, basis, basis),
         libint2::BraKet::xx_xx);
 
-    // make screener
-    auto bases =
-        ::mpqc::lcao::gaussian::BasisVector{{basis, basis, basis, basis}};
-    p_screener_ = ::mpqc::lcao::gaussian::detail::make_screener(
-        compute_world, engines_, bases, screen_, screen_threshold_);
+    // make screener, it only depends on the basis
+    if (!p_screener_) {
+      auto bases =
+          ::mpqc::lcao::gaussian::BasisVector{{basis, basis, basis, basis}};
+      p_screener_ = ::mpqc::lcao::gaussian::detail::make_screener(
+          compute_world, engines_, bases, screen_, screen_threshold_);
+    }
+
+    // function offsets of the shells of each cluster
+    if (func_offset_lists_.empty()) {
+      using ::mpqc::lcao::gaussian::detail::compute_func_offset_list;
+      const auto& trange1 = trange_D_.dim(0);
+      for (auto tile = 0ul; tile != ntiles; ++tile) {
+        func_offset_lists_.emplace_back(compute_func_offset_list(
+            basis.cluster_shells()[tile], trange1.tile(tile).first));
+      }
+    }
 
     num_ints_computed_ = 0;
 
-    // make shell block norm of D
+    // make shell block norm of D; for a batch the sum of the norms of all
+    // densities is used for screening, it bounds the norm of each
     using ::mpqc::lcao::gaussian::detail::compute_shellblock_norm;
-    auto shblk_norm_D = compute_shellblock_norm(basis, basis, D);
-    shblk_norm_D.make_replicated();  // make sure it is replicated
+    shblk_norm_D_ = compute_shellblock_norm(basis, basis, D[0]);
+    for (auto k = 1ul; k < ndensities; ++k) {
+      shblk_norm_D_("i,j") +=
+          compute_shellblock_norm(basis, basis, D[k])("i,j");
+    }
+    shblk_norm_D_.make_replicated();  // make sure it is replicated
+    // the tasks read the local tiles of the replicated arrays directly
+    compute_world.gop.fence();
 
-    auto empty = TA::Future<Tile>(Tile());
     // todo screen loop with schwarz
     for (auto tile0 = 0ul, tile0123 = 0ul; tile0 != ntiles; ++tile0) {
       for (auto tile1 = 0ul; tile1 <= tile0; ++tile1) {
@@ -191,72 +305,10 @@ class FourCenterFockBuilder
           for (auto tile3 = 0ul; tile3 <= tile2; ++tile3, ++tile0123) {
             // TODO screen D blocks using schwarz estimate for this Coulomb
             // operator tile
-            auto D01 = (!compute_J_ || D_repl.is_zero({tile0, tile1}))
-                           ? empty
-                           : D_repl.find({tile0, tile1});
-            auto D23 = (!compute_J_ || D_repl.is_zero({tile2, tile3}))
-                           ? empty
-                           : D_repl.find({tile2, tile3});
-            auto D02 = (!compute_K_ || D_repl.is_zero({tile0, tile2}))
-                           ? empty
-                           : D_repl.find({tile0, tile2});
-            auto D03 = (!compute_K_ || D_repl.is_zero({tile0, tile3}))
-                           ? empty
-                           : D_repl.find({tile0, tile3});
-            auto D12 = (!compute_K_ || D_repl.is_zero({tile1, tile2}))
-                           ? empty
-                           : D_repl.find({tile1, tile2});
-            auto D13 = (!compute_K_ || D_repl.is_zero({tile1, tile3}))
-                           ? empty
-                           : D_repl.find({tile1, tile3});
-
-            // shell block norms of D
-            auto norm_D01 =
-                (!compute_J_ || shblk_norm_D.is_zero({tile0, tile1}))
-                    ? empty
-                    : shblk_norm_D.find({tile0, tile1});
-            auto norm_D23 =
-                (!compute_J_ || shblk_norm_D.is_zero({tile2, tile3}))
-                    ? empty
-                    : shblk_norm_D.find({tile2, tile3});
-            auto norm_D02 =
-                (!compute_K_ || shblk_norm_D.is_zero({tile0, tile2}))
-                    ? empty
-                    : shblk_norm_D.find({tile0, tile2});
-            auto norm_D03 =
-                (!compute_K_ || shblk_norm_D.is_zero({tile0, tile3}))
-                    ? empty
-                    : shblk_norm_D.find({tile0, tile3});
-            auto norm_D12 =
-                (!compute_K_ || shblk_norm_D.is_zero({tile1, tile2}))
-                    ? empty
-                    : shblk_norm_D.find({tile1, tile2});
-            auto norm_D13 =
-                (!compute_K_ || shblk_norm_D.is_zero({tile1, tile3}))
-                    ? empty
-                    : shblk_norm_D.find({tile1, tile3});
-
-            // clang-format off
-            // Using lambda as a task argument fails
-            // because madness cannot find type trait (constness) of
-            // lambda.
-            // To be fixed ...
-//            auto task_func = [&, this]() {
-//              this->compute_task(
-//                  D01, D23, D02, D03, D12, D13,
-//                  std::array<size_t, 4>{{tile0, tile1, tile2, tile3}},
-//                  std::array<Tile, 6>{{norm_D01, norm_D23, norm_D02, norm_D03,
-//                                       norm_D12, norm_D13}});
-//            };
-//            if (pmap->is_local(tile0123)) WorldObject_::task(me, task_func);
-            // clang-format on
-
             if (tile0123 % nproc == me)
               WorldObject_::task(
-                  me, &FourCenterFockBuilder_::compute_task, D01, D23, D02, D03,
-                  D12, D13, std::array<size_t, 4>{{tile0, tile1, tile2, tile3}},
-                  std::array<Tile, 6>{{norm_D01, norm_D23, norm_D02, norm_D03,
-                                       norm_D12, norm_D13}});
+                  me, &FourCenterFockBuilder_::compute_task,
+                  std::array<size_t, 4>{{tile0, tile1, tile2, tile3}});
           }
         }
       }
@@ -265,6 +317,8 @@ class FourCenterFockBuilder
     // fence ensures everyone is done
     compute_world.gop.fence();
 
+    if (thread_local_reduction_) reduce_thread_fock_tiles();
+
     // cleanup
     engines_.reset();
 
@@ -278,91 +332,41 @@ class FourCenterFockBuilder
     }
     ExEnv::out0() << std::endl;
 
+    const auto ntiles2 = ntiles * ntiles;
+    std::vector<array_type> G(ndensities);
     if (pmap_D_->is_replicated() && compute_world.size() > 1) {
       // Each process has its own copy of G which is treated differently.
       // Reduce all G's to a dist array
       for (const auto& local_tile : local_fock_tiles_) {
-        const auto ij = local_tile.first;
-        const auto proc01 = dist_pmap_D_->owner(ij);
+        const auto kij = local_tile.first;
+        const auto proc01 = dist_pmap_D_->owner(kij % ntiles2);
         WorldObject_::task(proc01, &FourCenterFockBuilder_::accumulate_array,
-                           local_tile.second, ij);
+                           local_tile.second, kij);
       }
       local_fock_tiles_.clear();
 
       compute_world.gop.fence();
 
-      typename Policy::shape_type shape;
-      // compute the shape, if sparse
-      if (!decltype(shape)::is_dense()) {
-        // extract local contribution to the shape of G, construct global shape
-        std::vector<std::pair<std::array<size_t, 2>, double>> global_tile_norms;
-        for (const auto& global_tile : global_fock_tiles_) {
-          const auto ij = global_tile.first;
-          const auto i = ij / ntiles;
-          const auto j = ij % ntiles;
-          const auto ij_norm = global_tile.second.norm();
-          global_tile_norms.push_back(
-              std::make_pair(std::array<size_t, 2>{{i, j}}, ij_norm));
-        }
-#if TA_DEFAULT_POLICY == 0
-        shape = decltype(shape)();
-#elif TA_DEFAULT_POLICY == 1
-        shape = decltype(shape)(compute_world, global_tile_norms, trange_D_);
-#endif
-      }
-
-      array_type G_dist(compute_world, trange_D_, shape, dist_pmap_D_);
-      for (const auto& global_tile : global_fock_tiles_) {
-        if (!G_dist.shape().is_zero(global_tile.first))
-          G_dist.set(global_tile.first, global_tile.second);
-      }
-      G_dist.fill_local(0.0, true);
+      for (auto k = 0ul; k != ndensities; ++k)
+        G[k] = make_fock_array(global_fock_tiles_, k, dist_pmap_D_);
       global_fock_tiles_.clear();
-
-      // symmetrize to account for permutation symmetry use
-      G_dist("i,j") = 0.5 * (G_dist("i,j") + G_dist("j,i"));
-      return G_dist;
-
     } else {
-      typename Policy::shape_type shape;
-      // compute the shape, if sparse
-      if (!decltype(shape)::is_dense()) {
-        // extract local contribution to the shape of G, construct global shape
-        std::vector<std::pair<std::array<size_t, 2>, double>> local_tile_norms;
-        for (const auto& local_tile_iter : local_fock_tiles_) {
-          const auto ij = local_tile_iter.first;
-          const auto i = ij / ntiles;
-          const auto j = ij % ntiles;
-          const auto ij_norm = local_tile_iter.second.norm();
-          local_tile_norms.push_back(
-              std::make_pair(std::array<size_t, 2>{{i, j}}, ij_norm));
-        }
-#if TA_DEFAULT_POLICY == 0
-        shape = decltype(shape)();
-#elif TA_DEFAULT_POLICY == 1
-        shape = decltype(shape)(compute_world, local_tile_norms, trange_D_);
-#endif
-      }
-
-      array_type G(compute_world, trange_D_, shape, pmap_D_);
-
-      // copy results of local reduction tasks into the local copy of G
-      for (const auto& local_tile : local_fock_tiles_) {
-        // if this tile was not truncated away
-        if (!G.shape().is_zero(local_tile.first))
-          G.set(local_tile.first, local_tile.second);
-      }
-      // set the remaining local tiles to 0 (this should only be needed for
-      // dense policy)
-      G.fill_local(0.0, true);
-
+      for (auto k = 0ul; k != ndensities; ++k)
+        G[k] = make_fock_array(local_fock_tiles_, k, pmap_D_);
       local_fock_tiles_.clear();
+    }
 
-      // symmetrize to account for permutation symmetry use
-      G("i,j") = 0.5 * (G("i,j") + G("j,i"));
+    D_repl_.clear();
+    shblk_norm_D_ = array_type();
 
-      return G;
+    // symmetrize to account for permutation symmetry use
+    for (auto k = 0ul; k != ndensities; ++k) {
+      if (antisymmetric_[k])
+        G[k]("i,j") = 0.5 * (G[k]("i,j") - G[k]("j,i"));
+      else
+        G[k]("i,j") = 0.5 * (G[k]("i,j") + G[k]("j,i"));
     }
+    return G;
   }
 
   void register_fock(const array_type& fock,
@@ -370,7 +374,14 @@ class FourCenterFockBuilder
     registry.insert(Formula(L"(κ|F|λ)"), fock);
   }
 
-  inline void print_iter(std::string const& leader) override {}
+  inline void print_iter(std::string const& leader) override {
+    if (!incremental_) return;
+    if (norm_delta_D_ < 0.0)
+      ExEnv::out0() << leader << "Fock Build: full" << std::endl;
+    else
+      ExEnv::out0() << leader << "Fock Build: incremental, ||ΔD|| = "
+                    << norm_delta_D_ << std::endl;
+  }
 
  private:
   // set by ctor
@@ -381,22 +392,49 @@ class FourCenterFockBuilder
   std::shared_ptr<const Basis> density_basis_;
   const std::string screen_;
   const double screen_threshold_;
+  const bool incremental_;
+  const std::size_t rebuild_period_;
+  const bool thread_local_reduction_;
+
+  // state of the incremental build
+  array_type D_prev_;
+  array_type G_prev_;
+  std::size_t num_incremental_builds_ = 0;
+  double norm_delta_D_ = -1.0;
 
   // mutated by compute_ functions
   std::shared_ptr<lcao::Screener> p_screener_;
   madness::ConcurrentHashMap<std::size_t, Tile> local_fock_tiles_;
   madness::ConcurrentHashMap<std::size_t, Tile> global_fock_tiles_;
+  tbb::enumerable_thread_specific<std::unordered_map<std::size_t, Tile>>
+      thread_fock_tiles_;
   TA::TiledRange trange_D_;
   std::shared_ptr<TA::Pmap> pmap_D_;
   std::shared_ptr<TA::Pmap> dist_pmap_D_;
+  std::vector<array_type> D_repl_;
+  array_type shblk_norm_D_;
+  std::vector<bool> antisymmetric_;
   double target_precision_ = 0.0;
   ::mpqc::lcao::gaussian::ShrPool<libint2::Engine> engines_;
+
+  /// significant shell pairs of a pair of clusters, with their libint2
+  /// primitive pair data, \c shellpairs.at(sh0)[i] is the pair data of
+  /// {sh0, shellpair_list.at(sh0)[i]}
+  struct ShellPairData {
+    shellpair_list_t shellpair_list;
+    std::unordered_map<size_t, std::vector<libint2::ShellPair>> shellpairs;
+  };
+  // computed on demand, keyed by the ordinal of the cluster pair
+  madness::ConcurrentHashMap<std::size_t,
+                             std::shared_ptr<const ShellPairData>>
+      shellpair_cache_;
+  std::vector<func_offset_list> func_offset_lists_;
   std::atomic<size_t> num_ints_computed_{0};
 
-  void accumulate_array(Tile arg_tile, long tile01) {
+  void accumulate_array(Tile arg_tile, long ktile01) {
     typename decltype(global_fock_tiles_)::accessor acc;
     if (!global_fock_tiles_.insert(
-            acc, std::make_pair(tile01, arg_tile))) {  // CRITICAL SECTION
+            acc, std::make_pair(ktile01, arg_tile))) {  // CRITICAL SECTION
       const auto size = arg_tile.range().volume();
       TA::math::inplace_vector_op_serial(
           [](TA::detail::numeric_t<Tile>& l,
@@ -406,17 +444,36 @@ class FourCenterFockBuilder
     acc.release();  // END OF CRITICAL SECTION
   }
 
-  void accumulate_task(Tile fock_matrix_tile, long tile0, long tile1) {
+  /// @param k the index of the density
+  void accumulate_task(Tile fock_matrix_tile, std::size_t k, long tile0,
+                       long tile1) {
     const auto ntiles = trange_D_.dim(0).tile_extent();
     const auto tile01 = tile0 * ntiles + tile1;
     assert(pmap_D_->is_local(tile01));
+    // the reduction maps are keyed by {k, tile0, tile1}
+    const auto ktile01 = k * ntiles * ntiles + tile01;
+    if (thread_local_reduction_) {
+      // no other thread touches this map
+      auto& tiles = thread_fock_tiles_.local();
+      auto it = tiles.find(ktile01);
+      if (it == tiles.end()) {
+        tiles.emplace(ktile01, fock_matrix_tile);
+      } else {
+        const auto size = fock_matrix_tile.range().volume();
+        TA::math::inplace_vector_op_serial(
+            [](TA::detail::numeric_t<Tile>& l,
+               const TA::detail::numeric_t<Tile> r) { l += r; },
+            size, it->second.data(), fock_matrix_tile.data());
+      }
+      return;
+    }
     // if reducer does not exist, create entry and store F, else accumulate F to
     // the existing contents
     typename decltype(local_fock_tiles_)::accessor acc;
     // try inserting, otherwise, accumulate
     if (!local_fock_tiles_.insert(
             acc,
-            std::make_pair(tile01, fock_matrix_tile))) {  // CRITICAL SECTION
+            std::make_pair(ktile01, fock_matrix_tile))) {  // CRITICAL SECTION
       // NB can't do acc->second += fock_matrix_tile to avoid spawning TBB
       // tasks from critical section
       const auto size = fock_matrix_tile.range().volume();
@@ -428,9 +485,81 @@ class FourCenterFockBuilder
     acc.release();  // END OF CRITICAL SECTION
   }
 
-  void compute_task(Tile D01, Tile D23, Tile D02, Tile D03, Tile D12, Tile D13,
-                    std::array<size_t, 4> tile_idx,
-                    std::array<Tile, 6> norm_D) {
+  /// merges the per-thread Fock tiles into local_fock_tiles_; each tile is
+  /// summed by one task, hence no locks are contended
+  void reduce_thread_fock_tiles() {
+    std::unordered_map<std::size_t, std::vector<Tile*>> contributions;
+    for (auto& tiles : thread_fock_tiles_) {
+      for (auto& tile : tiles)
+        contributions[tile.first].push_back(&tile.second);
+    }
+    std::vector<std::pair<std::size_t, std::vector<Tile*>>> tile_contributions(
+        contributions.begin(), contributions.end());
+    contributions.clear();
+
+    tbb::parallel_for(
+        std::size_t(0), tile_contributions.size(), [&](std::size_t t) {
+          const auto ktile01 = tile_contributions[t].first;
+          const auto& tiles = tile_contributions[t].second;
+          Tile& result = *tiles[0];
+          const auto size = result.range().volume();
+          for (auto i = 1ul; i < tiles.size(); ++i) {
+            TA::math::inplace_vector_op_serial(
+                [](TA::detail::numeric_t<Tile>& l,
+                   const TA::detail::numeric_t<Tile> r) { l += r; },
+                size, result.data(), tiles[i]->data());
+          }
+          local_fock_tiles_.insert(std::make_pair(ktile01, result));
+        });
+
+    thread_fock_tiles_.clear();
+  }
+
+  /// @return the array of G(D[k]) made of the tiles of \c tiles with keys
+  /// {k, tile0, tile1}
+  array_type make_fock_array(
+      const madness::ConcurrentHashMap<std::size_t, Tile>& tiles,
+      std::size_t k, const std::shared_ptr<TA::Pmap>& pmap) {
+    auto& compute_world = this->get_world();
+    const auto ntiles = trange_D_.dim(0).tile_extent();
+    const auto ntiles2 = ntiles * ntiles;
+
+    typename Policy::shape_type shape;
+    // compute the shape, if sparse
+    if (!decltype(shape)::is_dense()) {
+      // extract local contribution to the shape of G, construct global shape
+      std::vector<std::pair<std::array<size_t, 2>, double>> tile_norms;
+      for (const auto& tile : tiles) {
+        if (tile.first / ntiles2 != k) continue;
+        const auto ij = tile.first % ntiles2;
+        const auto i = ij / ntiles;
+        const auto j = ij % ntiles;
+        tile_norms.push_back(
+            std::make_pair(std::array<size_t, 2>{{i, j}}, tile.second.norm()));
+      }
+#if TA_DEFAULT_POLICY == 0
+      shape = decltype(shape)();
+#elif TA_DEFAULT_POLICY == 1
+      shape = decltype(shape)(compute_world, tile_norms, trange_D_);
+#endif
+    }
+
+    array_type G(compute_world, trange_D_, shape, pmap);
+    // copy results of local reduction tasks into the local copy of G
+    for (const auto& tile : tiles) {
+      if (tile.first / ntiles2 != k) continue;
+      const auto ij = tile.first % ntiles2;
+      // if this tile was not truncated away
+      if (!G.shape().is_zero(ij)) G.set(ij, tile.second);
+    }
+    // set the remaining local tiles to 0 (this should only be needed for
+    // dense policy)
+    G.fill_local(0.0, true);
+    return G;
+  }
+
+  void compute_task(std::array<size_t, 4> tile_idx) {
+    using numeric_type = TA::detail::numeric_t<Tile>;
     const auto tile0 = tile_idx[0];
     const auto tile1 = tile_idx[1];
     const auto tile2 = tile_idx[2];
@@ -446,43 +575,59 @@ class FourCenterFockBuilder
     const auto rng2_size = rng2.second - rng2.first;
     const auto rng3_size = rng3.second - rng3.first;
 
-    // 2-d tile ranges describing the Fock contribution blocks produced by this
-    auto rng01 = compute_J_ ? TA::Range({rng0, rng1}) : TA::Range();
-    auto rng23 = compute_J_ ? TA::Range({rng2, rng3}) : TA::Range();
-    auto rng02 = compute_K_ ? TA::Range({rng0, rng2}) : TA::Range();
-    auto rng03 = compute_K_ ? TA::Range({rng0, rng3}) : TA::Range();
-    auto rng12 = compute_K_ ? TA::Range({rng1, rng2}) : TA::Range();
-    auto rng13 = compute_K_ ? TA::Range({rng1, rng3}) : TA::Range();
-
-    // initialize contribution to the Fock matrices
-    auto F01 = compute_J_ ? Tile(std::move(rng01), 0.0) : Tile();
-    auto F23 = compute_J_ ? Tile(std::move(rng23), 0.0) : Tile();
-    auto F02 = compute_K_ ? Tile(std::move(rng02), 0.0) : Tile();
-    auto F03 = compute_K_ ? Tile(std::move(rng03), 0.0) : Tile();
-    auto F12 = compute_K_ ? Tile(std::move(rng12), 0.0) : Tile();
-    auto F13 = compute_K_ ? Tile(std::move(rng13), 0.0) : Tile();
-
+    // the tile pairs of the Fock contribution blocks produced by this task,
+    // {01, 23} are Coulomb, {02, 03, 12, 13} exchange
+    const std::array<std::array<size_t, 2>, 6> pairs{{{{tile0, tile1}},
+                                                      {{tile2, tile3}},
+                                                      {{tile0, tile2}},
+                                                      {{tile0, tile3}},
+                                                      {{tile1, tile2}},
+                                                      {{tile1, tile3}}}};
+    const auto is_coulomb = [](std::size_t p) { return p < 2; };
+
+    // shell block norms of D
+    std::array<Tile, 6> norm_D;
+    for (auto p = 0ul; p != 6; ++p) {
+      const auto needed = is_coulomb(p) ? compute_J_ : compute_K_;
+      if (needed && !shblk_norm_D_.is_zero(pairs[p]))
+        norm_D[p] = shblk_norm_D_.find(pairs[p]).get();
+    }
+    std::array<const numeric_type*, 6> norm_D_ptr;
+    for (auto p = 0ul; p != 6; ++p)
+      norm_D_ptr[p] = norm_D[p].empty() ? nullptr : norm_D[p].data();
+    const auto* norm_D01_ptr = norm_D_ptr[0];
+    const auto* norm_D23_ptr = norm_D_ptr[1];
+    const auto* norm_D02_ptr = norm_D_ptr[2];
+    const auto* norm_D03_ptr = norm_D_ptr[3];
+    const auto* norm_D12_ptr = norm_D_ptr[4];
+    const auto* norm_D13_ptr = norm_D_ptr[5];
+
+    // density tiles and contributions to the Fock matrices of each density;
+    // the Coulomb contribution of an antisymmetric density vanishes
+    const auto ndensities = D_repl_.size();
+    std::vector<std::array<Tile, 6>> D(ndensities);
+    std::vector<std::array<Tile, 6>> F(ndensities);
     // grab ptrs to tile data to make addressing more efficient
-    auto* F01_ptr = compute_J_ ? F01.data() : nullptr;
-    auto* F23_ptr = compute_J_ ? F23.data() : nullptr;
-    auto* F02_ptr = compute_K_ ? F02.data() : nullptr;
-    auto* F03_ptr = compute_K_ ? F03.data() : nullptr;
-    auto* F12_ptr = compute_K_ ? F12.data() : nullptr;
-    auto* F13_ptr = compute_K_ ? F13.data() : nullptr;
-    const auto* D01_ptr = compute_J_ ? D01.data() : nullptr;
-    const auto* D23_ptr = compute_J_ ? D23.data() : nullptr;
-    const auto* D02_ptr = compute_K_ ? D02.data() : nullptr;
-    const auto* D03_ptr = compute_K_ ? D03.data() : nullptr;
-    const auto* D12_ptr = compute_K_ ? D12.data() : nullptr;
-    const auto* D13_ptr = compute_K_ ? D13.data() : nullptr;
-    const auto* norm_D01_ptr = compute_J_ ? norm_D[0].data() : nullptr;
-    const auto* norm_D23_ptr = compute_J_ ? norm_D[1].data() : nullptr;
-    const auto* norm_D02_ptr = compute_K_ ? norm_D[2].data() : nullptr;
-    const auto* norm_D03_ptr = compute_K_ ? norm_D[3].data() : nullptr;
-    const auto* norm_D12_ptr = compute_K_ ? norm_D[4].data() : nullptr;
-    const auto* norm_D13_ptr = compute_K_ ? norm_D[5].data() : nullptr;
-
-    using ::mpqc::lcao::gaussian::detail::compute_func_offset_list;
+    struct DensityPtrs {
+      std::array<const numeric_type*, 6> D;
+      std::array<numeric_type*, 6> F;
+    };
+    std::vector<DensityPtrs> ptrs(ndensities);
+    for (auto k = 0ul; k != ndensities; ++k) {
+      for (auto p = 0ul; p != 6; ++p) {
+        const auto needed =
+            is_coulomb(p) ? compute_J_ && !antisymmetric_[k] : compute_K_;
+        if (needed) {
+          if (!D_repl_[k].is_zero(pairs[p]))
+            D[k][p] = D_repl_[k].find(pairs[p]).get();
+          F[k][p] = Tile(TA::Range({trange1.tile(pairs[p][0]),
+                                    trange1.tile(pairs[p][1])}),
+                         0.0);
+        }
+        ptrs[k].D[p] = D[k][p].empty() ? nullptr : D[k][p].data();
+        ptrs[k].F[p] = F[k][p].empty() ? nullptr : F[k][p].data();
+      }
+    }
 
     // compute contributions to all Fock matrices
     {
@@ -499,27 +644,11 @@ class FourCenterFockBuilder
       const auto& cluster2 = basis->cluster_shells()[tile2];
       const auto& cluster3 = basis->cluster_shells()[tile3];
 
-      // make unique shell pair list
-      const auto same_c0c1 = tile0 == tile1;
-      const auto same_c2c3 = tile2 == tile3;
-      const auto same_c0c2 = tile0 == tile2;
-      shellpair_list_t bra_shellpair_list, ket_shellpair_list;
-      if (same_c0c1 && same_c2c3 && same_c0c2) {
-        bra_shellpair_list = compute_shellpair_list(cluster0);
-        ket_shellpair_list = bra_shellpair_list;
-      } else if (same_c0c1 && same_c2c3 && !same_c0c2) {
-        bra_shellpair_list = compute_shellpair_list(cluster0);
-        ket_shellpair_list = compute_shellpair_list(cluster2);
-      } else if (same_c0c1 && !same_c2c3) {
-        bra_shellpair_list = compute_shellpair_list(cluster0);
-        ket_shellpair_list = compute_shellpair_list(cluster2, cluster3);
-      } else if (!same_c0c1 && same_c2c3) {
-        bra_shellpair_list = compute_shellpair_list(cluster0, cluster1);
-        ket_shellpair_list = compute_shellpair_list(cluster2);
-      } else {
-        bra_shellpair_list = compute_shellpair_list(cluster0, cluster1);
-        ket_shellpair_list = compute_shellpair_list(cluster2, cluster3);
-      }
+      // significant shell pairs, unique if the clusters are the same
+      const auto bra_data = shellpair_data(tile0, tile1);
+      const auto ket_data = shellpair_data(tile2, tile3);
+      const auto& bra_shellpair_list = bra_data->shellpair_list;
+      const auto& ket_shellpair_list = ket_data->shellpair_list;
 
       // number of shells in each cluster
       const auto nshells0 = cluster0.size();
@@ -527,9 +656,9 @@ class FourCenterFockBuilder
       const auto nshells2 = cluster2.size();
       const auto nshells3 = cluster3.size();
 
-      // compute offset list of cluster1 and cluster3
-      auto offset_list_c1 = compute_func_offset_list(cluster1, rng1.first);
-      auto offset_list_c3 = compute_func_offset_list(cluster3, rng3.first);
+      // offset list of cluster1 and cluster3
+      const auto& offset_list_c1 = func_offset_lists_[tile1];
+      const auto& offset_list_c3 = func_offset_lists_[tile3];
 
       // this is the index of the first basis functions for each shell *in this
       // shell cluster*
@@ -547,8 +676,11 @@ class FourCenterFockBuilder
         const auto& shell0 = cluster0[sh0];
         const auto nf0 = shell0.size();
 
-        for (const auto& sh1 : bra_shellpair_list[sh0]) {
-          std::tie(cf1_offset, bf1_offset) = offset_list_c1[sh1];
+        const auto& sh1_list = bra_shellpair_list.at(sh0);
+        const auto& shellpairs01 = bra_data->shellpairs.at(sh0);
+        for (auto p01 = 0ul; p01 != sh1_list.size(); ++p01) {
+          const auto sh1 = sh1_list[p01];
+          std::tie(cf1_offset, bf1_offset) = offset_list_c1.at(sh1);
           // skip if shell set is nonunique
           if (bf0_offset < bf1_offset)
             break;  // assuming basis functions increase monotonically in the
@@ -584,8 +716,11 @@ class FourCenterFockBuilder
                 (norm_D12_ptr != nullptr) ? norm_D12_ptr[sh12] : 0.0;
             const auto Dnorm012 = std::max({Dnorm12, Dnorm02, Dnorm01});
 
-            for (const auto& sh3 : ket_shellpair_list[sh2]) {
-              std::tie(cf3_offset, bf3_offset) = offset_list_c3[sh3];
+            const auto& sh3_list = ket_shellpair_list.at(sh2);
+            const auto& shellpairs23 = ket_data->shellpairs.at(sh2);
+            for (auto p23 = 0ul; p23 != sh3_list.size(); ++p23) {
+              const auto sh3 = sh3_list[p23];
+              std::tie(cf3_offset, bf3_offset) = offset_list_c3.at(sh3);
               // skip if shell set is nonunique
               if (bf2_offset < bf3_offset ||
                   (bf0_offset == bf2_offset && bf1_offset < bf3_offset))
@@ -624,8 +759,9 @@ class FourCenterFockBuilder
 
               // compute shell set
               engine.compute2<libint2::Operator::coulomb,
-                              libint2::BraKet::xx_xx, 0>(shell0, shell1, shell2,
-                                                         shell3);
+                              libint2::BraKet::xx_xx, 0>(
+                  shell0, shell1, shell2, shell3, &shellpairs01[p01],
+                  &shellpairs23[p23]);
               const auto* eri_0123 = computed_shell_sets[0];
 
               if (eri_0123 !=
@@ -664,37 +800,29 @@ class FourCenterFockBuilder
                         const auto value_scaled_by_multiplicity =
                             value * multiplicity;
 
-                        if (compute_J_) {
-                          F01_ptr[cf01] +=
-                              (D23_ptr != nullptr)
-                                  ? D23_ptr[cf23] * value_scaled_by_multiplicity
-                                  : 0.0;
-                          F23_ptr[cf23] +=
-                              (D01_ptr != nullptr)
-                                  ? D01_ptr[cf01] * value_scaled_by_multiplicity
-                                  : 0.0;
-                        }
-                        if (compute_K_) {
-                          F02_ptr[cf02] -=
-                              (D13_ptr != nullptr)
-                                  ? 0.25 * D13_ptr[cf13] *
-                                        value_scaled_by_multiplicity
-                                  : 0.0;
-                          F13_ptr[cf13] -=
-                              (D02_ptr != nullptr)
-                                  ? 0.25 * D02_ptr[cf02] *
-                                        value_scaled_by_multiplicity
-                                  : 0.0;
-                          F03_ptr[cf03] -=
-                              (D12_ptr != nullptr)
-                                  ? 0.25 * D12_ptr[cf12] *
-                                        value_scaled_by_multiplicity
-                                  : 0.0;
-                          F12_ptr[cf12] -=
-                              (D03_ptr != nullptr)
-                                  ? 0.25 * D03_ptr[cf03] *
-                                        value_scaled_by_multiplicity
-                                  : 0.0;
+                        for (const auto& d : ptrs) {
+                          // Coulomb
+                          if (d.F[0] != nullptr) {
+                            if (d.D[1] != nullptr)
+                              d.F[0][cf01] +=
+                                  d.D[1][cf23] * value_scaled_by_multiplicity;
+                            if (d.D[0] != nullptr)
+                              d.F[1][cf23] +=
+                                  d.D[0][cf01] * value_scaled_by_multiplicity;
+                          }
+                          // exchange
+                          if (d.F[2] != nullptr) {
+                            const auto value_K =
+                                0.25 * value_scaled_by_multiplicity;
+                            if (d.D[5] != nullptr)
+                              d.F[2][cf02] -= d.D[5][cf13] * value_K;
+                            if (d.D[2] != nullptr)
+                              d.F[5][cf13] -= d.D[2][cf02] * value_K;
+                            if (d.D[4] != nullptr)
+                              d.F[3][cf03] -= d.D[4][cf12] * value_K;
+                            if (d.D[3] != nullptr)
+                              d.F[4][cf12] -= d.D[3][cf03] * value_K;
+                          }
                         }
                       }
                     }
@@ -715,16 +843,47 @@ class FourCenterFockBuilder
 
     // accumulate the contributions by submitting tasks to the owners of their
     // tiles
-    if (compute_J_) {
-      FourCenterFockBuilder_::accumulate_task(F01, tile_idx[0], tile_idx[1]);
-      FourCenterFockBuilder_::accumulate_task(F23, tile_idx[2], tile_idx[3]);
+    for (auto k = 0ul; k != ndensities; ++k) {
+      for (auto p = 0ul; p != 6; ++p) {
+        if (!F[k][p].empty())
+          FourCenterFockBuilder_::accumulate_task(F[k][p], k, pairs[p][0],
+                                                  pairs[p][1]);
+      }
+    }
+  }
+
+  /// @return the significant shell pairs of clusters \c tile0 and \c tile1
+  /// (only the unique ones if they are the same cluster), computed on first
+  /// use
+  std::shared_ptr<const ShellPairData> shellpair_data(std::size_t tile0,
+                                                      std::size_t tile1) {
+    const auto key = tile0 * bra_basis_->nclusters() + tile1;
+    {
+      typename decltype(shellpair_cache_)::const_accessor acc;
+      if (shellpair_cache_.find(acc, key)) return acc->second;
     }
-    if (compute_K_) {
-      FourCenterFockBuilder_::accumulate_task(F02, tile_idx[0], tile_idx[2]);
-      FourCenterFockBuilder_::accumulate_task(F03, tile_idx[0], tile_idx[3]);
-      FourCenterFockBuilder_::accumulate_task(F12, tile_idx[1], tile_idx[2]);
-      FourCenterFockBuilder_::accumulate_task(F13, tile_idx[1], tile_idx[3]);
+
+    // compute outside of the critical section; if another thread computes the
+    // same pair concurrently the first inserted copy is kept
+    const auto& cluster0 = bra_basis_->cluster_shells()[tile0];
+    const auto& cluster1 = bra_basis_->cluster_shells()[tile1];
+    auto data = std::make_shared<ShellPairData>();
+    data->shellpair_list = (tile0 == tile1)
+                               ? compute_shellpair_list(cluster0)
+                               : compute_shellpair_list(cluster0, cluster1);
+    // keep all primitive pairs that can matter at any engine precision
+    const auto ln_prec = std::log(std::numeric_limits<double>::epsilon());
+    for (const auto& sh0_list : data->shellpair_list) {
+      const auto sh0 = sh0_list.first;
+      auto& shellpairs = data->shellpairs[sh0];
+      shellpairs.reserve(sh0_list.second.size());
+      for (const auto sh1 : sh0_list.second)
+        shellpairs.emplace_back(cluster0[sh0], cluster1[sh1], ln_prec);
     }
+
+    typename decltype(shellpair_cache_)::accessor acc;
+    if (shellpair_cache_.insert(acc, key)) acc->second = std::move(data);
+    return acc->second;
   }
 
   /*!
@@ -11,6 +11,7 @@
 #include "mpqc/chemistry/qc/lcao/expression/trange1_engine.h"
 #include "mpqc/chemistry/qc/lcao/factory/periodic_ao_factory.h"
 #include "mpqc/chemistry/qc/lcao/scf/builder.h"
+#include "mpqc/chemistry/qc/lcao/scf/pbc/periodic_lattice_transform.h"
 
 
 // constant: imaginary unit i
@@ -63,6 +64,7 @@ class zRHF : public PeriodicAOWavefunction<Tile, Policy>,
    * | @c diis_mixing | real | 0 | this nonnegative floating point number is used to dampen the DIIS extrapolation by mixing the input Fock with the output Fock for each iteration |
    * | @c diis_num_iters_group | unsigned int | 1 | the number of iterations in a DIIS group | DIIS extrapolation is only used for the first \c diis_num_extrap_group of these iterations |
    * | @c diis_num_extrap_group | unsigned int | 1 | the number of DIIS extrapolations to do at the beginning of an iteration group |
+   * | @c time_reversal_symmetry | bool | false | if true, use F(-k) = F(k)^* to store and diagonalize only the irreducible half of the k points |
    *
    * example input:
    *
@@ -117,6 +119,12 @@ class zRHF : public PeriodicAOWavefunction<Tile, Policy>,
    */
   std::pair<array_type, array_type_z> compute_density();
 
+  /*!
+   * \brief This replicates the crystal orbital coefficients, which
+   * compute_density() leaves on the ranks that diagonalized their k-blocks
+   */
+  void replicate_co_coeff();
+
   /*!
    * \brief This transforms an integral matrix from real to reciprocal space
    * via M(μ, ν_k) = \sum_R exp(I k.R) M(μ, ν_R).
@@ -125,11 +133,14 @@ class zRHF : public PeriodicAOWavefunction<Tile, Policy>,
    * sum of \c R. n1, n2 and n3 are non-negative integers.
    * \param recip_lattice_range number of k points (k1, k2, k3) in reciprocal
    * space. k1, k2, and k3 are positive integers
+   * \param time_reversal if true, only the irreducible half of the k points is
+   * computed, i.e. M(μ, ν_-k) = M(μ, ν_k)^* is implied
    * \return the reciprocal-space integral matrix M(μ, ν_k)
    */
   array_type_z transform_real2recip(const array_type& matrix,
                                     const Vector3i& real_lattice_range,
-                                    const Vector3i& recip_lattice_range);
+                                    const Vector3i& recip_lattice_range,
+                                    bool time_reversal = false);
 
   /*!
    * \brief This transforms an integral matrix from real to reciprocal space
@@ -139,6 +150,23 @@ class zRHF : public PeriodicAOWavefunction<Tile, Policy>,
    */
   array_type_z transform_real2recip(const array_type& matrix);
 
+  /*!
+   * \brief This transforms a matrix from reciprocal to real space
+   * via M(μ, ν_R) = Re \sum_k exp(I k.R) M(μ, ν_k) / N_k.
+   * \param matrix the reciprocal-space matrix M(μ, ν_k)
+   * \param real_lattice_range maximum unit cell index (n1, n2, n3) of \c R.
+   * n1, n2 and n3 are non-negative integers.
+   * \param recip_lattice_range number of k points (k1, k2, k3) in reciprocal
+   * space. k1, k2, and k3 are positive integers
+   * \param time_reversal if true, only the irreducible half of the k points is
+   * used, i.e. M(μ, ν_-k) = M(μ, ν_k)^* is implied
+   * \return the real-space matrix M(μ, ν_R)
+   */
+  array_type transform_recip2real(const array_type_z& matrix,
+                                  const Vector3i& real_lattice_range,
+                                  const Vector3i& recip_lattice_range,
+                                  bool time_reversal = false);
+
   /*!
    * \brief This changes phase factor of a complex value
    * \param arg_value original complex value
@@ -170,7 +198,8 @@ class zRHF : public PeriodicAOWavefunction<Tile, Policy>,
   array_type_z Fk_;
   array_type_z Dk_;
 
-  MatrixzVec C_;
+  MatrixzVec C_;  // only the k-blocks of this rank, unless C_replicated_
+  bool C_replicated_ = false;
   VectordVec eps_;
   MatrixzVec X_;
 
@@ -194,6 +223,7 @@ class zRHF : public PeriodicAOWavefunction<Tile, Policy>,
   unsigned int diis_num_extrap_group_;
 
   double level_shift_;
+  bool time_reversal_;
 
   Vector3i R_max_;
   Vector3i RJ_max_;
@@ -205,6 +235,8 @@ class zRHF : public PeriodicAOWavefunction<Tile, Policy>,
   int64_t RD_size_;
   int64_t k_size_;
 
+  std::unique_ptr<scf::PeriodicLatticeTransform<Policy>> lattice_transform_;
+
   double init_duration_ = 0.0;
   double j_duration_ = 0.0;
   double k_duration_ = 0.0;
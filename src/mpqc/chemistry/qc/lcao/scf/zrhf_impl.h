@@ -39,6 +39,7 @@ void zRHF<Tile, Policy>::init(const KeyVal& kv) {
   max_condition_num_ = kv.value<double>("max_condition_num", 1.0e8);
   fmix_ = kv.value<double>("fock_mixing", 0.0);
   level_shift_ = kv.value<double>("level_shift", 0.0);
+  time_reversal_ = kv.value<bool>("time_reversal_symmetry", false);
 
   diis_ = kv.value<std::string>("diis", "none");
   diis_start_ = kv.value<unsigned int>("diis_start", 1);
@@ -72,6 +73,8 @@ void zRHF<Tile, Policy>::init(const KeyVal& kv) {
                      __LINE__, "unitcell");
   docc_ = nelectrons / 2;
   dcell_ = unitcell.dcell();
+  lattice_transform_ =
+      std::make_unique<scf::PeriodicLatticeTransform<Policy>>(world, dcell_);
 
   // retrieve unitcell info from periodic ao_factory
   R_max_ = ao_factory.R_max();
@@ -93,6 +96,9 @@ void zRHF<Tile, Policy>::init(const KeyVal& kv) {
   ExEnv::out0() << "zRHF computational parameters:" << std::endl;
   ExEnv::out0() << indent << "# of k points in each direction: ["
                 << nk_.transpose() << "]" << std::endl;
+  if (time_reversal_)
+    ExEnv::out0() << indent << "# of irreducible k points (time reversal): "
+                  << (k_size_ + 1) / 2 << std::endl;
 
   eps_.resize(k_size_);
   C_.resize(k_size_);
@@ -144,7 +150,7 @@ void zRHF<Tile, Policy>::init(const KeyVal& kv) {
   }
 
   // transform Fock from real to reciprocal space
-  Fk_ = transform_real2recip(F_init);
+  Fk_ = transform_real2recip(F_init, R_max_, nk_, time_reversal_);
   // compute orthogonalizer matrix
   X_ = utility::conditioned_orthogonalizer(Sk_, k_size_, max_condition_num_,
                                            print_max_item_);
@@ -214,7 +220,7 @@ void zRHF<Tile, Policy>::solve(double thresh) {
 
     // transform Fock from real to reciprocal space
     auto trans_start = mpqc::fenced_now(world);
-    Fk_ = transform_real2recip(F_, fock_lattice_range, nk_);
+    Fk_ = transform_real2recip(F_, fock_lattice_range, nk_, time_reversal_);
     auto trans_end = mpqc::fenced_now(world);
     trans_duration_ += mpqc::duration_in_s(trans_start, trans_end);
 
@@ -329,6 +335,9 @@ void zRHF<Tile, Policy>::solve(double thresh) {
   // print out band gap information
   print_band_gaps();
 
+  // the crystal orbitals are needed on every rank by the correlated methods
+  replicate_co_coeff();
+
   // store fock matrix in registry
   auto& registry = this->ao_factory().registry();
   f_builder_->register_fock(F_, registry);
@@ -391,22 +400,41 @@ zRHF<Tile, Policy>::compute_density() {
   using ::mpqc::detail::extend_trange1;
 
   auto tr0 = Fk_.trange().data()[0];
-  auto tr1_real = extend_trange1(tr0, RD_size_);
   auto tr1_recip = extend_trange1(tr0, k_size_);
 
   const auto ext0 = tr0.extent();
-  RowMatrixXd result_real_eig(ext0, tr1_real.extent());
-  MatrixZ result_recip_eig(ext0, tr1_recip.extent());
-  result_real_eig.setZero();
-  result_recip_eig.setZero();
+  const auto ntiles0 = tr0.tile_extent();
+  const auto me = world.rank();
+
+  // the k-blocks are distributed: block k is diagonalized, and its density
+  // built, by the owner of its first tile, which fetches only the other tiles
+  // of the block
+  auto k_owner = [&](int64_t k) {
+    return Fk_.pmap()->owner(Fk_.trange().tiles_range().ordinal(
+        std::array<std::size_t, 2>{{0, std::size_t(k) * ntiles0}}));
+  };
+  auto k_block = [&](const array_type_z& A, int64_t k) {
+    MatrixZ result = MatrixZ::Zero(ext0, ext0);
+    std::vector<std::pair<TA::Range, madness::Future<TA::TensorZ>>> tiles;
+    for (auto i = 0ul; i != ntiles0; ++i) {
+      for (auto j = 0ul; j != ntiles0; ++j) {
+        const std::array<std::size_t, 2> idx{{i, k * ntiles0 + j}};
+        if (!A.is_zero(idx))
+          tiles.emplace_back(A.trange().make_tile_range(idx), A.find(idx));
+      }
+    }
+    for (auto& tile : tiles) {
+      const auto lobound = tile.first.lobound();
+      const auto extent = tile.first.extent();
+      result.block(lobound[0], lobound[1] - k * ext0, extent[0], extent[1]) =
+          math::tile_to_eigen(tile.second.get());
+    }
+    return result;
+  };
 
   MatrixzVec F_recip_vec, D_recip_vec;
-  MatrixdVec D_real_vec;
   F_recip_vec.resize(k_size_);
   D_recip_vec.resize(k_size_);
-  D_real_vec.resize(RD_size_);
-
-  auto fock_eig = math::array_to_eigen(Fk_);
 
   // parallel impl for F_k diagonalization and D_k build
   auto compute_recip_density =
@@ -472,120 +500,119 @@ zRHF<Tile, Policy>::compute_density() {
         D = C_occ.conjugate() * C_occ.transpose();
       };
 
+  // with time-reversal symmetry only k <= k_size_ - 1 - k are diagonalized,
+  // the rest are obtained from F(-k) = F(k)^*
+  const int64_t k_irreducible_size =
+      time_reversal_ ? (k_size_ + 1) / 2 : k_size_;
   bool do_level_shift = (level_shift_ > 0.0 && iter_ > 0);
-  for (int64_t k = 0; k != k_size_; ++k) {
+  for (int64_t k = 0; k != k_irreducible_size; ++k) {
+    if (k_owner(k) != me) continue;
     bool is_gamma_point = (k_size_ > 1 && k == ((k_size_ - 1) / 2));
     MatrixZ* C_old = do_level_shift ? &C_[k] : nullptr;
-    F_recip_vec[k] = fock_eig.block(0, k * ext0, ext0, ext0);
+    F_recip_vec[k] = k_block(Fk_, k);
 
     world.taskq.add(compute_recip_density, &(F_recip_vec[k]), &(X_[k]), C_old,
                     &(C_[k]), &(eps_[k]), &(D_recip_vec[k]), is_gamma_point,
                     do_level_shift);
   }
   world.gop.fence();
-
-  // collect all D_k's to a big rectangular matrix
-  for (int64_t k = 0; k != k_size_; ++k) {
-    result_recip_eig.block(0, k * ext0, ext0, ext0) = D_recip_vec[k];
+  C_replicated_ = false;
+
+  // the orbital energies are small, replicate them; ε(-k) = ε(k)
+  // (the orthogonalizer may drop linear dependencies, hence the number of
+  // orbitals of block k is the number of columns of X_[k])
+  for (int64_t k = 0; k != k_irreducible_size; ++k) {
+    if (k_owner(k) != me) eps_[k] = VectorD::Zero(X_[k].cols());
+    world.gop.sum(eps_[k].data(), eps_[k].size());
+  }
+  for (int64_t k = k_irreducible_size; k != k_size_; ++k) {
+    eps_[k] = eps_[k_size_ - 1 - k];
   }
 
-  // parallel impl for D_r
-  const auto denom_inv = 1.0 / double(nk_(0) * nk_(1) * nk_(2));
-  auto transform_recip2real = [ext0, denom_inv, this](MatrixZ* D_recip_ptr,
-                                                      RowMatrixXd* D_real_ptr,
-                                                      int64_t R) {
-    using ::mpqc::detail::k_vector;
-    using ::mpqc::detail::direct_vector;
-
-    // get references to all matrix pointers
-    const auto& D_recip = *D_recip_ptr;
-    auto& D_real = *D_real_ptr;
-
-    auto vec_R = direct_vector(R, RD_max_, dcell_);
-    D_real.setZero(ext0, ext0);
-
-    for (int64_t k = 0; k != k_size_; ++k) {
-      auto vec_k = k_vector(k, nk_, dcell_);
-      auto exponent = std::exp(I * vec_k.dot(vec_R)) * denom_inv;
-      D_real += (exponent * D_recip.block(0, k * ext0, ext0, ext0)).real();
+  // the owner of each k-block sets its tiles (the nonlocal ones are sent to
+  // their owners); with time-reversal symmetry the blocks of the reducible k
+  // are zero
+  TA::TiledRange trange{tr0, tr1_recip};
+  typename Policy::shape_type shape;
+  if (!decltype(shape)::is_dense()) {
+    TA::Tensor<float> norms(trange.tiles_range(),
+                            std::numeric_limits<float>::max());
+    shape = decltype(shape)(world, norms, trange);
+  }
+  array_type_z result_recip(world, trange, shape);
+  for (int64_t k = 0; k != k_size_; ++k) {
+    if (k_owner(k) != me) continue;
+    for (auto i = 0ul; i != ntiles0; ++i) {
+      for (auto j = 0ul; j != ntiles0; ++j) {
+        const std::array<std::size_t, 2> idx{{i, k * ntiles0 + j}};
+        const auto range = trange.make_tile_range(idx);
+        TA::TensorZ tile(range, std::complex<double>(0.0, 0.0));
+        if (k < k_irreducible_size) {
+          const auto lobound = range.lobound();
+          const auto extent = range.extent();
+          TA::eigen_map(tile, extent[0], extent[1]) = D_recip_vec[k].block(
+              lobound[0], lobound[1] - k * ext0, extent[0], extent[1]);
+        }
+        result_recip.set(idx, tile);
+      }
     }
-  };
-
-  for (int64_t Rd = 0; Rd != RD_size_; ++Rd) {
-    world.taskq.add(transform_recip2real, &result_recip_eig, &(D_real_vec[Rd]),
-                    Rd);
   }
   world.gop.fence();
+  result_recip.truncate();
 
-  // collect all D_r's to a big rectangular matrix
-  for (int64_t Rd = 0; Rd != RD_size_; ++Rd) {
-    result_real_eig.block(0, Rd * ext0, ext0, ext0) = D_real_vec[Rd];
-  }
-
-  // convert rectangular matrices to TA::DistArray
-  auto result_real = math::eigen_to_array<Tile, Policy>(
-      world, result_real_eig, tr0, tr1_real);
-  auto result_recip = math::eigen_to_array<TA::TensorZ, Policy>(
-      world, result_recip_eig, tr0, tr1_recip);
+  auto result_real =
+      transform_recip2real(result_recip, RD_max_, nk_, time_reversal_);
 
   return std::make_pair(result_real, result_recip);
 }
 
+template <typename Tile, typename Policy>
+void zRHF<Tile, Policy>::replicate_co_coeff() {
+  if (C_replicated_) return;
+  auto& world = this->ao_factory().world();
+  const auto me = world.rank();
+  const auto ntiles0 = Fk_.trange().data()[0].tile_extent();
+  const auto nbf = Fk_.trange().data()[0].extent();
+  const int64_t k_irreducible_size =
+      time_reversal_ ? (k_size_ + 1) / 2 : k_size_;
+
+  // each block was computed by the owner of the first tile of its k-block
+  for (int64_t k = 0; k != k_irreducible_size; ++k) {
+    const auto owner = Fk_.pmap()->owner(Fk_.trange().tiles_range().ordinal(
+        std::array<std::size_t, 2>{{0, std::size_t(k) * ntiles0}}));
+    if (owner != me) C_[k] = MatrixZ::Zero(nbf, X_[k].cols());
+    world.gop.sum(C_[k].data(), C_[k].size());
+  }
+  // C(-k) = C(k)^*
+  for (int64_t k = k_irreducible_size; k != k_size_; ++k) {
+    C_[k] = C_[k_size_ - 1 - k].conjugate();
+  }
+  C_replicated_ = true;
+}
+
 template <typename Tile, typename Policy>
 typename zRHF<Tile, Policy>::array_type_z
 zRHF<Tile, Policy>::transform_real2recip(const array_type& matrix,
                                          const Vector3i& real_lattice_range,
-                                         const Vector3i& recip_lattice_range) {
+                                         const Vector3i& recip_lattice_range,
+                                         bool time_reversal) {
   // Make sure range values are all positive
   MPQC_ASSERT((real_lattice_range.array() >= 0).all() &&
               (recip_lattice_range.array() > 0).all());
 
   using ::mpqc::detail::direct_ord_idx;
-  using ::mpqc::detail::direct_vector;
-  using ::mpqc::detail::extend_trange1;
-  using ::mpqc::detail::k_ord_idx;
-  using ::mpqc::detail::k_vector;
 
   const auto real_lattice_size =
       1 + direct_ord_idx(real_lattice_range, real_lattice_range);
-  const Vector3i k_end_3D_idx = (recip_lattice_range.array() - 1).matrix();
-  const auto recip_lattice_size =
-      1 + k_ord_idx(k_end_3D_idx, recip_lattice_range);
   const auto tiles_range = matrix.trange().tiles_range();
   MPQC_ASSERT(tiles_range.extent(1) % tiles_range.extent(0) == 0);
   MPQC_ASSERT(uint64_t(real_lattice_size) ==
               tiles_range.extent(1) / tiles_range.extent(0));
 
-  array_type_z result;
-  auto tr0 = matrix.trange().data()[0];
-  auto tr1 = extend_trange1(tr0, recip_lattice_size);
-  auto& world = matrix.world();
-
-  // Perform real->reciprocal transformation with Eigen
-  // TODO: perform it with TA
-  auto matrix_eig = math::array_to_eigen(matrix);
-  MatrixZ result_eig(tr0.extent(), tr1.extent());
-  result_eig.setZero();
-
-  auto threshold = std::numeric_limits<double>::epsilon();
-  for (auto R = 0; R < real_lattice_size; ++R) {
-    auto bmat =
-        matrix_eig.block(0, R * tr0.extent(), tr0.extent(), tr0.extent());
-    if (bmat.norm() < bmat.size() * threshold)
-      continue;
-    else {
-      auto vec_R = direct_vector(R, real_lattice_range, dcell_);
-      for (auto k = 0; k < recip_lattice_size; ++k) {
-        auto vec_k = k_vector(k, recip_lattice_range, dcell_);
-        auto exponent = std::exp(I * vec_k.dot(vec_R));
-        result_eig.block(0, k * tr0.extent(), tr0.extent(), tr0.extent()) +=
-            bmat * exponent;
-      }
-    }
-  }
-
-  result = math::eigen_to_array<TA::TensorZ, TA::SparsePolicy>(
-      world, result_eig, tr0, tr1);
+  MPQC_ASSERT(lattice_transform_ != nullptr);
+  auto result = lattice_transform_->real2recip(matrix, real_lattice_range,
+                                               recip_lattice_range,
+                                               time_reversal);
 
   return result;
 }
@@ -602,6 +629,31 @@ zRHF<Tile, Policy>::transform_real2recip(const array_type& matrix) {
   return transform_real2recip(matrix, R_max_, nk_);
 }
 
+template <typename Tile, typename Policy>
+typename zRHF<Tile, Policy>::array_type
+zRHF<Tile, Policy>::transform_recip2real(const array_type_z& matrix,
+                                         const Vector3i& real_lattice_range,
+                                         const Vector3i& recip_lattice_range,
+                                         bool time_reversal) {
+  // Make sure range values are all positive
+  MPQC_ASSERT((real_lattice_range.array() >= 0).all() &&
+              (recip_lattice_range.array() > 0).all());
+
+  using ::mpqc::detail::k_ord_idx;
+
+  const Vector3i k_end_3D_idx = (recip_lattice_range.array() - 1).matrix();
+  const auto recip_lattice_size =
+      1 + k_ord_idx(k_end_3D_idx, recip_lattice_range);
+  const auto tiles_range = matrix.trange().tiles_range();
+  MPQC_ASSERT(tiles_range.extent(1) % tiles_range.extent(0) == 0);
+  MPQC_ASSERT(uint64_t(recip_lattice_size) ==
+              tiles_range.extent(1) / tiles_range.extent(0));
+
+  MPQC_ASSERT(lattice_transform_ != nullptr);
+  return lattice_transform_->recip2real(matrix, real_lattice_range,
+                                        recip_lattice_range, time_reversal);
+}
+
 template <typename Tile, typename Policy>
 MatrixZ zRHF<Tile, Policy>::reverse_phase_factor(const MatrixZ& mat0) {
   MatrixZ result(mat0);
@@ -0,0 +1,108 @@
+#include "./scalapack.h"
+
+#include <cmath>
+#include <sstream>
+
+#include "mpqc/util/core/exception.h"
+
+extern "C" {
+int Csys2blacs_handle(MPI_Comm comm);
+void Cfree_blacs_system_handle(int handle);
+void Cblacs_gridinit(int *context, const char *order, int nprow, int npcol);
+void Cblacs_gridinfo(int context, int *nprow, int *npcol, int *myrow,
+                     int *mycol);
+void Cblacs_gridexit(int context);
+
+int numroc_(const int *n, const int *nb, const int *iproc,
+            const int *isrcproc, const int *nprocs);
+void descinit_(int *desc, const int *m, const int *n, const int *mb,
+               const int *nb, const int *irsrc, const int *icsrc,
+               const int *ictxt, const int *lld, int *info);
+void pdsyevd_(const char *jobz, const char *uplo, const int *n, double *a,
+              const int *ia, const int *ja, const int *desca, double *w,
+              double *z, const int *iz, const int *jz, const int *descz,
+              double *work, const int *lwork, int *iwork, const int *liwork,
+              int *info);
+}
+
+namespace mpqc {
+namespace math {
+namespace scalapack {
+
+BlacsGrid::BlacsGrid(madness::World &world) : world_(&world) {
+  const int nproc = world.size();
+  nprow_ = std::sqrt(double(nproc));
+  while (nproc % nprow_ != 0) --nprow_;
+  npcol_ = nproc / nprow_;
+
+  system_handle_ = Csys2blacs_handle(world.mpi.comm().Get_mpi_comm());
+  context_ = system_handle_;
+  Cblacs_gridinit(&context_, "R", nprow_, npcol_);
+  Cblacs_gridinfo(context_, &nprow_, &npcol_, &myrow_, &mycol_);
+}
+
+BlacsGrid::~BlacsGrid() {
+  Cblacs_gridexit(context_);
+  Cfree_blacs_system_handle(system_handle_);
+}
+
+BlockCyclicMatrix::BlockCyclicMatrix(BlacsGrid const &grid, int nrows,
+                                     int ncols, int block_size)
+    : grid_(&grid),
+      nrows_(nrows),
+      ncols_(ncols),
+      block_size_(block_size) {
+  const int zero = 0;
+  const int myrow = grid.myrow();
+  const int mycol = grid.mycol();
+  const int nprow = grid.nprow();
+  const int npcol = grid.npcol();
+  local_nrows_ = numroc_(&nrows_, &block_size_, &myrow, &zero, &nprow);
+  local_ncols_ = numroc_(&ncols_, &block_size_, &mycol, &zero, &npcol);
+
+  const int context = grid.context();
+  const int ld = lld();
+  int info;
+  descinit_(desc_, &nrows_, &ncols_, &block_size_, &block_size_, &zero, &zero,
+            &context, &ld, &info);
+  if (info != 0) {
+    throw ProgrammingError("descinit failed", __FILE__, __LINE__);
+  }
+
+  data_.resize(std::size_t(ld) * local_ncols_, 0.0);
+}
+
+std::vector<double> syevd(BlockCyclicMatrix &A, BlockCyclicMatrix &Z) {
+  const char jobz = 'V';
+  const char uplo = 'L';
+  const int n = A.nrows();
+  const int one = 1;
+  std::vector<double> w(n);
+
+  // workspace query
+  int lwork = -1, liwork = -1, info;
+  double work_size;
+  int iwork_size;
+  pdsyevd_(&jobz, &uplo, &n, A.data(), &one, &one, A.descriptor(), w.data(),
+           Z.data(), &one, &one, Z.descriptor(), &work_size, &lwork,
+           &iwork_size, &liwork, &info);
+
+  lwork = work_size;
+  liwork = iwork_size;
+  std::vector<double> work(lwork);
+  std::vector<int> iwork(liwork);
+  pdsyevd_(&jobz, &uplo, &n, A.data(), &one, &one, A.descriptor(), w.data(),
+           Z.data(), &one, &one, Z.descriptor(), work.data(), &lwork,
+           iwork.data(), &liwork, &info);
+  if (info != 0) {
+    std::ostringstream oss;
+    oss << "pdsyevd failed, info = " << info;
+    throw AlgorithmException(oss.str().c_str(), __FILE__, __LINE__);
+  }
+
+  return w;
+}
+
+}  // namespace scalapack
+}  // namespace math
+}  // namespace mpqc
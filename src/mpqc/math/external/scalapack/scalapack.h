@@ -0,0 +1,137 @@
+#ifndef MPQC4_SRC_MPQC_MATH_EXTERNAL_SCALAPACK_SCALAPACK_H_
+#define MPQC4_SRC_MPQC_MATH_EXTERNAL_SCALAPACK_SCALAPACK_H_
+
+#include <algorithm>
+#include <vector>
+
+#include <TiledArray/madness.h>
+
+namespace mpqc {
+namespace math {
+namespace scalapack {
+
+/**
+ * \brief BlacsGrid is a 2-d BLACS process grid over all processes of a
+ * madness::World.
+ *
+ * The grid is as square as the number of processes allows; process \c p of
+ * the world is at row <tt>p / npcol()</tt> and column <tt>p % npcol()</tt>.
+ */
+class BlacsGrid {
+ public:
+  /// creates the grid, this is collective
+  explicit BlacsGrid(madness::World &world);
+  ~BlacsGrid();
+
+  BlacsGrid(BlacsGrid const &) = delete;
+  BlacsGrid &operator=(BlacsGrid const &) = delete;
+
+  madness::World &world() const { return *world_; }
+  int context() const { return context_; }
+  int nprow() const { return nprow_; }
+  int npcol() const { return npcol_; }
+  int myrow() const { return myrow_; }
+  int mycol() const { return mycol_; }
+
+  /// @return the rank of the process at row \c prow and column \c pcol
+  int rank(int prow, int pcol) const { return prow * npcol_ + pcol; }
+
+ private:
+  madness::World *world_;
+  int system_handle_;
+  int context_;
+  int nprow_, npcol_, myrow_, mycol_;
+};
+
+/**
+ * \brief BlockCyclicMatrix is a real matrix distributed over a BlacsGrid in
+ * the 2-d block-cyclic layout of ScaLAPACK, with square blocks.
+ *
+ * Block (I,J) lives on the process at row <tt>I % nprow</tt> and column
+ * <tt>J % npcol</tt>; the local blocks are stored in column-major order.
+ */
+class BlockCyclicMatrix {
+ public:
+  /// @param grid the process grid, must outlive this
+  /// @param nrows the number of rows
+  /// @param ncols the number of columns
+  /// @param block_size the row and column size of the blocks
+  BlockCyclicMatrix(BlacsGrid const &grid, int nrows, int ncols,
+                    int block_size);
+
+  BlacsGrid const &grid() const { return *grid_; }
+  int nrows() const { return nrows_; }
+  int ncols() const { return ncols_; }
+  int block_size() const { return block_size_; }
+
+  /// @return the number of rows stored on this process
+  int local_nrows() const { return local_nrows_; }
+  /// @return the number of columns stored on this process
+  int local_ncols() const { return local_ncols_; }
+
+  /// @return the rank of the process that holds element (\c row, \c col)
+  int owner(int row, int col) const {
+    return grid_->rank((row / block_size_) % grid_->nprow(),
+                       (col / block_size_) % grid_->npcol());
+  }
+
+  /// @return the local row index of global row \c row, that must be held by
+  /// this process row
+  int local_row(int row) const {
+    return local_index(row, grid_->nprow());
+  }
+  /// @return the local column index of global column \c col, that must be
+  /// held by this process column
+  int local_col(int col) const {
+    return local_index(col, grid_->npcol());
+  }
+  /// @return the global row index of local row \c lrow
+  int global_row(int lrow) const {
+    return global_index(lrow, grid_->myrow(), grid_->nprow());
+  }
+  /// @return the global column index of local column \c lcol
+  int global_col(int lcol) const {
+    return global_index(lcol, grid_->mycol(), grid_->npcol());
+  }
+
+  /// @return the local element at local row \c lrow and column \c lcol
+  double &local(int lrow, int lcol) { return data_[lrow + lcol * lld()]; }
+  double local(int lrow, int lcol) const { return data_[lrow + lcol * lld()]; }
+
+  double *data() { return data_.data(); }
+  /// @return the ScaLAPACK array descriptor
+  const int *descriptor() const { return desc_; }
+
+ private:
+  int lld() const { return std::max(1, local_nrows_); }
+  int local_index(int i, int nproc) const {
+    return (i / (block_size_ * nproc)) * block_size_ + i % block_size_;
+  }
+  int global_index(int li, int iproc, int nproc) const {
+    return ((li / block_size_) * nproc + iproc) * block_size_ +
+           li % block_size_;
+  }
+
+  BlacsGrid const *grid_;
+  int nrows_, ncols_, block_size_;
+  int local_nrows_, local_ncols_;
+  int desc_[9];
+  std::vector<double> data_;
+};
+
+/**
+ * \brief computes all eigenpairs of the symmetric matrix \c A with the
+ * divide-and-conquer solver pdsyevd
+ *
+ * @param[in,out] A the matrix, only its lower triangle is referenced and it
+ * is destroyed on output
+ * @param[out] Z the eigenvectors, as columns; must have the layout of \c A
+ * @return the eigenvalues in ascending order, on every process
+ */
+std::vector<double> syevd(BlockCyclicMatrix &A, BlockCyclicMatrix &Z);
+
+}  // namespace scalapack
+}  // namespace math
+}  // namespace mpqc
+
+#endif  // MPQC4_SRC_MPQC_MATH_EXTERNAL_SCALAPACK_SCALAPACK_H_
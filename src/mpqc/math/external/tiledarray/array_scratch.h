@@ -0,0 +1,103 @@
+#ifndef SRC_MPQC_MATH_EXTERNAL_TILEDARRAY_ARRAY_SCRATCH_H_
+#define SRC_MPQC_MATH_EXTERNAL_TILEDARRAY_ARRAY_SCRATCH_H_
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <madness/world/binary_fstream_archive.h>
+#include <tiledarray.h>
+
+namespace mpqc {
+namespace detail {
+
+/// ArrayScratchTraits<Array> describes how an object of type \c Array is
+/// written to and read from node-local scratch files, it must provide:
+/// - \c handle_type , the (in-memory) metadata needed to read the object back
+/// - \c buffer_type , the local data read from disk
+/// - `handle_type write(const Array&, const std::string& basename)`
+/// - `buffer_type read_local(const handle_type&)`, reads the local data; this
+///   only involves local I/O, hence can be called from any thread
+/// - `Array make(const handle_type&, buffer_type&&)`, constructs the object
+///   from the local data; this is collective
+/// - `void remove(const handle_type&)`
+template <typename Array>
+struct ArrayScratchTraits;
+
+/// the local nonzero tiles of a TA::DistArray with TA::Tensor tiles are
+/// written to (and read from) a file, one per process
+template <typename T, typename Allocator, typename Policy>
+struct ArrayScratchTraits<TA::DistArray<TA::Tensor<T, Allocator>, Policy>> {
+  using Tile = TA::Tensor<T, Allocator>;
+  using Array = TA::DistArray<Tile, Policy>;
+
+  struct handle_type {
+    madness::World* world;
+    TA::TiledRange trange;
+    typename Policy::shape_type shape;
+    std::shared_ptr<TA::Pmap> pmap;
+    std::string filename;
+  };
+
+  using buffer_type = std::vector<Tile>;
+
+  /// writes the local nonzero tiles of \c A to file \c basename.rank
+  static handle_type write(const Array& A, const std::string& basename) {
+    const auto filename = basename + "." + std::to_string(A.world().rank());
+    madness::archive::BinaryFstreamOutputArchive ar(filename.c_str());
+    const auto end = A.pmap()->end();
+    for (auto it = A.pmap()->begin(); it != end; ++it) {
+      if (!A.is_zero(*it)) {
+        const Tile tile = A.find(*it).get();
+        ar & tile;
+      }
+    }
+    ar.close();
+    return handle_type{&A.world(), A.trange(), A.shape(), A.pmap(), filename};
+  }
+
+  /// reads the local tiles written by write()
+  static buffer_type read_local(const handle_type& handle) {
+    buffer_type tiles;
+    madness::archive::BinaryFstreamInputArchive ar(handle.filename.c_str());
+    const auto end = handle.pmap->end();
+    for (auto it = handle.pmap->begin(); it != end; ++it) {
+      if (!handle.shape.is_zero(*it)) {
+        Tile tile;
+        ar & tile;
+        tiles.push_back(std::move(tile));
+      }
+    }
+    ar.close();
+    return tiles;
+  }
+
+  /// reconstructs the array from the local tiles returned by read_local()
+  static Array make(const handle_type& handle, buffer_type&& tiles) {
+    Array A(*handle.world, handle.trange, handle.shape, handle.pmap);
+    auto tile_it = tiles.begin();
+    const auto end = A.pmap()->end();
+    for (auto it = A.pmap()->begin(); it != end; ++it) {
+      if (!A.is_zero(*it)) {
+        A.set(*it, std::move(*tile_it));
+        ++tile_it;
+      }
+    }
+    return A;
+  }
+
+  /// reads the array written by write()
+  static Array read(const handle_type& handle) {
+    return make(handle, read_local(handle));
+  }
+
+  static void remove(const handle_type& handle) {
+    std::remove(handle.filename.c_str());
+  }
+};
+
+}  // namespace detail
+}  // namespace mpqc
+
+#endif  // SRC_MPQC_MATH_EXTERNAL_TILEDARRAY_ARRAY_SCRATCH_H_
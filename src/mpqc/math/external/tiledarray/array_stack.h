@@ -0,0 +1,186 @@
+#ifndef SRC_MPQC_MATH_EXTERNAL_TILEDARRAY_ARRAY_STACK_H_
+#define SRC_MPQC_MATH_EXTERNAL_TILEDARRAY_ARRAY_STACK_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <tiledarray.h>
+
+namespace mpqc {
+
+namespace detail {
+
+/// @return the tiled range of the stack of \c n arrays with tiled range
+/// \c trange, the new leading mode is a single tile
+inline TA::TiledRange stacked_trange(const TA::TiledRange &trange,
+                                     std::size_t n) {
+  std::vector<TA::TiledRange1> tr1s{TA::TiledRange1{0, n}};
+  for (auto d = 0u; d != trange.rank(); ++d) tr1s.push_back(trange.dim(d));
+  return TA::TiledRange(tr1s.begin(), tr1s.end());
+}
+
+/// the tile of the stacked array is the concatenation of the (row-major)
+/// tiles of the arrays; empty tiles are zero tiles
+template <typename Tile>
+Tile stack_tiles(const TA::Range &range,
+                 const std::vector<madness::Future<Tile>> &tiles) {
+  Tile result(range, typename Tile::numeric_type(0));
+  const auto volume = range.volume() / tiles.size();
+  auto *result_ptr = result.data();
+  for (const auto &tile : tiles) {
+    const auto &t = tile.get();
+    if (!t.empty()) std::copy(t.data(), t.data() + volume, result_ptr);
+    result_ptr += volume;
+  }
+  return result;
+}
+
+/// @return the \c k-th slice of a tile of the stacked array
+template <typename Tile>
+Tile unstack_tile(const TA::Range &range, const Tile &stacked,
+                  std::size_t k) {
+  Tile result(range);
+  const auto volume = range.volume();
+  const auto *stacked_ptr = stacked.data() + k * volume;
+  std::copy(stacked_ptr, stacked_ptr + volume, result.data());
+  return result;
+}
+
+/// dense arrays have no shape
+template <typename Tile>
+TA::DenseShape stacked_shape(
+    const std::vector<TA::DistArray<Tile, TA::DensePolicy>> &,
+    const TA::TiledRange &) {
+  return TA::DenseShape();
+}
+
+/// the norm of a tile of the stacked array is computed from the norms of the
+/// corresponding tiles of the arrays
+template <typename Tile>
+TA::SparseShape<float> stacked_shape(
+    const std::vector<TA::DistArray<Tile, TA::SparsePolicy>> &arrays,
+    const TA::TiledRange &trange) {
+  const auto &tiles_range = arrays.front().trange().tiles_range();
+  TA::Tensor<float> norms(trange.tiles_range(), 0.0f);
+  for (auto ord = 0ul; ord != tiles_range.volume(); ++ord) {
+    // the shape stores norms per element
+    const float volume =
+        arrays.front().trange().make_tile_range(ord).volume();
+    float norm2 = 0.0f;
+    for (const auto &array : arrays) {
+      const auto norm = array.shape()[ord] * volume;
+      norm2 += norm * norm;
+    }
+    norms[ord] = std::sqrt(norm2);
+  }
+  // the norms are replicated
+  return TA::SparseShape<float>(norms, trange);
+}
+
+/// the norm of the tiles of the stacked array bound the norms of the slices
+template <typename Tile>
+TA::DenseShape unstacked_shape(const TA::DistArray<Tile, TA::DensePolicy> &,
+                               const TA::TiledRange &) {
+  return TA::DenseShape();
+}
+
+template <typename Tile>
+TA::SparseShape<float> unstacked_shape(
+    const TA::DistArray<Tile, TA::SparsePolicy> &stacked,
+    const TA::TiledRange &trange) {
+  TA::Tensor<float> norms(trange.tiles_range(), 0.0f);
+  for (auto ord = 0ul; ord != norms.size(); ++ord) {
+    const float volume = stacked.trange().make_tile_range(ord).volume();
+    norms[ord] = stacked.shape()[ord] * volume;
+  }
+  return TA::SparseShape<float>(norms, trange);
+}
+
+}  // namespace detail
+
+/**
+ * stacks arrays along a new leading mode, i.e. the result \c S is
+ * <tt>S(k,i...) = arrays[k](i...)</tt>. The new mode is a single tile, hence
+ * a contraction of \c S with another array multiplies each of the tiles of
+ * the latter with the tiles of all arrays at once: the tiles are read once
+ * and the GEMMs are \c arrays.size() times larger than for the arrays one at
+ * a time.
+ *
+ * @param arrays the arrays to stack, must have the same tiled range
+ * @return the stacked array
+ * @sa unstack_array()
+ */
+template <typename Tile, typename Policy>
+TA::DistArray<Tile, Policy> stack_arrays(
+    const std::vector<TA::DistArray<Tile, Policy>> &arrays) {
+  TA_USER_ASSERT(!arrays.empty(), "stack_arrays: no arrays");
+  const auto n = arrays.size();
+  auto &world = arrays.front().world();
+  const auto &trange = arrays.front().trange();
+  for (const auto &array : arrays) {
+    TA_USER_ASSERT(array.trange() == trange,
+                   "stack_arrays: the tiled ranges differ");
+  }
+
+  const auto result_trange = detail::stacked_trange(trange, n);
+  TA::DistArray<Tile, Policy> result(
+      world, result_trange, detail::stacked_shape(arrays, result_trange));
+
+  // the tiles of the leading tile mode have the same ordinals as the tiles of
+  // the arrays
+  const auto end = result.pmap()->end();
+  for (auto it = result.pmap()->begin(); it != end; ++it) {
+    const auto ord = *it;
+    if (result.is_zero(ord)) continue;
+    std::vector<madness::Future<Tile>> tiles;
+    tiles.reserve(n);
+    for (const auto &array : arrays) {
+      tiles.push_back(array.is_zero(ord) ? madness::Future<Tile>(Tile())
+                                         : array.find(ord));
+    }
+    result.set(ord, world.taskq.add(&detail::stack_tiles<Tile>,
+                                    result_trange.make_tile_range(ord),
+                                    std::move(tiles)));
+  }
+  world.gop.fence();
+  return result;
+}
+
+/// the inverse of stack_arrays()
+
+/// @param stacked an array returned by stack_arrays(), or an array with the
+/// same leading mode
+/// @param trange the tiled range of the modes that follow the leading mode
+/// @return the arrays
+template <typename Tile, typename Policy>
+std::vector<TA::DistArray<Tile, Policy>> unstack_array(
+    const TA::DistArray<Tile, Policy> &stacked, const TA::TiledRange &trange) {
+  TA_USER_ASSERT(stacked.trange().dim(0).tile_extent() == 1,
+                 "unstack_array: the leading mode must be a single tile");
+  const auto n = stacked.trange().dim(0).extent();
+  auto &world = stacked.world();
+  const auto shape = detail::unstacked_shape(stacked, trange);
+
+  std::vector<TA::DistArray<Tile, Policy>> result;
+  for (auto k = 0ul; k != n; ++k) {
+    TA::DistArray<Tile, Policy> array(world, trange, shape);
+    const auto end = array.pmap()->end();
+    for (auto it = array.pmap()->begin(); it != end; ++it) {
+      const auto ord = *it;
+      if (array.is_zero(ord)) continue;
+      array.set(ord, world.taskq.add(&detail::unstack_tile<Tile>,
+                                     trange.make_tile_range(ord),
+                                     stacked.find(ord), k));
+    }
+    result.push_back(array);
+  }
+  world.gop.fence();
+  // the shapes of the stacked tiles only bound the norms of the slices
+  for (auto &array : result) array.truncate();
+  return result;
+}
+
+}  // namespace mpqc
+
+#endif  // SRC_MPQC_MATH_EXTERNAL_TILEDARRAY_ARRAY_STACK_H_
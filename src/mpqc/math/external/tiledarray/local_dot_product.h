@@ -0,0 +1,33 @@
+#ifndef SRC_MPQC_MATH_EXTERNAL_TILEDARRAY_LOCAL_DOT_PRODUCT_H_
+#define SRC_MPQC_MATH_EXTERNAL_TILEDARRAY_LOCAL_DOT_PRODUCT_H_
+
+#include <tiledarray.h>
+
+namespace mpqc {
+
+/**
+ * computes the contribution of the tiles owned by this process to the
+ * dot product of \c a and \c b, i.e. summing the result over all processes
+ * gives dot_product(a, b). Unlike dot_product() this does not synchronize,
+ * hence many dot products can be reduced with a single global sum.
+ *
+ * @note \c a and \c b should have the same process map, otherwise the tiles
+ * of \c b are fetched from remote processes
+ */
+template <typename Tile, typename Policy>
+typename Tile::numeric_type local_dot_product(
+    const TA::DistArray<Tile, Policy>& a,
+    const TA::DistArray<Tile, Policy>& b) {
+  TA_ASSERT(a.trange() == b.trange());
+  typename Tile::numeric_type result = 0;
+  for (auto it = a.begin(); it != a.end(); ++it) {
+    const auto ord = it.ordinal();
+    if (b.is_zero(ord)) continue;
+    result += a.find(ord).get().dot(b.find(ord).get());
+  }
+  return result;
+}
+
+}  // namespace mpqc
+
+#endif  // SRC_MPQC_MATH_EXTERNAL_TILEDARRAY_LOCAL_DOT_PRODUCT_H_
@@ -0,0 +1,68 @@
+#ifndef MPQC4_SRC_MPQC_MATH_EXTERNAL_TILEDARRAY_TILE_UTIL_H_
+#define MPQC4_SRC_MPQC_MATH_EXTERNAL_TILEDARRAY_TILE_UTIL_H_
+
+#include <cmath>
+#include <utility>
+
+#include <tiledarray.h>
+
+namespace mpqc {
+namespace detail {
+
+/// @return the ordinal of the tile pair \c {t0,t1} , \c t0>=t1 , in a packed
+/// pair mode
+inline std::size_t tile_pair_ordinal(std::size_t t0, std::size_t t1) {
+  TA_ASSERT(t0 >= t1);
+  return t0 * (t0 + 1) / 2 + t1;
+}
+
+/// @return the tile pair \c {t0,t1} , \c t0>=t1 , with ordinal \c p in a
+/// packed pair mode
+inline std::pair<std::size_t, std::size_t> tile_pair(std::size_t p) {
+  auto t0 = std::size_t((std::sqrt(8.0 * p + 1.0) - 1.0) / 2.0);
+  // guard against rounding
+  while (t0 * (t0 + 1) / 2 > p) --t0;
+  while ((t0 + 1) * (t0 + 2) / 2 <= p) ++t0;
+  return std::make_pair(t0, p - t0 * (t0 + 1) / 2);
+}
+
+/// @return the shape of an array with tiled range \c trange , dense arrays
+/// have no shape
+template <typename NormOp>
+TA::DenseShape make_shape(const TA::TiledRange &, NormOp &&, TA::DensePolicy) {
+  return TA::DenseShape();
+}
+
+/// @return the shape of an array with tiled range \c trange , the norm of the
+/// tile with ordinal \c ord is (bounded by) \c norm_op(ord) ; \c norm_op must
+/// give the same norms on every process
+template <typename NormOp>
+TA::SparseShape<float> make_shape(const TA::TiledRange &trange,
+                                  NormOp &&norm_op, TA::SparsePolicy) {
+  TA::Tensor<float> norms(trange.tiles_range(), 0.0f);
+  for (auto ord = 0ul; ord != norms.size(); ++ord) norms[ord] = norm_op(ord);
+  // the norms are replicated
+  return TA::SparseShape<float>(norms, trange);
+}
+
+/// @return the norm of the tile \c idx of sparse array \c array
+template <typename Array, typename Index>
+float tile_norm(const Array &array, const Index &idx) {
+  // the shape stores norms per element
+  const auto ord = array.trange().tiles_range().ordinal(idx);
+  return array.shape()[ord] * array.trange().make_tile_range(ord).volume();
+}
+
+/// @return the future of the tile \c idx of \c array , an empty tile if it is
+/// zero
+template <typename Array, typename Index>
+madness::Future<typename Array::value_type> find_tile(const Array &array,
+                                                      const Index &idx) {
+  using Tile = typename Array::value_type;
+  return array.is_zero(idx) ? madness::Future<Tile>(Tile()) : array.find(idx);
+}
+
+}  // namespace detail
+}  // namespace mpqc
+
+#endif  // MPQC4_SRC_MPQC_MATH_EXTERNAL_TILEDARRAY_TILE_UTIL_H_
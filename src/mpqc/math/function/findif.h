@@ -8,13 +8,56 @@
 #ifndef SRC_MPQC_MATH_FUNCTION_FINDIF_H_
 #define SRC_MPQC_MATH_FUNCTION_FINDIF_H_
 
+#include <exception>
+
+#include <tiledarray.h>
+
 #include "mpqc/math/function/taylor.h"
+#include "mpqc/util/core/exception.h"
 #include "mpqc/util/external/c++/iterator"
 #include "mpqc/util/keyval/keyval.h"
 
 namespace mpqc {
 namespace math {
 
+namespace detail {
+
+/// makes \c world the default TA world for its lifetime, then restores the
+/// previous default world, also if an exception is thrown
+class DefaultWorldGuard {
+ public:
+  explicit DefaultWorldGuard(madness::World& world)
+      : previous_(&TA::get_default_world()) {
+    TA::set_default_world(world);
+  }
+  ~DefaultWorldGuard() { TA::set_default_world(*previous_); }
+
+  DefaultWorldGuard(const DefaultWorldGuard&) = delete;
+  DefaultWorldGuard& operator=(const DefaultWorldGuard&) = delete;
+
+ private:
+  madness::World* previous_;
+};
+
+/// rethrows on every process of \c world if any process caught an exception:
+/// the processes that caught one rethrow it, the others throw an
+/// AlgorithmException. This is a collective operation on \c world, hence it
+/// must be called by all its processes (after the exception was caught, so
+/// that a process that failed does not leave the others waiting).
+/// @param world the world
+/// @param eptr the exception caught by this process, or null
+inline void rethrow_if_any(madness::World& world, std::exception_ptr eptr) {
+  int nfailed = eptr ? 1 : 0;
+  world.gop.sum(nfailed);
+  if (eptr) std::rethrow_exception(eptr);
+  if (nfailed > 0)
+    throw AlgorithmException(
+        "FiniteDifferenceDerivative: the computation failed on another process",
+        __FILE__, __LINE__);
+}
+
+}  // namespace detail
+
 /// Computes finite-difference approximation to function derivatives
 template <size_t Order, typename Value, typename Parameters>
 class FiniteDifferenceDerivative
@@ -49,6 +92,8 @@ class FiniteDifferenceDerivative
    * |---------|------|--------|-------------|
    * | delta | real | 0.01 | the displacement size, in the internal units of Parameters  |
    * | error_order | int | accuracy of the finite difference stencil | controls the stencil order to use: 0 = use the lowest order stensil (accurate to \f$ \mathcal{O}(\delta^2) \f$ ), 1 = next lowest order (accurate to \f$ \mathcal{O}(\delta^24) \f$ ), etc. |
+   * | nsubworlds | int | 1 | the number of subworlds the world is split into; if greater than 1, each subworld constructs its own copy of \c function and the displacements are distributed among the subworlds and computed concurrently |
+   * | guess_from_reference | bool | false | if true and \c nsubworlds is greater than 1, each subworld evaluates \c function at the reference parameters before the displacements, so that the displaced computations can start from its state (e.g. the reference SCF density) |
    */
   // clang-format on
   FiniteDifferenceDerivative(const KeyVal& kv,
@@ -57,13 +102,20 @@ class FiniteDifferenceDerivative
       : TaylorExpansionFunction<Value, Parameters>(kv, params,
                                                    default_target_precision),
         delta_(kv.value<double>("delta", 1e-2)),
-        error_order_(kv.value<size_t>("error_order", 0)) {
+        error_order_(kv.value<size_t>("error_order", 0)),
+        nsubworlds_(kv.value<size_t>("nsubworlds", 1)),
+        guess_from_reference_(kv.value<bool>("guess_from_reference", false)),
+        world_(kv.value<madness::World*>("$:world")),
+        kv_(kv) {
     function_ = kv.class_ptr<function_type, std::true_type>("function");
     if (function_ == nullptr)
       throw InputError(
           "FiniteDifferenceDerivative was not given a Function to "
           "differentiate",
           __FILE__, __LINE__, "function");
+    if (nsubworlds_ == 0)
+      throw InputError("FiniteDifferenceDerivative: nsubworlds must be positive",
+                       __FILE__, __LINE__, "nsubworlds");
   }
 
   /// derived classes may need to customize how displacements are computed
@@ -105,9 +157,89 @@ class FiniteDifferenceDerivative
   /// \c error_order=0 means derivative is accurate to \c delta_^2 ,
   /// \c error_order=1 -- \c \delta^4 , etc.
   size_t error_order_;
+  /// the number of subworlds among which the displacements are distributed
+  size_t nsubworlds_;
+  /// whether each subworld evaluates the reference before the displacements
+  bool guess_from_reference_;
+  madness::World* world_;
+  /// used to construct the copies of function_ in subworlds
+  KeyVal kv_;
 
   const std::shared_ptr<function_type>& function() { return function_; }
 
+  /// computes the derivatives by distributing the displacements among
+  /// subworlds
+  /// @param ref_params the reference parameters
+  /// @return the derivatives, on every process of the world
+  std::vector<Value> compute_in_subworlds(
+      const std::shared_ptr<const Parameters>& ref_params) {
+    auto& world = *world_;
+    const auto nsubworlds = std::min<size_t>(nsubworlds_, world.size());
+
+    // split the world into nsubworlds contiguous blocks of processes
+    const auto rank = world.rank();
+    const int color = (rank * nsubworlds) / world.size();
+    SafeMPI::Intracomm comm = world.mpi.comm().Split(color, rank);
+
+    // each derivative term is a job, assigned to subworlds round-robin; the
+    // assignment is printed here since out0() only prints from one subworld
+    std::vector<std::pair<DerivIdx, const std::pair<Displacement, double>*>>
+        jobs;
+    for (const auto& disp : disps_)
+      for (const auto& term : disp.second) jobs.emplace_back(disp.first, &term);
+    for (size_t j = 0; j != jobs.size(); ++j)
+      ExEnv::out0() << indent << "displacement " << jobs[j].first[0]
+                    << " (subworld " << j % nsubworlds << ")" << std::endl;
+
+    std::vector<Value> grad_vec(disps_.size(), Value(0));
+    // an exception in one subworld must not leave the other subworlds waiting
+    // in the fence of the world: it is caught and rethrown after the fence
+    std::exception_ptr eptr;
+    {
+      madness::World subworld(comm);
+      world.gop.fence();
+      try {
+        detail::DefaultWorldGuard default_world_guard(subworld);
+        // construct a copy of the function in the subworld: every object it
+        // depends on is constructed anew from a copy of the input
+        auto sub_kv = kv_.clone();
+        sub_kv.assign("world", &subworld);
+        auto sub_function = sub_kv.keyval(kv_.path())
+                                .class_ptr<function_type>("function", true);
+
+        using detail::function::clone;
+        if (guess_from_reference_) {
+          sub_function->set_params(clone(ref_params));
+          sub_function->value();
+        }
+
+        for (size_t j = color; j < jobs.size(); j += nsubworlds) {
+          const auto& idx = jobs[j].first;
+          const auto& term = *jobs[j].second;
+          // apply the displacement
+          auto disp_params = clone(ref_params);
+          increment(disp_params.get(), idx, term.first);
+          sub_function->set_params(disp_params);
+          // compute
+          auto val = sub_function->value();
+          // only one process per subworld contributes
+          if (subworld.rank() == 0)
+            grad_vec[idx[0]] +=
+                term.second * val->derivs(0)[0];  // have energies only
+        }
+        subworld.gop.fence();
+      } catch (...) {
+        eptr = std::current_exception();
+      }
+    }
+    world.gop.fence();
+    detail::rethrow_if_any(world, eptr);
+
+    // gather the results
+    world.gop.sum(grad_vec.data(), grad_vec.size());
+    return grad_vec;
+  }
+
   void compute() override {
     // grab ref parameters to reset later
     using detail::function::clone;
@@ -140,25 +272,29 @@ class FiniteDifferenceDerivative
     /////////////////////////
     size_t coord = 0;
     std::vector<Value> grad_vec(nparams);
-    for (const auto& disp : disps_) {
-      Value result = 0;
-      const auto& idx = disp.first;
-      ExEnv::out0() << indent << "displacement " << disp.first[0] << std::endl;
-      using detail::function::clone;
-      auto disp_params = clone(ref_params);
-      for (const auto& term : disp.second) {
-        // apply the displacement
-        increment(disp_params.get(), idx, term.first);
-        function()->set_params(disp_params);
-        // compute
-        auto val = function()->value();
-        result += term.second * val->derivs(0)[0];  // have energies only
-        // revert the displacement
-        decrement(disp_params.get(), idx, term.first);
-      }
+    if (nsubworlds_ > 1 && world_->size() > 1)
+      grad_vec = compute_in_subworlds(ref_params);
+    else {
+      for (const auto& disp : disps_) {
+        Value result = 0;
+        const auto& idx = disp.first;
+        ExEnv::out0() << indent << "displacement " << disp.first[0] << std::endl;
+        using detail::function::clone;
+        auto disp_params = clone(ref_params);
+        for (const auto& term : disp.second) {
+          // apply the displacement
+          increment(disp_params.get(), idx, term.first);
+          function()->set_params(disp_params);
+          // compute
+          auto val = function()->value();
+          result += term.second * val->derivs(0)[0];  // have energies only
+          // revert the displacement
+          decrement(disp_params.get(), idx, term.first);
+        }
 
-      grad_vec[coord] = result;  // computing gradient only
-      ++coord;
+        grad_vec[coord] = result;  // computing gradient only
+        ++coord;
+      }
     }
 
     // reset the parameters
@@ -5,10 +5,15 @@
 #ifndef SRC_MPQC_MATH_LINALG_DAVIDSON_DIAG_H_
 #define SRC_MPQC_MATH_LINALG_DAVIDSON_DIAG_H_
 
+#include <cstdint>
+#include <string>
+
 #include <TiledArray/algebra/utils.h>
 #include <tiledarray.h>
 
 #include "mpqc/math/external/eigen/eigen.h"
+#include "mpqc/math/external/tiledarray/local_dot_product.h"
+#include "mpqc/math/linalg/davidson_subspace_store.h"
 #include "mpqc/math/linalg/gram_schmidt.h"
 #include "mpqc/util/core/exception.h"
 #include "mpqc/util/core/exenv.h"
@@ -29,6 +34,31 @@ class DavidsonDiagPred {
   virtual ~DavidsonDiagPred() = default;
 };
 
+namespace detail {
+
+/**
+ * computes dot_product(*pairs[i].first, *pairs[i].second) for all i in one
+ * pass over the local data, followed by a single global reduction (instead of
+ * one reduction per dot product)
+ *
+ * @param world the world in which the vectors live
+ * @param pairs list of {a, b} pairs
+ * @return the vector of dot products
+ */
+template <typename D>
+std::vector<typename D::element_type> batched_dot_product(
+    madness::World& world,
+    const std::vector<std::pair<const D*, const D*>>& pairs) {
+  std::vector<typename D::element_type> result(pairs.size(), 0);
+  for (std::size_t i = 0; i < pairs.size(); ++i) {
+    result[i] = local_dot_product(*pairs[i].first, *pairs[i].second);
+  }
+  if (!result.empty()) world.gop.sum(result.data(), result.size());
+  return result;
+}
+
+}  // namespace detail
+
 // clang-format off
 /**
  * \brief Davidson Algorithm
@@ -39,11 +69,16 @@ class DavidsonDiagPred {
  * the eigen vector is a linear combination of B
  * extrapolate() will update the vector B and store new x
  *
+ * the subspace vectors B and HB are kept in memory by default,
+ * set_subspace_store() can be used to keep them out of core
+ *
  * \tparam D
  * array type
  * \c D::element_type must be defined and \c D must provide the following stand-alone functions:
  * - `D copy(const D&)`
  * - `element_type dot_product(const D& a, const D& b)`
+ * - `element_type local_dot_product(const D& a, const D& b)`, the contribution
+ *   of this process to dot_product(a, b)
  * - `void scale(D& y , element_type a)`
  * - `void axpy(D&y , element_tye a, const D& z)`
  * - `void zero(D& x)`
@@ -103,17 +138,46 @@ class DavidsonDiag {
         max_n_guess_(max_n_guess),
         vector_threshold_(vector_threshold),
         eigen_vector_(),
-        HB_(),
-        B_(),
+        HB_(std::make_unique<InCoreSubspaceStore<D>>()),
+        B_(std::make_unique<InCoreSubspaceStore<D>>()),
         subspace_() {}
 
   virtual ~DavidsonDiag() {
     eigen_vector_.clear();
-    HB_.clear();
-    B_.clear();
+    HB_->clear();
+    B_->clear();
     subspace_.resize(0, 0);
   }
 
+  /**
+   * replaces the storage of the subspace vectors, e.g. by DiskSubspaceStore
+   * to keep them out of core; must be called before the first extrapolate()
+   * or after reset()
+   *
+   * @param B_store the storage of the guess vectors B
+   * @param HB_store the storage of the products HB
+   */
+  void set_subspace_store(std::unique_ptr<DavidsonSubspaceStore<D>> B_store,
+                          std::unique_ptr<DavidsonSubspaceStore<D>> HB_store) {
+    MPQC_ASSERT(B_->size() == 0 && HB_->size() == 0);
+    B_ = std::move(B_store);
+    HB_ = std::move(HB_store);
+  }
+
+  /**
+   * keeps the subspace vectors out of core, see DiskSubspaceStore; only the
+   * most recent \c n_roots vectors of B and HB are kept in memory. The stores
+   * are created by the next extrapolate(), once the number of roots solved
+   * at a time is final (SingleStateDavidsonDiag solves one root at a time).
+   *
+   * @param scratch_dir the directory of the scratch files, should be node-local
+   */
+  void use_disk_subspace_store(const std::string& scratch_dir) {
+    MPQC_ASSERT(B_->size() == 0 && HB_->size() == 0);
+    disk_scratch_dir_ = scratch_dir;
+    disk_n_resident_ = 0;
+  }
+
   /**
    *
    * @tparam Operator  operator that computes the product of H*B
@@ -197,15 +261,17 @@ class DavidsonDiag {
     // size of original subspace
     const auto n_s = subspace_.cols();
 
-    deflation(HB, B);
+    if (n_s == 0) init_disk_subspace_store();
 
-    B_.insert(B_.end(), B.begin(), B.end());
-    B.clear();
+    deflation(HB, B);
 
-    HB_.insert(HB_.end(), HB.begin(), HB.end());
-    HB.clear();
+    value_type B_new, HB_new;
+    std::swap(B_new, B);
+    std::swap(HB_new, HB);
+    for (const auto& b : B_new) B_->push_back(b);
+    for (const auto& hb : HB_new) HB_->push_back(hb);
     // size of new subspace
-    const auto n_v = B_.size();
+    const auto n_v = B_->size();
 
     // compute new subspace
     // G will be replicated Eigen Matrix
@@ -213,25 +279,33 @@ class DavidsonDiag {
       RowMatrix<element_type> G = RowMatrix<element_type>::Zero(n_v, n_v);
       // reuse stored subspace
       G.block(0, 0, n_s, n_s) << subspace_;
-      // initialize new value
-      if (symmetric_) {
-        for (std::size_t i = 0; i < n_b; ++i) {
-          const auto ii = i + n_s;
-          for (std::size_t j = 0; j <= ii; ++j) {
-            G(ii, j) = dot_product(B_[ii], HB_[j]);
-            if (ii != j) {
-              G(j, ii) = G(ii, j);
-            }
+      // initialize new value; the stored vectors are streamed once and all new
+      // elements are reduced at once
+      // rows(i, j) = B(n_s + i) . HB(j), cols(i, j) = B(j) . HB(n_s + i)
+      std::vector<element_type> dots(2 * n_b * n_v, 0);
+      auto rows = dots.data();
+      auto cols = dots.data() + n_b * n_v;
+      for (std::size_t j = 0; j < n_v; ++j) {
+        const D HB_j = (j < n_s) ? HB_->at(j) : HB_new[j - n_s];
+        const auto i_begin = (j < n_s) ? 0 : j - n_s;
+        for (std::size_t i = i_begin; i < n_b; ++i) {
+          rows[i * n_v + j] = local_dot_product(B_new[i], HB_j);
+        }
+        if (!symmetric_) {
+          const D B_j = (j < n_s) ? B_->at(j) : B_new[j - n_s];
+          for (std::size_t i = i_begin; i < n_b; ++i) {
+            cols[i * n_v + j] = local_dot_product(B_j, HB_new[i]);
           }
         }
-      } else {
-        for (std::size_t i = 0; i < n_b; ++i) {
-          const auto ii = i + n_s;
-          for (std::size_t j = 0; j <= ii; ++j) {
-            G(ii, j) = dot_product(B_[ii], HB_[j]);
-            if (ii != j) {
-              G(j, ii) = dot_product(B_[j], HB_[ii]);
-            }
+      }
+      world.gop.sum(dots.data(), dots.size());
+
+      for (std::size_t i = 0; i < n_b; ++i) {
+        const auto ii = i + n_s;
+        for (std::size_t j = 0; j <= ii; ++j) {
+          G(ii, j) = rows[i * n_v + j];
+          if (ii != j) {
+            G(j, ii) = symmetric_ ? G(ii, j) : cols[i * n_v + j];
           }
         }
       }
@@ -328,12 +402,18 @@ class DavidsonDiag {
 
     // compute eigen_vector at current iteration and store it
     // X(i) = B(i)*C(i)
+    // B_new may be empty (all new vectors deflated away), hence X is
+    // initialized from the first streamed subspace vector
     value_type X(n_roots_);
-    for (std::size_t i = 0; i < n_roots_; ++i) {
-      X[i] = copy(B_[i]);
-      zero(X[i]);
-      for (std::size_t j = 0; j < n_v; ++j) {
-        axpy(X[i], C(j, i), B_[j]);
+    for (std::size_t j = 0; j < n_v; ++j) {
+      const D B_j = B_->at(j);
+      for (std::size_t i = 0; i < n_roots_; ++i) {
+        if (j == 0) {
+          X[i] = copy(B_j);
+          scale(X[i], C(j, i));
+        } else {
+          axpy(X[i], C(j, i), B_j);
+        }
       }
     }
 
@@ -353,9 +433,14 @@ class DavidsonDiag {
       residual[i] = copy(X[i]);
       const auto e_i = -E[i];
       scale(residual[i], e_i);
-      for (std::size_t j = 0; j < n_v; ++j) {
-        axpy(residual[i], C(j, i), HB_[j]);
+    }
+    for (std::size_t j = 0; j < n_v; ++j) {
+      const D HB_j = HB_->at(j);
+      for (std::size_t i = 0; i < n_roots_; ++i) {
+        axpy(residual[i], C(j, i), HB_j);
       }
+    }
+    for (std::size_t i = 0; i < n_roots_; ++i) {
       norms[i] = pred->norm(residual[i]);
     }
     world.gop.fence();
@@ -372,9 +457,9 @@ class DavidsonDiag {
     // restart with new vector and most recent eigen vector
     // Journal of Computational Chemistry, 11(10), 1164–1168.
     // https://doi.org/10.1002/jcc.540111008
-    if (B_.size() > n_roots_ * (max_n_guess_ - 1)) {
-      B_.clear();
-      HB_.clear();
+    if (B_->size() > n_roots_ * (max_n_guess_ - 1)) {
+      B_->clear();
+      HB_->clear();
       subspace_.resize(0, 0);
       B.insert(B.end(), residual.begin(), residual.end());
       // TODO this generates too much eigen vectors
@@ -387,11 +472,8 @@ class DavidsonDiag {
       // call it second times
       math::gram_schmidt(B, vector_threshold_);
     } else {
-      // TODO better way to orthonormalize than double gram_schmidt
       // orthognolize new residual with original B
-      math::gram_schmidt(B_, residual, vector_threshold_);
-      // call it twice
-      math::gram_schmidt(B_, residual, vector_threshold_);
+      orthonormalize_to_subspace(residual);
       B = residual;
 
       //      for (std::size_t i = 0; i < n_roots_; i++) {
@@ -428,8 +510,8 @@ class DavidsonDiag {
   /// clean the cached values
   void reset() {
     eigen_vector_.clear();
-    HB_.clear();
-    B_.clear();
+    HB_->clear();
+    B_->clear();
     subspace_.resize(0, 0);
   }
 
@@ -439,6 +521,45 @@ class DavidsonDiag {
     // do nothing here
   }
 
+  /// creates the out-of-core subspace stores requested by
+  /// use_disk_subspace_store(), unless they already keep \c n_roots_ vectors
+  /// in memory
+  void init_disk_subspace_store() {
+    if (disk_scratch_dir_.empty() || disk_n_resident_ == n_roots_) return;
+    auto& world = TA::get_default_world();
+    // make file names unique among the solvers in this process
+    const auto prefix =
+        "davidson_" + std::to_string(reinterpret_cast<std::uintptr_t>(this));
+    set_subspace_store(std::make_unique<DiskSubspaceStore<D>>(
+                           world, disk_scratch_dir_, n_roots_, prefix + "_B"),
+                       std::make_unique<DiskSubspaceStore<D>>(
+                           world, disk_scratch_dir_, n_roots_, prefix + "_HB"));
+    disk_n_resident_ = n_roots_;
+  }
+
+  /// orthonormalizes \c V with respect to the (orthonormal) subspace vectors
+  /// B, equivalent to calling math::gram_schmidt(B, V, threshold) twice but
+  /// the subspace vectors are streamed only once: each B(j) is projected out
+  /// twice while it is in memory
+  void orthonormalize_to_subspace(value_type& V) {
+    if (V.empty()) return;
+    auto& world = TA::get_default_world();
+    std::vector<std::pair<const D*, const D*>> pairs;
+    for (std::size_t j = 0; j < B_->size(); ++j) {
+      const D B_j = B_->at(j);
+      pairs.clear();
+      for (const auto& v : V) pairs.emplace_back(&v, &B_j);
+      for (auto pass = 0; pass != 2; ++pass) {
+        const auto dots = detail::batched_dot_product(world, pairs);
+        for (std::size_t i = 0; i < V.size(); ++i) {
+          axpy(V[i], -dots[i], B_j);
+        }
+      }
+    }
+    math::gram_schmidt(V, vector_threshold_);
+    math::gram_schmidt(V, vector_threshold_);
+  }
+
  protected:
   unsigned int n_roots_;
   bool symmetric_;
@@ -446,9 +567,11 @@ class DavidsonDiag {
   unsigned int max_n_guess_;
   double vector_threshold_;
   std::deque<value_type> eigen_vector_;
-  value_type HB_;
-  value_type B_;
+  std::unique_ptr<DavidsonSubspaceStore<D>> HB_;
+  std::unique_ptr<DavidsonSubspaceStore<D>> B_;
   RowMatrix<element_type> subspace_;
+  std::string disk_scratch_dir_;
+  std::size_t disk_n_resident_ = 0;
 };
 
 template <typename D>
@@ -560,9 +683,17 @@ class SingleStateDavidsonDiag : public DavidsonDiag<D> {
 
     RowMatrix<element_type> QB = RowMatrix<element_type>::Zero(n, n_b);
 
+    std::vector<std::pair<const D*, const D*>> pairs;
+    for (std::size_t i = 0; i < n; i++) {
+      for (std::size_t j = 0; j < n_b; j++) {
+        pairs.emplace_back(&converged_eigen_vector_[i], &B[j]);
+      }
+    }
+    const auto dots =
+        detail::batched_dot_product(TA::get_default_world(), pairs);
     for (std::size_t i = 0; i < n; i++) {
       for (std::size_t j = 0; j < n_b; j++) {
-        QB(i, j) = dot_product(converged_eigen_vector_[i], B[j]);
+        QB(i, j) = dots[i * n_b + j];
       }
     }
 
@@ -0,0 +1,160 @@
+#ifndef SRC_MPQC_MATH_LINALG_DAVIDSON_SUBSPACE_STORE_H_
+#define SRC_MPQC_MATH_LINALG_DAVIDSON_SUBSPACE_STORE_H_
+
+#include <deque>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <tiledarray.h>
+
+#include "mpqc/math/external/tiledarray/array_scratch.h"
+#include "mpqc/util/misc/assert.h"
+
+namespace mpqc {
+
+/**
+ * \brief DavidsonSubspaceStore holds the subspace vectors (B or HB) of
+ * DavidsonDiag.
+ *
+ * The vectors are only accessed sequentially, by index, hence they can be
+ * kept out of core; prefetch() announces the vector that will be requested
+ * next so that its I/O can overlap with the computation on the current one.
+ */
+template <typename D>
+class DavidsonSubspaceStore {
+ public:
+  virtual ~DavidsonSubspaceStore() = default;
+
+  /// @return the number of stored vectors
+  virtual std::size_t size() const = 0;
+
+  /// appends vector \c v
+  virtual void push_back(const D& v) = 0;
+
+  /// @return the \c i-th vector
+  virtual D at(std::size_t i) = 0;
+
+  /// hints that the \c i-th vector will be requested by the next call to at()
+  virtual void prefetch(std::size_t i) {}
+
+  /// removes all vectors
+  virtual void clear() = 0;
+};
+
+/// InCoreSubspaceStore keeps all subspace vectors in memory
+template <typename D>
+class InCoreSubspaceStore : public DavidsonSubspaceStore<D> {
+ public:
+  std::size_t size() const override { return vectors_.size(); }
+
+  void push_back(const D& v) override { vectors_.push_back(v); }
+
+  D at(std::size_t i) override { return vectors_.at(i); }
+
+  void clear() override { vectors_.clear(); }
+
+ private:
+  std::vector<D> vectors_;
+};
+
+/**
+ * \brief DiskSubspaceStore keeps only the most recently added vectors in
+ * memory, the older ones are written to node-local scratch files and read
+ * back (asynchronously, if prefetched) when requested.
+ *
+ * \tparam D the vector type, detail::ArrayScratchTraits<D> must be defined
+ */
+template <typename D>
+class DiskSubspaceStore : public DavidsonSubspaceStore<D> {
+ public:
+  using scratch_traits = detail::ArrayScratchTraits<D>;
+  using handle_type = typename scratch_traits::handle_type;
+  using buffer_type = typename scratch_traits::buffer_type;
+
+  /**
+   * @param world the world in which the vectors live
+   * @param scratch_dir the directory of the scratch files, should be
+   * node-local
+   * @param n_resident the number of most recently added vectors kept in memory
+   * @param name the prefix of the scratch file names, must be unique among the
+   * stores using the same \c scratch_dir
+   */
+  DiskSubspaceStore(madness::World& world, const std::string& scratch_dir,
+                    std::size_t n_resident, const std::string& name)
+      : world_(world),
+        basename_(scratch_dir + "/" + name),
+        n_resident_(n_resident) {}
+
+  ~DiskSubspaceStore() { clear(); }
+
+  std::size_t size() const override {
+    return on_disk_.size() + resident_.size();
+  }
+
+  void push_back(const D& v) override {
+    resident_.push_back(v);
+    if (resident_.size() > n_resident_) {
+      // the file names are unique within the lifetime of the store
+      const auto name = basename_ + "_" + std::to_string(n_written_++);
+      on_disk_.push_back(scratch_traits::write(resident_.front(), name));
+      resident_.pop_front();
+    }
+  }
+
+  D at(std::size_t i) override {
+    MPQC_ASSERT(i < size());
+    if (i >= on_disk_.size()) return resident_[i - on_disk_.size()];
+
+    buffer_type buffer;
+    if (prefetched_ == i) {
+      buffer = prefetched_buffer_.get();
+      prefetched_ = none_;
+    } else {
+      buffer = scratch_traits::read_local(on_disk_[i]);
+    }
+    auto result = scratch_traits::make(on_disk_[i], std::move(buffer));
+
+    // start reading the next vector while this one is used
+    if (i + 1 < on_disk_.size()) prefetch(i + 1);
+    return result;
+  }
+
+  void prefetch(std::size_t i) override {
+    if (i >= on_disk_.size() || prefetched_ == i) return;
+    // wait for the pending read, if any, to keep at most one buffer in memory
+    if (prefetched_ != none_) prefetched_buffer_.get();
+    prefetched_ = i;
+    prefetched_buffer_ =
+        world_.taskq.add(&scratch_traits::read_local, on_disk_[i]);
+  }
+
+  void clear() override {
+    if (prefetched_ != none_) {
+      prefetched_buffer_.get();
+      prefetched_ = none_;
+    }
+    for (const auto& handle : on_disk_) scratch_traits::remove(handle);
+    on_disk_.clear();
+    resident_.clear();
+  }
+
+ private:
+  static constexpr std::size_t none_ = std::numeric_limits<std::size_t>::max();
+
+  madness::World& world_;
+  const std::string basename_;
+  const std::size_t n_resident_;
+  std::size_t n_written_ = 0;
+
+  std::vector<handle_type> on_disk_;
+  std::deque<D> resident_;
+
+  std::size_t prefetched_ = none_;
+  madness::Future<buffer_type> prefetched_buffer_;
+};
+
+}  // namespace mpqc
+
+#endif  // SRC_MPQC_MATH_LINALG_DAVIDSON_SUBSPACE_STORE_H_
@@ -0,0 +1,440 @@
+#ifndef MPQC4_SRC_MPQC_MATH_LINALG_SYMM_EIGEN_SOLVER_H_
+#define MPQC4_SRC_MPQC_MATH_LINALG_SYMM_EIGEN_SOLVER_H_
+
+#include <array>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <tiledarray.h>
+
+#include "mpqc/mpqc_config.h"
+#include "mpqc/math/external/eigen/eigen.h"
+#include "mpqc/math/external/eigen/util.h"
+#include "mpqc/math/tensor/clr/array_to_eigen.h"
+#include "mpqc/util/core/exception.h"
+
+#if MPQC_HAS_SCALAPACK
+#include "mpqc/math/external/scalapack/scalapack.h"
+#endif
+
+namespace mpqc {
+namespace math {
+
+/**
+ * \brief SymmEigenSolver computes the eigenpairs of a real symmetric matrix
+ * stored as a TA::DistArray.
+ *
+ * compute() diagonalizes the matrix, the eigenpairs are kept until the next
+ * call. The phase of each eigenvector is fixed by making its element of
+ * largest magnitude positive (see detail::canonical_column_phase()).
+ */
+template <typename Array>
+class SymmEigenSolver {
+ public:
+  using numeric_type = typename Array::value_type::numeric_type;
+  using vector_type = EigenVector<numeric_type>;
+
+  virtual ~SymmEigenSolver() = default;
+
+  /// diagonalizes \c A , this is collective
+  virtual void compute(Array const &A) = 0;
+
+  /// @return the eigenvalues in ascending order, on every process
+  vector_type const &eigenvalues() const { return evals_; }
+
+  /// @return the eigenvectors of the lowest \c nvecs eigenvalues, as columns;
+  /// the rows are tiled as those of the matrix, the columns by \c col_trange
+  virtual Array eigenvectors(std::size_t nvecs,
+                             TA::TiledRange1 const &col_trange) const = 0;
+
+  /// @return the name of the backend, as accepted by make_symm_eigen_solver()
+  virtual const char *name() const = 0;
+
+ protected:
+  vector_type evals_;
+};
+
+/// ReplicatedSymmEigenSolver gathers the matrix on every process and
+/// diagonalizes it on process 0 with Eigen; the eigenvectors are broadcast
+template <typename Array>
+class ReplicatedSymmEigenSolver : public SymmEigenSolver<Array> {
+ public:
+  using typename SymmEigenSolver<Array>::numeric_type;
+  using Tile = typename Array::value_type;
+  using Policy = typename Array::policy_type;
+
+  void compute(Array const &A) override {
+    auto &world = A.world();
+    world_ = &world;
+    row_trange_ = A.trange().data()[0];
+
+    auto A_eig = array_to_eigen(A);
+    if (world.rank() == 0) {
+      Eigen::SelfAdjointEigenSolver<decltype(A_eig)> es(A_eig);
+      this->evals_ = es.eigenvalues();
+      evecs_ = es.eigenvectors();
+      mpqc::detail::canonical_column_phase(evecs_, 1e-10);
+    }
+    world.gop.broadcast_serializable(this->evals_, 0);
+    world.gop.broadcast_serializable(evecs_, 0);
+  }
+
+  Array eigenvectors(std::size_t nvecs,
+                     TA::TiledRange1 const &col_trange) const override {
+    Matrix<numeric_type> C = evecs_.leftCols(nvecs);
+    return eigen_to_array<Tile, Policy>(*world_, C, row_trange_, col_trange);
+  }
+
+  const char *name() const override { return "replicated"; }
+
+ private:
+  madness::World *world_ = nullptr;
+  TA::TiledRange1 row_trange_;
+  Matrix<numeric_type> evecs_;
+};
+
+#if MPQC_HAS_SCALAPACK
+
+namespace detail {
+
+/**
+ * \brief MatrixPieceReceiver writes the pieces of a matrix sent by other
+ * processes to a local sink.
+ *
+ * A piece is a column-major block with rows [row0, row0 + nrows) and columns
+ * [col0, col0 + ncols) of the global matrix. The pieces must not overlap,
+ * since they are written concurrently.
+ * @note the constructor is collective
+ */
+class MatrixPieceReceiver : public madness::WorldObject<MatrixPieceReceiver> {
+ public:
+  using WorldObject_ = madness::WorldObject<MatrixPieceReceiver>;
+  using sink_type = std::function<void(int row0, int col0, int nrows,
+                                       int ncols, const double *piece)>;
+
+  MatrixPieceReceiver(madness::World &world, sink_type sink)
+      : WorldObject_(world), sink_(std::move(sink)) {
+    // WorldObject mandates this is called from the ctor
+    WorldObject_::process_pending();
+  }
+
+  virtual ~MatrixPieceReceiver() {}
+
+  /// sends the pieces described by \c headers ({row0, col0, nrows, ncols} per
+  /// piece) whose elements are concatenated in \c data to process \c dest
+  void send_pieces(int dest, std::vector<int> const &headers,
+                   std::vector<double> const &data) {
+    if (headers.empty()) return;
+    if (dest == this->get_world().rank())
+      put(headers, data);
+    else
+      WorldObject_::task(dest, &MatrixPieceReceiver::put, headers, data);
+  }
+
+ private:
+  sink_type sink_;
+
+  void put(std::vector<int> const &headers, std::vector<double> const &data) {
+    auto piece = data.data();
+    for (auto h = 0ul; h < headers.size(); h += 4) {
+      sink_(headers[h], headers[h + 1], headers[h + 2], headers[h + 3], piece);
+      piece += headers[h + 2] * headers[h + 3];
+    }
+  }
+};
+
+/// @return an array with all tiles (to be) nonzero
+template <typename Tile>
+TA::DistArray<Tile, TA::DensePolicy> make_nonzero_array(
+    madness::World &world, TA::TiledRange const &trange, TA::DensePolicy) {
+  return TA::DistArray<Tile, TA::DensePolicy>(world, trange);
+}
+
+template <typename Tile>
+TA::DistArray<Tile, TA::SparsePolicy> make_nonzero_array(
+    madness::World &world, TA::TiledRange const &trange, TA::SparsePolicy) {
+  TA::Tensor<float> norms(trange.tiles_range(),
+                          std::numeric_limits<float>::max());
+  TA::SparseShape<float> shape(world, norms, trange);
+  return TA::DistArray<Tile, TA::SparsePolicy>(world, trange, shape);
+}
+
+/// copies \c A to the block-cyclic matrix \c M , \c M must be zero on input;
+/// every process sends the pieces of its tiles directly to their owners
+template <typename Tile, typename Policy>
+void array_to_block_cyclic(TA::DistArray<Tile, Policy> const &A,
+                           scalapack::BlockCyclicMatrix &M) {
+  auto &world = A.world();
+  const auto nb = M.block_size();
+
+  MatrixPieceReceiver receiver(
+      world, [&M](int row0, int col0, int nrows, int ncols, const double *p) {
+        const auto lrow0 = M.local_row(row0);
+        const auto lcol0 = M.local_col(col0);
+        for (auto c = 0; c < ncols; ++c)
+          for (auto r = 0; r < nrows; ++r)
+            M.local(lrow0 + r, lcol0 + c) = p[r + c * nrows];
+      });
+
+  const auto end = A.pmap()->end();
+  for (auto it = A.pmap()->begin(); it != end; ++it) {
+    if (A.is_zero(*it)) continue;
+    const Tile tile = A.find(*it).get();
+    const auto lo = tile.range().lobound_data();
+    const auto up = tile.range().upbound_data();
+    const int ld = up[1] - lo[1];
+
+    // split the tile at the block boundaries and group the pieces by owner
+    std::unordered_map<int, std::pair<std::vector<int>, std::vector<double>>>
+        pieces;
+    for (int row0 = lo[0]; row0 < int(up[0]); row0 = (row0 / nb + 1) * nb) {
+      const int nrows = std::min(int(up[0]), (row0 / nb + 1) * nb) - row0;
+      for (int col0 = lo[1]; col0 < int(up[1]);
+           col0 = (col0 / nb + 1) * nb) {
+        const int ncols = std::min(int(up[1]), (col0 / nb + 1) * nb) - col0;
+        auto &piece = pieces[M.owner(row0, col0)];
+        piece.first.insert(piece.first.end(), {row0, col0, nrows, ncols});
+        for (auto c = col0; c < col0 + ncols; ++c)
+          for (auto r = row0; r < row0 + nrows; ++r)
+            piece.second.push_back(tile.data()[(r - lo[0]) * ld + c - lo[1]]);
+      }
+    }
+    for (auto const &piece : pieces)
+      receiver.send_pieces(piece.first, piece.second.first,
+                           piece.second.second);
+  }
+  world.gop.fence();
+}
+
+/// @return the leading columns of the block-cyclic matrix \c M as an array
+/// tiled by \c row_trange and \c col_trange ; every process sends the pieces
+/// of its blocks directly to the owners of the tiles
+template <typename Tile, typename Policy>
+TA::DistArray<Tile, Policy> block_cyclic_to_array(
+    scalapack::BlockCyclicMatrix const &M, TA::TiledRange1 const &row_trange,
+    TA::TiledRange1 const &col_trange) {
+  auto &world = M.grid().world();
+  const TA::TiledRange trange{row_trange, col_trange};
+  auto result = make_nonzero_array<Tile>(world, trange, Policy{});
+
+  // the local tiles, written by the receiver
+  std::unordered_map<std::size_t, Tile> tiles;
+  const auto end = result.pmap()->end();
+  for (auto it = result.pmap()->begin(); it != end; ++it)
+    tiles.emplace(*it, Tile(trange.make_tile_range(*it)));
+
+  MatrixPieceReceiver receiver(world, [&](int row0, int col0, int nrows,
+                                          int ncols, const double *p) {
+    const auto ord = trange.tiles_range().ordinal(std::array<std::size_t, 2>{
+        {row_trange.element_to_tile(row0), col_trange.element_to_tile(col0)}});
+    auto &tile = tiles.at(ord);
+    const auto lo = tile.range().lobound_data();
+    const auto ld = tile.range().extent_data()[1];
+    for (auto c = 0; c < ncols; ++c)
+      for (auto r = 0; r < nrows; ++r)
+        tile.data()[(row0 + r - lo[0]) * ld + col0 + c - lo[1]] =
+            p[r + c * nrows];
+  });
+
+  // split the local blocks at the tile boundaries and group them by owner
+  const int nb = M.block_size();
+  const int ncols = col_trange.extent();
+  std::unordered_map<int, std::pair<std::vector<int>, std::vector<double>>>
+      pieces;
+  for (int lcol_blk = 0; lcol_blk < M.local_ncols(); lcol_blk += nb) {
+    const int bcol0 = M.global_col(lcol_blk);
+    const int bcol1 = std::min(ncols, bcol0 + nb);
+    for (int lrow_blk = 0; lrow_blk < M.local_nrows(); lrow_blk += nb) {
+      const int brow0 = M.global_row(lrow_blk);
+      const int brow1 = std::min(M.nrows(), brow0 + nb);
+      for (int row0 = brow0; row0 < brow1;) {
+        const auto tile_row = row_trange.element_to_tile(row0);
+        const int row1 = std::min<int>(brow1, row_trange.tile(tile_row).second);
+        for (int col0 = bcol0; col0 < bcol1;) {
+          const auto tile_col = col_trange.element_to_tile(col0);
+          const int col1 =
+              std::min<int>(bcol1, col_trange.tile(tile_col).second);
+          const auto owner = result.pmap()->owner(trange.tiles_range().ordinal(
+              std::array<std::size_t, 2>{{tile_row, tile_col}}));
+          auto &piece = pieces[owner];
+          piece.first.insert(piece.first.end(),
+                             {row0, col0, row1 - row0, col1 - col0});
+          for (auto c = col0; c < col1; ++c)
+            for (auto r = row0; r < row1; ++r)
+              piece.second.push_back(M.local(M.local_row(r), M.local_col(c)));
+          col0 = col1;
+        }
+        row0 = row1;
+      }
+    }
+  }
+  for (auto const &piece : pieces)
+    receiver.send_pieces(piece.first, piece.second.first, piece.second.second);
+  world.gop.fence();
+
+  for (auto &tile : tiles) result.set(tile.first, std::move(tile.second));
+  world.gop.fence();
+  result.truncate();
+  return result;
+}
+
+/// makes the element of largest magnitude of each column of \c M positive,
+/// the first such element (within \c tolerance) if there are several
+inline void canonical_column_phase(scalapack::BlockCyclicMatrix &M,
+                                   double tolerance) {
+  auto &world = M.grid().world();
+  const auto ncols = M.ncols();
+
+  std::vector<double> max_abs(ncols, 0.0);
+  for (auto lc = 0; lc < M.local_ncols(); ++lc)
+    for (auto lr = 0; lr < M.local_nrows(); ++lr)
+      max_abs[M.global_col(lc)] =
+          std::max(max_abs[M.global_col(lc)], std::abs(M.local(lr, lc)));
+  world.gop.max(max_abs.data(), ncols);
+
+  std::vector<double> first_row(ncols, M.nrows());
+  std::vector<double> sign(ncols, 0.0);
+  auto is_max = [&](double x, int c) {
+    return max_abs[c] - std::abs(x) <= tolerance * max_abs[c];
+  };
+  for (auto lc = 0; lc < M.local_ncols(); ++lc)
+    for (auto lr = 0; lr < M.local_nrows(); ++lr)
+      if (is_max(M.local(lr, lc), M.global_col(lc)))
+        first_row[M.global_col(lc)] =
+            std::min<double>(first_row[M.global_col(lc)], M.global_row(lr));
+  world.gop.min(first_row.data(), ncols);
+
+  for (auto lc = 0; lc < M.local_ncols(); ++lc)
+    for (auto lr = 0; lr < M.local_nrows(); ++lr)
+      if (M.global_row(lr) == first_row[M.global_col(lc)])
+        sign[M.global_col(lc)] = M.local(lr, lc) < 0 ? -1.0 : 1.0;
+  world.gop.sum(sign.data(), ncols);
+
+  for (auto lc = 0; lc < M.local_ncols(); ++lc)
+    if (sign[M.global_col(lc)] < 0)
+      for (auto lr = 0; lr < M.local_nrows(); ++lr) M.local(lr, lc) *= -1;
+}
+
+}  // namespace detail
+
+/**
+ * \brief ScaLAPACKSymmEigenSolver diagonalizes the matrix in the 2-d
+ * block-cyclic layout with ScaLAPACK (pdsyevd), over all processes of its
+ * world.
+ *
+ * The matrix and the eigenvectors are moved directly between the tiles and
+ * the block-cyclic layout, hence no process ever holds a full copy of
+ * either.
+ */
+template <typename Array>
+class ScaLAPACKSymmEigenSolver : public SymmEigenSolver<Array> {
+ public:
+  using Tile = typename Array::value_type;
+  using Policy = typename Array::policy_type;
+  static_assert(std::is_same<Tile, TA::Tensor<double>>::value,
+                "ScaLAPACKSymmEigenSolver requires TA::Tensor<double> tiles");
+
+  /// @param block_size the row and column size of the blocks
+  explicit ScaLAPACKSymmEigenSolver(int block_size = 64)
+      : block_size_(block_size) {}
+
+  void compute(Array const &A) override {
+    auto &world = A.world();
+    if (!grid_ || &grid_->world() != &world)
+      grid_ = std::make_shared<scalapack::BlacsGrid>(world);
+    row_trange_ = A.trange().data()[0];
+
+    const int n = row_trange_.extent();
+    scalapack::BlockCyclicMatrix A_bc(*grid_, n, n, block_size_);
+    detail::array_to_block_cyclic(A, A_bc);
+
+    evecs_ = std::make_shared<scalapack::BlockCyclicMatrix>(*grid_, n, n,
+                                                            block_size_);
+    auto evals = scalapack::syevd(A_bc, *evecs_);
+    this->evals_ = Eigen::Map<EigenVector<double>>(evals.data(), n);
+    detail::canonical_column_phase(*evecs_, 1e-10);
+  }
+
+  Array eigenvectors(std::size_t nvecs,
+                     TA::TiledRange1 const &col_trange) const override {
+    TA_USER_ASSERT(col_trange.extent() == nvecs,
+                   "col_trange must span the requested eigenvectors");
+    return detail::block_cyclic_to_array<Tile, Policy>(*evecs_, row_trange_,
+                                                       col_trange);
+  }
+
+  const char *name() const override { return "scalapack"; }
+
+ private:
+  int block_size_;
+  std::shared_ptr<scalapack::BlacsGrid> grid_;
+  TA::TiledRange1 row_trange_;
+  std::shared_ptr<scalapack::BlockCyclicMatrix> evecs_;
+};
+
+#endif  // MPQC_HAS_SCALAPACK
+
+namespace detail {
+
+template <typename Array>
+std::enable_if_t<
+    std::is_same<typename Array::value_type, TA::Tensor<double>>::value,
+    std::shared_ptr<SymmEigenSolver<Array>>>
+make_scalapack_symm_eigen_solver(int block_size) {
+#if MPQC_HAS_SCALAPACK
+  return std::make_shared<ScaLAPACKSymmEigenSolver<Array>>(block_size);
+#else
+  return nullptr;
+#endif
+}
+
+template <typename Array>
+std::enable_if_t<
+    !std::is_same<typename Array::value_type, TA::Tensor<double>>::value,
+    std::shared_ptr<SymmEigenSolver<Array>>>
+make_scalapack_symm_eigen_solver(int) {
+  return nullptr;
+}
+
+}  // namespace detail
+
+/**
+ * @param backend the eigensolver: "scalapack" (ScaLAPACKSymmEigenSolver),
+ * "replicated" (ReplicatedSymmEigenSolver), or "auto" (ScaLAPACK if
+ * available and the tiles are real, replicated otherwise)
+ * @param block_size the block size of the block-cyclic layout
+ * @return a new eigensolver
+ * @throw InputError if \c backend is not valid or not available
+ */
+template <typename Array>
+std::shared_ptr<SymmEigenSolver<Array>> make_symm_eigen_solver(
+    std::string const &backend, int block_size = 64) {
+  constexpr bool real_tiles =
+      std::is_same<typename Array::value_type, TA::Tensor<double>>::value;
+#if MPQC_HAS_SCALAPACK
+  constexpr bool have_scalapack = real_tiles;
+#else
+  constexpr bool have_scalapack = false;
+#endif
+
+  if (backend == "replicated" || (backend == "auto" && !have_scalapack))
+    return std::make_shared<ReplicatedSymmEigenSolver<Array>>();
+  if (backend == "scalapack" || backend == "auto") {
+    if (!have_scalapack)
+      throw InputError("ScaLAPACK eigensolver is not available", __FILE__,
+                       __LINE__, "eigen_solver", backend.c_str());
+    return detail::make_scalapack_symm_eigen_solver<Array>(block_size);
+  }
+  throw InputError("invalid eigensolver", __FILE__, __LINE__, "eigen_solver",
+                   backend.c_str());
+}
+
+}  // namespace math
+}  // namespace mpqc
+
+#endif  // MPQC4_SRC_MPQC_MATH_LINALG_SYMM_EIGEN_SOLVER_H_
@@ -0,0 +1,92 @@
+#ifndef MPQC4_SRC_MPQC_UTIL_EXTERNAL_MADWORLD_TASK_COUNTER_H_
+#define MPQC4_SRC_MPQC_UTIL_EXTERNAL_MADWORLD_TASK_COUNTER_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+
+#include <madness/world/world.h>
+#include <madness/world/worldobj.h>
+
+namespace mpqc {
+namespace utility {
+
+/// TaskCounter is a global counter, hosted by rank 0 of a World, that hands
+/// out consecutive task indices to the ranks that ask for them. It is the
+/// simplest form of dynamic (self-scheduled) load balancing: a rank that is
+/// done with its task asks for the next one, hence fast ranks do more work and
+/// the slowest rank no longer determines the wall time.
+
+/// @note the constructor is collective, i.e. it must be called by all ranks in
+///       the same order as other WorldObject constructors
+class TaskCounter : public madness::WorldObject<TaskCounter> {
+ public:
+  using WorldObject_ = madness::WorldObject<TaskCounter>;
+
+  /// @param world the World in which the counter is shared
+  /// @param first the first index to be handed out
+  explicit TaskCounter(madness::World& world, std::size_t first = 0)
+      : WorldObject_(world), counter_(first) {
+    // WorldObject mandates this is called from the ctor
+    WorldObject_::process_pending();
+  }
+
+  virtual ~TaskCounter() {}
+
+  /// @param n the number of indices to claim
+  /// @return future to the first of the next \c n unclaimed (consecutive)
+  ///         indices; each index is handed out exactly once
+  madness::Future<std::size_t> next(std::size_t n = 1) {
+    return WorldObject_::task(0, &TaskCounter::fetch_and_add, n);
+  }
+
+ private:
+  std::atomic<std::size_t> counter_;
+
+  std::size_t fetch_and_add(std::size_t n) { return counter_.fetch_add(n); }
+};
+
+/// TaskFetcher claims the indices of a TaskCounter for one rank in chunks of
+/// consecutive indices, and requests the next chunk as soon as the current
+/// one is claimed; hence the round trip to rank 0 overlaps with the work on
+/// the current chunk, and its cost is amortized over the chunk.
+
+/// The indices claimed by a rank increase monotonically, hence a loop over all
+/// tasks in the order of their indices can skip the tasks for which
+/// current() does not match, see CCSD_T::compute_ccsd_t_coarse_grain().
+class TaskFetcher {
+ public:
+  /// @param counter the counter to claim the indices from
+  /// @param chunk_size the number of indices claimed at once
+  explicit TaskFetcher(TaskCounter& counter, std::size_t chunk_size = 1)
+      : counter_(counter), chunk_size_(chunk_size) {
+    assert(chunk_size_ > 0);
+    first_ = counter_.next(chunk_size_).get();
+    next_chunk_ = counter_.next(chunk_size_);
+  }
+
+  /// @return the index of the current task of this rank
+  std::size_t current() const { return first_ + position_; }
+
+  /// moves to the next task of this rank; blocks only if the next chunk has
+  /// not arrived yet
+  void advance() {
+    if (++position_ == chunk_size_) {
+      first_ = next_chunk_.get();
+      position_ = 0;
+      next_chunk_ = counter_.next(chunk_size_);
+    }
+  }
+
+ private:
+  TaskCounter& counter_;
+  const std::size_t chunk_size_;
+  std::size_t first_;
+  std::size_t position_ = 0;
+  madness::Future<std::size_t> next_chunk_;
+};
+
+}  // namespace utility
+}  // namespace mpqc
+
+#endif  // MPQC4_SRC_MPQC_UTIL_EXTERNAL_MADWORLD_TASK_COUNTER_H_
@@ -0,0 +1,48 @@
+#ifndef MPQC4_TESTS_UNIT_ARRAY_FIXTURE_H_
+#define MPQC4_TESTS_UNIT_ARRAY_FIXTURE_H_
+
+#include <tiledarray.h>
+
+#include "mpqc/math/external/tiledarray/tile_util.h"
+
+namespace mpqc {
+namespace test {
+
+/// @return the array with tiled range \c trange and elements \c value(idx) ,
+/// tiles for which \c zero(tile_idx) is true are zero
+template <typename Policy, typename Value, typename Zero>
+TA::DistArray<TA::TensorD, Policy> make_array(const TA::TiledRange &trange,
+                                              Value &&value, Zero &&zero) {
+  using Array = TA::DistArray<TA::TensorD, Policy>;
+  auto &world = TA::get_default_world();
+
+  auto make_tile = [&](std::size_t ord) {
+    TA::TensorD tile(trange.make_tile_range(ord));
+    const auto is_zero = zero(trange.tiles_range().idx(ord));
+    const auto &range = tile.range();
+    for (auto it = range.begin(); it != range.end(); ++it) {
+      tile[*it] = is_zero ? 0.0 : value(*it);
+    }
+    return tile;
+  };
+
+  // every process computes all tiles to get the (replicated) norms
+  TA::Tensor<float> norms(trange.tiles_range(), 0.0f);
+  for (auto ord = 0ul; ord != norms.size(); ++ord) {
+    norms[ord] = make_tile(ord).norm();
+  }
+  Array result(world, trange,
+               detail::make_shape(
+                   trange, [&norms](std::size_t ord) { return norms[ord]; },
+                   Policy()));
+  for (auto it = result.pmap()->begin(); it != result.pmap()->end(); ++it) {
+    if (!result.is_zero(*it)) result.set(*it, make_tile(*it));
+  }
+  world.gop.fence();
+  return result;
+}
+
+}  // namespace test
+}  // namespace mpqc
+
+#endif  // MPQC4_TESTS_UNIT_ARRAY_FIXTURE_H_
@@ -0,0 +1,69 @@
+#include "catch.hpp"
+
+#include "mpqc/math/external/eigen/eigen.h"
+#include "mpqc/math/external/tiledarray/array_stack.h"
+#include "mpqc/math/tensor/clr/array_to_eigen.h"
+
+using namespace mpqc;
+
+namespace {
+
+template <typename Policy>
+void test_stack_unstack() {
+  using Array = TA::DistArray<TA::TensorD, Policy>;
+  auto &world = TA::get_default_world();
+
+  const std::size_t n = 20;
+  const std::size_t nstack = 3;
+  TA::TiledRange1 tr1{0, 5, 10, 20};
+
+  // the k-th matrix has a zero (0,1) tile if k is even and a zero (2,0) tile
+  // if k is odd, hence the stack has no zero tiles but the arrays do
+  std::vector<RowMatrix<double>> matrices;
+  std::vector<Array> arrays;
+  for (auto k = 0ul; k != nstack; ++k) {
+    RowMatrix<double> A = RowMatrix<double>::Random(n, n);
+    if (k % 2 == 0) A.block(0, 5, 5, 5).setZero();
+    if (k % 2 == 1) A.block(10, 0, 10, 5).setZero();
+    matrices.push_back(A);
+    arrays.push_back(math::eigen_to_array<TA::TensorD, Policy>(world, A, tr1,
+                                                               tr1));
+  }
+
+  auto stacked = stack_arrays(arrays);
+  REQUIRE(stacked.trange().rank() == 3);
+  REQUIRE(stacked.trange().dim(0).extent() == nstack);
+  REQUIRE(stacked.trange().dim(0).tile_extent() == 1);
+
+  SECTION("contraction with the stack") {
+    RowMatrix<double> B = RowMatrix<double>::Random(n, n);
+    auto B_ta = math::eigen_to_array<TA::TensorD, Policy>(world, B, tr1, tr1);
+
+    Array SB;
+    SB("k,i,j") = stacked("k,i,l") * B_ta("l,j");
+    auto products = unstack_array(SB, arrays.front().trange());
+    REQUIRE(products.size() == nstack);
+    for (auto k = 0ul; k != nstack; ++k) {
+      RowMatrix<double> AB = math::array_to_eigen(products[k]);
+      RowMatrix<double> ref = matrices[k] * B;
+      CHECK((AB - ref).lpNorm<Eigen::Infinity>() < 1.0e-12);
+    }
+  }
+
+  SECTION("round trip") {
+    auto unstacked = unstack_array(stacked, arrays.front().trange());
+    REQUIRE(unstacked.size() == nstack);
+    for (auto k = 0ul; k != nstack; ++k) {
+      REQUIRE(unstacked[k].trange() == arrays[k].trange());
+      RowMatrix<double> A = math::array_to_eigen(unstacked[k]);
+      CHECK((A - matrices[k]).lpNorm<Eigen::Infinity>() == 0.0);
+    }
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Stack and unstack TA::DistArray", "[array-stack]") {
+  SECTION("dense") { test_stack_unstack<TA::DensePolicy>(); }
+  SECTION("sparse") { test_stack_unstack<TA::SparsePolicy>(); }
+}
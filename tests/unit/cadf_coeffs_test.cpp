@@ -0,0 +1,92 @@
+#include "catch.hpp"
+
+#include <sstream>
+
+#include "mpqc/chemistry/qc/lcao/basis/basis.h"
+#include "mpqc/chemistry/qc/lcao/integrals/density_fitting/cadf_coeffs.h"
+
+using namespace mpqc;
+
+TEST_CASE("CADF metric cache", "[cadf]") {
+  using Array = TA::TSpArrayD;
+  using AtomicBasis = lcao::gaussian::AtomicBasis;
+  auto &world = TA::get_default_world();
+
+  // the same molecule at two positions
+  const char h2o_xyz_cstr[] =
+      "3\n"
+      "\n"
+      "O   -0.702196054  -0.056060256   0.009942262\n"
+      "H   -1.022193224   0.846775782  -0.011488714\n"
+      "H    0.257521062   0.042121496   0.005218999\n";
+  const char h2o_shifted_xyz_cstr[] =
+      "3\n"
+      "\n"
+      "O    0.297803946   0.943939744   2.009942262\n"
+      "H   -0.022193224   1.846775782   1.988511286\n"
+      "H    1.257521062   1.042121496   2.005218999\n";
+
+  libint2::initialize();
+
+  auto make_basis = [&world](const char *xyz, const std::string &name) {
+    std::stringstream iss((std::string(xyz)));
+    auto mol = std::make_shared<Molecule>(iss);
+    return std::make_shared<AtomicBasis>(KeyVal()
+                                             .assign("atoms", mol)
+                                             .assign("world", &world)
+                                             .assign("name", name));
+  };
+  auto max_diff = [](Array &A, Array &B) {
+    Array diff;
+    diff("X,i,j") = A("X,i,j") - B("X,i,j");
+    return diff("X,i,j").abs_max().get();
+  };
+
+  auto obs = make_basis(h2o_xyz_cstr, "6-31G");
+  auto dfbs = make_basis(h2o_xyz_cstr, "cc-pVDZ");
+
+  lcao::detail::CADFMetricCache cache;
+  auto C = lcao::cadf_fitting_coefficients<TA::TensorD, TA::SparsePolicy>(
+      world, *obs, *dfbs, &cache);
+  const auto nfactorizations = cache.size();
+  // one metric per atom type and one per atom pair
+  REQUIRE(nfactorizations > 0);
+  REQUIRE(cache.nbytes() > 0);
+
+  SECTION("same geometry") {
+    // the second build reuses every factorization
+    auto C_again = lcao::cadf_fitting_coefficients<TA::TensorD,
+                                                   TA::SparsePolicy>(
+        world, *obs, *dfbs, &cache);
+    REQUIRE(cache.size() == nfactorizations);
+    CHECK(max_diff(C_again, C) < 1.0e-12);
+  }
+
+  SECTION("translated geometry") {
+    // the metrics only depend on the relative positions of the atoms, hence
+    // the factorizations of the first geometry are reused
+    auto obs_shifted = make_basis(h2o_shifted_xyz_cstr, "6-31G");
+    auto dfbs_shifted = make_basis(h2o_shifted_xyz_cstr, "cc-pVDZ");
+    auto C_cached = lcao::cadf_fitting_coefficients<TA::TensorD,
+                                                    TA::SparsePolicy>(
+        world, *obs_shifted, *dfbs_shifted, &cache);
+    REQUIRE(cache.size() == nfactorizations);
+
+    auto C_ref = lcao::cadf_fitting_coefficients<TA::TensorD,
+                                                 TA::SparsePolicy>(
+        world, *obs_shifted, *dfbs_shifted);
+    CHECK(max_diff(C_cached, C_ref) < 1.0e-10);
+  }
+
+  SECTION("no room") {
+    // factorizations that do not fit are computed but not stored
+    lcao::detail::CADFMetricCache small_cache(1.0e-8, 0);
+    auto C_uncached = lcao::cadf_fitting_coefficients<TA::TensorD,
+                                                      TA::SparsePolicy>(
+        world, *obs, *dfbs, &small_cache);
+    REQUIRE(small_cache.size() == 0);
+    CHECK(max_diff(C_uncached, C) < 1.0e-12);
+  }
+
+  libint2::finalize();
+}
@@ -0,0 +1,100 @@
+#include "catch.hpp"
+#include "array_fixture.h"
+#include "mpqc/chemistry/qc/lcao/cc/ccsd_ladder.h"
+
+using namespace mpqc;
+using mpqc::test::make_array;
+
+namespace {
+
+template <typename Array>
+double max_diff(Array &A, Array &B) {
+  Array diff;
+  diff("a,b,i,j") = A("a,b,i,j") - B("a,b,i,j");
+  return diff("a,b,i,j").abs_max().get();
+}
+
+template <typename Policy>
+void test_packed_ladder() {
+  using Array = TA::DistArray<TA::TensorD, Policy>;
+
+  // tiles of different extents
+  const TA::TiledRange1 tr_v{0, 3, 7, 10};
+  const TA::TiledRange1 tr_o{0, 2, 5};
+  const TA::TiledRange1 tr_x{0, 4, 9};
+
+  auto f = [](std::size_t a, std::size_t b, std::size_t c, std::size_t d) {
+    return std::sin(1.0 + a + 2.0 * b + 3.0 * c + 5.0 * d);
+  };
+  // the tiles {0,1,*,*} and {1,0,*,*} of tau are zero
+  auto tau = make_array<Policy>(
+      TA::TiledRange{tr_v, tr_v, tr_o, tr_o},
+      [&f](auto const &idx) {
+        // tau_cd^ij = tau_dc^ji
+        return f(idx[0], idx[1], idx[2], idx[3]) +
+               f(idx[1], idx[0], idx[3], idx[2]);
+      },
+      [](auto const &tile_idx) {
+        return (tile_idx[0] == 0 && tile_idx[1] == 1) ||
+               (tile_idx[0] == 1 && tile_idx[1] == 0);
+      });
+
+  auto no_zero = [](auto const &) { return false; };
+
+  SECTION("stored integrals") {
+    // W_abcd = W_badc
+    auto w = make_array<Policy>(
+        TA::TiledRange{tr_v, tr_v, tr_v, tr_v},
+        [&f](auto const &idx) {
+          return f(idx[3], idx[2], idx[0], idx[1]) +
+                 f(idx[2], idx[3], idx[1], idx[0]);
+        },
+        no_zero);
+
+    Array ref;
+    ref("a,b,i,j") = w("a,b,c,d") * tau("c,d,i,j");
+
+    auto w_packed = lcao::cc::pack_ladder_integrals(w);
+    // the pairs of the tile pairs A>=B: (10*10 + 3*3 + 4*4 + 3*3) / 2, of W+
+    // and W- for cd
+    REQUIRE(w_packed.trange().elements_range().extent_data()[0] == 67);
+    REQUIRE(w_packed.trange().elements_range().extent_data()[1] == 134);
+
+    auto b = lcao::cc::compute_packed_ladder(w_packed, tau);
+    REQUIRE(b.trange() == ref.trange());
+    CHECK(max_diff(b, ref) < 1.0e-10);
+  }
+
+  SECTION("density-fitting integrals") {
+    auto bra = make_array<Policy>(
+        TA::TiledRange{tr_x, tr_v, tr_v},
+        [](auto const &idx) {
+          return std::cos(1.0 + 0.5 * idx[0] + idx[1] + 3.0 * idx[2]);
+        },
+        no_zero);
+    auto ket = make_array<Policy>(
+        TA::TiledRange{tr_x, tr_v, tr_v},
+        [](auto const &idx) {
+          return std::sin(2.0 + idx[0] + 0.5 * idx[1] + 2.0 * idx[2]);
+        },
+        no_zero);
+
+    // W_abcd = M_abcd + M_badc, M_abcd = X^K_ac Y^K_bd
+    Array m, w;
+    m("a,b,c,d") = bra("K,a,c") * ket("K,b,d");
+    w("a,b,c,d") = m("a,b,c,d") + m("b,a,d,c");
+    Array ref;
+    ref("a,b,i,j") = w("a,b,c,d") * tau("c,d,i,j");
+
+    auto w_packed = lcao::cc::direct_packed_ladder_integrals(bra, ket);
+    auto b = lcao::cc::compute_packed_ladder(w_packed, tau);
+    CHECK(max_diff(b, ref) < 1.0e-10);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Packed CCSD Ladder", "[ccsd-ladder]") {
+  SECTION("dense") { test_packed_ladder<TA::DensePolicy>(); }
+  SECTION("sparse") { test_packed_ladder<TA::SparsePolicy>(); }
+}
@@ -240,3 +240,122 @@ TEST_CASE("Nonsymmetric Davidson Algorithm", "[nonsymm-davidson]") {
   // should converge in 10 iteration
   CHECK(i < max_iter);
 }
+
+TEST_CASE("Davidson Algorithm with Subspace Collapse", "[restart-davidson]") {
+  using Array = TA::DistArray<TA::TensorD, TA::DensePolicy>;
+
+  // matrix size
+  const auto n = 200;
+  const auto sparse = 0.1;
+  const auto n_roots = 2;
+  const auto converge = 1.0e-8;
+  const auto max_iter = 60;
+  // small subspace, forces the subspace to collapse (restart) several times
+  const auto n_guess = 2;
+  const auto max_n_guess = 3;
+
+  RowMatrix<double> A = RowMatrix<double>::Zero(n, n);
+  for (auto i = 0; i < n; i++) {
+    A(i, i) = i + 1;
+  }
+  A = A + sparse * RowMatrix<double>::Random(n, n);
+
+  TA::TiledRange1 tr_n{0, 50, 100, 150, n};
+  TA::TiledRange1 tr_guess{0, 1};
+
+  struct Pred : public DavidsonDiagPred<Array> {
+    Pred(const EigenVector<double> &diagonal) : diagonal_(diagonal) {}
+
+    void operator()(const EigenVector<double> &e,
+                    std::vector<Array> &guess) const override {
+      for (std::size_t i = 0; i < guess.size(); i++) {
+        auto &ei = e[i];
+        auto &diagonal = this->diagonal_;
+        auto task = [&diagonal, &ei](TA::TensorD &result_tile) {
+          const auto &range = result_tile.range();
+          double norm = 0.0;
+          for (const auto &i : range) {
+            const auto result = result_tile[i] / (ei - diagonal[i[0]]);
+            result_tile[i] = result;
+            norm += result * result;
+          }
+          return std::sqrt(norm);
+        };
+        TA::foreach_inplace(guess[i], task);
+        guess[i].world().gop.fence();
+      }
+    }
+
+    EigenVector<double> diagonal_;
+  };
+
+  // runs the Davidson iterations, returns the number of iterations; if
+  // on_disk is true the subspace vectors are kept out of core
+  auto solve = [&](const RowMatrix<double> &M, bool symmetric, bool on_disk,
+                   EigenVector<double> &eig) {
+    auto M_ta = math::eigen_to_array<TA::TensorD, TA::DensePolicy>(
+        TA::get_default_world(), M, tr_n, tr_n);
+
+    RowMatrix<double> guess = RowMatrix<double>::Identity(n, n_roots);
+    std::vector<Array> guess_ta(n_roots);
+    for (auto i = 0; i < n_roots; i++) {
+      guess_ta[i] = math::eigen_to_array<TA::TensorD, TA::DensePolicy>(
+          TA::get_default_world(), guess.col(i), tr_n, tr_guess);
+    }
+
+    DavidsonDiag<Array> dvd(n_roots, symmetric, n_guess, max_n_guess);
+    if (on_disk) dvd.use_disk_subspace_store(".");
+
+    Pred pred(M.diagonal());
+    eig = EigenVector<double>::Zero(n_roots);
+    auto i = 0;
+    for (; i < max_iter; i++) {
+      const auto n_v = guess_ta.size();
+      std::vector<Array> HB(n_v);
+      for (auto v = 0ul; v < n_v; v++) {
+        HB[v]("i,j") = M_ta("i,k") * guess_ta[v]("k,j");
+      }
+
+      EigenVector<double> eig_new, err;
+      std::tie(eig_new, err) = dvd.extrapolate(HB, guess_ta, &pred);
+
+      if ((eig - eig_new).norm() < converge) {
+        break;
+      }
+      eig = eig_new;
+    }
+    return i;
+  };
+
+  for (const auto on_disk : {false, true}) {
+    SECTION(on_disk ? "symmetric, on disk" : "symmetric, in core") {
+      RowMatrix<double> A_T = A.transpose();
+      RowMatrix<double> A_symm = 0.5 * (A_T + A);
+
+      Eigen::SelfAdjointEigenSolver<RowMatrix<double>> es(A_symm);
+      EigenVector<double> e = es.eigenvalues().segment(0, n_roots);
+
+      EigenVector<double> eig;
+      const auto n_iter = solve(A_symm, true, on_disk, eig);
+
+      CHECK((e - eig).norm() < 1.0e-7);
+      // more iterations than fit in the subspace, i.e. it was collapsed
+      CHECK(n_iter > max_n_guess);
+      CHECK(n_iter < max_iter);
+    }
+
+    SECTION(on_disk ? "nonsymmetric, on disk" : "nonsymmetric, in core") {
+      Eigen::EigenSolver<RowMatrix<double>> es(A);
+      EigenVector<double> e_all = es.eigenvalues().real();
+      std::sort(e_all.data(), e_all.data() + e_all.size());
+      EigenVector<double> e = e_all.segment(0, n_roots);
+
+      EigenVector<double> eig;
+      const auto n_iter = solve(A, false, on_disk, eig);
+
+      CHECK((e - eig).norm() < 1.0e-6);
+      CHECK(n_iter > max_n_guess);
+      CHECK(n_iter < max_iter);
+    }
+  }
+}
@@ -0,0 +1,116 @@
+#include "catch.hpp"
+
+#include <cmath>
+
+#include "array_fixture.h"
+#include "mpqc/chemistry/qc/lcao/cc/laplace_transform.h"
+#include "mpqc/chemistry/qc/lcao/mbpt/denom.h"
+
+using namespace mpqc;
+using mpqc::test::make_array;
+
+namespace {
+
+template <typename Array>
+double max_diff(Array &A, Array &B) {
+  const auto annotation = A.trange().rank() == 4
+                              ? std::string("p,q,r,s")
+                              : std::string("p,q,r,s,t,u");
+  Array diff;
+  diff(annotation) = A(annotation) - B(annotation);
+  return diff(annotation).abs_max().get();
+}
+
+template <typename Policy>
+void test_denominators() {
+  // 2 frozen core, 3 active occupied, 7 unoccupied orbitals
+  const std::size_t n_occ = 5;
+  const std::size_t n_frozen = 2;
+  Eigen::VectorXd ens(12);
+  for (auto p = 0; p != ens.size(); ++p) {
+    ens(p) = p < 5 ? -2.0 + 0.3 * p : 0.5 + 0.25 * (p - 5);
+  }
+  auto e_o = [&](std::size_t i) { return ens(i + n_frozen); };
+  auto e_v = [&](std::size_t a) { return ens(a + n_occ); };
+
+  // tiles of different extents, the innermost mode is split as well
+  const TA::TiledRange1 tr_v{0, 3, 7};
+  const TA::TiledRange1 tr_o{0, 1, 3};
+  const TA::TiledRange1 tr_x{0, 2, 5};
+
+  auto f = [](auto const &idx) {
+    double x = 1.0;
+    for (auto i = 0ul; i != idx.size(); ++i) x += (i + 2.0) * idx[i];
+    return std::sin(x);
+  };
+  // the tile {0,1,*,...} is zero
+  auto zero = [](auto const &tile_idx) {
+    return tile_idx[0] == 0 && tile_idx[1] == 1;
+  };
+
+  const TA::TiledRange trange4{tr_v, tr_v, tr_o, tr_o};
+  auto abij = make_array<Policy>(trange4, f, zero);
+
+  SECTION("doubles denominator") {
+    const double shift = 0.125;
+    auto ref = make_array<Policy>(
+        trange4,
+        [&](auto const &idx) {
+          return f(idx) / (shift + e_o(idx[2]) + e_o(idx[3]) - e_v(idx[0]) -
+                           e_v(idx[1]));
+        },
+        zero);
+
+    auto result = lcao::detail::d_abij(abij, ens, n_occ, n_frozen, shift);
+    CHECK(max_diff(result, ref) < 1.0e-12);
+
+    auto inplace = make_array<Policy>(trange4, f, zero);
+    lcao::detail::d_abij_inplace(inplace, ens, n_occ, n_frozen, shift);
+    CHECK(max_diff(inplace, ref) < 1.0e-12);
+  }
+
+  SECTION("triples denominator") {
+    const TA::TiledRange trange6{tr_v, tr_v, tr_v, tr_o, tr_o, tr_o};
+    auto abcijk = make_array<Policy>(trange6, f, zero);
+    auto ref = make_array<Policy>(
+        trange6,
+        [&](auto const &idx) {
+          return f(idx) / (e_o(idx[3]) + e_o(idx[4]) + e_o(idx[5]) -
+                           e_v(idx[0]) - e_v(idx[1]) - e_v(idx[2]));
+        },
+        zero);
+
+    auto result = lcao::detail::d_abcijk(abcijk, ens, n_occ, n_frozen);
+    CHECK(max_diff(result, ref) < 1.0e-12);
+  }
+
+  SECTION("Laplace transform") {
+    const double x = 0.3;
+    const double alpha = 3.0 * (ens(n_occ) - ens(n_occ - 1));
+    // the factor of a signed orbital energy
+    auto factor = [&](double e) {
+      return std::pow(x, -0.5 * (e / alpha + 1.0 / 6.0));
+    };
+
+    // the first mode does not contribute
+    const TA::TiledRange trange{tr_x, tr_v, tr_v, tr_o};
+    auto dabi = make_array<Policy>(trange, f, zero);
+    auto ref = make_array<Policy>(
+        trange,
+        [&](auto const &idx) {
+          return f(idx) * factor(-e_v(idx[1])) * factor(-e_v(idx[2])) *
+                 factor(e_o(idx[3]));
+        },
+        zero);
+
+    auto result = g_dabi_laplace_transform(dabi, ens, n_occ, n_frozen, x);
+    CHECK(max_diff(result, ref) < 1.0e-12);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Orbital energy denominators", "[denom]") {
+  SECTION("dense") { test_denominators<TA::DensePolicy>(); }
+  SECTION("sparse") { test_denominators<TA::SparsePolicy>(); }
+}
@@ -0,0 +1,73 @@
+#include "catch.hpp"
+
+#include <sstream>
+
+#include "mpqc/chemistry/qc/lcao/scf/eigen_solve_density_builder.h"
+#include "mpqc/chemistry/qc/lcao/scf/purification_density_build.h"
+#include "mpqc/chemistry/qc/lcao/wfn/ao_wfn.h"
+
+using namespace mpqc;
+
+TEST_CASE("Purification density builder", "[density-builder]") {
+  using Array = TA::TSpArrayD;
+  using ESolveBuilder =
+      lcao::scf::ESolveDensityBuilder<TA::TensorD, TA::SparsePolicy>;
+  using PurificationBuilder =
+      lcao::scf::PurificationDensityBuilder<TA::TensorD, TA::SparsePolicy>;
+  using AOWfn = lcao::AOWavefunction<TA::TensorD, TA::SparsePolicy>;
+  using AtomicBasis = lcao::gaussian::AtomicBasis;
+  auto &world = TA::get_default_world();
+
+  const char h2o_xyz_cstr[] =
+      "3\n"
+      "\n"
+      "O   -0.702196054  -0.056060256   0.009942262\n"
+      "H   -1.022193224   0.846775782  -0.011488714\n"
+      "H    0.257521062   0.042121496   0.005218999\n";
+
+  libint2::initialize();
+
+  std::stringstream iss((std::string(h2o_xyz_cstr)));
+  auto mol = std::make_shared<Molecule>(iss);
+  auto obs = std::make_shared<AtomicBasis>(KeyVal()
+                                               .assign("atoms", mol)
+                                               .assign("world", &world)
+                                               .assign("name", "6-31G")
+                                               .assign("reblock", 4));
+  auto aowfn = std::make_shared<AOWfn>(KeyVal()
+                                           .assign("world", &world)
+                                           .assign("atoms", mol)
+                                           .assign("basis", obs));
+  auto &ao_factory = aowfn->ao_factory();
+
+  auto max_diff = [](Array &A, Array &B) {
+    Array diff;
+    diff("i,j") = A("i,j") - B("i,j");
+    return diff("i,j").abs_max().get();
+  };
+
+  // the core Hamiltonian is a valid Fock matrix with a nonzero HOMO-LUMO gap
+  Array S = ao_factory.compute(L"<μ|ν>");
+  Array H = ao_factory.compute(L"<μ|H|ν>");
+  const auto nocc = mol->total_atomic_number() / 2;
+  const auto ncore = mol->core_electrons() / 2;
+
+  ESolveBuilder esolve_builder(S, {}, nocc, ncore, 1, 0.0, "inverse_sqrt");
+  auto D_ref = esolve_builder(H).first;
+
+  SECTION("trace-correcting purification") {
+    PurificationBuilder builder(S, {}, nocc, ncore, 1);
+    auto D = builder(H).first;
+    CHECK(max_diff(D, D_ref) < 1.0e-8);
+  }
+
+  SECTION("TRS4 purification") {
+    PurificationBuilder builder(S, {}, nocc, ncore, 1, 0.0, nullptr, true,
+                                false, "trs4");
+    builder.set_target_precision(1.0e-10);
+    auto D = builder(H).first;
+    CHECK(max_diff(D, D_ref) < 1.0e-6);
+  }
+
+  libint2::finalize();
+}
@@ -0,0 +1,33 @@
+#include "catch.hpp"
+
+#include <tiledarray.h>
+
+#include "mpqc/math/function/findif.h"
+
+using namespace mpqc;
+
+TEST_CASE("Finite-difference subworld errors", "[findif]") {
+  auto &world = TA::get_default_world();
+
+  SECTION("no exception") {
+    REQUIRE_NOTHROW(math::detail::rethrow_if_any(world, nullptr));
+  }
+
+  SECTION("exception on one process") {
+    // the exception is rethrown by the process that caught it, the other
+    // processes throw AlgorithmException
+    std::exception_ptr eptr;
+    if (world.rank() == 0) {
+      try {
+        throw InputError("bad input", __FILE__, __LINE__);
+      } catch (...) {
+        eptr = std::current_exception();
+      }
+    }
+    if (world.rank() == 0)
+      REQUIRE_THROWS_AS(math::detail::rethrow_if_any(world, eptr), InputError);
+    else
+      REQUIRE_THROWS_AS(math::detail::rethrow_if_any(world, eptr),
+                        AlgorithmException);
+  }
+}
@@ -0,0 +1,141 @@
+#include "catch.hpp"
+
+#include <sstream>
+
+#include "mpqc/chemistry/qc/lcao/scf/traditional_four_center_fock_builder.h"
+#include "mpqc/chemistry/qc/lcao/wfn/ao_wfn.h"
+
+using namespace mpqc;
+
+TEST_CASE("Four-center Fock builder", "[fock-builder]") {
+  using Array = TA::TSpArrayD;
+  using Builder =
+      lcao::scf::FourCenterFockBuilder<TA::TensorD, TA::SparsePolicy>;
+  using AOWfn = lcao::AOWavefunction<TA::TensorD, TA::SparsePolicy>;
+  using AtomicBasis = lcao::gaussian::AtomicBasis;
+  auto &world = TA::get_default_world();
+
+  const char h2o_xyz_cstr[] =
+      "3\n"
+      "\n"
+      "O   -0.702196054  -0.056060256   0.009942262\n"
+      "H   -1.022193224   0.846775782  -0.011488714\n"
+      "H    0.257521062   0.042121496   0.005218999\n";
+
+  libint2::initialize();
+
+  std::stringstream iss((std::string(h2o_xyz_cstr)));
+  auto mol = std::make_shared<Molecule>(iss);
+  // several tiles, such that the tile quartets of the builder are exercised
+  auto obs = std::make_shared<AtomicBasis>(KeyVal()
+                                               .assign("atoms", mol)
+                                               .assign("world", &world)
+                                               .assign("name", "6-31G")
+                                               .assign("reblock", 4));
+  auto aowfn = std::make_shared<AOWfn>(KeyVal()
+                                           .assign("world", &world)
+                                           .assign("atoms", mol)
+                                           .assign("basis", obs));
+  auto &ao_factory = aowfn->ao_factory();
+
+  const double precision = 1.0e-12;
+  auto max_diff = [](Array &A, Array &B) {
+    Array diff;
+    diff("i,j") = A("i,j") - B("i,j");
+    return diff("i,j").abs_max().get();
+  };
+
+  // symmetric densities
+  Array S = ao_factory.compute(L"<μ|ν>");
+  Array T = ao_factory.compute(L"<μ|T|ν>");
+  Array D1, D2;
+  D1("i,j") = 0.5 * S("i,j");
+  D2("i,j") = 0.1 * (S("i,k") * T("k,j") + T("i,k") * S("k,j"));
+
+  SECTION("incremental builds") {
+    const std::size_t rebuild_period = 3;
+    Builder builder(world, obs, obs, obs, true, true, "schwarz", precision);
+    Builder incremental_builder(world, obs, obs, obs, true, true, "schwarz",
+                                precision, true, rebuild_period);
+
+    // a full build is followed by rebuild_period-1 incremental builds
+    const std::size_t nbuilds = 7;
+    std::size_t nfull = 0;
+    for (auto n = 0ul; n != nbuilds; ++n) {
+      Array D;
+      D("i,j") = D1("i,j") + (0.5 * n) * D2("i,j");
+      auto G = builder(D, D, precision);
+      auto G_incremental = incremental_builder(D, D, precision);
+      const auto incremental = incremental_builder.last_build_incremental();
+      REQUIRE(incremental == (n % rebuild_period != 0));
+      if (!incremental) ++nfull;
+      CHECK(max_diff(G_incremental, G) < 1.0e-8);
+    }
+    REQUIRE(nfull == 3);
+
+    // with a rebuild period of 1 every build is full
+    Builder full_builder(world, obs, obs, obs, true, true, "schwarz",
+                         precision, true, 1);
+    for (auto n = 0ul; n != 3; ++n) {
+      Array D;
+      D("i,j") = D1("i,j") + (0.5 * n) * D2("i,j");
+      full_builder(D, D, precision);
+      REQUIRE(!full_builder.last_build_incremental());
+    }
+  }
+
+  SECTION("multi-density builds") {
+    // antisymmetric density, only its exchange contribution is nonzero
+    Array A;
+    A("i,j") = 0.1 * (S("i,k") * T("k,j") - T("i,k") * S("k,j"));
+    Array eri4 = ao_factory.compute(L"(μ ν| G|κ λ)");
+    Array G_A_ref;
+    G_A_ref("mu,nu") = -1.0 * eri4("mu,rho,nu,sig") * A("rho,sig");
+
+    Builder builder(world, obs, obs, obs, true, true, "schwarz", precision);
+    auto G1_ref = builder(D1, D1, precision);
+    auto G2_ref = builder(D2, D2, precision);
+
+    for (std::string reduction : {"locked", "thread_local"}) {
+      Builder multi_builder(world, obs, obs, obs, true, true, "schwarz",
+                            precision, false, 8, reduction);
+      auto G = multi_builder.compute_JK_multi({D1, D2, A}, precision,
+                                              {false, false, true});
+      REQUIRE(G.size() == 3);
+      CHECK(max_diff(G[0], G1_ref) < 1.0e-10);
+      CHECK(max_diff(G[1], G2_ref) < 1.0e-10);
+      CHECK(max_diff(G[2], G_A_ref) < 1.0e-10);
+    }
+  }
+
+  SECTION("reductions") {
+    Builder locked_builder(world, obs, obs, obs, true, true, "schwarz",
+                           precision, false, 8, "locked");
+    Builder thread_local_builder(world, obs, obs, obs, true, true, "schwarz",
+                                 precision, false, 8, "thread_local");
+    auto G_locked = locked_builder(D1, D1, precision);
+    auto G_thread_local = thread_local_builder(D1, D1, precision);
+    CHECK(max_diff(G_thread_local, G_locked) < 1.0e-12);
+
+    // the builders are reusable, e.g. by the next SCF iteration
+    auto G2_locked = locked_builder(D2, D2, precision);
+    auto G2_thread_local = thread_local_builder(D2, D2, precision);
+    CHECK(max_diff(G2_thread_local, G2_locked) < 1.0e-12);
+  }
+
+  SECTION("cached shell-pair data") {
+    // the shell-pair data cached by the first build is reused by later builds,
+    // also with a lower integral precision
+    const double low_precision = 1.0e-8;
+    Builder builder(world, obs, obs, obs, true, true, "schwarz", precision);
+    builder(D1, D1, precision);
+    auto G = builder(D2, D2, low_precision);
+
+    Builder fresh_builder(world, obs, obs, obs, true, true, "schwarz",
+                          precision);
+    auto G_ref = fresh_builder(D2, D2, low_precision);
+    CHECK(max_diff(G, G_ref) < 1.0e-12);
+  }
+
+  libint2::finalize();
+}
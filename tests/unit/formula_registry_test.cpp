@@ -0,0 +1,95 @@
+#include "catch.hpp"
+#include "mpqc/chemistry/qc/lcao/expression/formula_registry.h"
+
+using namespace mpqc;
+
+TEST_CASE("Formula Registry", "[formula-registry]") {
+  using Array = TA::DistArray<TA::TensorD, TA::DensePolicy>;
+  auto &world = TA::get_default_world();
+
+  const auto n = 10;
+  TA::TiledRange1 tr1{0, n};
+  TA::TiledRange trange{tr1, tr1, tr1};
+  // one tile, i.e. the largest local size is the size of the array
+  const std::size_t size = n * n * n * sizeof(double);
+
+  auto make_array = [&](double value) {
+    Array result(world, trange);
+    result.fill_local(value);
+    return result;
+  };
+  auto equal = [](Array &A, Array &B) {
+    return (A("i,j,k") - B("i,j,k")).norm().get() < 1.0e-12;
+  };
+
+  const Formula f1(L"( Κ|G|κ λ)");
+  const Formula f2(L"( Κ|G|i a)");
+
+  FormulaRegistry<Array> registry;
+  // only one of the arrays fits in memory
+  registry.set_memory_limit(size + size / 2);
+
+  auto A = make_array(1.0);
+  auto B = make_array(2.0);
+  registry.insert(f1, A);
+  registry.insert(f2, B);
+  // f1 is spilled
+  REQUIRE(registry.memory_used() == size);
+  REQUIRE(registry.registry().size() == 1);
+  REQUIRE(registry.have(f1));
+
+  SECTION("update") {
+    // updating the spilled f1 makes it resident, f2 is spilled
+    auto C = make_array(3.0);
+    registry.update(f1, C);
+    REQUIRE(registry.memory_used() == size);
+    REQUIRE(registry.registry().size() == 1);
+    REQUIRE(registry.find(f1) != registry.registry().end());
+    REQUIRE(equal(registry.retrieve(f1), C));
+
+    // updating the resident f1 does not change the memory used
+    auto D = make_array(4.0);
+    registry.update(f1, D);
+    REQUIRE(registry.memory_used() == size);
+    REQUIRE(equal(registry.retrieve(f1), D));
+
+    // f2 is restored with its value
+    REQUIRE(equal(registry.retrieve(f2), B));
+    REQUIRE(registry.memory_used() == size);
+
+    REQUIRE_THROWS(registry.update(Formula(L"( Κ|G|i j)"), D));
+  }
+
+  SECTION("const lookup") {
+    // the const lookup restores the spilled f1, f2 is spilled
+    const auto& const_registry = registry;
+    REQUIRE(const_registry.have(f1));
+    REQUIRE(const_registry.find(f1) != const_registry.registry().end());
+    auto C = const_registry.retrieve(f1);
+    REQUIRE(equal(C, A));
+    REQUIRE(const_registry.memory_used() == size);
+    REQUIRE(const_registry.registry().size() == 1);
+
+    auto D = const_registry.retrieve(f2);
+    REQUIRE(equal(D, B));
+    REQUIRE_THROWS(const_registry.retrieve(Formula(L"( Κ|G|i j)")));
+  }
+
+  SECTION("remove") {
+    // remove the spilled f1
+    registry.remove(f1);
+    REQUIRE(!registry.have(f1));
+    REQUIRE(registry.memory_used() == size);
+
+    // remove the resident f2
+    registry.remove(f2);
+    REQUIRE(!registry.have(f2));
+    REQUIRE(registry.memory_used() == 0);
+    REQUIRE(registry.registry().empty());
+
+    // the removed keys can be inserted again
+    registry.insert(f1, A);
+    REQUIRE(registry.memory_used() == size);
+    REQUIRE(equal(registry.retrieve(f1), A));
+  }
+}
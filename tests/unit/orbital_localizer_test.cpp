@@ -1099,4 +1099,41 @@ TEST_CASE("Foster-Boys Localizer", "[localizer]") {
       REQUIRE(row_has_identity == true);
     }
   }
+
+  // tournament ordering of the Jacobi rotations converges to the same
+  // localized orbitals, up to permutation
+  {
+    auto target_precision = 1e-8;
+    auto expected_precision = target_precision * 5e3;
+
+    mpqc::lcao::scf::FosterBoysLocalizer<Tile, Policy> localizer(
+        KeyVal{}
+            .assign("max_iter", 10000)
+            .assign("convergence", target_precision)
+            .assign("ordering", "tournament"));
+    localizer.initialize(ao_s, {ao_x, ao_y, ao_z});
+
+    auto U_ta = localizer.compute(C_ta, ncore);
+    auto U = math::array_to_eigen(U_ta);
+    decltype(C) Cloc = C * U;
+    detail::canonical_column_phase(Cloc, 1e-10);
+
+    decltype(C) Ip = Cref.transpose() * ao_s * Cloc;
+    std::vector<bool> column_has_identity(Ip.cols(), false);
+    for(int r=0; r!=Ip.rows(); ++r) {
+      bool row_has_identity = false;
+      for(int c=0; c!=Ip.cols(); ++c) {
+        bool is_identity = (std::abs(Ip(r,c) - 1) <= expected_precision);
+        if (is_identity) {
+          REQUIRE(row_has_identity == false);
+          REQUIRE(column_has_identity[c] == false);
+          row_has_identity = true;
+          column_has_identity[c] = true;
+        }
+        else
+          REQUIRE(std::abs(Ip(r,c)) <= expected_precision);
+      }
+      REQUIRE(row_has_identity == true);
+    }
+  }
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "catch.hpp"
+#include "array_fixture.h"
+#include "mpqc/chemistry/qc/lcao/cc/packed_t3.h"
+
+using namespace mpqc;
+using mpqc::test::make_array;
+
+namespace {
+
+template <typename Policy>
+void test_pack_unpack_t3() {
+  using Array = TA::DistArray<TA::TensorD, Policy>;
+
+  // tiles of different extents
+  const TA::TiledRange1 tr_v{0, 2, 5, 6};
+  const TA::TiledRange1 tr_o{0, 1, 3};
+
+  // invariant to the simultaneous permutation of the pairs (a,i), (b,j),
+  // (c,k); the tiles with unoccupied tiles {0,1,1} (in any order) are zero
+  auto p = [](std::size_t a, std::size_t i) {
+    return std::sin(1.0 + a + 2.0 * i);
+  };
+  auto q = [](std::size_t a, std::size_t i) { return std::cos(a * (3.0 + i)); };
+  auto t3 = make_array<Policy>(
+      TA::TiledRange{tr_v, tr_v, tr_v, tr_o, tr_o, tr_o},
+      [&p, &q](auto const &idx) {
+        return p(idx[0], idx[3]) * p(idx[1], idx[4]) * p(idx[2], idx[5]) +
+               q(idx[0], idx[3]) + q(idx[1], idx[4]) + q(idx[2], idx[5]);
+      },
+      [](auto const &tile_idx) {
+        std::array<std::size_t, 3> abc{{std::size_t(tile_idx[0]),
+                                        std::size_t(tile_idx[1]),
+                                        std::size_t(tile_idx[2])}};
+        std::sort(abc.begin(), abc.end());
+        return abc[0] == 0 && abc[1] == 1 && abc[2] == 1;
+      });
+
+  auto packed = lcao::cc::pack_t3(t3);
+  // the tile triples A>=B>=C of 3 tiles, which hold all triples of the
+  // multisets of 3 tiles of extents 2, 3 and 1
+  REQUIRE(packed.trange().dim(0).tile_extent() == 10);
+  REQUIRE(packed.trange().dim(0).extent() == 90);
+
+  // the unpacked tiles are evaluated in expressions, contract the occupied
+  // index j with the identity to get them all
+  auto unpacked = lcao::cc::direct_unpacked_t3(packed, tr_v);
+  auto identity = make_array<Policy>(
+      TA::TiledRange{tr_o, tr_o},
+      [](auto const &idx) { return idx[0] == idx[1] ? 1.0 : 0.0; },
+      [](auto const &tile_idx) { return tile_idx[0] != tile_idx[1]; });
+
+  Array result;
+  result("a,b,c,i,j,k") = unpacked("a,b,c,i,l,k") * identity("l,j");
+  Array diff;
+  diff("a,b,c,i,j,k") = result("a,b,c,i,j,k") - t3("a,b,c,i,j,k");
+  CHECK(diff("a,b,c,i,j,k").abs_max().get() < 1.0e-12);
+}
+
+}  // namespace
+
+TEST_CASE("Packed triples amplitudes", "[packed-t3]") {
+  SECTION("dense") { test_pack_unpack_t3<TA::DensePolicy>(); }
+  SECTION("sparse") { test_pack_unpack_t3<TA::SparsePolicy>(); }
+}
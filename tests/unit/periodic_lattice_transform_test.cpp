@@ -0,0 +1,150 @@
+#include "catch.hpp"
+#include "mpqc/chemistry/molecule/lattice/util.h"
+#include "mpqc/chemistry/qc/lcao/scf/pbc/periodic_lattice_transform.h"
+
+using namespace mpqc;
+
+TEST_CASE("Periodic Lattice Transform", "[lattice-transform]") {
+  using Array = TA::DistArray<TA::TensorD, TA::DensePolicy>;
+  using ArrayZ = TA::DistArray<TA::TensorZ, TA::DensePolicy>;
+  auto &world = TA::get_default_world();
+
+  // 1D chain along z, even number of k points: exp(I k.R) is anti-periodic
+  // in R with the period of the k mesh, and the k mesh is not centered on an
+  // integer offset
+  const auto n = 3;
+  const Vector3d dcell(0.0, 0.0, 2.0);
+  const Vector3i real_lattice_range(0, 0, 5);
+  const Vector3i nk(1, 1, 4);
+  const auto R_size =
+      1 + detail::direct_ord_idx(real_lattice_range, real_lattice_range);
+  const auto k_size = nk.prod();
+
+  auto value = [](int64_t mu, int64_t nu, int64_t R) {
+    return std::sin(1.0 + mu + 2.0 * nu + 3.0 * R);
+  };
+
+  TA::TiledRange1 tr0{0, n};
+  Array M(world, TA::TiledRange({tr0, detail::extend_trange1(tr0, R_size)}));
+  for (auto it = M.pmap()->begin(); it != M.pmap()->end(); ++it) {
+    TA::TensorD tile(M.trange().make_tile_range(*it));
+    const auto R = tile.range().lobound_data()[1] / n;
+    for (auto mu = 0; mu != n; ++mu)
+      for (auto nu = 0; nu != n; ++nu)
+        tile(mu, R * n + nu) = value(mu, nu, R);
+    M.set(*it, tile);
+  }
+  world.gop.fence();
+
+  scf::PeriodicLatticeTransform<TA::DensePolicy> transform(world, dcell);
+
+  SECTION("real to reciprocal space") {
+    ArrayZ Mk = transform.real2recip(M, real_lattice_range, nk);
+    for (auto k = 0; k != k_size; ++k) {
+      const auto tile =
+          Mk.find(std::array<std::size_t, 2>{{0ul, std::size_t(k)}}).get();
+      const auto k_vec = detail::k_vector(k, nk, dcell);
+      for (auto mu = 0; mu != n; ++mu) {
+        for (auto nu = 0; nu != n; ++nu) {
+          std::complex<double> ref(0.0, 0.0);
+          for (auto R = 0; R != R_size; ++R) {
+            const auto R_vec =
+                detail::direct_vector(R, real_lattice_range, dcell);
+            ref += std::exp(std::complex<double>(0.0, k_vec.dot(R_vec))) *
+                   value(mu, nu, R);
+          }
+          REQUIRE(std::abs(tile(mu, k * n + nu) - ref) < 1.0e-12);
+        }
+      }
+    }
+  }
+
+  SECTION("reciprocal to real space") {
+    ArrayZ Mk = transform.real2recip(M, real_lattice_range, nk);
+    Array MR = transform.recip2real(Mk, real_lattice_range, nk);
+
+    std::vector<TA::TensorZ> k_tiles;
+    for (auto k = 0; k != k_size; ++k)
+      k_tiles.push_back(
+          Mk.find(std::array<std::size_t, 2>{{0ul, std::size_t(k)}}).get());
+
+    for (auto R = 0; R != R_size; ++R) {
+      const auto tile =
+          MR.find(std::array<std::size_t, 2>{{0ul, std::size_t(R)}}).get();
+      const auto R_vec = detail::direct_vector(R, real_lattice_range, dcell);
+      for (auto mu = 0; mu != n; ++mu) {
+        for (auto nu = 0; nu != n; ++nu) {
+          std::complex<double> ref(0.0, 0.0);
+          for (auto k = 0; k != k_size; ++k) {
+            const auto k_vec = detail::k_vector(k, nk, dcell);
+            ref += std::exp(std::complex<double>(0.0, k_vec.dot(R_vec))) *
+                   k_tiles[k](mu, k * n + nu);
+          }
+          REQUIRE(std::abs(tile(mu, R * n + nu) - ref.real() / k_size) <
+                  1.0e-12);
+        }
+      }
+    }
+  }
+
+  SECTION("time-reversal symmetry") {
+    // the k mesh of an odd number of points is symmetric, -k is k_size-1-k
+    const Vector3i nk_odd(1, 1, 5);
+    const auto k_odd_size = nk_odd.prod();
+    auto is_irreducible = [k_odd_size](int64_t k) {
+      return k <= k_odd_size - 1 - k;
+    };
+    auto k_tile = [&](const ArrayZ &A, int64_t k) {
+      return A.find(std::array<std::size_t, 2>{{0ul, std::size_t(k)}}).get();
+    };
+    auto k_matrix = [&](const ArrayZ &A, int64_t k) {
+      const auto tile = k_tile(A, k);
+      MatrixZ result(n, n);
+      for (auto mu = 0; mu != n; ++mu)
+        for (auto nu = 0; nu != n; ++nu) result(mu, nu) = tile(mu, k * n + nu);
+      return result;
+    };
+
+    ArrayZ Mk = transform.real2recip(M, real_lattice_range, nk_odd);
+    ArrayZ Mk_reduced =
+        transform.real2recip(M, real_lattice_range, nk_odd, true);
+
+    for (auto k = 0; k != k_odd_size; ++k) {
+      const MatrixZ Mk_k = k_matrix(Mk, k);
+      if (is_irreducible(k)) {
+        // the reduced mesh has the same irreducible blocks
+        REQUIRE((k_matrix(Mk_reduced, k) - Mk_k).norm() < 1.0e-12);
+      } else {
+        // M(-k) = M(k)^* since M(R) is real
+        const MatrixZ Mk_minus_k = k_matrix(Mk, k_odd_size - 1 - k);
+        REQUIRE((Mk_k - Mk_minus_k.conjugate()).norm() < 1.0e-12);
+
+        // hence the eigenvectors of the Hermitian part satisfy
+        // C(-k) = C(k)^* with the same eigenvalues, as zRHF assumes
+        const MatrixZ F = 0.5 * (Mk_minus_k + Mk_minus_k.adjoint());
+        Eigen::SelfAdjointEigenSolver<MatrixZ> solver(F);
+        const MatrixZ C_minus_k = solver.eigenvectors().conjugate();
+        const MatrixZ F_k = 0.5 * (Mk_k + Mk_k.adjoint());
+        const MatrixZ FC = F_k * C_minus_k;
+        const MatrixZ CE =
+            C_minus_k * solver.eigenvalues().cast<std::complex<double>>()
+                            .asDiagonal();
+        REQUIRE((FC - CE).norm() < 1.0e-10);
+      }
+    }
+
+    // the real-space matrix from the reduced mesh matches the full mesh
+    Array MR = transform.recip2real(Mk, real_lattice_range, nk_odd);
+    Array MR_reduced =
+        transform.recip2real(Mk_reduced, real_lattice_range, nk_odd, true);
+    for (auto R = 0; R != R_size; ++R) {
+      const std::array<std::size_t, 2> idx{{0ul, std::size_t(R)}};
+      const auto tile = MR.find(idx).get();
+      const auto tile_reduced = MR_reduced.find(idx).get();
+      for (auto mu = 0; mu != n; ++mu)
+        for (auto nu = 0; nu != n; ++nu)
+          REQUIRE(std::abs(tile_reduced(mu, R * n + nu) -
+                           tile(mu, R * n + nu)) < 1.0e-12);
+    }
+  }
+}
@@ -0,0 +1,37 @@
+#include "catch.hpp"
+
+#include <vector>
+
+#include <tiledarray.h>
+
+#include "mpqc/util/external/madworld/task_counter.h"
+
+using namespace mpqc;
+
+TEST_CASE("Dynamic task distribution", "[task-counter]") {
+  auto &world = TA::get_default_world();
+
+  const std::size_t ntasks = 50;
+  const std::size_t first = 1;
+
+  // each task is claimed by exactly one rank, for any chunk size
+  for (std::size_t chunk_size : {1, 3, 64}) {
+    std::vector<int> visits(ntasks, 0);
+    {
+      utility::TaskCounter counter(world, first);
+      utility::TaskFetcher fetcher(counter, chunk_size);
+      std::size_t last = 0;
+      for (auto task = first; task != first + ntasks; ++task) {
+        if (task != fetcher.current()) continue;
+        // the tasks of a rank are claimed in increasing order
+        REQUIRE(task > last);
+        last = task;
+        ++visits[task - first];
+        fetcher.advance();
+      }
+      world.gop.fence();
+    }
+    world.gop.sum(visits.data(), visits.size());
+    for (auto task = 0ul; task != ntasks; ++task) REQUIRE(visits[task] == 1);
+  }
+}
@@ -3,10 +3,20 @@ macro(runtest)
 
 set(OUTPUT_FILE_NAME "${CMAKE_BINARY_DIR}/${testName}.out")
 
+# a test that must reproduce the result of another test, e.g. an alternative
+# algorithm, names the reference output of that test with the
+# "reference_output" keyword of its input
+file(READ "${srcDir}/reference/inputs/${testName}.json" infileContents)
+if ("${infileContents}" MATCHES "\"reference_output\"[\r\n\t ]*:[\r\n\t ]*\"([-a-zA-Z0-9_.]+)\"")
+  set(refName "${CMAKE_MATCH_1}")
+else()
+  set(refName "${testName}")
+endif()
+
 set(CHECK_CMD "${pythonExec}")
 set(CHECK_ARGS "${srcDir}/check.py"
 "${OUTPUT_FILE_NAME}"
-"${srcDir}/reference/outputs/${testName}.out")
+"${srcDir}/reference/outputs/${refName}.out")
 
 set(ENV{MAD_NUM_THREADS} 2)
 #if (NOT EXISTS "${OUTPUT_FILE_NAME}")
@@ -25,7 +35,6 @@ if (1)
   # filter out tests based on the registered classes
   # parse the wfn type from the input file, make sure it has a match in the registered class list
   if (${MPQC_DC_RESULT} EQUAL 0)
-      file(READ "${srcDir}/reference/inputs/${testName}.json" infileContents)
       string(REGEX REPLACE ".*\"wfn\"[\r\n\t ]*:[\r\n\t ]*{[\r\n\t ]*\"type\"[\r\n\t ]*:[\r\n\t ]*\"\([-a-zA-Z0-9 _]+\)\".*"
               "\\1" wfnType "${infileContents}")
       if (NOT "${MPQC_DC_OUTPUT}" MATCHES "${wfnType}")